@@ -43,6 +43,21 @@ namespace raptor_raytracer
 #define SHADOW_ARRAY_SIZE 1
 #endif /* #ifdef SOFT_SHADOW */
 
+/* Number of lights picked to shadow test from each hit, scenes with more lights than this sample them by importance */
+#ifndef LIGHT_SAMPLES
+#define LIGHT_SAMPLES 16
+#endif /* #ifndef LIGHT_SAMPLES */
+
+/* Cached textures are split into square tiles 2^LOG2_TEXTURE_TILE_SIZE texels a side */
+#ifndef LOG2_TEXTURE_TILE_SIZE
+#define LOG2_TEXTURE_TILE_SIZE 5
+#endif /* #ifndef LOG2_TEXTURE_TILE_SIZE */
+
+/* Default bytes of texture tiles the texture cache keeps in memory */
+#ifndef TEXTURE_CACHE_BUDGET
+#define TEXTURE_CACHE_BUDGET (256 << 20)
+#endif /* #ifndef TEXTURE_CACHE_BUDGET */
+
 /* Define the size of the bih trace stack */
 /* A bih may not grow to be bigger than this */
 #ifndef MAX_BIH_STACK_HEIGHT
@@ -64,6 +79,22 @@ namespace raptor_raytracer
 #define MAX_BVH_STACK_HEIGHT 100
 #endif
 
+/* Define the size of the wide bvh trace stack */
+/* Each level may stack all but one of its children */
+#ifndef MAX_WIDE_BVH_STACK_HEIGHT
+#define MAX_WIDE_BVH_STACK_HEIGHT ((MAX_BVH_STACK_HEIGHT * (SIMD_WIDTH - 1)) + 1)
+#endif
+
+/* A refit bvh is rebuilt once its SAH cost has grown by this factor since it was built */
+#ifndef BVH_REBUILD_FACTOR
+#define BVH_REBUILD_FACTOR 1.5f
+#endif /* #ifndef BVH_REBUILD_FACTOR */
+
+/* Define the number of planes per axis the top level acceleration structure builder evaluates */
+#ifndef TLAS_BUILDER_BINS
+#define TLAS_BUILDER_BINS 16
+#endif /* #ifndef TLAS_BUILDER_BINS */
+
 
 /* Define the size of the kd tree trace stack */
 /* A kd tree may not grow to be bigger than this */
@@ -81,6 +112,16 @@ namespace raptor_raytracer
 #define MIN_APPROX_KDT_BUILDER_NODE_SIZE 150
 #endif /* #ifndef MIN_APPROX_KDT_BUILDER_NODE_SIZE */
 
+/* Define the number of planes per axis the binned kd tree builder evaluates */
+#ifndef KDT_BUILDER_BINS
+#define KDT_BUILDER_BINS 32
+#endif /* #ifndef KDT_BUILDER_BINS */
+
+/* Nodes with at least this many primitives are binned and split in parallel */
+#ifndef KDT_BUILDER_PARALLEL_SIZE
+#define KDT_BUILDER_PARALLEL_SIZE 4096
+#endif /* #ifndef KDT_BUILDER_PARALLEL_SIZE */
+
 /* Define the kd tree completion criteria */
 #ifndef COST_OF_TRAVERSAL
 #define COST_OF_TRAVERSAL 0.15f
@@ -112,16 +153,16 @@ namespace raptor_raytracer
 
 /* SIMD numbers */
 #ifdef SIMD_PACKET_TRACING
-/* The maximum allowed number of SIMD vectors in a packet */
-/* Must be a power of 4, including 0 */
+/* The maximum allowed number of SIMD vectors in a packet, by default 8x8 rays at any SIMD_WIDTH */
+/* The number of rays, MAXIMUM_PACKET_SIZE * SIMD_WIDTH, must be a power of 4 */
 #ifndef MAXIMUM_PACKET_SIZE
-#define MAXIMUM_PACKET_SIZE     16
+#define MAXIMUM_PACKET_SIZE     (64 / SIMD_WIDTH)
 #endif
 
 /* The minimum allowed number of SIMD vectors in a packet */
-/* Must be a power of 4, including 0 */
+/* The number of rays, MINIMUM_PACKET_SIZE * SIMD_WIDTH, must be a power of 4 */
 #ifndef MINIMUM_PACKET_SIZE
-#define MINIMUM_PACKET_SIZE     16
+#define MINIMUM_PACKET_SIZE     (64 / SIMD_WIDTH)
 #endif
 
 /* The factor to reduce the packet size by everytime it is split */
@@ -130,7 +171,7 @@ namespace raptor_raytracer
 #define SPLIT_PACKET_DIVISOR    4
 #endif
 
-#define PACKET_WIDTH            (unsigned)sqrt(MAXIMUM_PACKET_SIZE * SIMD_WIDTH)
+#define PACKET_WIDTH            (unsigned)std::sqrt(MAXIMUM_PACKET_SIZE * SIMD_WIDTH)
 
 #else   /* #ifdef SIMD_PACKET_TRACING */
 
@@ -150,9 +191,24 @@ namespace raptor_raytracer
 #define SPLIT_PACKET_DIVISOR    1
 #endif
 
-#define PACKET_WIDTH            (unsigned)sqrt(MAXIMUM_PACKET_SIZE * SIMD_WIDTH)
+#define PACKET_WIDTH            (unsigned)std::sqrt(MAXIMUM_PACKET_SIZE * SIMD_WIDTH)
 #endif  /* #ifdef SIMD_PACKET_TRACING */
 
+/* Minimum number of bytes of a model file parsed by each thread */
+#ifndef PARSER_CHUNK_SIZE
+#define PARSER_CHUNK_SIZE (1 << 20)
+#endif /* #ifndef PARSER_CHUNK_SIZE */
+
+/* Number of jobs a render farm coordinator keeps queued at each worker to hide the network latency */
+#ifndef FARM_JOBS_IN_FLIGHT
+#define FARM_JOBS_IN_FLIGHT 2
+#endif /* #ifndef FARM_JOBS_IN_FLIGHT */
+
+/* Once there is no new work a render farm job running this many times longer than the average job is duplicated on an idle worker */
+#ifndef FARM_STRAGGLER_FACTOR
+#define FARM_STRAGGLER_FACTOR 4
+#endif /* #ifndef FARM_STRAGGLER_FACTOR */
+
 /* Primitive list to hold primitives */
 class light;
 typedef std::vector<light> light_list;
@@ -244,6 +300,9 @@ enum class model_format_t : char { cfg = 0, code = 1, mgf = 2, nff = 3, lwo = 4,
 /* Enumerate the output file formats */
 enum class image_format_t : char { tga = 0, jpg = 1, png = 2 };
 
+/* Enumerate the spatial sub divisions */
+enum class ssd_type_t : char { kdt = 0, bvh = 1, bih = 2, wbvh = 3, bkdt = 4 };
+
 /* Function to generate a random number between -1 and 1 */
 float gen_random_mersenne_twister();
 }; /* namespace raptor_raytracer */
@@ -4,9 +4,26 @@ const vfp_t vfp_zero   = vfp_t(0.0f);
 const vfp_t vfp_one    = vfp_t(1.0f);
 const vfp_t vfp_true   = vfp_t(bit_cast<unsigned, float>(0xffffffff));
 
-const vfp_t index_to_mask_lut[SIMD_WIDTH]       = { vfp_t(0.0f,                                  0.0f,                                  0.0f,                                  0.0f),
-                                                    vfp_t(bit_cast<unsigned, float>(0xffffffff), 0.0f,                                  0.0f,                                  0.0f),
-                                                    vfp_t(bit_cast<unsigned, float>(0xffffffff), bit_cast<unsigned, float>(0xffffffff), 0.0f,                                  0.0f),
-                                                    vfp_t(bit_cast<unsigned, float>(0xffffffff), bit_cast<unsigned, float>(0xffffffff), bit_cast<unsigned, float>(0xffffffff), 0.0f) };
+/* Vector with the lanes below i set */
+static vfp_t lanes_below(const int i)
+{
+    float m[SIMD_WIDTH] __attribute__ ((aligned(SIMD_WIDTH * 4)));
+    for (int j = 0; j < SIMD_WIDTH; ++j)
+    {
+        m[j] = (j < i) ? bit_cast<unsigned, float>(0xffffffff) : 0.0f;
+    }
 
-const int   mask_to_index_lut[1 << SIMD_WIDTH]  = { 0, 0, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3 };
+    return vfp_t(&m[0]);
+}
+
+#if SIMD_WIDTH == 4
+const vfp_t index_to_mask_lut[SIMD_WIDTH]       = { lanes_below(0), lanes_below(1), lanes_below(2), lanes_below(3) };
+#elif SIMD_WIDTH == 8
+const vfp_t index_to_mask_lut[SIMD_WIDTH]       = { lanes_below(0), lanes_below(1), lanes_below(2), lanes_below(3),
+                                                    lanes_below(4), lanes_below(5), lanes_below(6), lanes_below(7) };
+#elif SIMD_WIDTH == 16
+const vfp_t index_to_mask_lut[SIMD_WIDTH]       = { lanes_below(0),  lanes_below(1),  lanes_below(2),  lanes_below(3),
+                                                    lanes_below(4),  lanes_below(5),  lanes_below(6),  lanes_below(7),
+                                                    lanes_below(8),  lanes_below(9),  lanes_below(10), lanes_below(11),
+                                                    lanes_below(12), lanes_below(13), lanes_below(14), lanes_below(15) };
+#endif
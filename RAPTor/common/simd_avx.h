@@ -0,0 +1,546 @@
+#pragma once
+
+/* Standard headers */
+#include <immintrin.h>
+
+/* Common headers */
+#include "bit_cast.h"
+
+
+/* AVX2 implementation of vfp_t and vint_t with 8 lanes */
+/* Included by simd.h, do not include directly */
+#ifndef __AVX2__
+#error "SIMD_WIDTH 8 requires AVX2, build with -mavx2"
+#endif
+
+/* Loads and stores are unaligned because allocations are only guaranteed 16 byte alignment */
+class vfp_t
+{
+    public :
+        /* Constructors */
+        vfp_t() = default;
+        vfp_t(const vfp_t &rhs)     : m(rhs.m)                  { }
+        vfp_t(const float *a)       : m(_mm256_loadu_ps(a))     { }
+        vfp_t(const float a)        : m(_mm256_set1_ps(a))      { }
+
+        /* Destructor */
+        inline ~vfp_t() {  }
+
+        /* Operators */
+        /* Unary operators */
+        inline vfp_t& operator=(const vfp_t &rhs)
+        {
+            this->m = rhs.m;
+            return *this;
+        }
+
+        inline const vfp_t& operator+=(const vfp_t &rhs)
+        {
+            this->m = _mm256_add_ps(this->m, rhs.m);
+            return *this;
+        }
+
+        inline const vfp_t& operator-=(const vfp_t &rhs)
+        {
+            this->m = _mm256_sub_ps(this->m, rhs.m);
+            return *this;
+        }
+
+        inline const vfp_t& operator*=(const vfp_t &rhs)
+        {
+            this->m = _mm256_mul_ps(this->m, rhs.m);
+            return *this;
+        }
+
+        inline const vfp_t& operator/=(const vfp_t &rhs)
+        {
+            this->m = _mm256_div_ps(this->m, rhs.m);
+            return *this;
+        }
+
+        inline const vfp_t& operator&=(const vfp_t &rhs)
+        {
+            this->m = _mm256_and_ps(this->m, rhs.m);
+            return *this;
+        }
+
+        inline const vfp_t& operator|=(const vfp_t &rhs)
+        {
+            this->m = _mm256_or_ps(this->m, rhs.m);
+            return *this;
+        }
+
+        inline const vfp_t& operator^=(const vfp_t &rhs)
+        {
+            this->m = _mm256_xor_ps(this->m, rhs.m);
+            return *this;
+        }
+
+        inline vfp_t operator-() const
+        {
+            return _mm256_sub_ps(_mm256_setzero_ps(), this->m);
+        }
+
+        /* Lane access */
+        inline float& operator[](int i)
+        {
+            return reinterpret_cast<float *>(&this->m)[i];
+        }
+
+        inline float operator[](int i) const
+        {
+            float f[SIMD_WIDTH];
+            store(f);
+            return f[i];
+        }
+
+        inline operator float*()
+        {
+            return reinterpret_cast<float *>(&this->m);
+        }
+
+        inline operator const float*() const
+        {
+            return reinterpret_cast<const float *>(&this->m);
+        }
+
+        inline vfp_t store(float *const to) const
+        {
+            _mm256_storeu_ps(to, this->m);
+            return *this;
+        }
+
+        /* to must be 32 byte aligned */
+        inline vfp_t stream(float *const to) const
+        {
+            _mm256_stream_ps(to, this->m);
+            return *this;
+        }
+
+        inline float extract(int i) const
+        {
+            return (*this)[i];
+        }
+
+    private :
+        vfp_t(const __m256 &rhs) : m(rhs) { }
+
+        __m256 m;
+
+        /* Friend class */
+        friend class vint_t;
+
+        /* Friendly operators */
+        friend const vfp_t operator+            (const vfp_t &lhs, const vfp_t &rhs);
+        friend const vfp_t operator-            (const vfp_t &lhs, const vfp_t &rhs);
+        friend const vfp_t operator*            (const vfp_t &lhs, const vfp_t &rhs);
+        friend const vfp_t operator/            (const vfp_t &lhs, const vfp_t &rhs);
+        friend const vfp_t operator&            (const vfp_t &lhs, const vfp_t &rhs);
+        friend const vfp_t operator|            (const vfp_t &lhs, const vfp_t &rhs);
+        friend const vfp_t operator^            (const vfp_t &lhs, const vfp_t &rhs);
+
+
+        /* Comparisons */
+        friend const vfp_t operator==           (const vfp_t &lhs, const vfp_t &rhs);
+        friend const vfp_t operator!=           (const vfp_t &lhs, const vfp_t &rhs);
+        friend const vfp_t operator>            (const vfp_t &lhs, const vfp_t &rhs);
+        friend const vfp_t operator>=           (const vfp_t &lhs, const vfp_t &rhs);
+        friend const vfp_t operator<            (const vfp_t &lhs, const vfp_t &rhs);
+        friend const vfp_t operator<=           (const vfp_t &lhs, const vfp_t &rhs);
+
+
+        /* Friendly functions */
+        friend       vfp_t sqrt                 (const vfp_t &rhs);
+        friend       vfp_t inverse              (const vfp_t &rhs);
+        friend       vfp_t inverse_sqrt         (const vfp_t &rhs);
+        friend       vfp_t approx_inverse       (const vfp_t &rhs);
+        friend       vfp_t approx_inverse_sqrt  (const vfp_t &rhs);
+        friend       vfp_t abs                  (const vfp_t &rhs);
+        friend       vfp_t max                  (const vfp_t &lhs, const vfp_t &rhs);
+        friend       vfp_t min                  (const vfp_t &lhs, const vfp_t &rhs);
+        friend       float horizontal_max       (const vfp_t &rhs);
+        friend       float horizontal_min       (const vfp_t &rhs);
+
+        /* Non standard friendly functions */
+        friend int   move_mask                  (const vfp_t &rhs);
+        friend vfp_t andnot                     (const vfp_t &lhs, const vfp_t &rhs);
+        friend vfp_t mov_p                      (const vfp_t &p, const vfp_t &a, const vfp_t &b);
+        friend vint_t mov_p                     (const vfp_t &p, const vint_t &a, const vint_t &b);
+
+} __attribute__ ((aligned(32)));
+
+/* Friendly operators */
+/* Binary operators */
+inline const vfp_t operator+(const vfp_t &lhs, const vfp_t &rhs)
+{
+   return _mm256_add_ps(lhs.m, rhs.m);
+}
+
+inline const vfp_t operator-(const vfp_t &lhs, const vfp_t &rhs)
+{
+   return _mm256_sub_ps(lhs.m, rhs.m);
+}
+
+inline const vfp_t operator*(const vfp_t &lhs, const vfp_t &rhs)
+{
+   return _mm256_mul_ps(lhs.m, rhs.m);
+}
+
+inline const vfp_t operator/(const vfp_t &lhs, const vfp_t &rhs)
+{
+   return _mm256_div_ps(lhs.m, rhs.m);
+}
+
+inline const vfp_t operator&(const vfp_t &lhs, const vfp_t &rhs)
+{
+   return _mm256_and_ps(lhs.m, rhs.m);
+}
+
+inline const vfp_t operator|(const vfp_t &lhs, const vfp_t &rhs)
+{
+   return _mm256_or_ps(lhs.m, rhs.m);
+}
+
+inline const vfp_t operator^(const vfp_t &lhs, const vfp_t &rhs)
+{
+   return _mm256_xor_ps(lhs.m, rhs.m);
+}
+
+/* Comparisons, with the same nan handling as the SSE versions */
+inline const vfp_t operator==(const vfp_t &lhs, const vfp_t &rhs)
+{
+   return _mm256_cmp_ps(lhs.m, rhs.m, _CMP_EQ_OQ);
+}
+
+inline const vfp_t operator!=(const vfp_t &lhs, const vfp_t &rhs)
+{
+   return _mm256_cmp_ps(lhs.m, rhs.m, _CMP_NEQ_UQ);
+}
+
+inline const vfp_t operator>(const vfp_t &lhs, const vfp_t &rhs)
+{
+   return _mm256_cmp_ps(lhs.m, rhs.m, _CMP_GT_OS);
+}
+
+inline const vfp_t operator>=(const vfp_t &lhs, const vfp_t &rhs)
+{
+   return _mm256_cmp_ps(lhs.m, rhs.m, _CMP_GE_OS);
+}
+
+inline const vfp_t operator<(const vfp_t &lhs, const vfp_t &rhs)
+{
+   return _mm256_cmp_ps(lhs.m, rhs.m, _CMP_LT_OS);
+}
+
+inline const vfp_t operator<=(const vfp_t &lhs, const vfp_t &rhs)
+{
+   return _mm256_cmp_ps(lhs.m, rhs.m, _CMP_LE_OS);
+}
+
+
+/* Friendly functions */
+inline vfp_t sqrt(const vfp_t &rhs)
+{
+   return _mm256_sqrt_ps(rhs.m);
+}
+
+/* Use approximate inversion and added an interation of newton raphson */
+inline vfp_t inverse(const vfp_t &rhs)
+{
+   __m256 tmp0 = _mm256_rcp_ps(rhs.m);
+   __m256 tmp1 = _mm256_sub_ps(_mm256_add_ps(tmp0, tmp0), _mm256_mul_ps(_mm256_mul_ps(rhs.m, tmp0), tmp0));
+   return tmp1;
+}
+
+/* Use approximate inverse square root and added an interation of newton raphson */
+inline vfp_t inverse_sqrt(const vfp_t &rhs)
+{
+   __m256 tmp0 = _mm256_rsqrt_ps(rhs.m);
+   __m256 tmp1 = _mm256_mul_ps(_mm256_mul_ps(_mm256_set1_ps(0.5f), tmp0), _mm256_sub_ps(_mm256_set1_ps(3.0f), _mm256_mul_ps(_mm256_mul_ps(rhs.m, tmp0), tmp0)));
+   return tmp1;
+}
+
+/* Approximate inversion */
+inline vfp_t approx_inverse(const vfp_t &rhs)
+{
+   return _mm256_rcp_ps(rhs.m);
+}
+
+/* Approximate square root */
+inline vfp_t approx_inverse_sqrt(const vfp_t &rhs)
+{
+   return _mm256_rsqrt_ps(rhs.m);
+}
+
+inline vfp_t abs(const vfp_t &rhs)
+{
+   return _mm256_and_ps(_mm256_set1_ps(bit_cast<unsigned int, float>(0x7fffffff)), rhs.m);
+}
+
+inline vfp_t max(const vfp_t &lhs, const vfp_t &rhs)
+{
+   return _mm256_max_ps(lhs.m, rhs.m);
+}
+
+inline vfp_t min(const vfp_t &lhs, const vfp_t &rhs)
+{
+   return _mm256_min_ps(lhs.m, rhs.m);
+}
+
+/* Reduce the two halves then finish as SSE */
+inline float horizontal_max(const vfp_t &rhs)
+{
+    __m128 max0 = _mm_max_ps(_mm256_castps256_ps128(rhs.m), _mm256_extractf128_ps(rhs.m, 1));
+    __m128 max1 = _mm_shuffle_ps(max0, max0, _MM_SHUFFLE(0,0,3,2));
+    __m128 max2 = _mm_max_ps(max0, max1);
+    __m128 max3 = _mm_shuffle_ps(max2, max2, _MM_SHUFFLE(0,0,0,1));
+    __m128 max4 = _mm_max_ps(max2, max3);
+    return _mm_cvtss_f32(max4);
+}
+
+inline float horizontal_min(const vfp_t &rhs)
+{
+    __m128 min0 = _mm_min_ps(_mm256_castps256_ps128(rhs.m), _mm256_extractf128_ps(rhs.m, 1));
+    __m128 min1 = _mm_shuffle_ps(min0, min0, _MM_SHUFFLE(0,0,3,2));
+    __m128 min2 = _mm_min_ps(min0, min1);
+    __m128 min3 = _mm_shuffle_ps(min2, min2, _MM_SHUFFLE(0,0,0,1));
+    __m128 min4 = _mm_min_ps(min2, min3);
+    return _mm_cvtss_f32(min4);
+}
+
+
+/* Non standard friendly functions */
+inline int move_mask(const vfp_t &rhs)
+{
+   return _mm256_movemask_ps(rhs.m);
+}
+
+inline vfp_t andnot(const vfp_t &lhs, const vfp_t &rhs)
+{
+   return _mm256_andnot_ps(lhs.m, rhs.m);
+}
+
+/* Predicated move */
+/* Returns a if pred is set else returns b */
+inline vfp_t mov_p(const vfp_t &p, const vfp_t &a, const vfp_t &b)
+{
+   return _mm256_blendv_ps(b.m, a.m, p.m);
+}
+
+class vint_t
+{
+    public :
+        /* Constructors */
+        vint_t() = default;
+        vint_t(const vint_t &rhs)   : m(rhs.m)                                                      { }
+        vint_t(const vfp_t &rhs)    : m(_mm256_cvttps_epi32(rhs.m))                                 { }
+        vint_t(const int *a)        : m(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(a)))   { }
+        vint_t(const int a)         : m(_mm256_set1_epi32(a))                                       { }
+
+        /* Destructor */
+        inline ~vint_t() {  }
+
+        /* Operators */
+        /* Unary operators */
+        inline vint_t& operator=(const vint_t &rhs)
+        {
+            this->m = rhs.m;
+            return *this;
+        }
+
+        inline const vint_t& operator+=(const vint_t &rhs)
+        {
+            this->m = _mm256_add_epi32(this->m, rhs.m);
+            return *this;
+        }
+
+        inline const vint_t& operator-=(const vint_t &rhs)
+        {
+            this->m = _mm256_sub_epi32(this->m, rhs.m);
+            return *this;
+        }
+
+        inline const vint_t& operator<<=(const vint_t &rhs)
+        {
+            this->m = _mm256_sll_epi32(this->m, _mm256_castsi256_si128(rhs.m));
+            return *this;
+        }
+
+        inline const vint_t& operator>>=(const vint_t &rhs)
+        {
+            this->m = _mm256_sra_epi32(this->m, _mm256_castsi256_si128(rhs.m));
+            return *this;
+        }
+
+        inline const vint_t& operator<<=(const int rhs)
+        {
+            this->m = _mm256_slli_epi32(this->m, rhs);
+            return *this;
+        }
+
+        inline const vint_t& operator>>=(const int rhs)
+        {
+            this->m = _mm256_srai_epi32(this->m, rhs);
+            return *this;
+        }
+
+        inline const vint_t& operator&=(const vint_t &rhs)
+        {
+            this->m = _mm256_and_si256(this->m, rhs.m);
+            return *this;
+        }
+
+        inline const vint_t& operator|=(const vint_t &rhs)
+        {
+            this->m = _mm256_or_si256(this->m, rhs.m);
+            return *this;
+        }
+
+        inline const vint_t& operator^=(const vint_t &rhs)
+        {
+            this->m = _mm256_xor_si256(this->m, rhs.m);
+            return *this;
+        }
+
+        inline vint_t operator-() const
+        {
+            return _mm256_sub_epi32(_mm256_setzero_si256(), this->m);
+        }
+
+        /* Lane access */
+        inline int operator[](int i) const
+        {
+            int f[SIMD_WIDTH];
+            store(f);
+            return f[i];
+        }
+
+        inline vint_t store(int *const to) const
+        {
+            _mm256_storeu_si256(reinterpret_cast<__m256i *const>(to), this->m);
+            return *this;
+        }
+
+        inline int extract(int i) const
+        {
+            return (*this)[i];
+        }
+
+    private :
+        vint_t(const __m256i &rhs) : m(rhs) { }
+
+        __m256i m;
+
+        /* Friendly operators */
+        friend const vint_t operator+   (const vint_t &lhs, const vint_t &rhs);
+        friend const vint_t operator-   (const vint_t &lhs, const vint_t &rhs);
+        friend const vint_t operator<<  (const vint_t &lhs, const vint_t &rhs);
+        friend const vint_t operator>>  (const vint_t &lhs, const vint_t &rhs);
+        friend const vint_t operator<<  (const vint_t &lhs, const int rhs);
+        friend const vint_t operator>>  (const vint_t &lhs, const int rhs);
+        friend const vint_t operator&   (const vint_t &lhs, const vint_t &rhs);
+        friend const vint_t operator|   (const vint_t &lhs, const vint_t &rhs);
+        friend const vint_t operator^   (const vint_t &lhs, const vint_t &rhs);
+
+
+        /* Comparisons */
+        friend const vint_t operator==  (const vint_t &lhs, const vint_t &rhs);
+        friend const vint_t operator>   (const vint_t &lhs, const vint_t &rhs);
+        friend const vint_t operator<   (const vint_t &lhs, const vint_t &rhs);
+
+
+        /* Non standard friendly functions */
+        friend int   move_mask          (const vint_t &rhs);
+        friend vint_t andnot            (const vint_t &lhs, const vint_t &rhs);
+        friend vint_t mov_p             (const vint_t &p, const vint_t &a, const vint_t &b);
+        friend vint_t mov_p             (const vfp_t &p, const vint_t &a, const vint_t &b);
+
+} __attribute__ ((aligned(32)));
+
+/* Friendly operators */
+/* Binary operators */
+inline const vint_t operator+(const vint_t &lhs, const vint_t &rhs)
+{
+   return _mm256_add_epi32(lhs.m, rhs.m);
+}
+
+inline const vint_t operator-(const vint_t &lhs, const vint_t &rhs)
+{
+   return _mm256_sub_epi32(lhs.m, rhs.m);
+}
+
+inline const vint_t operator<<(const vint_t &lhs, const vint_t &rhs)
+{
+    return _mm256_sll_epi32(lhs.m, _mm256_castsi256_si128(rhs.m));
+}
+
+inline const vint_t operator>>(const vint_t &lhs, const vint_t &rhs)
+{
+    return _mm256_sra_epi32(lhs.m, _mm256_castsi256_si128(rhs.m));
+}
+
+inline const vint_t operator<<(const vint_t &lhs, const int rhs)
+{
+    return _mm256_slli_epi32(lhs.m, rhs);
+}
+
+inline const vint_t operator>>(const vint_t &lhs, const int rhs)
+{
+    return _mm256_srai_epi32(lhs.m, rhs);
+}
+
+inline const vint_t operator&(const vint_t &lhs, const vint_t &rhs)
+{
+   return _mm256_and_si256(lhs.m, rhs.m);
+}
+
+inline const vint_t operator|(const vint_t &lhs, const vint_t &rhs)
+{
+   return _mm256_or_si256(lhs.m, rhs.m);
+}
+
+inline const vint_t operator^(const vint_t &lhs, const vint_t &rhs)
+{
+   return _mm256_xor_si256(lhs.m, rhs.m);
+}
+
+/* Comparisons */
+inline const vint_t operator==(const vint_t &lhs, const vint_t &rhs)
+{
+   return _mm256_cmpeq_epi32(lhs.m, rhs.m);
+}
+
+inline const vint_t operator>(const vint_t &lhs, const vint_t &rhs)
+{
+   return _mm256_cmpgt_epi32(lhs.m, rhs.m);
+}
+
+inline const vint_t operator<(const vint_t &lhs, const vint_t &rhs)
+{
+   return _mm256_cmpgt_epi32(rhs.m, lhs.m);
+}
+
+
+/* Non standard friendly functions */
+/* One bit per byte, as the SSE version */
+inline int move_mask(const vint_t &rhs)
+{
+   return _mm256_movemask_epi8(rhs.m);
+}
+
+inline vint_t andnot(const vint_t &lhs, const vint_t &rhs)
+{
+   return _mm256_andnot_si256(lhs.m, rhs.m);
+}
+
+/* Predicated move */
+/* Returns a if pred is set else returns b */
+inline vint_t mov_p(const vint_t &p, const vint_t &a, const vint_t &b)
+{
+    return _mm256_blendv_epi8(b.m, a.m, p.m);
+}
+
+inline vint_t mov_p(const vfp_t &p, const vint_t &a, const vint_t &b)
+{
+    return mov_p(vint_t(_mm256_castps_si256(p.m)), a, b);
+}
@@ -0,0 +1,565 @@
+#pragma once
+
+/* Standard headers */
+#include <immintrin.h>
+
+/* Common headers */
+#include "bit_cast.h"
+
+
+/* AVX-512 implementation of vfp_t and vint_t with 16 lanes */
+/* Included by simd.h, do not include directly */
+#ifndef __AVX512F__
+#error "SIMD_WIDTH 16 requires AVX-512F, build with -mavx512f"
+#endif
+
+/* Comparisons produce vector masks, like SSE, so the rest of the code can combine them with bitwise operators */
+/* Only AVX-512F is required so floating point bitwise operations are done on the integer unit */
+inline __m512 avx512_mask_to_vector(const __mmask16 k)
+{
+    return _mm512_castsi512_ps(_mm512_maskz_mov_epi32(k, _mm512_set1_epi32(-1)));
+}
+
+inline __mmask16 avx512_vector_to_mask(const __m512 v)
+{
+    return _mm512_cmplt_epi32_mask(_mm512_castps_si512(v), _mm512_setzero_si512());
+}
+
+inline __mmask16 avx512_vector_to_mask(const __m512i v)
+{
+    return _mm512_cmplt_epi32_mask(v, _mm512_setzero_si512());
+}
+
+inline __m512 avx512_and_ps(const __m512 a, const __m512 b)
+{
+    return _mm512_castsi512_ps(_mm512_and_si512(_mm512_castps_si512(a), _mm512_castps_si512(b)));
+}
+
+inline __m512 avx512_or_ps(const __m512 a, const __m512 b)
+{
+    return _mm512_castsi512_ps(_mm512_or_si512(_mm512_castps_si512(a), _mm512_castps_si512(b)));
+}
+
+inline __m512 avx512_xor_ps(const __m512 a, const __m512 b)
+{
+    return _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(a), _mm512_castps_si512(b)));
+}
+
+inline __m512 avx512_andnot_ps(const __m512 a, const __m512 b)
+{
+    return _mm512_castsi512_ps(_mm512_andnot_si512(_mm512_castps_si512(a), _mm512_castps_si512(b)));
+}
+
+/* Loads and stores are unaligned because allocations are only guaranteed 16 byte alignment */
+class vfp_t
+{
+    public :
+        /* Constructors */
+        vfp_t() = default;
+        vfp_t(const vfp_t &rhs)     : m(rhs.m)                  { }
+        vfp_t(const float *a)       : m(_mm512_loadu_ps(a))     { }
+        vfp_t(const float a)        : m(_mm512_set1_ps(a))      { }
+
+        /* Destructor */
+        inline ~vfp_t() {  }
+
+        /* Operators */
+        /* Unary operators */
+        inline vfp_t& operator=(const vfp_t &rhs)
+        {
+            this->m = rhs.m;
+            return *this;
+        }
+
+        inline const vfp_t& operator+=(const vfp_t &rhs)
+        {
+            this->m = _mm512_add_ps(this->m, rhs.m);
+            return *this;
+        }
+
+        inline const vfp_t& operator-=(const vfp_t &rhs)
+        {
+            this->m = _mm512_sub_ps(this->m, rhs.m);
+            return *this;
+        }
+
+        inline const vfp_t& operator*=(const vfp_t &rhs)
+        {
+            this->m = _mm512_mul_ps(this->m, rhs.m);
+            return *this;
+        }
+
+        inline const vfp_t& operator/=(const vfp_t &rhs)
+        {
+            this->m = _mm512_div_ps(this->m, rhs.m);
+            return *this;
+        }
+
+        inline const vfp_t& operator&=(const vfp_t &rhs)
+        {
+            this->m = avx512_and_ps(this->m, rhs.m);
+            return *this;
+        }
+
+        inline const vfp_t& operator|=(const vfp_t &rhs)
+        {
+            this->m = avx512_or_ps(this->m, rhs.m);
+            return *this;
+        }
+
+        inline const vfp_t& operator^=(const vfp_t &rhs)
+        {
+            this->m = avx512_xor_ps(this->m, rhs.m);
+            return *this;
+        }
+
+        inline vfp_t operator-() const
+        {
+            return _mm512_sub_ps(_mm512_setzero_ps(), this->m);
+        }
+
+        /* Lane access */
+        inline float& operator[](int i)
+        {
+            return reinterpret_cast<float *>(&this->m)[i];
+        }
+
+        inline float operator[](int i) const
+        {
+            float f[SIMD_WIDTH];
+            store(f);
+            return f[i];
+        }
+
+        inline operator float*()
+        {
+            return reinterpret_cast<float *>(&this->m);
+        }
+
+        inline operator const float*() const
+        {
+            return reinterpret_cast<const float *>(&this->m);
+        }
+
+        inline vfp_t store(float *const to) const
+        {
+            _mm512_storeu_ps(to, this->m);
+            return *this;
+        }
+
+        /* to must be 64 byte aligned */
+        inline vfp_t stream(float *const to) const
+        {
+            _mm512_stream_ps(to, this->m);
+            return *this;
+        }
+
+        inline float extract(int i) const
+        {
+            return (*this)[i];
+        }
+
+    private :
+        vfp_t(const __m512 &rhs) : m(rhs) { }
+
+        __m512 m;
+
+        /* Friend class */
+        friend class vint_t;
+
+        /* Friendly operators */
+        friend const vfp_t operator+            (const vfp_t &lhs, const vfp_t &rhs);
+        friend const vfp_t operator-            (const vfp_t &lhs, const vfp_t &rhs);
+        friend const vfp_t operator*            (const vfp_t &lhs, const vfp_t &rhs);
+        friend const vfp_t operator/            (const vfp_t &lhs, const vfp_t &rhs);
+        friend const vfp_t operator&            (const vfp_t &lhs, const vfp_t &rhs);
+        friend const vfp_t operator|            (const vfp_t &lhs, const vfp_t &rhs);
+        friend const vfp_t operator^            (const vfp_t &lhs, const vfp_t &rhs);
+
+
+        /* Comparisons */
+        friend const vfp_t operator==           (const vfp_t &lhs, const vfp_t &rhs);
+        friend const vfp_t operator!=           (const vfp_t &lhs, const vfp_t &rhs);
+        friend const vfp_t operator>            (const vfp_t &lhs, const vfp_t &rhs);
+        friend const vfp_t operator>=           (const vfp_t &lhs, const vfp_t &rhs);
+        friend const vfp_t operator<            (const vfp_t &lhs, const vfp_t &rhs);
+        friend const vfp_t operator<=           (const vfp_t &lhs, const vfp_t &rhs);
+
+
+        /* Friendly functions */
+        friend       vfp_t sqrt                 (const vfp_t &rhs);
+        friend       vfp_t inverse              (const vfp_t &rhs);
+        friend       vfp_t inverse_sqrt         (const vfp_t &rhs);
+        friend       vfp_t approx_inverse       (const vfp_t &rhs);
+        friend       vfp_t approx_inverse_sqrt  (const vfp_t &rhs);
+        friend       vfp_t abs                  (const vfp_t &rhs);
+        friend       vfp_t max                  (const vfp_t &lhs, const vfp_t &rhs);
+        friend       vfp_t min                  (const vfp_t &lhs, const vfp_t &rhs);
+        friend       float horizontal_max       (const vfp_t &rhs);
+        friend       float horizontal_min       (const vfp_t &rhs);
+
+        /* Non standard friendly functions */
+        friend int   move_mask                  (const vfp_t &rhs);
+        friend vfp_t andnot                     (const vfp_t &lhs, const vfp_t &rhs);
+        friend vfp_t mov_p                      (const vfp_t &p, const vfp_t &a, const vfp_t &b);
+        friend vint_t mov_p                     (const vfp_t &p, const vint_t &a, const vint_t &b);
+
+} __attribute__ ((aligned(64)));
+
+/* Friendly operators */
+/* Binary operators */
+inline const vfp_t operator+(const vfp_t &lhs, const vfp_t &rhs)
+{
+   return _mm512_add_ps(lhs.m, rhs.m);
+}
+
+inline const vfp_t operator-(const vfp_t &lhs, const vfp_t &rhs)
+{
+   return _mm512_sub_ps(lhs.m, rhs.m);
+}
+
+inline const vfp_t operator*(const vfp_t &lhs, const vfp_t &rhs)
+{
+   return _mm512_mul_ps(lhs.m, rhs.m);
+}
+
+inline const vfp_t operator/(const vfp_t &lhs, const vfp_t &rhs)
+{
+   return _mm512_div_ps(lhs.m, rhs.m);
+}
+
+inline const vfp_t operator&(const vfp_t &lhs, const vfp_t &rhs)
+{
+   return avx512_and_ps(lhs.m, rhs.m);
+}
+
+inline const vfp_t operator|(const vfp_t &lhs, const vfp_t &rhs)
+{
+   return avx512_or_ps(lhs.m, rhs.m);
+}
+
+inline const vfp_t operator^(const vfp_t &lhs, const vfp_t &rhs)
+{
+   return avx512_xor_ps(lhs.m, rhs.m);
+}
+
+/* Comparisons, with the same nan handling as the SSE versions */
+inline const vfp_t operator==(const vfp_t &lhs, const vfp_t &rhs)
+{
+   return avx512_mask_to_vector(_mm512_cmp_ps_mask(lhs.m, rhs.m, _CMP_EQ_OQ));
+}
+
+inline const vfp_t operator!=(const vfp_t &lhs, const vfp_t &rhs)
+{
+   return avx512_mask_to_vector(_mm512_cmp_ps_mask(lhs.m, rhs.m, _CMP_NEQ_UQ));
+}
+
+inline const vfp_t operator>(const vfp_t &lhs, const vfp_t &rhs)
+{
+   return avx512_mask_to_vector(_mm512_cmp_ps_mask(lhs.m, rhs.m, _CMP_GT_OS));
+}
+
+inline const vfp_t operator>=(const vfp_t &lhs, const vfp_t &rhs)
+{
+   return avx512_mask_to_vector(_mm512_cmp_ps_mask(lhs.m, rhs.m, _CMP_GE_OS));
+}
+
+inline const vfp_t operator<(const vfp_t &lhs, const vfp_t &rhs)
+{
+   return avx512_mask_to_vector(_mm512_cmp_ps_mask(lhs.m, rhs.m, _CMP_LT_OS));
+}
+
+inline const vfp_t operator<=(const vfp_t &lhs, const vfp_t &rhs)
+{
+   return avx512_mask_to_vector(_mm512_cmp_ps_mask(lhs.m, rhs.m, _CMP_LE_OS));
+}
+
+
+/* Friendly functions */
+inline vfp_t sqrt(const vfp_t &rhs)
+{
+   return _mm512_sqrt_ps(rhs.m);
+}
+
+/* Use approximate inversion and added an interation of newton raphson */
+inline vfp_t inverse(const vfp_t &rhs)
+{
+   __m512 tmp0 = _mm512_rcp14_ps(rhs.m);
+   __m512 tmp1 = _mm512_sub_ps(_mm512_add_ps(tmp0, tmp0), _mm512_mul_ps(_mm512_mul_ps(rhs.m, tmp0), tmp0));
+   return tmp1;
+}
+
+/* Use approximate inverse square root and added an interation of newton raphson */
+inline vfp_t inverse_sqrt(const vfp_t &rhs)
+{
+   __m512 tmp0 = _mm512_rsqrt14_ps(rhs.m);
+   __m512 tmp1 = _mm512_mul_ps(_mm512_mul_ps(_mm512_set1_ps(0.5f), tmp0), _mm512_sub_ps(_mm512_set1_ps(3.0f), _mm512_mul_ps(_mm512_mul_ps(rhs.m, tmp0), tmp0)));
+   return tmp1;
+}
+
+/* Approximate inversion */
+inline vfp_t approx_inverse(const vfp_t &rhs)
+{
+   return _mm512_rcp14_ps(rhs.m);
+}
+
+/* Approximate square root */
+inline vfp_t approx_inverse_sqrt(const vfp_t &rhs)
+{
+   return _mm512_rsqrt14_ps(rhs.m);
+}
+
+inline vfp_t abs(const vfp_t &rhs)
+{
+   return avx512_and_ps(_mm512_set1_ps(bit_cast<unsigned int, float>(0x7fffffff)), rhs.m);
+}
+
+inline vfp_t max(const vfp_t &lhs, const vfp_t &rhs)
+{
+   return _mm512_max_ps(lhs.m, rhs.m);
+}
+
+inline vfp_t min(const vfp_t &lhs, const vfp_t &rhs)
+{
+   return _mm512_min_ps(lhs.m, rhs.m);
+}
+
+inline float horizontal_max(const vfp_t &rhs)
+{
+    return _mm512_reduce_max_ps(rhs.m);
+}
+
+inline float horizontal_min(const vfp_t &rhs)
+{
+    return _mm512_reduce_min_ps(rhs.m);
+}
+
+
+/* Non standard friendly functions */
+inline int move_mask(const vfp_t &rhs)
+{
+   return avx512_vector_to_mask(rhs.m);
+}
+
+inline vfp_t andnot(const vfp_t &lhs, const vfp_t &rhs)
+{
+   return avx512_andnot_ps(lhs.m, rhs.m);
+}
+
+/* Predicated move */
+/* Returns a if pred is set else returns b */
+inline vfp_t mov_p(const vfp_t &p, const vfp_t &a, const vfp_t &b)
+{
+   return _mm512_mask_blend_ps(avx512_vector_to_mask(p.m), b.m, a.m);
+}
+
+class vint_t
+{
+    public :
+        /* Constructors */
+        vint_t() = default;
+        vint_t(const vint_t &rhs)   : m(rhs.m)                                                      { }
+        vint_t(const vfp_t &rhs)    : m(_mm512_cvttps_epi32(rhs.m))                                 { }
+        vint_t(const int *a)        : m(_mm512_loadu_si512(a))   { }
+        vint_t(const int a)         : m(_mm512_set1_epi32(a))                                       { }
+
+        /* Destructor */
+        inline ~vint_t() {  }
+
+        /* Operators */
+        /* Unary operators */
+        inline vint_t& operator=(const vint_t &rhs)
+        {
+            this->m = rhs.m;
+            return *this;
+        }
+
+        inline const vint_t& operator+=(const vint_t &rhs)
+        {
+            this->m = _mm512_add_epi32(this->m, rhs.m);
+            return *this;
+        }
+
+        inline const vint_t& operator-=(const vint_t &rhs)
+        {
+            this->m = _mm512_sub_epi32(this->m, rhs.m);
+            return *this;
+        }
+
+        inline const vint_t& operator<<=(const vint_t &rhs)
+        {
+            this->m = _mm512_sll_epi32(this->m, _mm512_castsi512_si128(rhs.m));
+            return *this;
+        }
+
+        inline const vint_t& operator>>=(const vint_t &rhs)
+        {
+            this->m = _mm512_sra_epi32(this->m, _mm512_castsi512_si128(rhs.m));
+            return *this;
+        }
+
+        inline const vint_t& operator<<=(const int rhs)
+        {
+            this->m = _mm512_slli_epi32(this->m, rhs);
+            return *this;
+        }
+
+        inline const vint_t& operator>>=(const int rhs)
+        {
+            this->m = _mm512_srai_epi32(this->m, rhs);
+            return *this;
+        }
+
+        inline const vint_t& operator&=(const vint_t &rhs)
+        {
+            this->m = _mm512_and_si512(this->m, rhs.m);
+            return *this;
+        }
+
+        inline const vint_t& operator|=(const vint_t &rhs)
+        {
+            this->m = _mm512_or_si512(this->m, rhs.m);
+            return *this;
+        }
+
+        inline const vint_t& operator^=(const vint_t &rhs)
+        {
+            this->m = _mm512_xor_si512(this->m, rhs.m);
+            return *this;
+        }
+
+        inline vint_t operator-() const
+        {
+            return _mm512_sub_epi32(_mm512_setzero_si512(), this->m);
+        }
+
+        /* Lane access */
+        inline int operator[](int i) const
+        {
+            int f[SIMD_WIDTH];
+            store(f);
+            return f[i];
+        }
+
+        inline vint_t store(int *const to) const
+        {
+            _mm512_storeu_si512(to, this->m);
+            return *this;
+        }
+
+        inline int extract(int i) const
+        {
+            return (*this)[i];
+        }
+
+    private :
+        vint_t(const __m512i &rhs) : m(rhs) { }
+
+        __m512i m;
+
+        /* Friendly operators */
+        friend const vint_t operator+   (const vint_t &lhs, const vint_t &rhs);
+        friend const vint_t operator-   (const vint_t &lhs, const vint_t &rhs);
+        friend const vint_t operator<<  (const vint_t &lhs, const vint_t &rhs);
+        friend const vint_t operator>>  (const vint_t &lhs, const vint_t &rhs);
+        friend const vint_t operator<<  (const vint_t &lhs, const int rhs);
+        friend const vint_t operator>>  (const vint_t &lhs, const int rhs);
+        friend const vint_t operator&   (const vint_t &lhs, const vint_t &rhs);
+        friend const vint_t operator|   (const vint_t &lhs, const vint_t &rhs);
+        friend const vint_t operator^   (const vint_t &lhs, const vint_t &rhs);
+
+
+        /* Comparisons */
+        friend const vint_t operator==  (const vint_t &lhs, const vint_t &rhs);
+        friend const vint_t operator>   (const vint_t &lhs, const vint_t &rhs);
+        friend const vint_t operator<   (const vint_t &lhs, const vint_t &rhs);
+
+
+        /* Non standard friendly functions */
+        friend vint_t andnot            (const vint_t &lhs, const vint_t &rhs);
+        friend vint_t mov_p             (const vint_t &p, const vint_t &a, const vint_t &b);
+        friend vint_t mov_p             (const vfp_t &p, const vint_t &a, const vint_t &b);
+
+} __attribute__ ((aligned(64)));
+
+/* Friendly operators */
+/* Binary operators */
+inline const vint_t operator+(const vint_t &lhs, const vint_t &rhs)
+{
+   return _mm512_add_epi32(lhs.m, rhs.m);
+}
+
+inline const vint_t operator-(const vint_t &lhs, const vint_t &rhs)
+{
+   return _mm512_sub_epi32(lhs.m, rhs.m);
+}
+
+inline const vint_t operator<<(const vint_t &lhs, const vint_t &rhs)
+{
+    return _mm512_sll_epi32(lhs.m, _mm512_castsi512_si128(rhs.m));
+}
+
+inline const vint_t operator>>(const vint_t &lhs, const vint_t &rhs)
+{
+    return _mm512_sra_epi32(lhs.m, _mm512_castsi512_si128(rhs.m));
+}
+
+inline const vint_t operator<<(const vint_t &lhs, const int rhs)
+{
+    return _mm512_slli_epi32(lhs.m, rhs);
+}
+
+inline const vint_t operator>>(const vint_t &lhs, const int rhs)
+{
+    return _mm512_srai_epi32(lhs.m, rhs);
+}
+
+inline const vint_t operator&(const vint_t &lhs, const vint_t &rhs)
+{
+   return _mm512_and_si512(lhs.m, rhs.m);
+}
+
+inline const vint_t operator|(const vint_t &lhs, const vint_t &rhs)
+{
+   return _mm512_or_si512(lhs.m, rhs.m);
+}
+
+inline const vint_t operator^(const vint_t &lhs, const vint_t &rhs)
+{
+   return _mm512_xor_si512(lhs.m, rhs.m);
+}
+
+/* Comparisons */
+inline const vint_t operator==(const vint_t &lhs, const vint_t &rhs)
+{
+   return _mm512_maskz_mov_epi32(_mm512_cmpeq_epi32_mask(lhs.m, rhs.m), _mm512_set1_epi32(-1));
+}
+
+inline const vint_t operator>(const vint_t &lhs, const vint_t &rhs)
+{
+   return _mm512_maskz_mov_epi32(_mm512_cmpgt_epi32_mask(lhs.m, rhs.m), _mm512_set1_epi32(-1));
+}
+
+inline const vint_t operator<(const vint_t &lhs, const vint_t &rhs)
+{
+   return _mm512_maskz_mov_epi32(_mm512_cmplt_epi32_mask(lhs.m, rhs.m), _mm512_set1_epi32(-1));
+}
+
+
+/* Non standard friendly functions */
+inline vint_t andnot(const vint_t &lhs, const vint_t &rhs)
+{
+   return _mm512_andnot_si512(lhs.m, rhs.m);
+}
+
+/* Predicated move */
+/* Returns a if pred is set else returns b */
+inline vint_t mov_p(const vint_t &p, const vint_t &a, const vint_t &b)
+{
+    return _mm512_mask_blend_epi32(avx512_vector_to_mask(p.m), b.m, a.m);
+}
+
+inline vint_t mov_p(const vfp_t &p, const vint_t &a, const vint_t &b)
+{
+    return _mm512_mask_blend_epi32(avx512_vector_to_mask(p.m), b.m, a.m);
+}
@@ -223,6 +223,8 @@ bool merge_sort(float *a, float *b, const int length, const int insert_sort)
     return (widths & 0x1);
 }
 
+/* The merge networks are built from 4x4 transposes and shuffles so need SSE */
+#if SIMD_WIDTH == 4
 void vmerge_no_scalar(float *const a, float *const b, const int left_idx, const int right_idx, const int end_idx)
 {
     int i0 = left_idx + SIMD_WIDTH;
@@ -461,6 +463,18 @@ bool vmerge_sort(float *a, float *b, const int length)
 
     return !(widths & 0x1);
 }
+#else   /* #if SIMD_WIDTH == 4 */
+bool vmerge_sort(float *a, float *b, const int length)
+{
+    /* Scalar merge sort, leaving the result in a like the vector sort */
+    if (merge_sort(a, b, length))
+    {
+        std::copy(&b[0], &b[length], &a[0]);
+    }
+
+    return true;
+}
+#endif  /* #if SIMD_WIDTH == 4 */
 
 
 /* Radix sort */
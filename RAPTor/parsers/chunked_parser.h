@@ -0,0 +1,92 @@
+#pragma once
+
+/* Standard headers */
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+#include "common.h"
+
+
+namespace raptor_parsers
+{
+/* Number of chunks to parse bytes in. One per core, but not less than PARSER_CHUNK_SIZE bytes each */
+inline int number_of_chunks(const std::size_t bytes)
+{
+    const int cores = std::max(1u, std::thread::hardware_concurrency());
+    return std::max(1, std::min(cores, static_cast<int>(bytes / PARSER_CHUNK_SIZE)));
+}
+
+
+/* Start of the line after c */
+inline const char * next_line(const char *c, const char *const e)
+{
+    const char *const nl = static_cast<const char *>(memchr(c, '\n', e - c));
+    return (nl == nullptr) ? e : (nl + 1);
+}
+
+
+/* Split b to e into n chunks, each starting at the beginning of a line. The n + 1 chunk boundaries are returned */
+inline std::vector<const char *> split_lines(const char *const b, const char *const e, const int n)
+{
+    std::vector<const char *> chunks(n + 1, e);
+    chunks[0] = b;
+    const std::size_t chunk_size = (e - b) / n;
+    for (int i = 1; i < n; ++i)
+    {
+        chunks[i] = std::max(chunks[i - 1], next_line(std::min(b + (i * chunk_size), e) - 1, e));
+    }
+
+    return chunks;
+}
+
+
+/* Call f(i) for each of n chunks, each on its own thread */
+template<class F>
+void parallel_chunks(const int n, const F &f)
+{
+    std::vector<std::thread> threads;
+    threads.reserve(n - 1);
+    for (int i = 1; i < n; ++i)
+    {
+        threads.emplace_back([&f, i]() { f(i); });
+    }
+
+    f(0);
+    for (auto &t : threads)
+    {
+        t.join();
+    }
+}
+
+
+/* Call f(chunk, line number, start of line) for the first nr_lines lines from b to e split into n chunks. The */
+/* lines of each chunk are visited in order by one thread, but chunks are visited in parallel */
+template<class F>
+void parallel_for_lines(const char *const b, const char *const e, const int n, const int nr_lines, const F &f)
+{
+    /* Split into chunks and number the first line of each */
+    const std::vector<const char *> chunks(split_lines(b, e, n));
+    std::vector<int> first_line(n + 1, 0);
+    if (n > 1)
+    {
+        parallel_chunks(n, [&chunks, &first_line](const int i)
+        {
+            first_line[i + 1] = std::count(chunks[i], chunks[i + 1], '\n');
+        });
+        std::partial_sum(first_line.begin(), first_line.end(), first_line.begin());
+    }
+
+    /* Parse the lines */
+    parallel_chunks(n, [&chunks, &first_line, &f, e, nr_lines](const int i)
+    {
+        int line = first_line[i];
+        for (const char *c = chunks[i]; (c < chunks[i + 1]) && (line < nr_lines); c = next_line(c, e), ++line)
+        {
+            f(i, line, c);
+        }
+    });
+}
+} /* namespace raptor_parsers */
@@ -0,0 +1,94 @@
+#pragma once
+
+/* Standard headers */
+#include <cstring>
+#include <memory>
+#include <string>
+
+/* System headers */
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* Boost headers */
+#include "boost/noncopyable.hpp"
+
+
+namespace raptor_parsers
+{
+/* Read only view of a whole file, memory mapped so large files dont have to be copied before parsing */
+/* Text files are guaranteed to end in a new line so lines can be searched without checking for the */
+/* end of the file. Text files that dont are copied and a new line added */
+class mapped_file : private boost::noncopyable
+{
+    public :
+        explicit mapped_file(const std::string &file, const bool text = false) : _data(nullptr), _size(0), _mapped(false), _open(false)
+        {
+            const int fd = open(file.c_str(), O_RDONLY);
+            if (fd < 0)
+            {
+                return;
+            }
+
+            _open = true;
+            struct stat st;
+            if ((fstat(fd, &st) == 0) && (st.st_size > 0))
+            {
+                void *const data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (data != MAP_FAILED)
+                {
+                    _data   = static_cast<const char *>(data);
+                    _size   = st.st_size;
+                    _mapped = true;
+                    madvise(data, _size, MADV_SEQUENTIAL);
+                }
+                else
+                {
+                    _open = false;
+                }
+            }
+            close(fd);
+
+            /* Make sure text ends in a new line */
+            if (text && _open && ((_size == 0) || (_data[_size - 1] != '\n')))
+            {
+                _copy.reset(new char [_size + 1]);
+                if (_size > 0)
+                {
+                    memcpy(_copy.get(), _data, _size);
+                }
+                _copy[_size] = '\n';
+                unmap();
+                _data = _copy.get();
+                ++_size;
+            }
+        }
+
+        ~mapped_file()
+        {
+            unmap();
+        }
+
+        bool            is_open()   const { return _open;           }
+        const char *    data()      const { return _data;           }
+        const char *    end()       const { return _data + _size;   }
+        std::size_t     size()      const { return _size;           }
+
+    private :
+        void unmap()
+        {
+            if (_mapped)
+            {
+                munmap(const_cast<char *>(_data), _size);
+                _mapped = false;
+            }
+        }
+
+        std::unique_ptr<char []>    _copy;
+        const char *                _data;
+        std::size_t                 _size;
+        bool                        _mapped;
+        bool                        _open;
+};
+} /* namespace raptor_parsers */
@@ -11,6 +11,8 @@
 #include "logging.h"
 #include "point_t.h"
 #include "parser_common.h"
+#include "chunked_parser.h"
+#include "mapped_file.h"
 
 
 namespace raptor_parsers
@@ -18,30 +20,21 @@ namespace raptor_parsers
 inline bool load_off(const std::string &in_file, std::vector<point_t<>> *const points, std::vector<point_ti<>> *const triangles)
 {
     /* Open file */
-    std::ifstream off_file(in_file.c_str());
+    const mapped_file off_file(in_file, true);
     if (!off_file.is_open())
     {
         BOOST_LOG_TRIVIAL(error) << "File: " << in_file << " not found";
         return false;
     }
 
-    /* Find the size of the file */
-    off_file.seekg(0, std::ios::end);
-    const size_t len = off_file.tellg();
-    off_file.seekg(0, std::ios::beg);
-    
-    /* Read the whole file into a buffer */
     BOOST_LOG_TRIVIAL(info) << "Loading: " << in_file;
-    std::unique_ptr<char []> buffer(new char [len]);
-    off_file.read(buffer.get(), len);
-    const char *at = &buffer[0];
+    const char *at = off_file.data();
 
     /* Check header */
     const std::string header(get_this_string(&at));
     if ((header != "OFF") && (header != "OFF\r"))
     {
         BOOST_LOG_TRIVIAL(error) << "Format not recognized";
-        off_file.close();
         return false;
     }
 
@@ -57,32 +50,31 @@ inline bool load_off(const std::string &in_file, std::vector<point_t<>> *const p
     }
     find_next_line(&at);
 
-    /* Get vertices */
-    point_t<> vert;
-    points->reserve(nr_v);
-    for (unsigned int i = 0; i < nr_v; ++i)
+    /* Get vertices and faces, a line each, in parallel */
+    const std::size_t v_begin = points->size();
+    const std::size_t f_begin = triangles->size();
+    points->resize(v_begin + nr_v);
+    triangles->resize(f_begin + nr_f);
+    parallel_for_lines(at, off_file.end(), number_of_chunks(off_file.end() - at), nr_v + nr_f, [&](const int, const int i, const char *c)
     {
-        vert.x = get_this_float(&at);
-        vert.y = get_next_float(&at);
-        vert.z = get_next_float(&at);
-        points->push_back(vert);
-
-        find_next_line(&at);
-    }
-
-    /* Get faces */
-    for (unsigned int i = 0; i < nr_f; ++i)
-    {
-        const unsigned int nr_verts = get_this_unsigned(&at);
-        assert(nr_verts == 3);
-
-        const unsigned int vert_x = get_next_unsigned(&at);
-        const unsigned int vert_y = get_next_unsigned(&at);
-        const unsigned int vert_z = get_next_unsigned(&at);
-        triangles->push_back(point_ti<>(vert_x, vert_y, vert_z));
+        if (i < static_cast<int>(nr_v))
+        {
+            point_t<> &vert = (*points)[v_begin + i];
+            vert.x = get_this_float(&c);
+            vert.y = get_next_float(&c);
+            vert.z = get_next_float(&c);
+        }
+        else
+        {
+            const unsigned int nr_verts = get_this_unsigned(&c);
+            assert(nr_verts == 3);
 
-        find_next_line(&at);
-    }
+            const unsigned int vert_x = get_next_unsigned(&c);
+            const unsigned int vert_y = get_next_unsigned(&c);
+            const unsigned int vert_z = get_next_unsigned(&c);
+            (*triangles)[f_begin + i - nr_v] = point_ti<>(vert_x, vert_y, vert_z);
+        }
+    });
 
     return true;
 }
@@ -1,5 +1,9 @@
 #pragma once
 
+/* Standard headers */
+#include <algorithm>
+#include <cstdint>
+
 #include "common.h"
 
 
@@ -141,6 +145,133 @@ inline void skip_white_space(const char **a)
 }
 
 
+/* Locale free char* to int conversion, as atoi */
+inline int to_int(const char *c)
+{
+    /* Eat the white space, as isspace in the C locale */
+    while ((*c == ' ') || ((*c >= '\t') && (*c <= '\r')))
+    {
+        ++c;
+    }
+
+    /* Sign */
+    const bool neg = (*c == '-');
+    if ((*c == '-') || (*c == '+'))
+    {
+        ++c;
+    }
+
+    /* Digits */
+    int i = 0;
+    while ((*c >= '0') && (*c <= '9'))
+    {
+        i = (i * 10) + (*c - '0');
+        ++c;
+    }
+
+    return neg ? -i : i;
+}
+
+/* Locale free char* to float conversion, as atof but without allocating or checking the locale for every number */
+/* Decimal and exponent formats are converted here, anything else is left to strtod */
+inline float to_float(const char *c)
+{
+    /* Powers of 10 that are exact in a double */
+    static const double pow_10[23] = { 1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                       1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+    /* Eat the white space, as isspace in the C locale */
+    while ((*c == ' ') || ((*c >= '\t') && (*c <= '\r')))
+    {
+        ++c;
+    }
+
+    /* Sign */
+    const char *const start = c;
+    const bool neg = (*c == '-');
+    if ((*c == '-') || (*c == '+'))
+    {
+        ++c;
+    }
+
+    /* Mantissa, digits past what fits in 64 bits only scale the result */
+    std::uint64_t m = 0;
+    int digits      = 0;
+    int exp         = 0;
+    bool found      = false;
+    while ((*c >= '0') && (*c <= '9'))
+    {
+        if (digits < 19)
+        {
+            m = (m * 10) + (*c - '0');
+            digits += (m != 0);
+        }
+        else
+        {
+            ++exp;
+        }
+
+        found = true;
+        ++c;
+    }
+
+    if (*c == '.')
+    {
+        ++c;
+        while ((*c >= '0') && (*c <= '9'))
+        {
+            if (digits < 19)
+            {
+                m = (m * 10) + (*c - '0');
+                digits += (m != 0);
+                --exp;
+            }
+
+            found = true;
+            ++c;
+        }
+    }
+
+    /* Not a decimal, maybe inf, nan or hex */
+    if (!found)
+    {
+        return static_cast<float>(strtod(start, nullptr));
+    }
+
+    /* Exponent */
+    if ((*c == 'e') || (*c == 'E'))
+    {
+        const char *e = c + 1;
+        const bool neg_exp = (*e == '-');
+        if ((*e == '-') || (*e == '+'))
+        {
+            ++e;
+        }
+
+        int e_val = 0;
+        while ((*e >= '0') && (*e <= '9'))
+        {
+            e_val = std::min((e_val * 10) + (*e - '0'), 9999);
+            ++e;
+        }
+        exp += neg_exp ? -e_val : e_val;
+    }
+
+    /* Scale, dividing by exact powers keeps the result correctly rounded */
+    double v = static_cast<double>(m);
+    if (exp < 0)
+    {
+        v /= (exp >= -22) ? pow_10[-exp] : std::pow(10.0, -exp);
+    }
+    else if (exp > 0)
+    {
+        v *= (exp <= 22) ? pow_10[exp] : std::pow(10.0, exp);
+    }
+
+    return static_cast<float>(neg ? -v : v);
+}
+
+
 /* String to float conversion */
 inline float get_next_float(const std::string &s, size_t *const fst_space)
 {
@@ -148,7 +279,7 @@ inline float get_next_float(const std::string &s, size_t *const fst_space)
     *fst_space = s.find(' ', *fst_space) + 1;
     
     /* Assume the next thing is a float and convert */
-    return atof(s.c_str() + *fst_space);
+    return to_float(s.c_str() + *fst_space);
 }
 
 /* Char* to float conversion */
@@ -168,7 +299,7 @@ inline float get_next_float(const char **c)
     }
     
     /* Assume the next thing is a float and convert */
-    return atof(*c);
+    return to_float(*c);
 }
 
 inline float get_this_float(const char **c)
@@ -180,7 +311,7 @@ inline float get_this_float(const char **c)
     }
     
     /* Assume the next thing is a float and convert */
-    return atof(*c);
+    return to_float(*c);
 }
 
 
@@ -200,7 +331,7 @@ inline unsigned int get_next_unsigned(const char **c)
     }
     
     /* Assume the next thing is an unsigned and convert */
-    return static_cast<unsigned int>(atoi(*c));
+    return static_cast<unsigned int>(to_int(*c));
 }
 
 inline unsigned int get_this_unsigned(const char **c)
@@ -212,7 +343,7 @@ inline unsigned int get_this_unsigned(const char **c)
     }
     
     /* Assume the next thing is an unsigned and convert */
-    return static_cast<unsigned int>(atoi(*c));
+    return static_cast<unsigned int>(to_int(*c));
 }
 
 /* Char* to string conversion where string is quoted */
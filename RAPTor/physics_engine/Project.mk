@@ -27,7 +27,7 @@ LIBPATH = $(LIBARYS_PATH)/SDL2-$(SDL_VER)/lib \
     $(RAYTRACER_HOME) \
     ${BOOST_LIB_PATH}
 SO_LIBS = raytracer SDL2 SDL2_ttf SDL2_image tbb pthread boost_thread boost_filesystem boost_system boost_log boost_serialization
-LIBRARY = $(SO_LIBS) fftw3f
+LIBRARY = $(SO_LIBS) fftw3f_threads fftw3f
 
 # Defines
 DEFINES = REFLECTIONS_ON REFRACTIONS_ON SIMD_PACKET_TRACING FRUSTRUM_CULLING BOOST_LOG_DYN_LINK BOOST_LOG_LEVEL=boost::log::trivial::trace EXACT_NORMALISE
@@ -31,8 +31,8 @@ LIBPATH = $(LIBARYS_PATH)/SDL2-$(SDL_VER)/lib \
 	$(LIBARYS_PATH)/libtga-$(LIBTGA_VER)/lib \
 	${BOOST_LIB_PATH}
 SO_LIBS = SDL2 SDL2_ttf tbb tbbmalloc jpeg png tga pthread boost_system boost_filesystem boost_log boost_serialization
-LIBRARY = $(SO_LIBS) fftw3f
+LIBRARY = $(SO_LIBS) fftw3f_threads fftw3f
 
 # Defines
-DEFINES = SIMD_PACKET_TRACING FRUSTRUM_CULLING BOOST_LOG_DYN_LINK BOOST_LOG_LEVEL=boost::log::trivial::trace # THREADED_RAY_TRACE LOG_DEPTH SIMD_PACKET_TRACING FRUSTRUM_CULLING SHOW_KD_TREE DIFFUSE_REFLECTIONS=128.0 SOFT_SHADOW=256.0 
+DEFINES = SIMD_PACKET_TRACING FRUSTRUM_CULLING BOOST_LOG_DYN_LINK BOOST_LOG_LEVEL=boost::log::trivial::trace # THREADED_RAY_TRACE LOG_DEPTH SIMD_PACKET_TRACING FRUSTRUM_CULLING SHOW_KD_TREE TRAVERSAL_STATISTICS DIFFUSE_REFLECTIONS=128.0 SOFT_SHADOW=256.0 
 LINTER_DEFINES = DIFFUSE_REFLECTIONS=128.0 SOFT_SHADOW=256.0 
@@ -1,9 +1,395 @@
-#include "camera.h"
+/* Standard headers */
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+/* Boost headers */
+#include "boost/noncopyable.hpp"
+
+/* FFTW headers */
 #include "fftw3.h"
 
+/* TBB headers */
+#include "parallel_for.h"
+#include "parallel_reduce.h"
+#include "blocked_range.h"
+
+/* Common headers */
+#include "logging.h"
+#include "simd.h"
+
+/* Ray tracer headers */
+#include "camera.h"
+
 
 namespace raptor_raytracer
 {
+namespace
+{
+/* Pixels per task for post processing */
+const int post_process_grain = 4096;
+
+/* Call f(i) for each pixel i in [0, n) in parallel */
+template<class F>
+void parallel_pixels(const int n, const F &f)
+{
+    tbb::parallel_for(tbb::blocked_range<int>(0, n, post_process_grain), [&f](const tbb::blocked_range<int> &r)
+        {
+            for (int i = r.begin(); i != r.end(); ++i)
+            {
+                f(i);
+            }
+        });
+}
+
+/* Reduce f(&a, i) over each pixel i in [0, n) in parallel, partial results are combined with c */
+/* The split is fixed so the result doesnt vary run to run */
+template<class T, class F, class C>
+T parallel_pixel_reduce(const int n, const T &identity, const F &f, const C &c)
+{
+    return tbb::parallel_deterministic_reduce(tbb::blocked_range<int>(0, n, post_process_grain), identity, [&f](const tbb::blocked_range<int> &r, T a)
+        {
+            for (int i = r.begin(); i != r.end(); ++i)
+            {
+                f(&a, i);
+            }
+            return a;
+        }, c);
+}
+
+/* Complex multiply the n values of a by b in place, split into real and imaginary arrays */
+/* n must be a multiple of SIMD_WIDTH and the arrays aligned for vfp_t */
+void complex_multiply(float *const a_re, float *const a_im, const float *const b_re, const float *const b_im, const int n)
+{
+    assert((n & (SIMD_WIDTH - 1)) == 0);
+    /* Split by vector so every range starts aligned */
+    tbb::parallel_for(tbb::blocked_range<int>(0, n / SIMD_WIDTH, post_process_grain / SIMD_WIDTH), [=](const tbb::blocked_range<int> &r)
+        {
+            for (int i = r.begin() * SIMD_WIDTH; i < (r.end() * SIMD_WIDTH); i += SIMD_WIDTH)
+            {
+                const vfp_t ar(&a_re[i]);
+                const vfp_t ai(&a_im[i]);
+                const vfp_t br(&b_re[i]);
+                const vfp_t bi(&b_im[i]);
+                ((ar * br) - (ai * bi)).store(&a_re[i]);
+                ((ar * bi) + (ai * br)).store(&a_im[i]);
+            }
+        }, tbb::simple_partitioner());
+}
+
+/* Statistics of the image luminance gathered while converting to Yxy */
+struct luminance_stats
+{
+    luminance_stats operator+(const luminance_stats &rhs) const
+    {
+        return { log_sum + rhs.log_sum, std::max(max_Y, rhs.max_Y), rgb_sum + rhs.rgb_sum, count + rhs.count };
+    }
+
+    float   log_sum = 0.0f; /* Sum of log10 luminance of lit pixels */
+    float   max_Y   = 0.0f; /* Maximum luminance                    */
+    float   rgb_sum = 0.0f; /* Sum of average rgb                   */
+    int     count   = 0;    /* Number of lit pixels                 */
+};
+
+/* Round n up to a whole number of vectors */
+int simd_round_up(const int n)
+{
+    return (n + SIMD_WIDTH - 1) & ~(SIMD_WIDTH - 1);
+}
+
+/* The FFTW planner isnt thread safe */
+std::mutex fftw_planner_lock;
+
+/* Plans should use all the threads TBB would */
+void init_fftw_threads()
+{
+    static std::once_flag once;
+    std::call_once(once, []()
+        {
+            fftwf_init_threads();
+            fftwf_plan_with_nthreads(std::max(1u, std::thread::hardware_concurrency()));
+        });
+}
+
+/* Split complex arrays for vfp_t multiplies, padded to a whole number of vectors */
+float * new_spectrum(const int n)
+{
+    float *const s = reinterpret_cast<float *>(new vfp_t [simd_round_up(n) / SIMD_WIDTH]);
+    std::fill(s, s + simd_round_up(n), 0.0f);
+    return s;
+}
+
+void delete_spectrum(float *const s)
+{
+    delete [] reinterpret_cast<vfp_t *>(s);
+}
+} /* namespace */
+
+
+/* FFTW plans, buffers and transformed filters kept between frames. Spectra are held as split real and imaginary arrays so
+   they can be multiplied a vector at a time */
+struct camera::fft_cache : private boost::noncopyable
+{
+    fft_cache() :
+        glare_x(0), glare_y(0), glare_spectrum(0), glare_in(nullptr), glare_re(nullptr), glare_im(nullptr), glare_fwd(nullptr), glare_inv(nullptr),
+        grid_spectrum(0), grid_sigma_r(0.0f), grid_sigma_s(0.0f), grid_in(nullptr), grid_re(nullptr), grid_im(nullptr), kernel_re(nullptr), kernel_im(nullptr),
+        grid_fwd(nullptr), grid_inv(nullptr), psf_res(0), psf_in(nullptr), psf_out(nullptr), psf_p(nullptr)
+    {
+        std::fill(&filter_re[0], &filter_re[3], nullptr);
+        std::fill(&filter_im[0], &filter_im[3], nullptr);
+        std::fill(&grid[0], &grid[3], 0);
+        init_fftw_threads();
+    }
+
+    ~fft_cache()
+    {
+        free_glare();
+        free_grid();
+        free_psf();
+    }
+
+    /* Plan the convolution of 3 channels of x by y pixels */
+    void plan_glare(const int x, const int y)
+    {
+        if ((x == glare_x) && (y == glare_y))
+        {
+            return;
+        }
+
+        free_glare();
+        glare_x         = x;
+        glare_y         = y;
+        glare_spectrum  = y * ((x >> 1) + 1);
+        glare_in        = static_cast<float *>(fftwf_malloc(x * y * 3 * sizeof(float)));
+        glare_re        = new_spectrum(glare_spectrum * 3);
+        glare_im        = new_spectrum(glare_spectrum * 3);
+
+        /* Row major channels, the last dimension of the spectrum is halved */
+        const fftwf_iodim fwd_dims[2] = { { y, x, (x >> 1) + 1 }, { x, 1, 1 } };
+        const fftwf_iodim inv_dims[2] = { { y, (x >> 1) + 1, x }, { x, 1, 1 } };
+        const fftwf_iodim fwd_channels  = { 3, x * y, glare_spectrum };
+        const fftwf_iodim inv_channels  = { 3, glare_spectrum, x * y };
+
+        std::lock_guard<std::mutex> guard(fftw_planner_lock);
+        glare_fwd = fftwf_plan_guru_split_dft_r2c(2, fwd_dims, 1, &fwd_channels, glare_in, glare_re, glare_im, FFTW_MEASURE);
+        glare_inv = fftwf_plan_guru_split_dft_c2r(2, inv_dims, 1, &inv_channels, glare_re, glare_im, glare_in, FFTW_MEASURE);
+    }
+
+    /* Plan the convolution of 2 x by y by z grids with a gaussian kernel */
+    void plan_grid(const int x, const int y, const int z, const float sigma_r, const float sigma_s)
+    {
+        if ((x == grid[0]) && (y == grid[1]) && (z == grid[2]) && (sigma_r == grid_sigma_r) && (sigma_s == grid_sigma_s))
+        {
+            return;
+        }
+
+        free_grid();
+        grid[0]         = x;
+        grid[1]         = y;
+        grid[2]         = z;
+        grid_sigma_r    = sigma_r;
+        grid_sigma_s    = sigma_s;
+        grid_spectrum   = simd_round_up(z * y * ((x >> 1) + 1));
+        grid_in         = static_cast<float *>(fftwf_malloc(x * y * z * 2 * sizeof(float)));
+        grid_re         = new_spectrum(grid_spectrum * 2);
+        grid_im         = new_spectrum(grid_spectrum * 2);
+        kernel_re       = new_spectrum(grid_spectrum);
+        kernel_im       = new_spectrum(grid_spectrum);
+
+        /* X is the fastest changing */
+        const fftwf_iodim fwd_dims[3] = { { z, x * y, y * ((x >> 1) + 1) }, { y, x, (x >> 1) + 1 }, { x, 1, 1 } };
+        const fftwf_iodim inv_dims[3] = { { z, y * ((x >> 1) + 1), x * y }, { y, (x >> 1) + 1, x }, { x, 1, 1 } };
+        const fftwf_iodim fwd_grids  = { 2, x * y * z, grid_spectrum };
+        const fftwf_iodim inv_grids  = { 2, grid_spectrum, x * y * z };
+        fftwf_plan kernel_p;
+        {
+            std::lock_guard<std::mutex> guard(fftw_planner_lock);
+            grid_fwd = fftwf_plan_guru_split_dft_r2c(3, fwd_dims, 1, &fwd_grids, grid_in, grid_re, grid_im, FFTW_MEASURE);
+            grid_inv = fftwf_plan_guru_split_dft_c2r(3, inv_dims, 1, &inv_grids, grid_re, grid_im, grid_in, FFTW_MEASURE);
+            kernel_p = fftwf_plan_guru_split_dft_r2c(3, fwd_dims, 0, nullptr, grid_in, kernel_re, kernel_im, FFTW_ESTIMATE);
+        }
+
+        /* Build and transform the kernel, with the wrap around distance from 0 */
+        const int half_x = x >> 1;
+        const int half_y = y >> 1;
+        const int half_z = z >> 1;
+        tbb::parallel_for(0, z, [&](const int k)
+            {
+                const float Z = k - ((k > half_z) ? z : 0.0f);
+                for (int j = 0; j < y; ++j)
+                {
+                    const float Y = j - ((j > half_y) ? y : 0.0f);
+                    for (int i = 0; i < x; ++i)
+                    {
+                        const float X = i - ((i > half_x) ? x : 0.0f);
+                        const float rr = (((X * X) + (Y * Y)) / (sigma_s * sigma_s)) + ((Z * Z) / (sigma_r * sigma_r));
+                        grid_in[i + (x * (j + (y * k)))] = std::exp(-rr * 0.5f);
+                    }
+                }
+            });
+        fftwf_execute(kernel_p);
+
+        /* Fold the FFTW normalisation into the kernel */
+        const float s = 1.0f / static_cast<float>(x * y * z);
+        for (int i = 0; i < grid_spectrum; ++i)
+        {
+            kernel_re[i] *= s;
+            kernel_im[i] *= s;
+        }
+
+        std::lock_guard<std::mutex> guard(fftw_planner_lock);
+        fftwf_destroy_plan(kernel_p);
+    }
+
+    /* Plan a complex transform of n by n */
+    void plan_psf(const int n)
+    {
+        if (n == psf_res)
+        {
+            return;
+        }
+
+        free_psf();
+        psf_res = n;
+        psf_in  = static_cast<fftwf_complex *>(fftwf_malloc(n * n * sizeof(fftwf_complex)));
+        psf_out = static_cast<fftwf_complex *>(fftwf_malloc(n * n * sizeof(fftwf_complex)));
+
+        std::lock_guard<std::mutex> guard(fftw_planner_lock);
+        psf_p   = fftwf_plan_dft_2d(n, n, psf_in, psf_out, FFTW_FORWARD, FFTW_MEASURE);
+    }
+
+    void free_glare()
+    {
+        for (int i = 0; i < 3; ++i)
+        {
+            delete_spectrum(filter_re[i]);
+            delete_spectrum(filter_im[i]);
+            filter_re[i] = nullptr;
+            filter_im[i] = nullptr;
+        }
+
+        delete_spectrum(glare_re);
+        delete_spectrum(glare_im);
+        fftwf_free(glare_in);
+        glare_re = nullptr;
+        glare_im = nullptr;
+        glare_in = nullptr;
+
+        std::lock_guard<std::mutex> guard(fftw_planner_lock);
+        if (glare_fwd != nullptr)
+        {
+            fftwf_destroy_plan(glare_fwd);
+            fftwf_destroy_plan(glare_inv);
+        }
+        glare_fwd = nullptr;
+        glare_inv = nullptr;
+    }
+
+    void free_grid()
+    {
+        delete_spectrum(grid_re);
+        delete_spectrum(grid_im);
+        delete_spectrum(kernel_re);
+        delete_spectrum(kernel_im);
+        fftwf_free(grid_in);
+        grid_re     = nullptr;
+        grid_im     = nullptr;
+        kernel_re   = nullptr;
+        kernel_im   = nullptr;
+        grid_in     = nullptr;
+
+        std::lock_guard<std::mutex> guard(fftw_planner_lock);
+        if (grid_fwd != nullptr)
+        {
+            fftwf_destroy_plan(grid_fwd);
+            fftwf_destroy_plan(grid_inv);
+        }
+        grid_fwd = nullptr;
+        grid_inv = nullptr;
+    }
+
+    void free_psf()
+    {
+        fftwf_free(psf_in);
+        fftwf_free(psf_out);
+        psf_in  = nullptr;
+        psf_out = nullptr;
+
+        std::lock_guard<std::mutex> guard(fftw_planner_lock);
+        if (psf_p != nullptr)
+        {
+            fftwf_destroy_plan(psf_p);
+        }
+        psf_p = nullptr;
+    }
+
+    /* Glare convolution */
+    int             glare_x;            /* Width of the planned image                           */
+    int             glare_y;            /* Height of the planned image                          */
+    int             glare_spectrum;     /* Complex values in the transform of one channel       */
+    float *         glare_in;           /* Channels of the image, overwritten by the result     */
+    float *         glare_re;           /* Real part of the image transform                     */
+    float *         glare_im;           /* Imaginary part of the image transform                */
+    float *         filter_re[3];       /* Real part of the filter transform by light level     */
+    float *         filter_im[3];       /* Imaginary part of the filter transform by light level*/
+    fftwf_plan      glare_fwd;          /* Image to spectrum                                    */
+    fftwf_plan      glare_inv;          /* Spectrum to image                                    */
+
+    /* Bilateral grid convolution */
+    int             grid[3];            /* Size of the planned grid                             */
+    int             grid_spectrum;      /* Complex values in the transform of one grid, padded  */
+    float           grid_sigma_r;       /* Range sigma the kernel was built for                 */
+    float           grid_sigma_s;       /* Spatial sigma the kernel was built for               */
+    float *         grid_in;            /* Weight and weighted intensity grids                  */
+    float *         grid_re;            /* Real part of the grid transforms                     */
+    float *         grid_im;            /* Imaginary part of the grid transforms                */
+    float *         kernel_re;          /* Real part of the kernel transform, normalised        */
+    float *         kernel_im;          /* Imaginary part of the kernel transform, normalised   */
+    fftwf_plan      grid_fwd;           /* Grids to spectra                                     */
+    fftwf_plan      grid_inv;           /* Spectra to grids                                     */
+
+    /* Temporal point spread function */
+    int             psf_res;            /* Width and height of the planned transform            */
+    fftwf_complex * psf_in;             /* Pupil image                                          */
+    fftwf_complex * psf_out;            /* Its transform                                        */
+    fftwf_plan      psf_p;              /* Pupil to transform                                   */
+};
+
+
+camera::~camera()
+{
+    /* Delete the image data */
+    delete [] this->image;
+    
+    /* Delete any glare filter images */            
+    delete [] this->scotopic_glare_filter;
+    delete [] this->mesopic_glare_filter;
+    delete [] this->photopic_glare_filter;
+    delete [] this->temporal_glare_filter;
+
+    /* Delete the plans */
+    delete this->fft;
+}
+
+
+void camera::stage_done(const char *const s)
+{
+    const auto t1(std::chrono::system_clock::now());
+    this->post_times.emplace_back(s, std::chrono::duration_cast<std::chrono::microseconds>(t1 - this->post_t0).count() / 1000.0f);
+    this->post_t0 = t1;
+}
+
+
+void camera::scale_luminance(const float sf)
+{
+    ext_colour_t *const img = this->image;
+    parallel_pixels(this->x_res * this->y_res, [img, sf](const int i)
+        {
+            img[i].g *= sf;
+        });
+}
+
+
 /* C style headers */
 extern "C"
 {
@@ -226,78 +612,79 @@ void camera::apply_point_spreading_function(T p, ext_colour_t *const f)
 {
     const float pixdeg = (std::atan(-this->x_m / this->t) * 2.0f) / this->x_res;
 
-    for (int j = 0; j < static_cast<int>(this->y_res); ++j)
-    {
-        for (int i = 0; i < static_cast<int>(this->x_res); ++i)
+    /* Each pixel is independant */
+    tbb::parallel_for(0, static_cast<int>(this->y_res), [&](const int j)
         {
-            // perform 2D trapezoidal integration
-            float w = static_cast<float>(i) - this->x_res / 2.0f, x = w + 1.0f;
-            float y = static_cast<float>(j) - this->y_res / 2.0f, z = y + 1.0f;
+            for (int i = 0; i < static_cast<int>(this->x_res); ++i)
+            {
+                // perform 2D trapezoidal integration
+                float w = static_cast<float>(i) - this->x_res / 2.0f, x = w + 1.0f;
+                float y = static_cast<float>(j) - this->y_res / 2.0f, z = y + 1.0f;
       
-            // determine four corners, find ratio
-            float max, min;
-            ext_colour_t tmp, sum1;
-
-            // sum four corners and keep track of min and max
-            tmp = p(w, y, pixdeg);
-            sum1 = tmp;
-            max = std::max(std::max(sum1.r, sum1.g), sum1.b);
-            min = std::min(std::min(sum1.r, sum1.g), sum1.b);
-
-            tmp = p(x, y, pixdeg);
-            sum1+=tmp;
-            max = std::max(std::max(tmp.r, tmp.g), std::max(tmp.b, max));
-            min = std::min(std::min(tmp.r, tmp.g), std::min(tmp.b, min));
-
-            tmp = p(w, z, pixdeg);
-            sum1+=tmp;
-            max = std::max(std::max(tmp.r, tmp.g), std::max(tmp.b, max));
-            min = std::min(std::min(tmp.r, tmp.g), std::min(tmp.b, min));
-
-            tmp = p(x, z, pixdeg);
-            sum1+=tmp;
-            max = std::max(std::max(tmp.r, tmp.g), std::max(tmp.b, max));
-            min = std::min(std::min(tmp.r, tmp.g), std::min(tmp.b, min));
-
-            // choose number of samples based on ratio of min and max
-            int samps = 3;
-//            int samps = (max-min)/min > 2.0 ? 100 : 10;  // FIXME
-            //int samps = (std::fabs(w/(d*0.5)) < .1 && std::fabs(y/(d*0.5))<.1) ? 100 : 3;
-            int n = samps-1;
+                // determine four corners, find ratio
+                float max, min;
+                ext_colour_t tmp, sum1;
+
+                // sum four corners and keep track of min and max
+                tmp = p(w, y, pixdeg);
+                sum1 = tmp;
+                max = std::max(std::max(sum1.r, sum1.g), sum1.b);
+                min = std::min(std::min(sum1.r, sum1.g), sum1.b);
+
+                tmp = p(x, y, pixdeg);
+                sum1+=tmp;
+                max = std::max(std::max(tmp.r, tmp.g), std::max(tmp.b, max));
+                min = std::min(std::min(tmp.r, tmp.g), std::min(tmp.b, min));
+
+                tmp = p(w, z, pixdeg);
+                sum1+=tmp;
+                max = std::max(std::max(tmp.r, tmp.g), std::max(tmp.b, max));
+                min = std::min(std::min(tmp.r, tmp.g), std::min(tmp.b, min));
+
+                tmp = p(x, z, pixdeg);
+                sum1+=tmp;
+                max = std::max(std::max(tmp.r, tmp.g), std::max(tmp.b, max));
+                min = std::min(std::min(tmp.r, tmp.g), std::min(tmp.b, min));
+
+                // choose number of samples based on ratio of min and max
+                int samps = 3;
+    //            int samps = (max-min)/min > 2.0 ? 100 : 10;  // FIXME
+                //int samps = (std::fabs(w/(d*0.5)) < .1 && std::fabs(y/(d*0.5))<.1) ? 100 : 3;
+                int n = samps-1;
         
-            float h = (x - w) / n;
-            float k = (z - y) / n;
+                float h = (x - w) / n;
+                float k = (z - y) / n;
         
-            ext_colour_t sum2(0.0f, 0.0f, 0.0f);
-            for (int k = 1; k < n; k++)
-            {
-                float x_k = (x - w) / static_cast<float>(n * k + w); /* This cast may be include too many terms */
-                float y_k = (z - y) / static_cast<float>(n * k + y); /* This cast may be include too many terms */
-                sum2 += p(x_k, y, pixdeg) + 
-                        p(x_k, z, pixdeg) + 
-                        p(w, y_k, pixdeg) + 
-                        p(x, y_k, pixdeg);
-            }
-            sum1 += ext_colour_t(2.0f) * sum2;
-
-            sum2 = ext_colour_t(0.0f, 0.0f, 0.0f);
-            for (int k = 1; k < n; ++k)
-            {
-                for (int l = 1; l < n; ++l)
+                ext_colour_t sum2(0.0f, 0.0f, 0.0f);
+                for (int k = 1; k < n; k++)
                 {
                     float x_k = (x - w) / static_cast<float>(n * k + w); /* This cast may be include too many terms */
-                    float y_l = (z - y) / static_cast<float>(n * l + y); /* This cast may be include too many terms */
-                    sum2 += p(x_k, y_l, pixdeg);
+                    float y_k = (z - y) / static_cast<float>(n * k + y); /* This cast may be include too many terms */
+                    sum2 += p(x_k, y, pixdeg) + 
+                            p(x_k, z, pixdeg) + 
+                            p(w, y_k, pixdeg) + 
+                            p(x, y_k, pixdeg);
                 }
-            }
-            sum1 += ext_colour_t(4.0f) * sum2;
-            sum1 *= ext_colour_t(0.25f * h * k);
+                sum1 += ext_colour_t(2.0f) * sum2;
 
-            f[(i + (j * this->x_res))].r *= sum1.r;
-            f[(i + (j * this->x_res))].g *= sum1.g;
-            f[(i + (j * this->x_res))].b *= sum1.b;
-        }
-    }
+                sum2 = ext_colour_t(0.0f, 0.0f, 0.0f);
+                for (int k = 1; k < n; ++k)
+                {
+                    for (int l = 1; l < n; ++l)
+                    {
+                        float x_k = (x - w) / static_cast<float>(n * k + w); /* This cast may be include too many terms */
+                        float y_l = (z - y) / static_cast<float>(n * l + y); /* This cast may be include too many terms */
+                        sum2 += p(x_k, y_l, pixdeg);
+                    }
+                }
+                sum1 += ext_colour_t(4.0f) * sum2;
+                sum1 *= ext_colour_t(0.25f * h * k);
+
+                f[(i + (j * this->x_res))].r *= sum1.r;
+                f[(i + (j * this->x_res))].g *= sum1.g;
+                f[(i + (j * this->x_res))].b *= sum1.b;
+            }
+        });
     
     return;
 }
@@ -360,10 +747,7 @@ void camera::generate_glare_filter(ext_colour_t **gf, const light_level_t ll)
     
     /* Set white for the bloom with the same average intensity as the other images */
     const float bloom_lum = flare_sum / (this->x_res * this->y_res);
-    for (int i = 0; i < (int)(this->x_res * this->y_res); i++)
-    {
-        (*gf)[(this->x_res * this->y_res * 2) + i] = ext_colour_t(bloom_lum, bloom_lum, bloom_lum);
-    }
+    std::fill(&(*gf)[this->x_res * this->y_res * 2], &(*gf)[this->x_res * this->y_res * 3], ext_colour_t(bloom_lum, bloom_lum, bloom_lum));
     
 
     /* Apply the spreading function to each componant */
@@ -400,13 +784,14 @@ void camera::generate_glare_filter(ext_colour_t **gf, const light_level_t ll)
     
 
     /* Combine the componants and normalise the image */
-    ext_colour_t sum(0.0, 0.0, 0.0);
-    for (int i = 0; i < (int)(this->x_res * this->y_res); i++)
-    {
-        (*gf)[i] += (*gf)[(this->x_res * this->y_res    ) + i];
-        (*gf)[i] += (*gf)[(this->x_res * this->y_res * 2) + i];
-        sum += (*gf)[i];
-    }
+    ext_colour_t *const f = *gf;
+    const int picture_size = this->x_res * this->y_res;
+    const ext_colour_t sum = parallel_pixel_reduce(picture_size, ext_colour_t(0.0f, 0.0f, 0.0f), [f, picture_size](ext_colour_t *const s, const int i)
+        {
+            f[i] += f[picture_size + i];
+            f[i] += f[(picture_size << 1) + i];
+            (*s) += f[i];
+        }, [](const ext_colour_t &a, const ext_colour_t &b) { return a + b; });
   
 
     // In section 3.1 on page 4 it mentions
@@ -430,12 +815,12 @@ void camera::generate_glare_filter(ext_colour_t **gf, const light_level_t ll)
     std::cout << "Sum = " << sum.r << ", " << sum.g << ", " << sum.b << std::endl;
     std::cout << "Mul = " << mul.r << "," << mul.g << "," << mul.b << std::endl;
 
-    for (int i = 0; i < static_cast<int>(this->x_res * this->y_res); ++i)
-    {
-        (*gf)[i].r *= mul.r;
-        (*gf)[i].g *= mul.g;
-        (*gf)[i].b *= mul.b;
-    }
+    parallel_pixels(picture_size, [f, &mul](const int i)
+        {
+            f[i].r *= mul.r;
+            f[i].g *= mul.g;
+            f[i].b *= mul.b;
+        });
 
 
 
@@ -726,23 +1111,12 @@ void camera::generate_temporal_psf(const float y)
 
     /* Sum the componants */
     const int complete_image_offset  = (5 * picture_resolution * picture_resolution_y);
-    for (int i = 0; i < static_cast<int>(picture_resolution * picture_resolution_y); i++)
-    {
-        image_componants[complete_image_offset + i]  = image_componants[i];
-        image_componants[complete_image_offset + i] += image_componants[i + vitreous_humour_offset];
-        image_componants[complete_image_offset + i] += image_componants[i + lens_fiber_offset     ];
-        image_componants[complete_image_offset + i] += image_componants[i + lens_particle_offset  ];
-        image_componants[complete_image_offset + i] += image_componants[i + cornea_particle_offset];
-       
-        if (image_componants[complete_image_offset + i] < (255.0f * 5.0f))
-        {
-            image_componants[complete_image_offset + i] = 1.0f;
-        }
-        else
+    parallel_pixels(picture_resolution * picture_resolution_y, [&](const int i)
         {
-            image_componants[complete_image_offset + i] = 0.0f;
-        }
-    }
+            const float sum = image_componants[i] + image_componants[i + vitreous_humour_offset] + image_componants[i + lens_fiber_offset] +
+                image_componants[i + lens_particle_offset] + image_componants[i + cornea_particle_offset];
+            image_componants[complete_image_offset + i] = (sum < (255.0f * 5.0f)) ? 1.0f : 0.0f;
+        });
 
     /* Down sample to 1K X 1K */
     const int downsampled_resolution = 1000;
@@ -751,23 +1125,25 @@ void camera::generate_temporal_psf(const float y)
     std::cout << picture_resolution << ", " << picture_resolution_y << std::endl;
     std::cout << x_samples << ", " << y_samples << std::endl;
     
-    int image_addr = 0;
-    for (int j = 0; j < downsampled_resolution; j++)
-    {
-        for (int i = 0; i < downsampled_resolution; i++)
+    /* Rows are written in place over the first rows of the image, which must all be read first */
+    std::vector<float> downsampled(downsampled_resolution * downsampled_resolution);
+    tbb::parallel_for(0, downsampled_resolution, [&](const int j)
         {
-            float sample = 0.0f;
-            for (int i_aa = 0; i_aa < x_samples; i_aa++)
+            for (int i = 0; i < downsampled_resolution; i++)
             {
-                for (int j_aa = 0; j_aa < y_samples; j_aa++)
+                float sample = 0.0f;
+                for (int i_aa = 0; i_aa < x_samples; i_aa++)
                 {
-                    int sample_addr = ((i * x_samples) + i_aa) + (((j * y_samples) + j_aa) * picture_resolution);
-                    sample += image_componants[complete_image_offset + sample_addr];
+                    for (int j_aa = 0; j_aa < y_samples; j_aa++)
+                    {
+                        int sample_addr = ((i * x_samples) + i_aa) + (((j * y_samples) + j_aa) * picture_resolution);
+                        sample += image_componants[complete_image_offset + sample_addr];
+                    }
                 }
+                downsampled[i + (j * downsampled_resolution)] = sample / (x_samples * y_samples);
             }
-            image_componants[complete_image_offset + image_addr++] = sample / (x_samples * y_samples);
-        }
-    }
+        });
+    std::copy(downsampled.begin(), downsampled.end(), &image_componants[complete_image_offset]);
 
 #if 1
 {
@@ -821,12 +1197,13 @@ void camera::generate_temporal_psf(const float y)
 
     /* Multiply by the complex exponential e^(i * (PI / (lambda * d)) * (xp^2 + yq^2)) */
     /*                                    = std::cos((PI / (lambda * d)) * (x^2 + y^2))) + (i * std::sin((PI / (lambda * d)) * (xp^2 + yq^2))) */
-    fftwf_complex *image_in;
-    fftwf_complex *image_out;
-    fftwf_plan image_p;
-    image_in    = (fftwf_complex *)fftwf_malloc(downsampled_resolution * downsampled_resolution * sizeof(fftwf_complex));
-    image_out   = (fftwf_complex *)fftwf_malloc(downsampled_resolution * downsampled_resolution * sizeof(fftwf_complex));
-    image_p     = fftwf_plan_dft_2d(downsampled_resolution, downsampled_resolution, image_in, image_out, FFTW_FORWARD, FFTW_ESTIMATE);
+    if (this->fft == nullptr)
+    {
+        this->fft = new fft_cache();
+    }
+    this->fft->plan_psf(downsampled_resolution);
+    fftwf_complex *const image_in   = this->fft->psf_in;
+    fftwf_complex *const image_out  = this->fft->psf_out;
 
     const float retina_pixel_scale   = 1.0e-9f;
     const float image_scale_factor   = retina_pixel_scale / pixel_scale;
@@ -835,24 +1212,24 @@ void camera::generate_temporal_psf(const float y)
     const float lambda_d             = 5.0e-4f;//lambda * pupil_to_retina_dist;
     std::cout << "lambda_d          : " << lambda_d           << std::endl;
     std::cout << "image_scale_factor: " << image_scale_factor << std::endl;
-    for (int j = 0; j < (int)downsampled_resolution; j++)
-    {
-        const float yq = (static_cast<float>(j) - (static_cast<float>(downsampled_resolution) * 0.5f)) * (5.0f * pixel_scale) * 0.5f;
-        for (int i = 0; i < (int)downsampled_resolution; i++)
+    tbb::parallel_for(0, downsampled_resolution, [&](const int j)
         {
-            const float xp = (static_cast<float>(i) - (static_cast<float>(downsampled_resolution) * 0.5f)) * (5.0f * pixel_scale) * 0.5f;
-            const float exponential = ((PI / lambda_d) * ((xp * xp) + (yq * yq)));
-            
-            const int image_addr = i + (downsampled_resolution * j);
+            const float yq = (static_cast<float>(j) - (static_cast<float>(downsampled_resolution) * 0.5f)) * (5.0f * pixel_scale) * 0.5f;
+            for (int i = 0; i < (int)downsampled_resolution; i++)
+            {
+                const float xp = (static_cast<float>(i) - (static_cast<float>(downsampled_resolution) * 0.5f)) * (5.0f * pixel_scale) * 0.5f;
+                const float exponential = ((PI / lambda_d) * ((xp * xp) + (yq * yq)));
+                
+                const int image_addr = i + (downsampled_resolution * j);
 
-            const int xp_addr    = std::max(std::min((int)((xp / (5.0f * pixel_scale)) + (static_cast<float>(downsampled_resolution) * 0.5f)), (int)downsampled_resolution - 1), 0);
-            const int yq_addr    = std::max(std::min((int)((yq / (5.0f * pixel_scale)) + (static_cast<float>(downsampled_resolution) * 0.5f)), (int)downsampled_resolution - 1), 0);
-            const int pupil_addr = complete_image_offset + xp_addr + (downsampled_resolution * yq_addr);
+                const int xp_addr    = std::max(std::min((int)((xp / (5.0f * pixel_scale)) + (static_cast<float>(downsampled_resolution) * 0.5f)), (int)downsampled_resolution - 1), 0);
+                const int yq_addr    = std::max(std::min((int)((yq / (5.0f * pixel_scale)) + (static_cast<float>(downsampled_resolution) * 0.5f)), (int)downsampled_resolution - 1), 0);
+                const int pupil_addr = complete_image_offset + xp_addr + (downsampled_resolution * yq_addr);
 
-            image_in[image_addr][0] = std::cos(exponential) * image_componants[pupil_addr];
-            image_in[image_addr][1] = std::sin(exponential) * image_componants[pupil_addr];
-        }
-    }
+                image_in[image_addr][0] = std::cos(exponential) * image_componants[pupil_addr];
+                image_in[image_addr][1] = std::sin(exponential) * image_componants[pupil_addr];
+            }
+        });
 
 #if 1
 {
@@ -917,15 +1294,13 @@ void camera::generate_temporal_psf(const float y)
     }
     
     /* FFT, take square magnitude and scale */    
-    fftwf_execute(image_p);
+    fftwf_execute(this->fft->psf_p);
 
     const float fft_scale = 1.0f;// / (lambda_d * lambda_d);
-    for (int i = 0; i < (int)(downsampled_resolution * downsampled_resolution); i++)
-    {
-        image_in[i][0] /= (downsampled_resolution * downsampled_resolution);
-        image_in[i][1] /= (downsampled_resolution * downsampled_resolution);
-        image_in[i][0] = ((image_out[i][0] * image_out[i][0]) + (image_out[i][1] * image_out[i][1])) * fft_scale;
-    }
+    parallel_pixels(downsampled_resolution * downsampled_resolution, [image_in, image_out, fft_scale](const int i)
+        {
+            image_in[i][0] = ((image_out[i][0] * image_out[i][0]) + (image_out[i][1] * image_out[i][1])) * fft_scale;
+        });
 
 #if 1
 {
@@ -1007,58 +1382,58 @@ void camera::generate_temporal_psf(const float y)
                                        0.0f / (4.0f * 106836.0f),     0.0f / (4.0f * 106836.0f),     0.0f / (4.0f * 106836.0f),     0.0f / (4.0f * 106836.0f),     0.0f / (4.0f * 106836.0f),     
                                        0.0f / (4.0f * 106836.0f),     0.0f / (4.0f * 106836.0f),     0.0f / (4.0f * 106836.0f),     0.0f / (4.0f * 106836.0f),     0.0f / (4.0f * 106836.0f), 0.0f / (4.0f * 106836.0f) };//106770L
 
-    for (int j = 0; j < (int)downsampled_resolution; j++)
-    {
-        for (int i = 0; i < (int)downsampled_resolution; i++)
+    tbb::parallel_for(0, downsampled_resolution, [&](const int j)
         {
-            const float x_o  = static_cast<float>(i) - (downsampled_resolution * 0.5f);
-            const float y_o  = static_cast<float>(j) - (downsampled_resolution * 0.5f);
-            float lambda_i   = 380.0f;
-
-            for (int f = 0; f < 41; f++)
+            for (int i = 0; i < (int)downsampled_resolution; i++)
             {
-                /* X, Y co-ordinate of the frequency */
-                const float scale    = 575.0f / lambda_i;
-                const float x_i      = std::min(std::max(static_cast<float>((x_o * scale) + (static_cast<float>(downsampled_resolution) * 0.5f)), 0.0f), (static_cast<float>(downsampled_resolution) - 1.0f));
-                const float y_i      = std::min(std::max(static_cast<float>((y_o * scale) + (static_cast<float>(downsampled_resolution) * 0.5f)), 0.0f), (static_cast<float>(downsampled_resolution) - 1.0f));
+                const float x_o  = static_cast<float>(i) - (downsampled_resolution * 0.5f);
+                const float y_o  = static_cast<float>(j) - (downsampled_resolution * 0.5f);
+                float lambda_i   = 380.0f;
+
+                for (int f = 0; f < 41; f++)
+                {
+                    /* X, Y co-ordinate of the frequency */
+                    const float scale    = 575.0f / lambda_i;
+                    const float x_i      = std::min(std::max(static_cast<float>((x_o * scale) + (static_cast<float>(downsampled_resolution) * 0.5f)), 0.0f), (static_cast<float>(downsampled_resolution) - 1.0f));
+                    const float y_i      = std::min(std::max(static_cast<float>((y_o * scale) + (static_cast<float>(downsampled_resolution) * 0.5f)), 0.0f), (static_cast<float>(downsampled_resolution) - 1.0f));
                 
-                /* Bi-linear interpolation co-ordinates and weights */
-                const int x_index   = std::max((int)0, std::min((int)x_i,    (int)(downsampled_resolution - 1)));
-                const int xx_index  = std::max((int)0, std::min(x_index + 1, (int)(downsampled_resolution - 1)));
+                    /* Bi-linear interpolation co-ordinates and weights */
+                    const int x_index   = std::max((int)0, std::min((int)x_i,    (int)(downsampled_resolution - 1)));
+                    const int xx_index  = std::max((int)0, std::min(x_index + 1, (int)(downsampled_resolution - 1)));
     
-                const int y_index   = std::max((int)0, std::min((int)y_i,    (int)(downsampled_resolution - 1)));
-                const int yy_index  = std::max((int)0, std::min(y_index + 1, (int)(downsampled_resolution - 1)));
-
-                const float x_alpha      = x_i - static_cast<float>(x_index);
-                const float y_alpha      = y_i - static_cast<float>(y_index);
-                const float m_x_alpha    = 1.0f - x_alpha;
-                const float m_y_alpha    = 1.0f - y_alpha;
-                const float x_y_alpha    = m_x_alpha * m_y_alpha;
-                const float xx_y_alpha   =   x_alpha * m_y_alpha;
-                const float x_yy_alpha   = m_x_alpha *   y_alpha;
-                const float xx_yy_alpha  =   x_alpha *   y_alpha;
-
-                const int output_addr = i + (j * downsampled_resolution);
-                this->temporal_glare_filter[output_addr].r += x_y_alpha   * cie_xf[f] * image_in[x_index  + (y_index  * downsampled_resolution)][0];
-                this->temporal_glare_filter[output_addr].g += x_y_alpha   * cie_yf[f] * image_in[x_index  + (y_index  * downsampled_resolution)][0];
-                this->temporal_glare_filter[output_addr].b += x_y_alpha   * cie_zf[f] * image_in[x_index  + (y_index  * downsampled_resolution)][0];
-
-                this->temporal_glare_filter[output_addr].r += xx_y_alpha  * cie_xf[f] * image_in[xx_index + (y_index  * downsampled_resolution)][0];
-                this->temporal_glare_filter[output_addr].g += xx_y_alpha  * cie_yf[f] * image_in[xx_index + (y_index  * downsampled_resolution)][0];
-                this->temporal_glare_filter[output_addr].b += xx_y_alpha  * cie_zf[f] * image_in[xx_index + (y_index  * downsampled_resolution)][0];
-
-                this->temporal_glare_filter[output_addr].r += x_yy_alpha  * cie_xf[f] * image_in[x_index  + (yy_index * downsampled_resolution)][0];
-                this->temporal_glare_filter[output_addr].g += x_yy_alpha  * cie_yf[f] * image_in[x_index  + (yy_index * downsampled_resolution)][0];
-                this->temporal_glare_filter[output_addr].b += x_yy_alpha  * cie_zf[f] * image_in[x_index  + (yy_index * downsampled_resolution)][0];
-
-                this->temporal_glare_filter[output_addr].r += xx_yy_alpha * cie_xf[f] * image_in[xx_index + (yy_index * downsampled_resolution)][0];
-                this->temporal_glare_filter[output_addr].g += xx_yy_alpha * cie_yf[f] * image_in[xx_index + (yy_index * downsampled_resolution)][0];
-                this->temporal_glare_filter[output_addr].b += xx_yy_alpha * cie_zf[f] * image_in[xx_index + (yy_index * downsampled_resolution)][0];
+                    const int y_index   = std::max((int)0, std::min((int)y_i,    (int)(downsampled_resolution - 1)));
+                    const int yy_index  = std::max((int)0, std::min(y_index + 1, (int)(downsampled_resolution - 1)));
+
+                    const float x_alpha      = x_i - static_cast<float>(x_index);
+                    const float y_alpha      = y_i - static_cast<float>(y_index);
+                    const float m_x_alpha    = 1.0f - x_alpha;
+                    const float m_y_alpha    = 1.0f - y_alpha;
+                    const float x_y_alpha    = m_x_alpha * m_y_alpha;
+                    const float xx_y_alpha   =   x_alpha * m_y_alpha;
+                    const float x_yy_alpha   = m_x_alpha *   y_alpha;
+                    const float xx_yy_alpha  =   x_alpha *   y_alpha;
+
+                    const int output_addr = i + (j * downsampled_resolution);
+                    this->temporal_glare_filter[output_addr].r += x_y_alpha   * cie_xf[f] * image_in[x_index  + (y_index  * downsampled_resolution)][0];
+                    this->temporal_glare_filter[output_addr].g += x_y_alpha   * cie_yf[f] * image_in[x_index  + (y_index  * downsampled_resolution)][0];
+                    this->temporal_glare_filter[output_addr].b += x_y_alpha   * cie_zf[f] * image_in[x_index  + (y_index  * downsampled_resolution)][0];
+
+                    this->temporal_glare_filter[output_addr].r += xx_y_alpha  * cie_xf[f] * image_in[xx_index + (y_index  * downsampled_resolution)][0];
+                    this->temporal_glare_filter[output_addr].g += xx_y_alpha  * cie_yf[f] * image_in[xx_index + (y_index  * downsampled_resolution)][0];
+                    this->temporal_glare_filter[output_addr].b += xx_y_alpha  * cie_zf[f] * image_in[xx_index + (y_index  * downsampled_resolution)][0];
+
+                    this->temporal_glare_filter[output_addr].r += x_yy_alpha  * cie_xf[f] * image_in[x_index  + (yy_index * downsampled_resolution)][0];
+                    this->temporal_glare_filter[output_addr].g += x_yy_alpha  * cie_yf[f] * image_in[x_index  + (yy_index * downsampled_resolution)][0];
+                    this->temporal_glare_filter[output_addr].b += x_yy_alpha  * cie_zf[f] * image_in[x_index  + (yy_index * downsampled_resolution)][0];
+
+                    this->temporal_glare_filter[output_addr].r += xx_yy_alpha * cie_xf[f] * image_in[xx_index + (yy_index * downsampled_resolution)][0];
+                    this->temporal_glare_filter[output_addr].g += xx_yy_alpha * cie_yf[f] * image_in[xx_index + (yy_index * downsampled_resolution)][0];
+                    this->temporal_glare_filter[output_addr].b += xx_yy_alpha * cie_zf[f] * image_in[xx_index + (yy_index * downsampled_resolution)][0];
                 
-                lambda_i += ((770.0f - 380.0f) / 40.0f);
+                    lambda_i += ((770.0f - 380.0f) / 40.0f);
+                }
             }
-        }
-    }
+        });
 
     this->convert_xyz_to_rgb(this->temporal_glare_filter, downsampled_resolution, downsampled_resolution);
 
@@ -1112,10 +1487,6 @@ void camera::generate_temporal_psf(const float y)
 #endif   
     /* Clean up */
     delete [] image_componants;
-
-    fftwf_destroy_plan(image_p);
-    fftwf_free(image_in);
-    fftwf_free(image_out);
     
     return;
 }
@@ -1129,83 +1500,85 @@ camera & camera::tone_map(const tone_mapping_mode_t tone_map, const float key, c
     static const float zb[3] = { 0.0193f,  0.1192f, 0.9505f };
     static const float vb[3] = { 0.01477f, 0.497f,  0.631f  };
     
-    /* Convert to CIE Yxy */
-    float Yi     = 0.0f;
-    float maxY   = 0.0f;
-    float rgbAvg = 0.0f;
-    int numpix  = 0;
-    for (int i = 0; i < (int)(this->x_res * this->y_res); i++)
-    {
-        this->image[i] /= 255.0f;
-
-        /* Find average rgb value for average tone mapper */
-        if (tone_map == tone_mapping_mode_t::global_exposure)
-        {
-            rgbAvg += (this->image[i].r + this->image[i].g + this->image[i].b) * (1.0f / 3.0f);
-        }
+    this->post_times.clear();
+    this->post_t0 = std::chrono::system_clock::now();
+    const auto t0(this->post_t0);
 
-        /* Convert to CIE xyz */
-        ext_colour_t xyz;
-        xyz.r = 683.0f * ((xb[0] * this->image[i].r) + (xb[1] * this->image[i].g) + (xb[2] * this->image[i].b));
-        xyz.g = 683.0f * ((yb[0] * this->image[i].r) + (yb[1] * this->image[i].g) + (yb[2] * this->image[i].b));
-        xyz.b = 683.0f * ((zb[0] * this->image[i].r) + (zb[1] * this->image[i].g) + (zb[2] * this->image[i].b));
-        if (xyz.g < 3.18e-7f)
-        {
-            xyz.g = 3.18e-7f;
-        }
-        else
+    /* Convert to CIE Yxy */
+    const int picture_size = this->x_res * this->y_res;
+    const luminance_stats stats = parallel_pixel_reduce(picture_size, luminance_stats(), [&](luminance_stats *const st, const int i)
         {
-            numpix++;
-            maxY = std::max(maxY, xyz.g);
-            Yi += std::log10(xyz.g);
-        }
+            this->image[i] /= 255.0f;
 
-        /* Convert to CIE Yyz */
-        float W = xyz.g + xyz.r + xyz.b;
-        float x = xyz.r/W;
-        float y = xyz.g/W;
-
-        /* Desaturate colours */
-        if (ds)
-        {
-            float s;
-            const float log10_Y = log10(xyz.g);
-            if (log10_Y < -2.0f)
+            /* Find average rgb value for average tone mapper */
+            if (tone_map == tone_mapping_mode_t::global_exposure)
             {
-                s = 0.0f;
+                st->rgb_sum += (this->image[i].r + this->image[i].g + this->image[i].b) * (1.0f / 3.0f);
             }
-            else if (log10_Y < 0.6f)
+
+            /* Convert to CIE xyz */
+            ext_colour_t xyz;
+            xyz.r = 683.0f * ((xb[0] * this->image[i].r) + (xb[1] * this->image[i].g) + (xb[2] * this->image[i].b));
+            xyz.g = 683.0f * ((yb[0] * this->image[i].r) + (yb[1] * this->image[i].g) + (yb[2] * this->image[i].b));
+            xyz.b = 683.0f * ((zb[0] * this->image[i].r) + (zb[1] * this->image[i].g) + (zb[2] * this->image[i].b));
+            xyz.g = std::max(xyz.g, 3.18e-7f);
+            const float log10_Y = std::log10(xyz.g);
+            if (xyz.g > 3.18e-7f)
             {
-                const float scaled_log10_y       = (log10_Y + 2.0f) / 2.6f;
-                const float sq_scaled_log10_y    = scaled_log10_y * scaled_log10_y;
-                s = (3.0f * sq_scaled_log10_y) -  (2.0f * scaled_log10_y * sq_scaled_log10_y);
+                st->count++;
+                st->max_Y = std::max(st->max_Y, xyz.g);
+                st->log_sum += log10_Y;
             }
-            else
+
+            /* Convert to CIE Yyz */
+            float W = xyz.g + xyz.r + xyz.b;
+            float x = xyz.r/W;
+            float y = xyz.g/W;
+
+            /* Desaturate colours */
+            if (ds)
             {
-                s = 1.0f;
-            }
+                float s;
+                if (log10_Y < -2.0f)
+                {
+                    s = 0.0f;
+                }
+                else if (log10_Y < 0.6f)
+                {
+                    const float scaled_log10_y       = (log10_Y + 2.0f) / 2.6f;
+                    const float sq_scaled_log10_y    = scaled_log10_y * scaled_log10_y;
+                    s = (3.0f * sq_scaled_log10_y) -  (2.0f * scaled_log10_y * sq_scaled_log10_y);
+                }
+                else
+                {
+                    s = 1.0f;
+                }
 
-            /* Scotopic luminance */
-            const float V = 1700.0f * ((vb[0] * this->image[i].r) + (vb[1] * this->image[i].g) + (vb[2] * this->image[i].b));
+                /* Scotopic luminance */
+                const float V = 1700.0f * ((vb[0] * this->image[i].r) + (vb[1] * this->image[i].g) + (vb[2] * this->image[i].b));
     
-            x     = ((1.0f - s) * xw) + (s * (x + xw - (1.0f / 3.0f)));
-            y     = ((1.0f - s) * yw) + (s * (y + yw - (1.0f / 3.0f)));
-            xyz.g = (0.4468f * (1.0f - s) * V) + (s * xyz.g);
-        }
+                x     = ((1.0f - s) * xw) + (s * (x + xw - (1.0f / 3.0f)));
+                y     = ((1.0f - s) * yw) + (s * (y + yw - (1.0f / 3.0f)));
+                xyz.g = (0.4468f * (1.0f - s) * V) + (s * xyz.g);
+            }
 
 
-        this->image[i].r = x;
-        this->image[i].g = xyz.g;
-        this->image[i].b = y;
-    }
+            this->image[i].r = x;
+            this->image[i].g = xyz.g;
+            this->image[i].b = y;
+        }, [](const luminance_stats &a, const luminance_stats &b) { return a + b; });
 
-    if (numpix)
+    float Yi     = stats.log_sum;
+    float maxY   = stats.max_Y;
+    float rgbAvg = stats.rgb_sum;
+    if (stats.count)
     {
-        Yi /= numpix;
+        Yi /= stats.count;
     }
 
-    rgbAvg /= (this->x_res * this->y_res);
+    rgbAvg /= picture_size;
     Yi = std::pow(10.0f, Yi);
+    this->stage_done("to Yxy");
 
 
     /* Correct Yi to the adaption level */
@@ -1280,11 +1653,7 @@ camera & camera::tone_map(const tone_mapping_mode_t tone_map, const float key, c
         const float num = 1.219f + std::pow(Yw * 0.5f, 0.4f);
         const float den = 1.219f + std::pow(Yi, 0.4f);
         const float sf  = (1.0f / Yw) * std::pow((num / den), 2.5f);
-
-        for (int i = 0; i < (int)(this->x_res * this->y_res); i++)
-        {
-            this->image[i].g *= sf;
-        }
+        this->scale_luminance(sf);
     }
     /* Hostogram based local tone mapping function */
     else if (tone_map == tone_mapping_mode_t::local_histogram)
@@ -1303,13 +1672,18 @@ camera & camera::tone_map(const tone_mapping_mode_t tone_map, const float key, c
         maxY *= sf;
         maxY  = 1.0f / (maxY * maxY);
 
-        for (int i = 0; i < (int)(this->x_res * this->y_res); i++)
+        ext_colour_t *const img = this->image;
+        if (maxY)
         {
-            this->image[i].g *= sf;
-            if (maxY)
-            {
-                this->image[i].g *= (1.0f + this->image[i].g * maxY) / (1.0f + this->image[i].g);
-            }
+            parallel_pixels(picture_size, [img, sf, maxY](const int i)
+                {
+                    const float g = img[i].g * sf;
+                    img[i].g = g * ((1.0f + g * maxY) / (1.0f + g));
+                });
+        }
+        else
+        {
+            this->scale_luminance(sf);
         }
     }
     /* Exposure based tone mapping */
@@ -1318,13 +1692,17 @@ camera & camera::tone_map(const tone_mapping_mode_t tone_map, const float key, c
         const float sf = key / Yi;
         maxY *= sf;
 
-        for (int i = 0; i < static_cast<int>(this->x_res * this->y_res); i++)
+        ext_colour_t *const img = this->image;
+        if (maxY)
         {
-            this->image[i].g *= sf;
-            if (maxY)
-            {
-                this->image[i].g = 1.0f - std::exp(-this->image[i].g);
-            }
+            parallel_pixels(picture_size, [img, sf](const int i)
+                {
+                    img[i].g = 1.0f - std::exp(-(img[i].g * sf));
+                });
+        }
+        else
+        {
+            this->scale_luminance(sf);
         }
     }
     /* Average luminance based tone mapping */
@@ -1336,20 +1714,13 @@ camera & camera::tone_map(const tone_mapping_mode_t tone_map, const float key, c
         {
             sf *= key * (0.5f / (rgbAvg * 683.0f));
         }
-
-        for (int i = 0; i < static_cast<int>(this->x_res * this->y_res); i++)
-        {
-            this->image[i].g *= sf;
-        }
+        this->scale_luminance(sf);
     }
     /* Maximum luminance based tone mapping */
     else if (tone_map == tone_mapping_mode_t::global_max_luminance)
     {
         const float sf = key / maxY;
-        for (int i = 0; i < static_cast<int>(this->x_res * this->y_res); i++)
-        {
-            this->image[i].g *= sf;
-        }
+        this->scale_luminance(sf);
     }
     else if (tone_map == tone_mapping_mode_t::global_bilateral_filter)
     {
@@ -1408,49 +1779,48 @@ camera & camera::tone_map(const tone_mapping_mode_t tone_map, const float key, c
             k = 0.0f;
         }
 
-        for (int i = 0; i < (int)(this->x_res * this->y_res); i++)
-        {
-            const float ldp  = mp * this->image[i].g;
-            const float lds  = ms * this->image[i].g;
-            this->image[i].g = (1.0f / lda) * (ldp + (k * lds));
-        }
+        this->scale_luminance((1.0f / lda) * (mp + (k * ms)));
     }
     /* No tone mapping */
     else
     {
         /* Remove the k conversion factor */
         const float sf = 1.0f / 683.0f;
-        for (int i = 0; i < (int)(this->x_res * this->y_res); i++)
-        {
-            this->image[i].g *= sf;
-        }
+        this->scale_luminance(sf);
     }
+    this->stage_done("tone map");
 
     /* Stretch low contrast or over compressed images */
     if (sc)
     {
         /* Find max and min luminance value */
-        float maxY2 = -MAX_DIST;
-        float minY2 =  MAX_DIST;
-        for (int i = 0; i < (int)(this->x_res * this->y_res); i++)
-        {
-            maxY2 = std::max(maxY2, this->image[i].g);
-            minY2 = std::min(minY2, this->image[i].g);
-        }
+        ext_colour_t *const img = this->image;
+        const auto range = parallel_pixel_reduce(picture_size, std::make_pair(MAX_DIST, -MAX_DIST), [img](std::pair<float, float> *const r, const int i)
+            {
+                r->first    = std::min(r->first,  img[i].g);
+                r->second   = std::max(r->second, img[i].g);
+            }, [](const std::pair<float, float> &a, const std::pair<float, float> &b)
+            {
+                return std::make_pair(std::min(a.first, b.first), std::max(a.second, b.second));
+            });
+        const float minY2 = range.first;
+        const float maxY2 = range.second;
       
         if (((minY2 > 0.0f) || (maxY2 < 0.0f)) && (minY2 < maxY2))
         {
             const float offset = std::min(-minY2, 0.0f);
             const float scale  = 1.0f / (std::min(1.0f, maxY2) - std::max(0.0f, minY2));
-            for (int i = 0; i < (int)(this->x_res * this->y_res); i++)
-            {
-                this->image[i].g = (this->image[i].g + offset) * scale;
-            }
+            parallel_pixels(picture_size, [img, offset, scale](const int i)
+                {
+                    img[i].g = (img[i].g + offset) * scale;
+                });
         }
+        this->stage_done("contrast stretch");
     }
 
     /* convert Yxy back to rgb */
     this->convert_Yxy_to_rgb();
+    this->stage_done("to rgb");
 
     /* Add glare filter */
     if (gf)
@@ -1458,6 +1828,15 @@ camera & camera::tone_map(const tone_mapping_mode_t tone_map, const float key, c
         this->perform_glare_filter(Yi, 1.0f);
     }
 
+    /* Report where the time went */
+    const float total_ms = std::chrono::duration_cast<std::chrono::microseconds>(this->post_t0 - t0).count() / 1000.0f;
+    std::ostringstream times;
+    for (const auto &t : this->post_times)
+    {
+        times << t.first << ": " << t.second << ", ";
+    }
+    BOOST_LOG_TRIVIAL(info) << "Post processing ms, " << times.str() << "total: " << total_ms;
+
     return *this;
 }
 
@@ -1465,37 +1844,37 @@ camera & camera::tone_map(const tone_mapping_mode_t tone_map, const float key, c
 // cppcheck-suppress unusedFunction
 camera & camera::gamma_correct(const float gamma)
 {
-    for (int i = 0; i < (int)(this->x_res * this->y_res); i++)
-    {
-        float r = this->image[i].r / 255.0f;
-        float g = this->image[i].g / 255.0f;
-        float b = this->image[i].b / 255.0f;
+    parallel_pixels(this->x_res * this->y_res, [this, gamma](const int i)
+        {
+            float r = this->image[i].r / 255.0f;
+            float g = this->image[i].g / 255.0f;
+            float b = this->image[i].b / 255.0f;
 
-        /* Saturate */
-        r = std::min(std::max(r, 0.0f), 1.0f);
-        g = std::min(std::max(g, 0.0f), 1.0f);
-        b = std::min(std::max(b, 0.0f), 1.0f);
+            /* Saturate */
+            r = std::min(std::max(r, 0.0f), 1.0f);
+            g = std::min(std::max(g, 0.0f), 1.0f);
+            b = std::min(std::max(b, 0.0f), 1.0f);
 
-        /* Gamma correct */
-        if (std::fabs(gamma - 2.2f) > 0.001f)
-        {
-            /* regular gamma correction */
-            r = std::pow(r, 1.0f / gamma);
-            g = std::pow(g, 1.0f / gamma);
-            b = std::pow(b, 1.0f / gamma);
-        }
-        else if (std::fabs(gamma - 1.0f) > 0.001f)
-        {
-            /* sRGB standard gamma correction (similar to regular w/2.2) */
-            r = (r <= 0.0031308f) ? (12.92f * r) : (1.055f * std::pow(r, (1.0f / 2.4f)) - 0.055f);
-            g = (g <= 0.0031308f) ? (12.92f * g) : (1.055f * std::pow(g, (1.0f / 2.4f)) - 0.055f);
-            b = (b <= 0.0031308f) ? (12.92f * b) : (1.055f * std::pow(b, (1.0f / 2.4f)) - 0.055f);
-        }
+            /* Gamma correct */
+            if (std::fabs(gamma - 2.2f) > 0.001f)
+            {
+                /* regular gamma correction */
+                r = std::pow(r, 1.0f / gamma);
+                g = std::pow(g, 1.0f / gamma);
+                b = std::pow(b, 1.0f / gamma);
+            }
+            else if (std::fabs(gamma - 1.0f) > 0.001f)
+            {
+                /* sRGB standard gamma correction (similar to regular w/2.2) */
+                r = (r <= 0.0031308f) ? (12.92f * r) : (1.055f * std::pow(r, (1.0f / 2.4f)) - 0.055f);
+                g = (g <= 0.0031308f) ? (12.92f * g) : (1.055f * std::pow(g, (1.0f / 2.4f)) - 0.055f);
+                b = (b <= 0.0031308f) ? (12.92f * b) : (1.055f * std::pow(b, (1.0f / 2.4f)) - 0.055f);
+            }
 
-        this->image[i].r = r * 255.0f;
-        this->image[i].g = g * 255.0f;
-        this->image[i].b = b * 255.0f;
-    }
+            this->image[i].r = r * 255.0f;
+            this->image[i].g = g * 255.0f;
+            this->image[i].b = b * 255.0f;
+        });
 
     return *this;
 }
@@ -1531,6 +1910,7 @@ void camera::perform_glare_filter(const float Yi, const float Yw)
     if ((*glare_filter_ptr) == nullptr)
     {
         this->generate_glare_filter(glare_filter_ptr, current_light_level);
+        this->stage_done("glare filter");
     }
     glare_filter = (*glare_filter_ptr);
 
@@ -1538,92 +1918,75 @@ void camera::perform_glare_filter(const float Yi, const float Yw)
     const int image_g_offset = picture_size;
     const int image_b_offset = picture_size << 1;
 
-    /* Allocate data for FFT */
-    float *image_in;
-    fftwf_complex *image_out;
-    fftwf_plan image_p;
-    image_in    = (float *)fftwf_malloc(picture_size * (3 * sizeof(float)));
-    image_out   = (fftwf_complex *)fftwf_malloc(picture_size * (3 * sizeof(fftwf_complex)));
-    int n[2]    = { static_cast<int>(this->y_res), static_cast<int>(this->x_res) };
-    image_p     = fftwf_plan_many_dft_r2c(2, n, 3, image_in, nullptr, 1, (this->x_res * this->y_res), image_out, nullptr, 1, (this->x_res * this->y_res), FFTW_ESTIMATE);
-    
-    float *glare_in;
-    fftwf_complex *glare_out;
-    fftwf_plan glare_p;
-    glare_in    = (float *)fftwf_malloc(picture_size * (3 * sizeof(float)));
-    glare_out   = (fftwf_complex *)fftwf_malloc(picture_size * (3 * sizeof(fftwf_complex)));
-    glare_p     = fftwf_plan_many_dft_r2c(2, n, 3, glare_in, nullptr, 1, (this->x_res * this->y_res), glare_out, nullptr, 1, (this->x_res * this->y_res), FFTW_ESTIMATE);
-     
-    fftwf_plan inv_p;
-    inv_p       = fftwf_plan_many_dft_c2r(2, n, 3, image_out, nullptr, 1, (this->x_res * this->y_res), image_in, nullptr, 1, (this->x_res * this->y_res), FFTW_ESTIMATE);
-
-    /* Split input image into channels */
-    for (int i = 0; i < picture_size; i++)
-    {
-        if ((this->image[i].r > 255.0f) || (this->image[i].g > 255.0f) || (this->image[i].b > 255.0f))
-        {
-            image_in[i                 ] = this->image[i].r;
-            image_in[i + image_g_offset] = this->image[i].g;
-            image_in[i + image_b_offset] = this->image[i].b;
-        }
-        else
-        {
-            image_in[i                 ] = 0.0f;
-            image_in[i + image_g_offset] = 0.0f;
-            image_in[i + image_b_offset] = 0.0f;
-        }
-    }
-
-    /*  Split glare image into channels and offset centre to pixel 0 0 */
-    const int gf_offset      = static_cast<int>((this->x_res >> 1) + (this->x_res * ((this->y_res - 1) >> 1)));
-    for (int i = 0; i < gf_offset; i++)
+    /* Plan once for the resolution */
+    if (this->fft == nullptr)
     {
-        glare_in[i                 ] = glare_filter[i + gf_offset].r;
-        glare_in[i + image_g_offset] = glare_filter[i + gf_offset].g;
-        glare_in[i + image_b_offset] = glare_filter[i + gf_offset].b;
+        this->fft = new fft_cache();
     }
+    this->fft->plan_glare(this->x_res, this->y_res);
+    float *const image_in = this->fft->glare_in;
 
-    for (int i = gf_offset; i < picture_size; i++)
+    /* Transform the filter the first time it is used at this light level */
+    const int spectrum_size = this->fft->glare_spectrum * 3;
+    float *&filter_re = this->fft->filter_re[static_cast<int>(current_light_level)];
+    float *&filter_im = this->fft->filter_im[static_cast<int>(current_light_level)];
+    if (filter_re == nullptr)
     {
-       glare_in[i                 ] = glare_filter[i - gf_offset].r;
-       glare_in[i + image_g_offset] = glare_filter[i - gf_offset].g;
-       glare_in[i + image_b_offset] = glare_filter[i - gf_offset].b;
+        /*  Split glare image into channels and offset centre to pixel 0 0 */
+        const int gf_offset = static_cast<int>((this->x_res >> 1) + (this->x_res * ((this->y_res - 1) >> 1)));
+        parallel_pixels(picture_size, [image_in, glare_filter, gf_offset, picture_size, image_g_offset, image_b_offset](const int i)
+            {
+                const int j = (i < gf_offset) ? (i + gf_offset) : (i - gf_offset);
+                image_in[i                 ] = glare_filter[j].r;
+                image_in[i + image_g_offset] = glare_filter[j].g;
+                image_in[i + image_b_offset] = glare_filter[j].b;
+            });
+
+        filter_re = new_spectrum(spectrum_size);
+        filter_im = new_spectrum(spectrum_size);
+        fftwf_execute_split_dft_r2c(this->fft->glare_fwd, image_in, filter_re, filter_im);
+
+        /* Fold the FFTW normalisation and conversion to 0-255 into the filter */
+        const float pixel_divisor = 1.0f / static_cast<float>(picture_size * 255);
+        parallel_pixels(spectrum_size, [filter_re, filter_im, pixel_divisor](const int i)
+            {
+                filter_re[i] *= pixel_divisor;
+                filter_im[i] *= pixel_divisor;
+            });
+        this->stage_done("glare filter fft");
     }
 
+    /* Split input image into channels, only over saturated pixels glare */
+    const ext_colour_t *const img = this->image;
+    parallel_pixels(picture_size, [image_in, img, image_g_offset, image_b_offset](const int i)
+        {
+            const bool glare = (img[i].r > 255.0f) || (img[i].g > 255.0f) || (img[i].b > 255.0f);
+            image_in[i                 ] = glare ? img[i].r : 0.0f;
+            image_in[i + image_g_offset] = glare ? img[i].g : 0.0f;
+            image_in[i + image_b_offset] = glare ? img[i].b : 0.0f;
+        });
+    this->stage_done("glare split");
+
     /* FFT */
-    fftwf_execute(glare_p);
-    fftwf_execute(image_p);
+    fftwf_execute(this->fft->glare_fwd);
+    this->stage_done("glare fft");
         
     /* Complex multiply and inverse transfrom */
-    for (int i = 0; i < (picture_size * 3); i++)
-    {
-        const float tmp = image_out[i][0];
-        image_out[i][0] = (image_out[i][0] * glare_out[i][0]) - (image_out[i][1] * glare_out[i][1]);
-        image_out[i][1] = (tmp             * glare_out[i][1]) + (image_out[i][1] * glare_out[i][0]);
-    }
-    fftwf_execute(inv_p);
+    complex_multiply(this->fft->glare_re, this->fft->glare_im, filter_re, filter_im, simd_round_up(spectrum_size));
+    this->stage_done("glare convolve");
 
+    fftwf_execute(this->fft->glare_inv);
+    this->stage_done("glare inverse fft");
 
     /* Merge the convolution and original image */
-    const float pixel_divisor = 1.0f / static_cast<float>(picture_size * 255);
-    for (int i = 0; i < picture_size; i++)
-    {
-        this->image[i].r += image_in[i]                  * pixel_divisor;
-        this->image[i].g += image_in[i + image_g_offset] * pixel_divisor;
-        this->image[i].b += image_in[i + image_b_offset] * pixel_divisor;
-    }
-
-
-    /* Clean up */
-    fftwf_destroy_plan(image_p);
-    fftwf_free(image_in);
-    fftwf_free(image_out);
-
-    fftwf_destroy_plan(glare_p);
-    fftwf_free(glare_in);
-    fftwf_free(glare_out);
-
-    fftwf_destroy_plan(inv_p);
+    ext_colour_t *const out = this->image;
+    parallel_pixels(picture_size, [out, image_in, image_g_offset, image_b_offset](const int i)
+        {
+            out[i].r += image_in[i                 ];
+            out[i].g += image_in[i + image_g_offset];
+            out[i].b += image_in[i + image_b_offset];
+        });
+    this->stage_done("glare merge");
 
     return;
 }
@@ -1632,18 +1995,23 @@ void camera::perform_glare_filter(const float Yi, const float Yw)
 void camera::bilateral_filter_tone_map(const float r_s, const float s_s, const float r_sa, const float s_sa)
 {
     /* Build log image */
-    float *log_intensity = new float [ this->x_res * this->y_res ];
-    float input_max = -MAX_DIST;
-    float input_min =  MAX_DIST;
-    for (int i = 0; i < static_cast<int>(this->x_res * this->y_res); i++)
-    {
-        if (this->image[i].g > 3.18e-7f)
+    const int picture_size = this->x_res * this->y_res;
+    float *log_intensity = new float [picture_size];
+    const ext_colour_t *const img = this->image;
+    const auto input_range = parallel_pixel_reduce(picture_size, std::make_pair(MAX_DIST, -MAX_DIST), [img, log_intensity](std::pair<float, float> *const r, const int i)
         {
-            log_intensity[i] = log10(this->image[i].g);
-            input_max = std::max(input_max, log_intensity[i]);
-            input_min = std::min(input_min, log_intensity[i]);
-        }
-    }
+            if (img[i].g > 3.18e-7f)
+            {
+                log_intensity[i] = log10(img[i].g);
+                r->first    = std::min(r->first,  log_intensity[i]);
+                r->second   = std::max(r->second, log_intensity[i]);
+            }
+        }, [](const std::pair<float, float> &a, const std::pair<float, float> &b)
+        {
+            return std::make_pair(std::min(a.first, b.first), std::max(a.second, b.second));
+        });
+    const float input_min = input_range.first;
+    const float input_max = input_range.second;
 
 
     /* Down sample */    
@@ -1654,14 +2022,22 @@ void camera::bilateral_filter_tone_map(const float r_s, const float s_s, const f
     const int padding_xy    = (int)(2.0f * sigma_s) + 1;
     const int padding_z     = (int)(2.0f * sigma_r) + 1;
 
+    /* The depth is rounded up so small changes in the range of the image dont need a new plan */
     const int small_width   = (int)((this->x_res - 1) / s_sa) + 1 + (padding_xy << 1);
     const int small_height  = (int)((this->y_res - 1) / s_sa) + 1 + (padding_xy << 1);
-    const int small_depth   = (int)(input_delta / r_sa) + 1 + (padding_z << 1);
+    const int small_depth   = ((int)(input_delta / r_sa) + 1 + (padding_z << 1) + 7) & ~7;
+
+    if (this->fft == nullptr)
+    {
+        this->fft = new fft_cache();
+    }
+    this->fft->plan_grid(small_width, small_height, small_depth, sigma_r, sigma_s);
+    this->stage_done("bilateral plan");
 
-    float *wiw = (float *)fftwf_malloc(2 * small_width * small_height * small_depth * sizeof(float));
+    float *const wiw = this->fft->grid_in;
     memset(wiw,  0, (2 * small_width * small_height * small_depth * sizeof(float)));
 
-    int iw_offset = (small_width * small_height * small_depth);
+    const int iw_offset = (small_width * small_height * small_depth);
     for(int x = 0; x < (int)this->x_res; x++)
     {
         for(int y = 0; y < (int)this->y_res; y++)
@@ -1674,71 +2050,25 @@ void camera::bilateral_filter_tone_map(const float r_s, const float s_s, const f
             wiw[small_x + (small_width * (small_y + (small_height * small_z))) + iw_offset] += log_intensity[x + (this->x_res * y)];
         }
     }
+    this->stage_done("bilateral splat");
     
     
-    /* Build kernel */
-    float *kernel = (float *)fftwf_malloc(small_width * small_height * small_depth * sizeof(float));
-
-    const int half_width  = small_width  >> 1;
-    const int half_height = small_height >> 1;
-    const int half_depth  = small_depth  >> 1;
-    for(int x = 0; x < small_width; x++)
-    {
-        const float X = x - ((x > half_width) ? small_width : 0.0f);
-
-        for(int y = 0; y < small_height; y++)
-        {
-            const float Y = y - ((y > half_height) ? small_height : 0.0f);
-
-            for(int z = 0; z < small_depth; z++)
-            {
-                const float Z = z - ((z > half_depth) ? small_depth : 0.0f);
-                const float rr = (X * X + Y * Y) / (sigma_s * sigma_s) + Z * Z / (sigma_r * sigma_r);	
-                kernel[x + (small_width * (y + (small_height * z)))] = std::exp(-rr * 0.5f);
-            }
-        }
-    }
-
-
-    /* Convolve */
-    /* Plan FFT */
-    int n[3]                = { small_width, small_height, small_depth };
-    fftwf_complex *wiw_freq = (fftwf_complex *)fftwf_malloc(2 * small_width * small_height * small_depth * sizeof(fftwf_complex));
-    fftwf_plan     fwd_p    = fftwf_plan_many_dft_r2c(3, n, 2, wiw,      nullptr, 1, (small_width * small_height * small_depth), wiw_freq, nullptr, 1, (small_width * small_height * small_depth), FFTW_ESTIMATE);
-    fftwf_plan     inv_p    = fftwf_plan_many_dft_c2r(3, n, 2, wiw_freq, nullptr, 1, (small_width * small_height * small_depth), wiw,      nullptr, 1, (small_width * small_height * small_depth), FFTW_ESTIMATE);
-
-
-    fftwf_complex *k_freq   = (fftwf_complex *)fftwf_malloc(small_width * small_height * small_depth * sizeof(fftwf_complex));
-    fftwf_plan     k_plan   = fftwf_plan_dft_r2c_3d(small_width, small_height, small_depth, kernel, k_freq, FFTW_ESTIMATE);
-
-    /* FFT kernel */
-    fftwf_execute(k_plan);
-    
-    /* Convolve i and iw */
-    fftwf_execute(fwd_p);
-    const float s = 1.0f / (small_width * small_height * small_depth);
-    for(int i = 0; i < (small_width * small_height * small_depth); i++)
-    {
-        float tmp = wiw_freq[i][0];
-        wiw_freq[i][0] = ((k_freq[i][0] * tmp           ) - (k_freq[i][1] * wiw_freq[i][1])) * s;
-        wiw_freq[i][1] = ((k_freq[i][0] * wiw_freq[i][1]) + (k_freq[i][1] * tmp           )) * s;
-
-        tmp = wiw_freq[i + iw_offset][0];
-        wiw_freq[i + iw_offset][0] = ((k_freq[i][0] * tmp                       ) - (k_freq[i][1] * wiw_freq[i + iw_offset][1])) * s;
-        wiw_freq[i + iw_offset][1] = ((k_freq[i][0] * wiw_freq[i + iw_offset][1]) + (k_freq[i][1] * tmp                       )) * s;
-    }
-    fftwf_execute(inv_p);
+    /* Convolve i and iw with the kernel, the kernel is already transformed and normalised */
+    fftwf_execute(this->fft->grid_fwd);
+    const int spectrum_size = this->fft->grid_spectrum;
+    complex_multiply(this->fft->grid_re, this->fft->grid_im, this->fft->kernel_re, this->fft->kernel_im, spectrum_size);
+    complex_multiply(&this->fft->grid_re[spectrum_size], &this->fft->grid_im[spectrum_size], this->fft->kernel_re, this->fft->kernel_im, spectrum_size);
+    fftwf_execute(this->fft->grid_inv);
+    this->stage_done("bilateral convolve");
 
 
     /* Apply non-linearities */
-    float *result = new float [this->x_res * this->y_res];
-    float max_value = -MAX_DIST;
-    float min_value =  MAX_DIST;
-    for(int x = 0; x < (int)this->x_res; x++)
-    {
-        for(int y = 0; y < (int)this->y_res; y++)
+    float *result = new float [picture_size];
+    const auto result_range = parallel_pixel_reduce(picture_size, std::make_pair(MAX_DIST, -MAX_DIST), [&](std::pair<float, float> *const r, const int i)
         {
-            const float z = log_intensity[x + (this->x_res * y)] - input_min;
+            const int x = i % this->x_res;
+            const int y = i / this->x_res;
+            const float z = log_intensity[i] - input_min;
 
             const float x_addr   = static_cast<float>(x) / s_sa + padding_xy;
             const int x_index   = std::max(0, std::min(static_cast<int>(x_addr),    small_width - 1));
@@ -1777,36 +2107,33 @@ void camera::bilateral_filter_tone_map(const float r_s, const float s_s, const f
                 (1.0f - x_alpha) * y_alpha          * z_alpha          * wiw[x_index  + (small_width * (yy_index + (small_height * zz_index)))] +
                 x_alpha          * y_alpha          * z_alpha          * wiw[xx_index + (small_width * (yy_index + (small_height * zz_index)))];
 
-            result[x + (this->x_res * y)] = IW / W;
-            max_value = std::max(max_value, result[x + (this->x_res * y)]);
-            min_value = std::min(min_value, result[x + (this->x_res * y)]);
-        }
-    }
+            result[i] = IW / W;
+            r->first    = std::min(r->first,  result[i]);
+            r->second   = std::max(r->second, result[i]);
+        }, [](const std::pair<float, float> &a, const std::pair<float, float> &b)
+        {
+            return std::make_pair(std::min(a.first, b.first), std::max(a.second, b.second));
+        });
+    const float min_value = result_range.first;
+    const float max_value = result_range.second;
 
 
     /* Scale the image */
     const float contrast = 300.0f;
     const float gamma = std::log10(contrast) /  (max_value - min_value);
-    for(int i = 0; i < (int)(this->x_res * this->y_res); i++)
-    {
-        const float scaled_value = std::pow(10.0f, (result[i] * gamma + (log_intensity[i] - result[i])));
-        this->image[i].g = scaled_value * (1.0f / 255.0f);
-    }
+    ext_colour_t *const out = this->image;
+    parallel_pixels(picture_size, [out, result, log_intensity, gamma](const int i)
+        {
+            const float scaled_value = std::pow(10.0f, (result[i] * gamma + (log_intensity[i] - result[i])));
+            out[i].g = scaled_value * (1.0f / 255.0f);
+        });
+    this->stage_done("bilateral slice");
     
     
     /* Clean up */
     delete [] log_intensity;
     delete [] result;
 
-    fftwf_free(wiw);
-    fftwf_free(wiw_freq);
-    fftwf_free(kernel);
-    fftwf_free(k_freq);
-
-    fftwf_destroy_plan(fwd_p);
-    fftwf_destroy_plan(inv_p);
-    fftwf_destroy_plan(k_plan);
-
     return;
 }
 
@@ -1926,10 +2253,11 @@ void camera::histogram_tone_map(const bool h)
     {
         std::cout << "using linear scale factor" << std::endl;
         const float sf = (bd_max - bd_min) / (bw_max - bw_min);
-        for (int i = 0; i < (int)(this->x_res * this->y_res); i++)
-        {
-            this->image[i].g = this->image[i].g * sf + bd_min;
-        }
+        ext_colour_t *const img = this->image;
+        parallel_pixels(this->x_res * this->y_res, [img, sf, bd_min](const int i)
+            {
+                img[i].g = img[i].g * sf + bd_min;
+            });
 
         delete [] scaled_luminance;
         return;
@@ -1984,11 +2312,7 @@ void camera::histogram_tone_map(const bool h)
             const float den = 1.219f + std::pow(lw_avg , 0.4f);
 
             const float sf  = (1.0f / ld_max) * std::pow((num / den), 2.5f);
-
-            for (int i = 0; i < (int)(this->x_res * this->y_res); i++)
-            {
-                this->image[i].g *= sf;
-            }
+            this->scale_luminance(sf);
 
             delete [] scaled_luminance;
             return;
@@ -2036,25 +2360,28 @@ void camera::histogram_tone_map(const bool h)
     } while (trimmings > tolerance);
 
 
+    this->stage_done("histogram");
+
     /* Tone map the original image */
-    for (int i = 0; i < (int)(this->x_res * this->y_res); i++)
-    {
-        if (this->image[i].g > 0.0f)
+    ext_colour_t *const img = this->image;
+    parallel_pixels(this->x_res * this->y_res, [&](const int i)
         {
-            const float bw = std::log(this->image[i].g);
-
-            float bf = (bw - bw_min) / (bw_max - bw_min) * bins;
-            bf = std::min(std::max(bf, 0.0f), static_cast<float>(bins));
-            const int b0 = (int)bf;
-            const int b1 = std::min((b0 + 1), bins);
-            const float s = bf - b0;
-            const float pbw = (1 - s) * cdf[b0] + s * cdf[b1];
-    
-            const float bde = bd_min + (bd_max - bd_min) * pbw;
-            this->image[i].g = std::exp(bde);
-            this->image[i].g /= ld_max;
-        }
-    }
+            if (img[i].g > 0.0f)
+            {
+                const float bw = std::log(img[i].g);
+
+                float bf = (bw - bw_min) / (bw_max - bw_min) * bins;
+                bf = std::min(std::max(bf, 0.0f), static_cast<float>(bins));
+                const int b0 = (int)bf;
+                const int b1 = std::min((b0 + 1), bins);
+                const float s = bf - b0;
+                const float pbw = (1 - s) * cdf[b0] + s * cdf[b1];
+        
+                const float bde = bd_min + (bd_max - bd_min) * pbw;
+                img[i].g = std::exp(bde);
+                img[i].g /= ld_max;
+            }
+        });
 
     delete [] scaled_luminance;
     return;
@@ -2063,15 +2390,15 @@ void camera::histogram_tone_map(const bool h)
 
 void camera::convert_xyz_to_rgb(ext_colour_t *const p, const int x, const int y) const
 {
-    for (int i = 0; i < (int)(x * y); i++)
-    {
-        const ext_colour_t xyz = p[i];
+    parallel_pixels(x * y, [p](const int i)
+        {
+            const ext_colour_t xyz = p[i];
 
-        /* Conversion matrix assumes Y is in the range 0-1.0 and scales up by 255 */
-        p[i].r = ( 826.353f  * xyz.r) + (-391.986f * xyz.g) + (-127.143f  * xyz.b);
-        p[i].g = (-247.0695f * xyz.r) + ( 478.329f * xyz.g) + (  10.5825f * xyz.b);
-        p[i].b = ( 14.2035f  * xyz.r) + ( -52.02f  * xyz.g) + ( 269.535f  * xyz.b);
-    }
+            /* Conversion matrix assumes Y is in the range 0-1.0 and scales up by 255 */
+            p[i].r = ( 826.353f  * xyz.r) + (-391.986f * xyz.g) + (-127.143f  * xyz.b);
+            p[i].g = (-247.0695f * xyz.r) + ( 478.329f * xyz.g) + (  10.5825f * xyz.b);
+            p[i].b = ( 14.2035f  * xyz.r) + ( -52.02f  * xyz.g) + ( 269.535f  * xyz.b);
+        });
 
     return;
 }
@@ -2079,21 +2406,22 @@ void camera::convert_xyz_to_rgb(ext_colour_t *const p, const int x, const int y)
 
 void camera::convert_Yxy_to_rgb()
 {
-    for (int i = 0; i < (int)(this->x_res * this->y_res); i++)
-    {
-        ext_colour_t yxy = this->image[i];
+    ext_colour_t *const img = this->image;
+    parallel_pixels(this->x_res * this->y_res, [img](const int i)
+        {
+            ext_colour_t yxy = img[i];
 
-        /* Convert to CIE xyz */
-        const float x = yxy.r;
-        const float y = yxy.b;
-        yxy.r = x * yxy.g / y;
-        yxy.b = (1.0f - x - y) * yxy.g / y;
+            /* Convert to CIE xyz */
+            const float x = yxy.r;
+            const float y = yxy.b;
+            yxy.r = x * yxy.g / y;
+            yxy.b = (1.0f - x - y) * yxy.g / y;
 
-        /* Conversion matrix assumes Y is in the range 0-1.0 and scales up by 255 */
-        this->image[i].r = ( 826.353f  * yxy.r) + (-391.986f * yxy.g) + (-127.143f  * yxy.b);
-        this->image[i].g = (-247.0695f * yxy.r) + ( 478.329f * yxy.g) + (  10.5825f * yxy.b);
-        this->image[i].b = ( 14.2035f  * yxy.r) + ( -52.02f  * yxy.g) + ( 269.535f  * yxy.b);
-    }
+            /* Conversion matrix assumes Y is in the range 0-1.0 and scales up by 255 */
+            img[i].r = ( 826.353f  * yxy.r) + (-391.986f * yxy.g) + (-127.143f  * yxy.b);
+            img[i].g = (-247.0695f * yxy.r) + ( 478.329f * yxy.g) + (  10.5825f * yxy.b);
+            img[i].b = ( 14.2035f  * yxy.r) + ( -52.02f  * yxy.g) + ( 269.535f  * yxy.b);
+        });
 
     return;
 }
@@ -2224,6 +2552,109 @@ const camera & camera::write_png_file(const std::string &file_name) const
 }
 
 
+#ifdef TRAVERSAL_STATISTICS
+camera & camera::clear_traversal_statistics()
+{
+    this->traversal_heat.assign(this->x_res * this->y_res * traversal_statistics::number_of_counters, 0.0f);
+    return *this;
+}
+
+
+camera & camera::add_traversal_statistics(const traversal_statistics &s, const int x0, const int y0, const int x1, const int y1)
+{
+    /* Clip to the image, packets and blocks may hang off the edge */
+    const int x_end = std::min(x1, static_cast<int>(this->x_res));
+    const int y_end = std::min(y1, static_cast<int>(this->y_res));
+    if ((x_end <= x0) || (y_end <= y0) || this->traversal_heat.empty())
+    {
+        return *this;
+    }
+
+    /* Share the work between the pixels, each is only added to by the thread tracing it */
+    const float pixels_inv = 1.0f / static_cast<float>((x_end - x0) * (y_end - y0));
+    for (int y = y0; y < y_end; ++y)
+    {
+        for (int x = x0; x < x_end; ++x)
+        {
+            float *const heat = &this->traversal_heat[(x + (y * this->x_res)) * traversal_statistics::number_of_counters];
+            for (int i = 0; i < traversal_statistics::number_of_counters; ++i)
+            {
+                heat[i] += static_cast<float>(s.counts[i]) * pixels_inv;
+            }
+        }
+    }
+
+    return *this;
+}
+
+
+/* Colour ramp from black through red and yellow to white */
+inline void heat_to_rgb(unsigned char *const c, const float h)
+{
+    c[0] = static_cast<unsigned char>(std::min(255.0f, std::max(0.0f, h * 3.0f * 255.0f)));
+    c[1] = static_cast<unsigned char>(std::min(255.0f, std::max(0.0f, ((h * 3.0f) - 1.0f) * 255.0f)));
+    c[2] = static_cast<unsigned char>(std::min(255.0f, std::max(0.0f, ((h * 3.0f) - 2.0f) * 255.0f)));
+}
+
+
+const camera & camera::write_traversal_heatmaps(const std::string &file_name) const
+{
+    if (this->traversal_heat.empty())
+    {
+        return *this;
+    }
+
+    /* Totals for the whole image */
+    const int nr_pixels = this->x_res * this->y_res;
+    double totals[traversal_statistics::number_of_counters] = {};
+    for (int i = 0; i < nr_pixels; ++i)
+    {
+        for (int j = 0; j < traversal_statistics::number_of_counters; ++j)
+        {
+            totals[j] += this->traversal_heat[(i * traversal_statistics::number_of_counters) + j];
+        }
+    }
+
+    std::stringstream counts;
+    for (int i = 0; i < traversal_statistics::number_of_counters; ++i)
+    {
+        counts << traversal_counter_names[i] << ": " << static_cast<std::uint64_t>(totals[i]) << ", ";
+    }
+    BOOST_LOG_TRIVIAL(info) << "Traversal statistics, " << counts.str() << "per pixel nodes: " << (totals[traversal_statistics::nodes_visited] / nr_pixels);
+
+    /* Heatmap of each counter, normalised to the hottest pixel */
+    std::vector<unsigned char> png_data(nr_pixels * 3);
+    for (int i = 0; i < traversal_statistics::number_of_counters; ++i)
+    {
+        float max_heat = 0.0f;
+        for (int j = 0; j < nr_pixels; ++j)
+        {
+            max_heat = std::max(max_heat, this->traversal_heat[(j * traversal_statistics::number_of_counters) + i]);
+        }
+
+        const float max_heat_inv = (max_heat > 0.0f) ? (1.0f / max_heat) : 0.0f;
+        for (int j = 0; j < nr_pixels; ++j)
+        {
+            heat_to_rgb(&png_data[j * 3], this->traversal_heat[(j * traversal_statistics::number_of_counters) + i] * max_heat_inv);
+        }
+
+        raptor_raytracer::write_png_file(file_name + "_" + traversal_counter_names[i] + ".png", png_data.data(), this->x_res, this->y_res);
+    }
+
+    /* Fraction of the lanes of traced packets that were doing useful work */
+    for (int j = 0; j < nr_pixels; ++j)
+    {
+        const float *const heat = &this->traversal_heat[j * traversal_statistics::number_of_counters];
+        const float packet_lanes = heat[traversal_statistics::packet_lanes];
+        heat_to_rgb(&png_data[j * 3], (packet_lanes > 0.0f) ? (heat[traversal_statistics::active_lanes] / packet_lanes) : 0.0f);
+    }
+    raptor_raytracer::write_png_file(file_name + "_lane_utilisation.png", png_data.data(), this->x_res, this->y_res);
+
+    return *this;
+}
+#endif /* #ifdef TRAVERSAL_STATISTICS */
+
+
 void read_png_file(const std::string &file_name, unsigned char *png_data, unsigned int *const x, unsigned int *const y)
 {
     /* Open output file */
@@ -1,5 +1,11 @@
 #pragma once
 
+/* Standard headers */
+#include <chrono>
+#include <string>
+#include <utility>
+#include <vector>
+
 /* Boost headers */
 #include "boost/archive/text_oarchive.hpp"
 #include "boost/archive/text_iarchive.hpp"
@@ -13,6 +19,7 @@
 #include "ext_colour_t.h"
 #include "texture_mapper.h"
 #include "ray.h"
+#include "traversal_statistics.h"
 
 #ifdef SIMD_PACKET_TRACING
 #include "packet_ray.h"
@@ -55,56 +62,49 @@ class camera : public base_camera
         camera(const point_t<> &c, const point_t<> &x, const point_t<> &y, const point_t<> &z, const ext_colour_t &b, const float w, 
                const float h, const float t, const unsigned x_res, const unsigned y_res, const unsigned x_a_res, const unsigned y_a_res,
                const float aperture, const float focal_length) :
-                base_camera(c, x, y, z, 1.0f), tm(nullptr), sampler(point_t<>(0.0f, 0.0f, 1.0f), point_t<>(0.0f, 1.0f, 0.0f)),
-                image(new ext_colour_t [ (x_res * x_a_res) * (y_res * y_a_res) ]), scotopic_glare_filter(nullptr), mesopic_glare_filter(nullptr), photopic_glare_filter(nullptr), temporal_glare_filter(nullptr),
+                base_camera(c, x, y, z, 1.0f), tm(nullptr),
+                image(new ext_colour_t [ (x_res * x_a_res) * (y_res * y_a_res) ]), scotopic_glare_filter(nullptr), mesopic_glare_filter(nullptr), photopic_glare_filter(nullptr), temporal_glare_filter(nullptr), fft(nullptr),
                 u(point_t<>(0.0f, 0.0f, 0.0f)), l(point_t<>(0.0f, 0.0f, 0.0f)), b(b), x_m(-w), y_m(-h), x_inc((w * 2.0f)/static_cast<float>(x_res * x_a_res)), y_inc((h * 2.0f)/static_cast<float>(y_res * y_a_res)), 
                 t(t), x_res(x_res * x_a_res), y_res(y_res * y_a_res), out_x_res(x_res), out_y_res(y_res), r_vec(point_t<>(0.0f, 0.0f, 0.0f)), r_angle(0.0f),
-                r_pivot(point_t<>(0.0f, 0.0f, 0.0f)), time_step(0.0f), adatption_level(0.0f), aperture(aperture), focal_length(focal_length) { };
+                r_pivot(point_t<>(0.0f, 0.0f, 0.0f)), time_step(0.0f), adatption_level(0.0f), aperture(aperture), focal_length(focal_length),
+                adaptive_x(1), adaptive_y(1), adaptive_contrast(0.0f) { };
 
         camera(const std::vector<texture_mapper *>  *const tm, const point_t<> &u, const point_t<> &l, const point_t<> &c, 
                const point_t<> &x, const point_t<> &y, const point_t<> &z, const ext_colour_t &b, const float w, 
                const float h, const float t, const unsigned x_res, const unsigned y_res, 
                const point_t<> &r_vec = point_t<>(0.0f, 0.0f, 0.0f), const float r_angle = 0.0f, const point_t<> &r_pivot = point_t<>(0.0f, 0.0f, 0.0f),
                const unsigned x_a_res = 1, const unsigned y_a_res = 1, const float speed = 1.0f, const float time_step = 0.0f) :
-            base_camera(c, x, y, z, speed), tm(tm), sampler(point_t<>(0.0f, 0.0f, 1.0f), point_t<>(0.0f, 1.0f, 0.0f)), 
-            image(new ext_colour_t [ (x_res * x_a_res) * (y_res * y_a_res) ]), scotopic_glare_filter(nullptr), mesopic_glare_filter(nullptr), photopic_glare_filter(nullptr), temporal_glare_filter(nullptr),
+            base_camera(c, x, y, z, speed), tm(tm), 
+            image(new ext_colour_t [ (x_res * x_a_res) * (y_res * y_a_res) ]), scotopic_glare_filter(nullptr), mesopic_glare_filter(nullptr), photopic_glare_filter(nullptr), temporal_glare_filter(nullptr), fft(nullptr),
             u(u), l(l), b(b), x_m(-w), y_m(-h), x_inc((w * 2.0f)/static_cast<float>(x_res * x_a_res)), y_inc((h * 2.0f)/static_cast<float>(y_res * y_a_res)), 
             t(t), x_res(x_res * x_a_res), y_res(y_res * y_a_res), out_x_res(x_res), out_y_res(y_res), r_vec(r_vec), r_angle(r_angle),
-            r_pivot(r_pivot), time_step(time_step), adatption_level(0.0)
+            r_pivot(r_pivot), time_step(time_step), adatption_level(0.0), adaptive_x(1), adaptive_y(1), adaptive_contrast(0.0f)
         {  };
 
-        ~camera()
-        {
-            /* Delete the image data */
-            delete [] this->image;
-            
-            /* Delete any glare filter images */            
-            if (this->scotopic_glare_filter != nullptr)
-            {
-                delete [] this->scotopic_glare_filter;
-            }
-            
-            if (this->mesopic_glare_filter != nullptr)
-            {
-                delete [] this->mesopic_glare_filter;
-            }
-            
-            if (this->photopic_glare_filter != nullptr)
-            {
-                delete [] this->photopic_glare_filter;
-            }
-            
-            if (this->temporal_glare_filter != nullptr)
-            {
-                delete [] this->temporal_glare_filter;
-            }
-        };
+        ~camera();
         
         /* Access function */
         unsigned x_resolution()     const   { return this->out_x_res;   }
         unsigned y_resolution()     const   { return this->out_y_res;   }
         unsigned x_number_of_rays() const   { return this->x_res;       }
         unsigned y_number_of_rays() const   { return this->y_res;       }
+
+        /* Approximate angle between the rays through neighbouring pixels */
+        float pixel_spread() const { return std::min(this->x_inc, this->y_inc) / this->t; }
+
+        /* Adaptive anti-aliasing, pixels that contrast with their neighbours are refined to x by y samples */
+        /* The image is kept at the output resolution, so x and y should be used instead of a fixed anti-aliasing factor */
+        camera& adaptive_anti_alias(const unsigned x, const unsigned y, const float contrast)
+        {
+            this->adaptive_x        = std::max(1u, x);
+            this->adaptive_y        = std::max(1u, y);
+            this->adaptive_contrast = contrast;
+            return *this;
+        }
+
+        bool     adaptive()             const   { return (this->adaptive_x * this->adaptive_y) > 1; }
+        unsigned x_adaptive_samples()   const   { return this->adaptive_x;  }
+        unsigned y_adaptive_samples()   const   { return this->adaptive_y;  }
         
         /* Time control */
         camera& advance_time(const float t)
@@ -113,13 +113,13 @@ class camera : public base_camera
             return *this;
         }
         
-        /* Pixel to co-ordinate conversion */
+        /* Pixel to co-ordinate conversion, a_x and a_y pick the sub pixel sample for adaptive anti-aliasing */
         point_t<> pixel_to_co_ordinate(const int x, const int y, const int a_x = 0, const int a_y = 0) const
         {
             /* The camera can be anywhere so these co-ordinates are relative to it */
             /* Calaculate the direction that would pass through x,y */
-            const float x_t = (static_cast<float>(x) * x_inc) + x_m;
-            const float y_t = (static_cast<float>(y) * y_inc) + y_m;
+            const float x_t = ((static_cast<float>(x) + (static_cast<float>(a_x) / adaptive_x)) * x_inc) + x_m;
+            const float y_t = ((static_cast<float>(y) + (static_cast<float>(a_y) / adaptive_y)) * y_inc) + y_m;
             
             return (x_axis() * x_t) + (y_axis() * y_t) + (z_axis() * this->t);
         }
@@ -127,8 +127,8 @@ class camera : public base_camera
         int pixel_to_co_ordinate(std::vector<ray> *const rays, const int x, const int y, const int a_x = 0, const int a_y = 0, const int samples = 0)
         {
             /* Find the way the center ray would go */
-            const float x_t = (static_cast<float>(x) * x_inc) + x_m;
-            const float y_t = (static_cast<float>(y) * y_inc) + y_m;
+            const float x_t = ((static_cast<float>(x) + (static_cast<float>(a_x) / adaptive_x)) * x_inc) + x_m;
+            const float y_t = ((static_cast<float>(y) + (static_cast<float>(a_y) / adaptive_y)) * y_inc) + y_m;
             
             /* Work out where the rays should focus, if we dont need depth of focus send it back */
             const point_t<> screen((x_axis() * x_t) + (y_axis() * y_t) + (z_axis() * this->t));
@@ -145,7 +145,9 @@ class camera : public base_camera
             // rays->resize(sampler.samples());
             // for (int i = 0; i < sampler.samples(); ++i)
             rays->resize(samples);
-            sampler.reset(dir, y_axis() * aperture);
+
+            /* The sampler is local so each thread samples from its own stream */
+            circle_sampler_random sampler(dir, y_axis() * aperture);
             for (int i = 0; i < samples; ++i)
             {
                 const point_t<> o(camera_position() + sampler.sample());
@@ -186,11 +188,11 @@ class camera : public base_camera
         void pixel_to_co_ordinate(packet_ray *const r, const int x, const int y) const
         {
             /* Assert packet is square */
-            assert(std::fmod(std::sqrt(static_cast<float>(MAXIMUM_PACKET_SIZE)), 1.0f) == 0.0f);
+            assert(std::fmod(std::sqrt(static_cast<float>(MAXIMUM_PACKET_SIZE * SIMD_WIDTH)), 1.0f) == 0.0f);
 
             /* Assert the packet is MAXIMUM_PACKET_SIZE aligned */
-            assert((x & (((unsigned int)std::sqrt(MAXIMUM_PACKET_SIZE) << 1) - 1)) == 0);
-            assert((y & (((unsigned int)std::sqrt(MAXIMUM_PACKET_SIZE) << 1) - 1)) == 0);
+            assert((x & (PACKET_WIDTH - 1)) == 0);
+            assert((y & (PACKET_WIDTH - 1)) == 0);
 
             /* Create the packet data */
             for (unsigned int i = 0; i < MAXIMUM_PACKET_SIZE; i++)
@@ -200,8 +202,8 @@ class camera : public base_camera
                 const int ty = y + packet_ray_to_co_ordinate_lut.y_offset(i);
                 
                 /* Calculate the rays direction */
-                vfp_t vx(tx, (tx + 1.0f), tx,         (tx + 1.0f));
-                vfp_t vy(ty,  ty,        (ty + 1.0f), (ty + 1.0f));
+                vfp_t vx(vfp_t(static_cast<float>(tx)) + packet_ray_to_co_ordinate_lut.x_lane_offset());
+                vfp_t vy(vfp_t(static_cast<float>(ty)) + packet_ray_to_co_ordinate_lut.y_lane_offset());
 
                 vfp_t vx_t((vx * vfp_t(x_inc)) + vfp_t(this->x_m));
                 vfp_t vy_t((vy * vfp_t(y_inc)) + vfp_t(this->y_m));
@@ -284,6 +286,33 @@ class camera : public base_camera
             return *this;
         }
 
+        const ext_colour_t & get_pixel(const int x, const int y) const
+        {
+            return this->image[x + (y * this->x_res)];
+        }
+
+        /* Check if a pixel contrasts with any of its 4 neighbours enough to need adaptive anti-aliasing */
+        bool needs_refinement(const int x, const int y) const
+        {
+            const ext_colour_t &p = get_pixel(x, y);
+            const auto contrasts = [this, &p](const int n_x, const int n_y)
+            {
+                if ((n_x < 0) || (n_y < 0) || (n_x >= static_cast<int>(this->x_res)) || (n_y >= static_cast<int>(this->y_res)))
+                {
+                    return false;
+                }
+
+                /* Contrast of each channel is the difference over the sum, so dark areas are refined as much as light */
+                const ext_colour_t &n = get_pixel(n_x, n_y);
+                const float t = this->adaptive_contrast;
+                return (std::fabs(p.r - n.r) > (t * (p.r + n.r + 1.0f))) ||
+                       (std::fabs(p.g - n.g) > (t * (p.g + n.g + 1.0f))) ||
+                       (std::fabs(p.b - n.b) > (t * (p.b + n.b + 1.0f)));
+            };
+
+            return contrasts(x - 1, y) || contrasts(x + 1, y) || contrasts(x, y - 1) || contrasts(x, y + 1);
+        }
+
         /* Image output function */
         /* Downsample and set output clipped to rgb */
         void clip_image_to_rgb(unsigned char * c) const
@@ -380,9 +409,26 @@ class camera : public base_camera
         /* Gamma correction of the image */
         camera & gamma_correct(const float gamma);
 
+        /* Milliseconds taken by each stage of the last tone_map */
+        const std::vector<std::pair<std::string, float>> & post_processing_times() const { return this->post_times; }
+
+#ifdef TRAVERSAL_STATISTICS
+        /* Zero the work done tracing each pixel */
+        camera & clear_traversal_statistics();
+
+        /* Spread the work s done tracing the pixels from (x0, y0) up to, but not including, (x1, y1) evenly over them */
+        camera & add_traversal_statistics(const traversal_statistics &s, const int x0, const int y0, const int x1, const int y1);
+
+        /* Write a heatmap of each counter to file_name_<counter>.png */
+        const camera & write_traversal_heatmaps(const std::string &file_name) const;
+#endif /* #ifdef TRAVERSAL_STATISTICS */
+
     private :
         friend class boost::serialization::access;
 
+        /* FFTW plans and buffers kept between frames */
+        struct fft_cache;
+
         template<class Archive> friend void boost::serialization::save_construct_data(Archive & ar, const camera *cam, const unsigned int file_version);
         template<class Archive> friend void boost::serialization::load_construct_data(Archive & ar, camera *cam, const unsigned int file_version);
 
@@ -410,11 +456,11 @@ class camera : public base_camera
             const unsigned x_res, const unsigned y_res, const unsigned out_x_res, const unsigned out_y_res, 
             const point_t<> &r_vec, const float r_angle, const point_t<> &r_pivot) : 
             base_camera(point_t<>(0.0f, 0.0f, 0.0f), point_t<>(0.0f, 0.0f, 0.0f), point_t<>(0.0f, 0.0f, 0.0f), point_t<>(0.0f, 0.0f, 0.0f), 1.0f),
-            tm(tm), sampler(point_t<>(1.0f, 0.0f, 0.0f), y_axis() * aperture), image(new ext_colour_t[x_res * y_res]),
+            tm(tm), image(new ext_colour_t[x_res * y_res]),
             scotopic_glare_filter(nullptr), mesopic_glare_filter(nullptr), photopic_glare_filter(nullptr), 
-            temporal_glare_filter(nullptr), u(u), l(l), b(b), x_m(x_m), y_m(y_m), x_inc(x_inc), y_inc(y_inc), 
+            temporal_glare_filter(nullptr), fft(nullptr), u(u), l(l), b(b), x_m(x_m), y_m(y_m), x_inc(x_inc), y_inc(y_inc), 
             t(t), x_res(x_res), y_res(y_res), out_x_res(out_x_res), out_y_res(out_y_res), r_vec(r_vec), 
-            r_angle(r_angle), r_pivot(r_pivot)
+            r_angle(r_angle), r_pivot(r_pivot), adaptive_x(1), adaptive_y(1), adaptive_contrast(0.0f)
         {  };
 
         unsigned int sky_box_intersection(const ray &r, point_t<> *p) const
@@ -522,17 +568,28 @@ class camera : public base_camera
         float just_noticable_difference(const float La) const;
         void histogram_tone_map(const bool human);
         
+        /* Record the time since the last stage finished against stage s */
+        void stage_done(const char *const s);
+
+        /* Multiply the luminance of each pixel of the Yxy image by sf */
+        void scale_luminance(const float sf);
+
         /* Colour space conversion */
         void convert_Yxy_to_rgb();
         void convert_xyz_to_rgb(ext_colour_t *const p, const int x, const int y) const;
 
         const std::vector<texture_mapper *>  * const    tm;                         /* Texture mapper for each face of the sky box                      */
-        circle_sampler_random                           sampler;                    /* Sampler for depth of focus                                       */
         ext_colour_t                    *               image;                      /* The rendered image                                               */
         ext_colour_t                    *               scotopic_glare_filter;      /* Array of colours for glare filter images in scotopic lighting    */
         ext_colour_t                    *               mesopic_glare_filter;       /* Array of colours for glare filter images in mesopic lighting     */
         ext_colour_t                    *               photopic_glare_filter;      /* Array of colours for glare filter images in photopic lighting    */
         ext_colour_t                    *               temporal_glare_filter;      /* Array of colours for temporal glare filter images                */
+        fft_cache                       *               fft;                        /* FFT plans and transformed filters, built on first use            */
+        std::vector<std::pair<std::string, float>>      post_times;                 /* Milliseconds taken by each stage of the last tone_map            */
+        std::chrono::system_clock::time_point           post_t0;                    /* When the last post processing stage finished                     */
+#ifdef TRAVERSAL_STATISTICS
+        std::vector<float>                              traversal_heat;             /* Work done tracing each pixel, number_of_counters per pixel       */
+#endif /* #ifdef TRAVERSAL_STATISTICS */
         const point_t<>                                 u;                          /* Upper bounds of the sky box                                      */
         const point_t<>                                 l;                          /* Lower bounds of the sky box                                      */
         const ext_colour_t                              b;                          /* Background colour                                                */
@@ -552,6 +609,9 @@ class camera : public base_camera
         float                                           adatption_level;            /* Current light level that has been adapted to                     */
         float                                           aperture;                   /* The radius of the aperture                                       */
         float                                           focal_length;               /* The focal length                                                 */
+        unsigned                                        adaptive_x;                 /* X samples of pixels refined by adaptive anti-aliasing            */
+        unsigned                                        adaptive_y;                 /* Y samples of pixels refined by adaptive anti-aliasing            */
+        float                                           adaptive_contrast;          /* Contrast with a neighbour above which a pixel is refined         */
 };
 }; /* namespace raptor_raytracer */
 
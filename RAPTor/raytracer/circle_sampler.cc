@@ -1,6 +0,0 @@
-#include "circle_sampler.h"
-
-namespace raptor_raytracer
-{
-std::minstd_rand0 circle_sampler::_rand;
-}; /* namespace raptor_raytracer  */
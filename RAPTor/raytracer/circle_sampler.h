@@ -11,15 +11,18 @@
 #include "point_t.h"
 
 /* Ray tracer headers */
+#include "random_stream.h"
 #include "sobol_numbers_2d.h"
 
 
 namespace raptor_raytracer
 {
+/* Samplers draw from the random stream of the thread that built them so they should be built where they are used */
 class circle_sampler : private boost::noncopyable
 {
     public:
-        circle_sampler(const point_t<> &n, const point_t<> &r, const float s, const float a) : _rdist(0.0f, s), _tdist(0.0f, a), _n(othogonalise(n, normalise(r))), _r(r) {  }
+        circle_sampler(const point_t<> &n, const point_t<> &r, const float s, const float a) :
+            _rand(random_stream::thread_stream()), _rdist(0.0f, s), _tdist(0.0f, a), _n(othogonalise(n, normalise(r))), _r(r) {  }
 
         /* Take a completely random sample over the circle */
         point_t<> sample(const float r, const float t)
@@ -35,10 +38,10 @@ class circle_sampler : private boost::noncopyable
             _n = othogonalise(n, normalise(r));
         }
 
-        static void seed() { _rand.seed(); }
+        static void seed() { random_stream::thread_stream().seed(); }
 
     protected:
-        static std::minstd_rand0                _rand;
+        random_stream &                         _rand;
         std::uniform_real_distribution<float>   _rdist;
         std::uniform_real_distribution<float>   _tdist;
 
@@ -76,12 +79,16 @@ class circle_sampler_random : public circle_sampler
 class circle_sampler_sobol : public circle_sampler
 {
     public:
-        circle_sampler_sobol(const point_t<> &n, const point_t<> &r, const int s) : circle_sampler(n, r, 1.0f / s, (2.0f * PI) / s), _ld(s) {  }
+        /* The low descrepency sequence is scrambled when built and for every reset so neighbouring pixels arent correlated */
+        circle_sampler_sobol(const point_t<> &n, const point_t<> &r, const int s) : circle_sampler(n, r, 1.0f / s, (2.0f * PI) / s), _ld(s)
+        {
+            _ld.reset(_rand(), _rand());
+        }
 
         void reset(const point_t<> &n, const point_t<> &r)
         {
             circle_sampler::reset(n, r);
-            _ld.reset();
+            _ld.reset(_rand(), _rand());
         }
 
         /* Take an evenly spreaded sample over the circle */
@@ -96,8 +103,15 @@ class circle_sampler_sobol : public circle_sampler
             const float r_rand = _rdist(_rand);
             const float t_rand = _tdist(_rand);
 
+            /* Wrap the radius into the circle, scrambled sectors can be jittered past the edge */
+            float r = x + r_rand;
+            if (r >= 1.0f)
+            {
+                r -= 1.0f;
+            }
+
             /* Convert the pair to a point */
-            return circle_sampler::sample(x + r_rand, (y * 2.0f * PI) + t_rand);
+            return circle_sampler::sample(r, (y * 2.0f * PI) + t_rand);
         }
 
     private:
@@ -4,6 +4,7 @@
 #include "simd.h"
 #include "ray.h"
 #include "packet_ray.h"
+#include "traversal_statistics.h"
 
 #ifdef SIMD_PACKET_TRACING
 
@@ -63,13 +64,13 @@ class frustrum
             _y_data[3] = 1.0f / horizontal_max(max_y_dir);
             _z_data[3] = 1.0f / horizontal_max(max_z_dir);
             
-            this->mm_ogn[0] = vfp_t(_x_data[0], _x_data[0], _x_data[1], _x_data[1]);
-            this->mm_ogn[1] = vfp_t(_y_data[0], _y_data[0], _y_data[1], _y_data[1]);
-            this->mm_ogn[2] = vfp_t(_z_data[0], _z_data[0], _z_data[1], _z_data[1]);
+            this->mm_ogn[0] = halves(_x_data[0], _x_data[1]);
+            this->mm_ogn[1] = halves(_y_data[0], _y_data[1]);
+            this->mm_ogn[2] = halves(_z_data[0], _z_data[1]);
             
-            this->mm_dir[0] = vfp_t(_x_data[2], _x_data[2], _x_data[3], _x_data[3]);
-            this->mm_dir[1] = vfp_t(_y_data[2], _y_data[2], _y_data[3], _y_data[3]);
-            this->mm_dir[2] = vfp_t(_z_data[2], _z_data[2], _z_data[3], _z_data[3]);
+            this->mm_dir[0] = halves(_x_data[2], _x_data[3]);
+            this->mm_dir[1] = halves(_y_data[2], _y_data[3]);
+            this->mm_dir[2] = halves(_z_data[2], _z_data[3]);
             
             /* Pick a major axis -- NOTE positive direction, _data[3], is inverse so flip the comparison */
             if (fabs(_x_data[3]) < fabs(_y_data[3]))
@@ -138,9 +139,9 @@ class frustrum
             this->mm_ogn[1] = vfp_t(o.y);
             this->mm_ogn[2] = vfp_t(o.z);
             
-            this->mm_dir[0] = vfp_t(_x_data[2], _x_data[2], _x_data[3], _x_data[3]);
-            this->mm_dir[1] = vfp_t(_y_data[2], _y_data[2], _y_data[3], _y_data[3]);
-            this->mm_dir[2] = vfp_t(_z_data[2], _z_data[2], _z_data[3], _z_data[3]);
+            this->mm_dir[0] = halves(_x_data[2], _x_data[3]);
+            this->mm_dir[1] = halves(_y_data[2], _y_data[3]);
+            this->mm_dir[2] = halves(_z_data[2], _z_data[3]);
             
             /* Pick a major axis -- NOTE positive direction _data[3] is inverse so flip the comparison */
             if (fabs(_x_data[3]) < fabs(_y_data[3]))
@@ -261,19 +262,15 @@ class frustrum
                 r1max[1] = max(r1max[1], i2_exit); 
             } 
 
-            transpose(r0min[0], r0min[1], r1min[0], r1min[1]); 
-            const vfp_t emin = min(min(r0min[0], r0min[1]), min(r1min[0], r1min[1])); 
+            /* Extents of the entry and exit rectangles */
+            const float emin[4] = { horizontal_min(r0min[0]), horizontal_min(r0min[1]), horizontal_min(r1min[0]), horizontal_min(r1min[1]) };
+            const float emax[4] = { horizontal_max(r0max[0]), horizontal_max(r0max[1]), horizontal_max(r1max[0]), horizontal_max(r1max[1]) };
 
-            transpose(r0max[0], r0max[1], r1max[0], r1max[1]); 
-            const vfp_t emax = max(max(r0max[0], r0max[1]), max(r1max[0], r1max[1])); 
-
-            const vfp_t ext1 = shuffle<2, 0, 2, 0>(emin, emax); // I1 values 
-            
             /* Triangle culling pre-computes */
-            const vfp_t mix1    = shuffle<3, 2, 1, 0>(emin, emax); 
-            const vfp_t mix2    = shuffle<1, 0, 3, 2>(emin, emax); 
-            const vfp_t xminmax = shuffle<0, 0, 0, 0>(bmin, bmax); 
-            const vfp_t xmaxmin = shuffle<0, 0, 0, 0>(bmax, bmin); 
+            const vfp_t mix1    = corners(emin[0], emin[1], emax[2], emax[3]);
+            const vfp_t mix2    = corners(emin[2], emin[3], emax[0], emax[1]);
+            const vfp_t xminmax = corners(bminf, bminf, bmaxf, bmaxf);
+            const vfp_t xmaxmin = corners(bmaxf, bmaxf, bminf, bminf);
 
             const vfp_t term0 = inverse(bmax - bmin); 
             this->q2 = mix1 - mix2;
@@ -285,13 +282,13 @@ class frustrum
             /* Rectangles on the front and rear face forming the frustrum */
             vfp_t entr[3];
             entr[I0] = bmin; 
-            entr[I1] = shuffle<0, 2, 2, 0>(ext1, ext1);
-            entr[I2] = shuffle<1, 1, 1, 1>(emin, emax);
+            entr[I1] = corners(emin[0], emax[0], emax[0], emin[0]);
+            entr[I2] = corners(emin[1], emin[1], emax[1], emax[1]);
 
             vfp_t extr[3];
             extr[I0] = bmax; 
-            extr[I1] = shuffle<1, 3, 3, 1>(ext1, ext1);
-            extr[I2] = shuffle<3, 3, 3, 3>(emin, emax);
+            extr[I1] = corners(emin[2], emax[2], emax[2], emin[2]);
+            extr[I2] = corners(emin[3], emin[3], emax[3], emax[3]);
 
             /* Frustrum origin and direction */
             this->ogn[0] = entr[0];
@@ -329,12 +326,14 @@ class frustrum
             /* Dot products with node pre-computes */
             const vfp_t t1 = this->q1; 
             const vfp_t t2 = this->q2; 
-            const vfp_t d0 = t1 + (vfp_t(a[I0]) * t2) + vfp_t(a[I1], a[I2], -a[I1], -a[I2]);
-            const vfp_t d1 = t1 + (vfp_t(b[I0]) * t2) + vfp_t(b[I1], b[I2], -b[I1], -b[I2]);
-            const vfp_t d2 = t1 + (vfp_t(c[I0]) * t2) + vfp_t(c[I1], c[I2], -c[I1], -c[I2]); 
+            const vfp_t d0 = t1 + (vfp_t(a[I0]) * t2) + corners(a[I1], a[I2], -a[I1], -a[I2]);
+            const vfp_t d1 = t1 + (vfp_t(b[I0]) * t2) + corners(b[I1], b[I2], -b[I1], -b[I2]);
+            const vfp_t d2 = t1 + (vfp_t(c[I0]) * t2) + corners(c[I1], c[I2], -c[I1], -c[I2]); 
 
             /* Exclude the triangle if all vertices are on one side of the beam */
-            return (move_mask(d0 & d1 & d2) != 0);
+            const bool culled = (move_mask(d0 & d1 & d2) != 0);
+            COUNT_TRAVERSAL(frustrum_culls, culled);
+            return culled;
         }
 
         /* Frustrum-aabb culling */
@@ -348,17 +347,19 @@ class frustrum
             /* Dot products with node pre-computes */
             const vfp_t t1 = this->q1; 
             const vfp_t t2 = this->q2; 
-            const vfp_t d0 = t1 + (vfp_t( low[I0]) * t2) + vfp_t( low[I1],  low[I2],  -low[I1],  -low[I2]);
-            const vfp_t d1 = t1 + (vfp_t(high[I0]) * t2) + vfp_t( low[I1],  low[I2],  -low[I1],  -low[I2]);
-            const vfp_t d2 = t1 + (vfp_t( low[I0]) * t2) + vfp_t(high[I1],  low[I2], -high[I1],  -low[I2]);
-            const vfp_t d3 = t1 + (vfp_t(high[I0]) * t2) + vfp_t(high[I1],  low[I2], -high[I1],  -low[I2]);
-            const vfp_t d4 = t1 + (vfp_t( low[I0]) * t2) + vfp_t( low[I1], high[I2],  -low[I1], -high[I2]);
-            const vfp_t d5 = t1 + (vfp_t(high[I0]) * t2) + vfp_t( low[I1], high[I2],  -low[I1], -high[I2]);
-            const vfp_t d6 = t1 + (vfp_t( low[I0]) * t2) + vfp_t(high[I1], high[I2], -high[I1], -high[I2]);
-            const vfp_t d7 = t1 + (vfp_t(high[I0]) * t2) + vfp_t(high[I1], high[I2], -high[I1], -high[I2]);
+            const vfp_t d0 = t1 + (vfp_t( low[I0]) * t2) + corners( low[I1],  low[I2],  -low[I1],  -low[I2]);
+            const vfp_t d1 = t1 + (vfp_t(high[I0]) * t2) + corners( low[I1],  low[I2],  -low[I1],  -low[I2]);
+            const vfp_t d2 = t1 + (vfp_t( low[I0]) * t2) + corners(high[I1],  low[I2], -high[I1],  -low[I2]);
+            const vfp_t d3 = t1 + (vfp_t(high[I0]) * t2) + corners(high[I1],  low[I2], -high[I1],  -low[I2]);
+            const vfp_t d4 = t1 + (vfp_t( low[I0]) * t2) + corners( low[I1], high[I2],  -low[I1], -high[I2]);
+            const vfp_t d5 = t1 + (vfp_t(high[I0]) * t2) + corners( low[I1], high[I2],  -low[I1], -high[I2]);
+            const vfp_t d6 = t1 + (vfp_t( low[I0]) * t2) + corners(high[I1], high[I2], -high[I1], -high[I2]);
+            const vfp_t d7 = t1 + (vfp_t(high[I0]) * t2) + corners(high[I1], high[I2], -high[I1], -high[I2]);
 
             /* Exclude the aabb if all vertices are on one side of the beam */
-            return (move_mask(d0 & d1 & d2 & d3 & d4 & d5 & d6 & d7) != 0);
+            const bool culled = (move_mask(d0 & d1 & d2 & d3 & d4 & d5 & d6 & d7) != 0);
+            COUNT_TRAVERSAL(frustrum_culls, culled);
+            return culled;
         }
        
         /* Access functions */
@@ -401,6 +402,27 @@ class frustrum
 //        bool neg_dir()                      const { return ((this->n & 0x4) != 0); }
       
     private : 
+        /* Vector with a in the lower half and b in the upper half */
+        static vfp_t halves(const float a, const float b)
+        {
+            return mov_p(index_to_mask_lut[SIMD_WIDTH >> 1], vfp_t(a), vfp_t(b));
+        }
+
+        /* Vector with the values for the 4 frustrum corners repeated across it */
+        static vfp_t corners(const float a, const float b, const float c, const float d)
+        {
+            float f[SIMD_WIDTH] __attribute__ ((aligned(SIMD_WIDTH * 4)));
+            for (int i = 0; i < SIMD_WIDTH; i += 4)
+            {
+                f[i    ] = a;
+                f[i + 1] = b;
+                f[i + 2] = c;
+                f[i + 3] = d;
+            }
+
+            return vfp_t(&f[0]);
+        }
+
         vfp_t       ogn[3];         /* Entry point of the frustrum corner rays              */
         vfp_t       dir[3];         /* Direction of the frustrum corner rays                */
         vfp_t       q1;             /* Frustrum constant per leaf node for triangle culling */
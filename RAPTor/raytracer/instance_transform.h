@@ -0,0 +1,109 @@
+#pragma once
+
+/* Standard headers */
+
+/* Boost headers */
+
+/* Common headers */
+#include "point_t.h"
+#include "quaternion_t.h"
+
+/* Ray tracer headers */
+#include "ray.h"
+
+
+namespace raptor_raytracer
+{
+/* Placement of an instance in the world. The instance is uniformly scaled, rotated and then translated */
+/* Uniform scaling keeps rays straight and normals perpendicular, so only distances need scaling */
+class instance_transform
+{
+    public :
+        instance_transform(const quaternion_t &o = quaternion_t(), const point_t<> &t = point_t<>(0.0f, 0.0f, 0.0f), const float s = 1.0f) :
+            _t(t), _s(s), _s_inv(1.0f / s)
+        {
+            assert(s > 0.0f);
+            normalise(o).rotation_matrix(&_r[0]);
+        }
+
+        /* Allow default DTOR, copy CTOR and assignment operator (for using in vector) */
+
+        /* Points */
+        point_t<> point_to_world(const point_t<> &p) const
+        {
+            return (rotate_to_world(p) * _s) + _t;
+        }
+
+        point_t<> point_to_object(const point_t<> &p) const
+        {
+            return rotate_to_object(p - _t) * _s_inv;
+        }
+
+        /* Directions and normals */
+        point_t<> direction_to_world(const point_t<> &d) const
+        {
+            return rotate_to_world(d);
+        }
+
+        point_t<> direction_to_object(const point_t<> &d) const
+        {
+            return rotate_to_object(d);
+        }
+
+        /* Distances along rays */
+        float distance_to_world(const float d) const
+        {
+            return (d < MAX_DIST) ? (d * _s) : MAX_DIST;
+        }
+
+        float distance_to_object(const float d) const
+        {
+            return (d < MAX_DIST) ? (d * _s_inv) : MAX_DIST;
+        }
+
+        /* Rays, only the origin and direction are transformed */
+        ray ray_to_object(const ray &r) const
+        {
+            const point_t<> d(direction_to_object(r.get_dir()));
+            return ray(point_to_object(r.get_ogn()), d.x, d.y, d.z);
+        }
+
+        /* Bounding box of the transformed box from b to t */
+        void bounds_to_world(point_t<> *const b, point_t<> *const t) const
+        {
+            point_t<> low( MAX_DIST,  MAX_DIST,  MAX_DIST);
+            point_t<> high(-MAX_DIST, -MAX_DIST, -MAX_DIST);
+            for (int i = 0; i < 8; ++i)
+            {
+                const point_t<> corner((i & 0x1) ? t->x : b->x, (i & 0x2) ? t->y : b->y, (i & 0x4) ? t->z : b->z);
+                const point_t<> world(point_to_world(corner));
+                low  = min(low, world);
+                high = max(high, world);
+            }
+
+            (*b) = low;
+            (*t) = high;
+        }
+
+    private :
+        point_t<> rotate_to_world(const point_t<> &p) const
+        {
+            return point_t<>((_r[0] * p.x) + (_r[1] * p.y) + (_r[2] * p.z),
+                             (_r[3] * p.x) + (_r[4] * p.y) + (_r[5] * p.z),
+                             (_r[6] * p.x) + (_r[7] * p.y) + (_r[8] * p.z));
+        }
+
+        /* The rotation is orthonormal so its inverse is its transpose */
+        point_t<> rotate_to_object(const point_t<> &p) const
+        {
+            return point_t<>((_r[0] * p.x) + (_r[3] * p.y) + (_r[6] * p.z),
+                             (_r[1] * p.x) + (_r[4] * p.y) + (_r[7] * p.z),
+                             (_r[2] * p.x) + (_r[5] * p.y) + (_r[8] * p.z));
+        }
+
+        float       _r[9];      /* Row major rotation to world space    */
+        point_t<>   _t;         /* Translation to world space           */
+        float       _s;         /* Scale to world space                 */
+        float       _s_inv;     /* Scale to object space                */
+};
+}; /* namespace raptor_raytracer */
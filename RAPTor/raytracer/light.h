@@ -2,10 +2,14 @@
 
 #include "triangle.h"
 #include "primitive_store.h"
+#include "random_stream.h"
 
 
 namespace raptor_raytracer
 {
+/* Forward declarations */
+class scene_cache;
+
 /* Enumerate the major axis and direction of the lights direction */
 enum class light_direction_t : char { x_pos = 0, y_pos = 1, z_pos = 2, x_neg = 3, y_neg = 4, z_neg = 5 };
 
@@ -38,6 +42,26 @@ class light
             : e(l.e), t(l.t), rgb(l.rgb), c(l.c), n(l.n), r(l.r), d(l.d), s_a(l.s_a), s_b(l.s_b), n_dir(l.n_dir) { };
         
         const point_t<>      & get_centre()                       const   { return this->c;               }
+        const ext_colour_t   & get_colour()                       const   { return this->rgb;             }
+        float                  get_drop_off()                     const   { return this->d;               }
+        bool                   is_directional()                   const   { return (this->n.x != 2.0f) && (this->s_b == 0.0f); }
+
+        /* Bounds of where shadow rays to this light may end */
+        void get_bounds(point_t<> *const lo, point_t<> *const hi) const
+        {
+            const point_t<> r(this->r, this->r, this->r);
+            *lo = this->c - r;
+            *hi = this->c + r;
+            if (this->t != nullptr)
+            {
+                for (const int i : *this->t)
+                {
+                    const triangle *const tri = this->e->primitive(i);
+                    *lo = min(min(min(*lo, tri->get_vertex_a()), tri->get_vertex_b()), tri->get_vertex_c());
+                    *hi = max(max(max(*hi, tri->get_vertex_a()), tri->get_vertex_b()), tri->get_vertex_c());
+                }
+            }
+        }
         
         /* Use inverse distance square law for light intensity */
         /* Distance is scaled by this->d */
@@ -58,11 +82,40 @@ class light
             }
         }
         
+        /* Light intensity for SIMD_WIDTH directions dx, dy, dz and distances c, the same as get_light_intensity for each lane */
+        void get_light_intensity(vfp_t *const r, vfp_t *const g, vfp_t *const b, const vfp_t &dx, const vfp_t &dy, const vfp_t &dz, const vfp_t &c) const
+        {
+            const vfp_t dist    = c * vfp_t(this->d);
+            const vfp_t d_scale = ((dist * dist) + vfp_one);
+            if (this->s_b != 0.0f)
+            {
+                /* There is no SIMD acos so spot lights fade a lane at a time */
+                float f[SIMD_WIDTH] __attribute__ ((aligned(SIMD_WIDTH * 4)));
+                for (int i = 0; i < SIMD_WIDTH; ++i)
+                {
+                    const float a = acos(dot_product(point_t<>(dx[i], dy[i], dz[i]), this->n));
+                    const float p = (a - this->s_a) / (this->s_b - this->s_a);
+                    f[i] = std::max(0.0f, std::min(1.0f, (1.0f - p)));
+                }
+
+                const vfp_t scale(vfp_t(f) / d_scale);
+                *r = vfp_t(this->rgb.r) * scale;
+                *g = vfp_t(this->rgb.g) * scale;
+                *b = vfp_t(this->rgb.b) * scale;
+            }
+            else
+            {
+                *r = vfp_t(this->rgb.r) / d_scale;
+                *g = vfp_t(this->rgb.g) / d_scale;
+                *b = vfp_t(this->rgb.b) / d_scale;
+            }
+        }
+        
         /* Soft shadow destination picking */
         int find_rays(ray *const r, const point_t<> &d, const int n) const
         {
             /* Directional light */
-            if ((this->n.x != 2.0f) && (this->s_b == 0.0f))
+            if (is_directional())
             {
                 /* The light should be parallel light and from infinetly far away */
                 /* Place the light outside the scene bounding box and in the direction of this->n */
@@ -107,13 +160,14 @@ class light
                 const float r_scale = 1.0f / static_cast<float>((n >> 4) + ((n & 0x8) != 0) + 1);
 
                 /* Create n rays, each with a random offset in a fixed volume */
+                random_stream &rng = random_stream::thread_stream();
                 for (int i = 0; i < n; i++)
                 {
                     /* Pick random offsets */
                     const int eigths    = (i >> 2) & ~0x1;
-                    const float a_off   = gen_random_mersenne_twister() * (a_scale * static_cast<float>(eigths + (i & 0x1))) * (2.0f * PI);
-                    const float b_off   = gen_random_mersenne_twister() * (b_scale * static_cast<float>(eigths + (i & 0x2))) * (2.0f * PI);
-                    const float r_off   = gen_random_mersenne_twister() * (r_scale * static_cast<float>(eigths + (i & 0x4))) * this->r;
+                    const float a_off   = rng.next() * (a_scale * static_cast<float>(eigths + (i & 0x1))) * (2.0f * PI);
+                    const float b_off   = rng.next() * (b_scale * static_cast<float>(eigths + (i & 0x2))) * (2.0f * PI);
+                    const float r_off   = rng.next() * (r_scale * static_cast<float>(eigths + (i & 0x4))) * this->r;
 
                     /* Convert to cartesian co-ordinates */
                     const float sin_a   = cos_lut.get_sin(a_off);
@@ -168,6 +222,13 @@ class light
         }
     
     private :
+        friend class scene_cache;
+
+        /* CTOR for restoring a cached light, rgb is already scaled */
+        light(const primitive_store *const e, const std::vector<int> *const t, const ext_colour_t &rgb, const point_t<> &c, const point_t<> &n, 
+            const float r, const float d, const float s_a, const float s_b, const light_direction_t n_dir)
+            : e(e), t(t), rgb(rgb), c(c), n(n), r(r), d(d), s_a(s_a), s_b(s_b), n_dir(n_dir) {  };
+
         light& operator=(const light &l) { return *this; }
 
         light_direction_t find_major_direction()
@@ -0,0 +1,186 @@
+/* Standard headers */
+#include <algorithm>
+
+/* Ray tracer headers */
+#include "light_tree.h"
+
+
+namespace raptor_raytracer
+{
+light_tree::light_tree(const light_list &l) : _leaf(l.size(), -1), _nr_lights(l.size()), _root(0)
+{
+    /* Directional lights are always picked, everything else goes in the tree */
+    std::vector<int> idx;
+    std::vector<point_t<>> centres(l.size());
+    for (int i = 0; i < static_cast<int>(l.size()); ++i)
+    {
+        if (l[i].is_directional())
+        {
+            _directional.push_back(i);
+            continue;
+        }
+
+        idx.push_back(i);
+        point_t<> lo;
+        point_t<> hi;
+        l[i].get_bounds(&lo, &hi);
+        centres[i] = (lo + hi) * 0.5f;
+    }
+
+    /* Build the leaves */
+    _nodes.reserve(std::max(1, (static_cast<int>(idx.size()) * 2) - 1));
+    for (const int i : idx)
+    {
+        _leaf[i] = _nodes.size();
+
+        node n;
+        l[i].get_bounds(&n.lo, &n.hi);
+        const ext_colour_t &rgb = l[i].get_colour();
+        n.power     = std::max(0.0f, rgb.r + rgb.g + rgb.b);
+        n.d         = std::fabs(l[i].get_drop_off());
+        n.parent    = -1;
+        n.left      = -1;
+        n.right     = -1;
+        n.light     = i;
+        _nodes.push_back(n);
+    }
+
+    /* Build the hierarchy over the leaves, the root is the first node after them */
+    if (idx.size() > 1)
+    {
+        std::vector<int> leaves(idx.size());
+        for (int i = 0; i < static_cast<int>(idx.size()); ++i)
+        {
+            leaves[i] = i;
+            centres[i] = centres[idx[i]];
+        }
+        centres.resize(idx.size());
+        _root = build(leaves, centres, 0, leaves.size(), -1);
+    }
+}
+
+
+int light_tree::build(std::vector<int> &idx, const std::vector<point_t<>> &centres, const int b, const int e, const int parent)
+{
+    /* Leaves already exist */
+    if ((e - b) == 1)
+    {
+        _nodes[idx[b]].parent = parent;
+        return idx[b];
+    }
+
+    /* Split at the median of the widest axis of the centres */
+    point_t<> lo(centres[idx[b]]);
+    point_t<> hi(centres[idx[b]]);
+    for (int i = b + 1; i < e; ++i)
+    {
+        lo = min(lo, centres[idx[i]]);
+        hi = max(hi, centres[idx[i]]);
+    }
+
+    const point_t<> width(hi - lo);
+    const int axis = ((width.x >= width.y) && (width.x >= width.z)) ? 0 : ((width.y >= width.z) ? 1 : 2);
+    const int m = b + ((e - b) >> 1);
+    std::nth_element(idx.begin() + b, idx.begin() + m, idx.begin() + e, [&centres, axis](const int l, const int r)
+    {
+        return centres[l][axis] < centres[r][axis];
+    });
+
+    /* Reserve this node before the children so the root is built first, but fill it in after */
+    const int n = _nodes.size();
+    _nodes.emplace_back();
+    const int left  = build(idx, centres, b, m, n);
+    const int right = build(idx, centres, m, e, n);
+
+    node &nd = _nodes[n];
+    nd.lo       = min(_nodes[left].lo, _nodes[right].lo);
+    nd.hi       = max(_nodes[left].hi, _nodes[right].hi);
+    nd.power    = _nodes[left].power + _nodes[right].power;
+    nd.d        = std::min(_nodes[left].d, _nodes[right].d);
+    nd.parent   = parent;
+    nd.left     = left;
+    nd.right    = right;
+    nd.light    = -1;
+    return n;
+}
+
+
+float light_tree::probability(const point_t<> &p, const int l) const
+{
+    if (_leaf[l] < 0)
+    {
+        return 1.0f;
+    }
+
+    /* Walk up from the leaf taking the probability of each turn */
+    float pdf = 1.0f;
+    for (int c = _leaf[l]; _nodes[c].parent >= 0; c = _nodes[c].parent)
+    {
+        const node &n = _nodes[_nodes[c].parent];
+        const float left = left_probability(n, p);
+        pdf *= (n.left == c) ? left : (1.0f - left);
+    }
+
+    return pdf;
+}
+
+
+int light_tree::sample(const point_t<> &p, float u, float *const pdf) const
+{
+    assert(!_nodes.empty());
+
+    /* Descend from the root, re-using u for each turn by rescaling it into the range of the turn taken */
+    float prob = 1.0f;
+    int c = _root;
+    while (_nodes[c].light < 0)
+    {
+        const node &n = _nodes[c];
+        const float left = left_probability(n, p);
+        if (u < left)
+        {
+            u /= left;
+            prob *= left;
+            c = n.left;
+        }
+        else
+        {
+            u = (u - left) / (1.0f - left);
+            prob *= (1.0f - left);
+            c = n.right;
+        }
+
+        u = std::min(u, 0.99999994f);
+    }
+
+    *pdf = prob;
+    return _nodes[c].light;
+}
+
+
+void light_tree::pick(float *const w, const point_t<> &p, random_stream &rng, const int n, const int stride) const
+{
+    for (int i = 0; i < _nr_lights; ++i)
+    {
+        w[i * stride] = 0.0f;
+    }
+
+    for (const int i : _directional)
+    {
+        w[i * stride] = 1.0f;
+    }
+
+    if (_nodes.empty())
+    {
+        return;
+    }
+
+    /* Each pick adds 1 / (n * pdf) so a light shaded with its weight has the expected value of shading it fully */
+    const float n_inv = 1.0f / n;
+    for (int i = 0; i < n; ++i)
+    {
+        float pdf;
+        const int l = sample(p, rng.next(), &pdf);
+        w[l * stride] += n_inv / pdf;
+    }
+}
+}; /* namespace raptor_raytracer */
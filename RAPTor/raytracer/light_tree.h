@@ -0,0 +1,83 @@
+#pragma once
+
+/* Standard headers */
+#include <vector>
+
+/* Boost headers */
+#include "boost/noncopyable.hpp"
+
+/* Common headers */
+#include "common.h"
+#include "point_t.h"
+
+/* Ray tracer headers */
+#include "light.h"
+#include "random_stream.h"
+
+
+namespace raptor_raytracer
+{
+/* Hierarchy over the lights for picking which to shadow test from a point. Each node keeps the bounds, total power
+   and weakest drop off of its lights. A descent picks each child in proportion to its estimated contribution at the
+   point so the probability of reaching a light is known and its shading can be weighted to stay unbiased.
+   Directional lights have no position or drop off so they arent in the tree and are always picked */
+class light_tree : private boost::noncopyable
+{
+    public :
+        explicit light_tree(const light_list &l);
+
+        /* Probability of a descent from p picking light l, directional lights always return 1 */
+        float probability(const point_t<> &p, const int l) const;
+
+        /* Pick a light from p with u in the range [0.0, 1.0), the probability of picking it is returned in pdf */
+        int sample(const point_t<> &p, float u, float *const pdf) const;
+
+        /* Weight every light for n picks from p into w[l * stride]. Directional lights are weighted 1, lights not */
+        /* picked 0 and picked lights the number of times picked / (n * probability) */
+        void pick(float *const w, const point_t<> &p, random_stream &rng, const int n, const int stride = 1) const;
+
+        /* Access functions */
+        int number_of_lights()      const { return _nr_lights;      }
+        int number_of_directional() const { return _directional.size(); }
+
+    private :
+        /* Leaves have no children and hold their light in light */
+        struct node
+        {
+            point_t<>   lo;
+            point_t<>   hi;
+            float       power;
+            float       d;
+            int         parent;
+            int         left;
+            int         right;
+            int         light;
+        };
+
+        /* Build the node for lights b to e of idx and return its index */
+        int build(std::vector<int> &idx, const std::vector<point_t<>> &centres, const int b, const int e, const int parent);
+
+        /* Estimate of the contribution of the lights under n at p, the power dropped off from the nearest point of its bounds */
+        float importance(const node &n, const point_t<> &p) const
+        {
+            const point_t<> near(max(max(n.lo - p, p - n.hi), point_t<>(0.0f, 0.0f, 0.0f)));
+            const float dist_sq = dot_product(near, near);
+            return n.power / ((dist_sq * n.d * n.d) + 1.0f);
+        }
+
+        /* Probability of descending to left of n from p */
+        float left_probability(const node &n, const point_t<> &p) const
+        {
+            const float l = importance(_nodes[n.left], p);
+            const float r = importance(_nodes[n.right], p);
+            const float t = l + r;
+            return (t > 0.0f) ? (l / t) : 0.5f;
+        }
+
+        std::vector<node>   _nodes;
+        std::vector<int>    _leaf;
+        std::vector<int>    _directional;
+        int                 _nr_lights;
+        int                 _root;
+};
+}; /* namespace raptor_raytracer */
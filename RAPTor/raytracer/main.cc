@@ -1,5 +1,14 @@
+/* Standard headers */
+#include <chrono>
+#include <future>
+#include <memory>
+
 /* Raytracer headers */
 #include "raytracer.h"
+#include "render_farm.h"
+#include "tile_scheduler.h"
+#include "scene_cache.h"
+#include "texture_cache.h"
 #include "common.h"
 #include "scene.h"
 #include "camera.h"
@@ -13,6 +22,8 @@
 #include "vrml_parser.h"
 #include "polygon_to_triangles.h"
 #include "bih.h"
+#include "bvh.h"
+#include "wide_bvh.h"
 #include "kd_tree.h"
 
 /* Display headers */
@@ -29,8 +40,22 @@ void help()
 {
     std::cout << "Usage: raytracer [-i] [-f file_name] [-mgf|-nff|-lwo|-obj|-vrml] [-cam x y z]"                              << std::endl;
     std::cout << "                 [-at x y z] [-rx x] [-ry x] [-rz x] [-bg r g b]  "            	                          << std::endl;
-    std::cout << "                 [-light x y z ra r g b d]"                                                                 << std::endl;
+    std::cout << "                 [-light x y z ra r g b d] [-ssd kdt|bkdt|bvh|bih|wbvh] [-bench n]"                         << std::endl;
+    std::cout << "                 [-wavefront] [-cache f] [-adaptive x y c] [-texture_cache m]"                              << std::endl;
+    std::cout << "                 [-farm p] [-farm_worker a p]"                                                              << std::endl;
     std::cout << "       -i                      	                    : enables interactive mode."                          << std::endl;
+    std::cout << "       -ssd        s                                   : s is the spatial sub division, kdt, bkdt, bvh, bih or wbvh." << std::endl;
+    std::cout << "                                                        bkdt is a kd tree built with a binned sah."        << std::endl;
+    std::cout << "       -bench      n                                   : build each spatial sub division and trace n times."<< std::endl;
+    std::cout << "                                                        -ssd limits this to one spatial sub division."      << std::endl;
+    std::cout << "       -wavefront                                      : trace each tile in waves of sorted rays."          << std::endl;
+    std::cout << "       -cache      f                                   : f is a binary cache of the parsed scene and ssd."  << std::endl;
+    std::cout << "                                                        mgf, lwo, obj, off and ply scenes are cached."      << std::endl;
+    std::cout << "       -texture_cache m                                : m is the megabytes of texture tiles kept in memory."<< std::endl;
+    std::cout << "       -farm       p                                   : hand tiles of the image to render farm workers that"<< std::endl;
+    std::cout << "                                                        connect on port p, 0 picks a free port."            << std::endl;
+    std::cout << "       -farm_worker a p                                : render tiles for the render farm at address a port p."<< std::endl;
+    std::cout << "                                                        Workers are given the same scene arguments."        << std::endl;
     std::cout << "       -tga        f                                   : f is tga snapshot file."                           << std::endl;
     std::cout << "       -png        f                                   : f is png snapshot file."                           << std::endl;
     std::cout << "       -jpg        f q                                 : f is jpeg snapshot file. q is image quality."      << std::endl;
@@ -41,6 +66,9 @@ void help()
     std::cout << "       -vrml       f v                                 : f is vrml format scene. v is the view point."      << std::endl;
     std::cout << "       -res        x y                                 : x y are the image resolutions."                    << std::endl;
     std::cout << "       -anti_alias x y                                 : x y are the image anti-aliasing factors."          << std::endl;
+    std::cout << "       -adaptive   x y c                               : x y are the anti-aliasing factors of pixels whose"  << std::endl;
+    std::cout << "                                                        contrast with a neighbour is over c."               << std::endl;
+    std::cout << "                                                        Other pixels are traced once, replaces -anti_alias."<< std::endl;
     std::cout << "       -cam        x y z                               : x y z are the camera's co-ordinate."               << std::endl;
     std::cout << "       -at         x y z                               : x y z are the co-ordinates looked at."             << std::endl;
     std::cout << "       -rx         x                                   : x is an angle to rotate about the x axis."         << std::endl;
@@ -91,6 +119,86 @@ void help()
     std::cout << "   p           :   dump position data."                                        	                          << std::endl;
 }
 
+/*****************************************************
+ Function to build the requested spatial sub division.
+*****************************************************/
+raptor_raytracer::ssd * build_ssd(raptor_raytracer::primitive_store *const everything, const raptor_raytracer::ssd_type_t type)
+{
+    /* Reset indirections, the bvh and bih reorder them while building */
+    everything->reset_indirection();
+    switch (type)
+    {
+        case raptor_raytracer::ssd_type_t::kdt :
+            return new raptor_raytracer::kd_tree(*everything);
+        case raptor_raytracer::ssd_type_t::bkdt :
+            return new raptor_raytracer::kd_tree(*everything, raptor_raytracer::kdt_build_t::binned);
+        case raptor_raytracer::ssd_type_t::bvh :
+            return new raptor_raytracer::bvh(*everything);
+        case raptor_raytracer::ssd_type_t::bih :
+            return new raptor_raytracer::bih(*everything);
+        case raptor_raytracer::ssd_type_t::wbvh :
+            return new raptor_raytracer::wide_bvh(*everything);
+        default :
+            assert(!"Error unknown spatial sub division");
+            return nullptr;
+    }
+}
+
+
+/*****************************************************
+ Function to name a spatial sub division.
+*****************************************************/
+const char * ssd_name(const raptor_raytracer::ssd_type_t type)
+{
+    switch (type)
+    {
+        case raptor_raytracer::ssd_type_t::kdt :
+            return "kdt";
+        case raptor_raytracer::ssd_type_t::bkdt :
+            return "bkdt";
+        case raptor_raytracer::ssd_type_t::bvh :
+            return "bvh";
+        case raptor_raytracer::ssd_type_t::bih :
+            return "bih";
+        case raptor_raytracer::ssd_type_t::wbvh :
+            return "wbvh";
+        default :
+            assert(!"Error unknown spatial sub division");
+            return "";
+    }
+}
+
+
+/*****************************************************
+ Function to time building a spatial sub division and
+ tracing the scene through it iterations times.
+*****************************************************/
+void benchmark(raptor_raytracer::primitive_store *const everything, const raptor_raytracer::light_list &lights, raptor_raytracer::camera *const cam,
+    const raptor_raytracer::ssd_type_t type, const raptor_raytracer::trace_mode_t mode, const int iterations)
+{
+    /* Build */
+    const auto build_t0(std::chrono::system_clock::now());
+    std::unique_ptr<raptor_raytracer::ssd> ssd(build_ssd(everything, type));
+    const auto build_t1(std::chrono::system_clock::now());
+
+    /* Trace */
+    const auto trace_t0(std::chrono::system_clock::now());
+    for (int i = 0; i < iterations; ++i)
+    {
+        ray_tracer(ssd.get(), lights, *everything, *cam, mode);
+    }
+    const auto trace_t1(std::chrono::system_clock::now());
+
+    /* Report */
+    const float build_ms    = std::chrono::duration_cast<std::chrono::microseconds>(build_t1 - build_t0).count() / 1000.0f;
+    const float trace_ms    = std::chrono::duration_cast<std::chrono::microseconds>(trace_t1 - trace_t0).count() / 1000.0f;
+    const float rays        = static_cast<float>(cam->x_number_of_rays()) * static_cast<float>(cam->y_number_of_rays()) * iterations;
+    std::cout << ssd_name(type) << " build ms: " << build_ms << ", trace ms: " << (trace_ms / iterations);
+    std::cout << ", primary rays/s: " << (rays / (trace_ms / 1000.0f));
+    std::cout << ", nodes: " << ssd->number_of_nodes() << ", leaves: " << ssd->number_of_leaves() << ", sah: " << ssd->sah_cost() << std::endl;
+}
+
+
 
 /*****************************************************
  The main function.
@@ -99,19 +207,28 @@ int main (int argc, char **argv)
 {
     using raptor_raytracer::model_format_t;
     using raptor_raytracer::image_format_t;
+    using raptor_raytracer::ssd_type_t;
     using raptor_raytracer::ext_colour_t;
+    using raptor_raytracer::trace_mode_t;
 
     /* Default parameters */
     bool            interactive     = false;
+    bool            bench_all       = true;
+    int             bench_iters     = 0;
     model_format_t  input_format    = model_format_t::code;
     image_format_t  image_format    = image_format_t::tga;
+    ssd_type_t      ssd_type        = ssd_type_t::kdt;
+    trace_mode_t    trace_mode      = trace_mode_t::recursive;
     int             jpg_quality     = 50;
     float           focal_length    = 0.0f;
     float           aperture        = 0.0f;
     ext_colour_t    bg;
     std::string     input_file;
     std::string     view_point;
+    std::string     cache_file;
     std::string     output_file     = "snapshot";
+    std::string     farm_addr;
+    int             farm_port       = -1;
     std::string     caption         = "raytracer ";
 
     /* Camera parameters */
@@ -127,6 +244,9 @@ int main (int argc, char **argv)
     unsigned yr = 480;                      /* Y resolution                     */
     unsigned xa = 1;                        /* X anti-aliasing factor           */
     unsigned ya = 1;                        /* Y anti-aliasing factor           */
+    unsigned xad = 1;                       /* X adaptive anti-aliasing factor  */
+    unsigned yad = 1;                       /* Y adaptive anti-aliasing factor  */
+    float    contrast = 0.0f;               /* Adaptive anti-aliasing contrast  */
 
     /* Scene data */
     raptor_raytracer::light_list            lights;
@@ -149,6 +269,128 @@ int main (int argc, char **argv)
                 interactive = true;
                 caption += "-i ";
             }
+            /* Spatial sub division */
+            else if (strcmp(argv[i], "-ssd") == 0)
+            {
+                if ((argc - i) < 2)
+                {
+                    std::cout << "Incorrectly specified spatial sub division" << std::endl;
+                    help();
+                    return 1;
+                }
+
+                ++i;
+                if (strcmp(argv[i], "kdt") == 0)
+                {
+                    ssd_type = ssd_type_t::kdt;
+                }
+                else if (strcmp(argv[i], "bkdt") == 0)
+                {
+                    ssd_type = ssd_type_t::bkdt;
+                }
+                else if (strcmp(argv[i], "bvh") == 0)
+                {
+                    ssd_type = ssd_type_t::bvh;
+                }
+                else if (strcmp(argv[i], "bih") == 0)
+                {
+                    ssd_type = ssd_type_t::bih;
+                }
+                else if (strcmp(argv[i], "wbvh") == 0)
+                {
+                    ssd_type = ssd_type_t::wbvh;
+                }
+                else
+                {
+                    std::cout << "Unknown spatial sub division: " << argv[i] << std::endl;
+                    help();
+                    return 1;
+                }
+
+                bench_all   = false;
+                caption    += "-ssd ";
+                caption    += argv[i];
+                caption    += " ";
+            }
+            /* Wavefront tracing */
+            else if (strcmp(argv[i], "-wavefront") == 0)
+            {
+                trace_mode  = trace_mode_t::wavefront;
+                caption    += "-wavefront ";
+            }
+            /* Scene cache */
+            else if (strcmp(argv[i], "-cache") == 0)
+            {
+                if ((argc - i) < 2)
+                {
+                    std::cout << "Incorrectly specified scene cache file" << std::endl;
+                    help();
+                    return 1;
+                }
+
+                cache_file = argv[++i];
+            }
+            /* Texture cache */
+            else if (strcmp(argv[i], "-texture_cache") == 0)
+            {
+                if ((argc - i) < 2)
+                {
+                    std::cout << "Incorrectly specified texture cache size" << std::endl;
+                    help();
+                    return 1;
+                }
+
+                const int mb = atoi(argv[++i]);
+                if (mb < 1)
+                {
+                    std::cout << "Incorrectly specified texture cache size" << std::endl;
+                    help();
+                    return 1;
+                }
+                raptor_raytracer::texture_cache::global().budget(static_cast<std::size_t>(mb) << 20);
+            }
+            /* Benchmark */
+            else if (strcmp(argv[i], "-bench") == 0)
+            {
+                if ((argc - i) < 2)
+                {
+                    std::cout << "Incorrectly specified benchmark iterations" << std::endl;
+                    help();
+                    return 1;
+                }
+
+                bench_iters = atoi(argv[++i]);
+                if (bench_iters < 1)
+                {
+                    std::cout << "Incorrectly specified benchmark iterations" << std::endl;
+                    help();
+                    return 1;
+                }
+            }
+            /* Render farm coordinator or worker */
+            else if ((strcmp(argv[i], "-farm") == 0) || (strcmp(argv[i], "-farm_worker") == 0))
+            {
+                const bool worker = (strcmp(argv[i], "-farm_worker") == 0);
+                if ((argc - i) < (worker ? 3 : 2))
+                {
+                    std::cout << "Incorrectly specified render farm" << std::endl;
+                    help();
+                    return 1;
+                }
+
+                if (worker)
+                {
+                    farm_addr = argv[++i];
+                }
+
+                farm_port = atoi(argv[++i]);
+                if ((farm_port < 0) || (farm_port > 65535) || (worker && (farm_port == 0)))
+                {
+                    std::cout << "Incorrectly specified render farm port" << std::endl;
+                    help();
+                    return 1;
+                }
+            }
             /* TGA output */
             else if (strcmp(argv[i], "-tga") == 0)
             {
@@ -331,6 +573,20 @@ int main (int argc, char **argv)
                 xa = atoi(argv[++i]);
                 ya = atoi(argv[++i]);
             }
+            /* Adaptive anti-aliasing factor */
+            else if (strcmp(argv[i], "-adaptive") == 0)
+            {
+                if ((argc - i) < 4)
+                {
+                    std::cout << "Incorrectly specified adaptive anti-aliasing" << std::endl;
+                    help();
+                    return 1;
+                }
+                
+                xad         = atoi(argv[++i]);
+                yad         = atoi(argv[++i]);
+                contrast    = atof(argv[++i]);
+            }
             /* Camera position */
             else if (strcmp(argv[i], "-cam") == 0)
             {
@@ -619,9 +875,30 @@ int main (int argc, char **argv)
     std::string     path;
     size_t          last_slash;
     
+    /* Adaptive anti-aliasing samples pixels as they need it, so the image is traced at the output resolution */
+    if ((xad * yad) > 1)
+    {
+        xa = 1;
+        ya = 1;
+    }
+
     /* Get the screen aspect ratio */
     const float screen_width    = 10.0f;
     const float screen_height   = screen_width * (static_cast<float>(yr) / static_cast<float>(xr));
+
+    /* Try to load the scene from the cache, scenes that set the camera cant be cached */
+    std::unique_ptr<raptor_raytracer::ssd> ssd;
+    std::uint64_t   source_hash = 0;
+    const int       first_light = lights.size();
+    bool            cached      = false;
+    const bool      cacheable   = !cache_file.empty() && ((input_format == model_format_t::mgf) || (input_format == model_format_t::lwo) ||
+        (input_format == model_format_t::obj) || (input_format == model_format_t::off) || (input_format == model_format_t::ply));
+    if (cacheable)
+    {
+        source_hash = raptor_raytracer::scene_cache::hash_file(input_file);
+        cached      = raptor_raytracer::scene_cache::load(cache_file, source_hash, ssd_type, &lights, &everything, &materials, &ssd);
+    }
+
     switch (input_format)
     {
         case model_format_t::cfg :
@@ -643,7 +920,10 @@ int main (int argc, char **argv)
             break;
 
         case model_format_t::mgf :
-            raptor_raytracer::mgf_parser(input_file.c_str(), lights, everything, materials);
+            if (!cached)
+            {
+                raptor_raytracer::mgf_parser(input_file.c_str(), lights, everything, materials);
+            }
             
             /* Camera is not set in the scene so do it here */
             cam = new raptor_raytracer::camera(cam_p, x_vec, y_vec, z_vec, bg, screen_width, screen_height, 10, xr, yr, xa, ya, aperture, focal_length);
@@ -656,40 +936,46 @@ int main (int argc, char **argv)
             break;
 
         case model_format_t::lwo :
-            input_stream.open(input_file.c_str());
-            assert(input_stream.is_open());
-            last_slash  = input_file.find_last_of('/');
-            path        = input_file.substr(0, last_slash + 1);
-            raptor_raytracer::lwo_parser(input_stream, path, lights, everything, materials, &cam);
+            if (!cached)
+            {
+                input_stream.open(input_file.c_str());
+                assert(input_stream.is_open());
+                last_slash  = input_file.find_last_of('/');
+                path        = input_file.substr(0, last_slash + 1);
+                raptor_raytracer::lwo_parser(input_stream, path, lights, everything, materials, &cam);
+            }
 
             /* Camera is not set in the scene so do it here */
             cam = new raptor_raytracer::camera(cam_p, x_vec, y_vec, z_vec, bg, screen_width, screen_height, 20, xr, yr, xa, ya, aperture, focal_length);
             break;
             
         case model_format_t::obj :
-            input_stream.open(input_file.c_str());
-            assert(input_stream.is_open());
-            last_slash  = input_file.find_last_of('/');
-            path        = input_file.substr(0, last_slash + 1);
-            raptor_raytracer::obj_parser(input_stream, path, lights, everything, materials, &cam);
+            if (!cached)
+            {
+                last_slash  = input_file.find_last_of('/');
+                path        = input_file.substr(0, last_slash + 1);
+                raptor_raytracer::obj_parser(input_file, path, lights, everything, materials, &cam);
+            }
             
             /* Camera is not set in the scene so do it here */
             cam = new raptor_raytracer::camera(cam_p, x_vec, y_vec, z_vec, bg, screen_width, screen_height, 20, xr, yr, xa, ya, aperture, focal_length);
             break;
             
         case model_format_t::off :
-            input_stream.open(input_file.c_str());
-            assert(input_stream.is_open());
-            raptor_raytracer::off_parser(input_stream, lights, everything, materials, cam);
+            if (!cached)
+            {
+                raptor_raytracer::off_parser(input_file, lights, everything, materials, cam);
+            }
             
             /* Camera is not set in the scene so do it here */
             cam = new raptor_raytracer::camera(cam_p, x_vec, y_vec, z_vec, bg, screen_width, screen_height, 20, xr, yr, xa, ya, aperture, focal_length);
             break;
 
         case model_format_t::ply :
-            input_stream.open(input_file.c_str());
-            assert(input_stream.is_open());
-            raptor_raytracer::ply_parser(input_stream, lights, everything, materials, &cam);
+            if (!cached)
+            {
+                raptor_raytracer::ply_parser(input_file, lights, everything, materials, &cam);
+            }
             
             /* Camera is not set in the scene so do it here */
             cam = new raptor_raytracer::camera(cam_p, x_vec, y_vec, z_vec, bg, screen_width, screen_height, 20, xr, yr, xa, ya, aperture, focal_length);
@@ -723,9 +1009,65 @@ int main (int argc, char **argv)
     cam->tilt(rx);
     cam->pan(ry);
     cam->roll(rz);
+    cam->adaptive_anti_alias(xad, yad, contrast);
+
+    /* Time building and tracing with each spatial sub division */
+    if (bench_iters > 0)
+    {
+        std::cout << "Benchmarking " << everything.size() << " primitives, " << lights.size() << " lights" << std::endl;
+        if (bench_all)
+        {
+            benchmark(&everything, lights, cam, ssd_type_t::kdt, trace_mode, bench_iters);
+            benchmark(&everything, lights, cam, ssd_type_t::bkdt, trace_mode, bench_iters);
+            benchmark(&everything, lights, cam, ssd_type_t::bvh, trace_mode, bench_iters);
+            benchmark(&everything, lights, cam, ssd_type_t::bih, trace_mode, bench_iters);
+            benchmark(&everything, lights, cam, ssd_type_t::wbvh, trace_mode, bench_iters);
+        }
+        else
+        {
+            benchmark(&everything, lights, cam, ssd_type, trace_mode, bench_iters);
+        }
+
+        raptor_raytracer::scene_clean(&materials, cam);
+        return 0;
+    }
+
+    /* Build spatial sub division, unless it came from the cache or render farm workers will trace the scene */
+    const bool farm_coordinator = (farm_port >= 0) && farm_addr.empty();
+    const bool built = (ssd == nullptr) && !farm_coordinator;
+    if (built)
+    {
+        ssd.reset(build_ssd(&everything, ssd_type));
+    }
 
-    /* Build spatial sub division */
-    raptor_raytracer::kd_tree ssd(everything);
+    /* Update the cache if it was missing, out of date or held a different ssd */
+    if (cacheable && !farm_coordinator && (!cached || (built && (ssd_type != ssd_type_t::wbvh))))
+    {
+        raptor_raytracer::scene_cache::save(cache_file, source_hash, lights, first_light, everything, materials, ssd_type, ssd.get());
+    }
+
+    /* Render tiles for a render farm until it has no more work */
+    if (!farm_addr.empty())
+    {
+        raptor_raytracer::render_worker worker(farm_addr, farm_port);
+        const bool worked = worker.run([&](const raptor_raytracer::render_job &job, ext_colour_t *pixels)
+        {
+            ray_tracer(ssd.get(), lights, everything, *cam, job.t, trace_mode);
+            for (int y = job.t.y0; y < job.t.y1; ++y)
+            {
+                for (int x = job.t.x0; x < job.t.x1; ++x)
+                {
+                    *pixels++ = cam->get_pixel(x, y);
+                }
+            }
+
+            return true;
+        });
+
+        std::cout << "Rendered " << worker.jobs_rendered() << " render farm jobs" << std::endl;
+        raptor_raytracer::scene_clean(&materials, cam);
+        return worked ? 0 : 1;
+    }
     
     /* Run in interactive mode */
     if (interactive)
@@ -745,16 +1087,29 @@ int main (int argc, char **argv)
         append_raytracer_camera_event_handler(handler_map, cam, output_file, jpg_quality, image_format);
         sdl_event_handler cam_event_handler(handler_map);
         std::unique_ptr<unsigned char[]> screen_data(new unsigned char [cam->x_resolution() * cam->y_resolution() * 3]);
+        raptor_raytracer::tile_scheduler scheduler(cam->x_number_of_rays(), cam->y_number_of_rays(), 32, 8, raptor_raytracer::tile_order_t::spiral);
+        bool complete = true;
         while (do_next != 1) 
         {
-            /* Poll for user input */
-            do_next = cam_event_handler.process_events();
-            
-            /* Draw if required */
-            if (do_next == 0)
+            /* Trace progressively, showing each pass. The first pass always completes, later passes are abandoned on user input */
+            scheduler.reset();
+            for (int p = 0; (do_next == 0) && (p < scheduler.number_of_passes()); ++p)
             {
-                /* Display output for interactive mode */
-                ray_tracer(&ssd, lights, everything, *cam);
+                auto pass = std::async(std::launch::async, [&]() { return ray_tracer(ssd.get(), lights, everything, *cam, scheduler, p, trace_mode); });
+                while (pass.wait_for(std::chrono::milliseconds(1)) != std::future_status::ready)
+                {
+                    SDL_PumpEvents();
+                    if ((p > 0) && SDL_HasEvents(SDL_FIRSTEVENT, SDL_LASTEVENT))
+                    {
+                        scheduler.cancel();
+                    }
+                }
+
+                complete = pass.get();
+                if (!complete)
+                {
+                    break;
+                }
 
                 /* Display the output */
                 cam->clip_image_to_bgr(screen_data.get());
@@ -765,6 +1120,19 @@ int main (int argc, char **argv)
                     return draw_status;
                 }
             }
+
+            /* Nothing changes until there is user input so wait for it after a complete frame */
+            if (complete)
+            {
+                do_next = cam_event_handler.wait_for_event();
+                if (do_next != 0)
+                {
+                    continue;
+                }
+            }
+
+            /* Poll for user input */
+            do_next = cam_event_handler.process_events();
         }
 
         /* SDL clean up */
@@ -773,8 +1141,32 @@ int main (int argc, char **argv)
     /* Produce a single image */
     else
     {
-        /* Ray trace the scene */
-        ray_tracer(&ssd, lights, everything, *cam);
+        /* Ray trace the scene, or have render farm workers trace it */
+        if (farm_coordinator)
+        {
+            raptor_raytracer::render_coordinator coordinator(farm_port, cam->x_number_of_rays(), cam->y_number_of_rays(), 1, 128);
+            std::cout << "Waiting for render farm workers on port " << coordinator.port() << std::endl;
+            const bool rendered = coordinator.run([cam](const raptor_raytracer::render_job &job, const ext_colour_t *pixels)
+            {
+                for (int y = job.t.y0; y < job.t.y1; ++y)
+                {
+                    for (int x = job.t.x0; x < job.t.x1; ++x)
+                    {
+                        cam->set_pixel(*pixels++, x, y);
+                    }
+                }
+            });
+
+            if (!rendered)
+            {
+                raptor_raytracer::scene_clean(&materials, cam);
+                return 1;
+            }
+        }
+        else
+        {
+            ray_tracer(ssd.get(), lights, everything, *cam, trace_mode);
+        }
         
         /* Tone mapping */
         //cam->tone_map(local_human_histogram, 0.75, (1.0/3.0), (1.0/3.0), false, false, false);
@@ -799,6 +1191,11 @@ int main (int argc, char **argv)
                 assert(!"Error unknown image format");
                 break;
         }
+
+#ifdef TRAVERSAL_STATISTICS
+        /* Output the work done tracing each pixel next to the image */
+        cam->write_traversal_heatmaps(output_file + "_0");
+#endif /* #ifdef TRAVERSAL_STATISTICS */
     }
 
     /* Clean up dynamic memory usage */
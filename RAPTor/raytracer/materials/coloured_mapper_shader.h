@@ -11,6 +11,7 @@
 namespace raptor_raytracer
 {
 /* Forward delcarations */
+class scene_cache;
 class secondary_ray_data;
 
 /* Child of material used to attach multiple texture mapper */
@@ -89,6 +90,8 @@ class coloured_mapper_shader : public material
         void combind_secondary_rays(const ray_trace_engine &r, ext_colour_t *const c, const secondary_ray_data &rl, const secondary_ray_data &rf) const override;
 
     private :
+        friend class scene_cache;
+
         const texture_mapper    *   t_ka;   /* Texture mapper to map Ka     */
         const texture_mapper    *   t_kd;   /* Texture mapper to map Kd     */
         const texture_mapper    *   t_ks;   /* Texture mapper to map Ks     */
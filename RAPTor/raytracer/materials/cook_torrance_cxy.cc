@@ -88,4 +88,105 @@ void cook_torrance_cxy::combind_secondary_rays(const ray_trace_engine &r, ext_co
 
     return;
 }
+
+
+void cook_torrance_cxy::shade_batch(const ray_trace_engine &r, ray *const i, const point_t<> *const n, const hit_description *const h, ext_colour_t *const *const c, 
+    const point_t<> *const vt, const int *const hits, const int nr) const
+{
+    const light_list &lights = r.get_scene_lights();
+    for (int b = 0; b < nr; b += SIMD_WIDTH)
+    {
+        /* Take SIMD_WIDTH hits, repeating the last to fill the vector */
+        const int lanes = std::min(SIMD_WIDTH, nr - b);
+        int lane[SIMD_WIDTH];
+        for (int j = 0; j < SIMD_WIDTH; ++j)
+        {
+            lane[j] = hits[b + std::min(j, lanes - 1)];
+        }
+
+        const vfp_t nx(gather_lanes(lane, [n](const int k) { return n[k].x; }));
+        const vfp_t ny(gather_lanes(lane, [n](const int k) { return n[k].y; }));
+        const vfp_t nz(gather_lanes(lane, [n](const int k) { return n[k].z; }));
+        const vfp_t ix(gather_lanes(lane, [i](const int k) { return i[k].get_x_grad(); }));
+        const vfp_t iy(gather_lanes(lane, [i](const int k) { return i[k].get_y_grad(); }));
+        const vfp_t iz(gather_lanes(lane, [i](const int k) { return i[k].get_z_grad(); }));
+        vfp_t cr(gather_lanes(lane, [c](const int k) { return c[k]->r; }));
+        vfp_t cg(gather_lanes(lane, [c](const int k) { return c[k]->g; }));
+        vfp_t cb(gather_lanes(lane, [c](const int k) { return c[k]->b; }));
+
+        /* A common dot product and Fresnel term to all light sources */
+        const vfp_t nv((nx * ix) + (ny * iy) + (nz * iz));
+        float f_lane[SIMD_WIDTH] __attribute__ ((aligned(SIMD_WIDTH * 4)));
+        for (int j = 0; j < SIMD_WIDTH; ++j)
+        {
+            f_lane[j] = schlick_fresnell(this->sr, nv[j], this->ri_i);
+        }
+        const vfp_t f(f_lane);
+
+        /* For each light shade the objects */
+        for (unsigned int l = 0; l < lights.size(); ++l)
+        {
+            /* Query the scene to see if this light is visiable */
+            const vfp_t lx(gather_lanes(lane, [&r, l](const int k) { return r.get_illumination(l, k).get_x_grad();    }));
+            const vfp_t ly(gather_lanes(lane, [&r, l](const int k) { return r.get_illumination(l, k).get_y_grad();    }));
+            const vfp_t lz(gather_lanes(lane, [&r, l](const int k) { return r.get_illumination(l, k).get_z_grad();    }));
+
+            /* Cos(angle between normal and the ray), ignore lanes where the surface is facing away from the ray */
+            const vfp_t shade((lx * nx) + (ly * ny) + (lz * nz));
+            const vfp_t lit(shade >= vfp_zero);
+            if (move_mask(lit) == 0)
+            {
+                continue;
+            }
+
+            /* Take the half vector and some common dot products */
+            const vfp_t hx((lx + ix) * vfp_t(0.5f));
+            const vfp_t hy((ly + iy) * vfp_t(0.5f));
+            const vfp_t hz((lz + iz) * vfp_t(0.5f));
+            const vfp_t nh((nx * hx) + (ny * hy) + (nz * hz));
+            const vfp_t vh((hx * ix) + (hy * iy) + (hz * iz));
+            const vfp_t nl(shade);
+
+            /* Geometric attenuation */
+            const vfp_t g0((vfp_t(2.0f) * nh * nv) / vh);
+            const vfp_t g1((vfp_t(2.0f) * nh * nl) / vh);
+            const vfp_t g(min(vfp_one, max(vfp_zero, min(g0, g1))));
+
+            /* There is no SIMD exp so the facet distribution is taken a lane at a time */
+            float ro[SIMD_WIDTH] __attribute__ ((aligned(SIMD_WIDTH * 4)));
+            for (int j = 0; j < SIMD_WIDTH; ++j)
+            {
+                ro[j] = gaussian_facet_distribution(nh[j], this->sr, 5.0f);
+            }
+
+            const vfp_t s(vfp_t(this->rs) * ((g * f * vfp_t(ro)) / (nl * nv)));
+
+            /* Convert from cxy to rgb and bound, as cxy_to_rgb */
+            const vfp_t m(gather_lanes(lane, [&r, l](const int k) { return r.get_illumination(l, k).get_magnitude(); }));
+            const vfp_t lum(shade * (vfp_t(this->rd) + s) * m);
+            const vfp_t cie_x((lum * vfp_t(this->x)) / vfp_t(this->y));
+            const vfp_t cie_z((lum * vfp_t(1.0f / this->y - 1.0f)) - cie_x);
+            const vfp_t rgb_r(max(vfp_zero, min(vfp_one, (vfp_t(xyz2rgbmat[0][0]) * cie_x) + (vfp_t(xyz2rgbmat[0][1]) * lum) + (vfp_t(xyz2rgbmat[0][2]) * cie_z))) * vfp_t(255.0f));
+            const vfp_t rgb_g(max(vfp_zero, min(vfp_one, (vfp_t(xyz2rgbmat[1][0]) * cie_x) + (vfp_t(xyz2rgbmat[1][1]) * lum) + (vfp_t(xyz2rgbmat[1][2]) * cie_z))) * vfp_t(255.0f));
+            const vfp_t rgb_b(max(vfp_zero, min(vfp_one, (vfp_t(xyz2rgbmat[2][0]) * cie_x) + (vfp_t(xyz2rgbmat[2][1]) * lum) + (vfp_t(xyz2rgbmat[2][2]) * cie_z))) * vfp_t(255.0f));
+
+            /* Add to the overall shading */
+            const vfp_t d(gather_lanes(lane, [&r, l](const int k) { return r.get_illumination(l, k).get_length(); }));
+            vfp_t ir;
+            vfp_t ig;
+            vfp_t ib;
+            lights[l].get_light_intensity(&ir, &ig, &ib, lx, ly, lz, d);
+            cr += (rgb_r * ir) & lit;
+            cg += (rgb_g * ig) & lit;
+            cb += (rgb_b * ib) & lit;
+        }
+
+        for (int j = 0; j < lanes; ++j)
+        {
+            c[lane[j]]->r = cr[j];
+            c[lane[j]]->g = cg[j];
+            c[lane[j]]->b = cb[j];
+        }
+    }
+}
 }; /* namespace raptor_raytracer */
@@ -0,0 +1,24 @@
+/* Standard headers */
+
+/* Boost headers */
+
+/* Common headers */
+
+/* Raytracer headers */
+#include "material.h"
+#include "raytracer.h"
+
+
+namespace raptor_raytracer
+{
+void material::shade_batch(const ray_trace_engine &r, ray *const i, const point_t<> *const n, const hit_description *const h, ext_colour_t *const *const c, 
+    const point_t<> *const vt, const int *const hits, const int nr) const
+{
+    for (int j = 0; j < nr; ++j)
+    {
+        const int k = hits[j];
+        r.shader_nr = k;
+        shade(r, i[k], n[k], h[k].h, c[k], vt[k]);
+    }
+}
+}; /* namespace raptor_raytracer */
@@ -3,6 +3,7 @@
 #include "common.h"
 #include "ext_colour_t.h"
 #include "point_t.h"
+#include "simd.h"
 
 
 namespace raptor_raytracer
@@ -59,6 +60,11 @@ class material
         /* Pure virtual function to the allow the shader a combined SIMD packets traced secondary rays into the image */
         virtual void combind_secondary_rays(const ray_trace_engine &r, ext_colour_t *const c, const secondary_ray_data &rl, const secondary_ray_data &rf) const = 0;
 
+        /* Shade the nr hits of this material listed in hits together. Hit k reads its illumination from shader k of r and */
+        /* is shaded into c[k]. By default each hit is shaded alone, materials may override this to shade SIMD_WIDTH at a time */
+        virtual void shade_batch(const ray_trace_engine &r, ray *const i, const point_t<> *const n, const hit_description *const h, ext_colour_t *const *const c, 
+            const point_t<> *const vt, const int *const hits, const int nr) const;
+
         /* Allow read transparency */
         const bool is_transparent() const { return t; }
 
@@ -66,6 +72,20 @@ class material
         const bool  t;  /* Is the material transparent */
 };
 
+/* Gather f(hit) from each of SIMD_WIDTH hits into a vector for batch shading */
+template<class F>
+inline vfp_t gather_lanes(const int *const hits, const F &f)
+{
+    float v[SIMD_WIDTH] __attribute__ ((aligned(SIMD_WIDTH * 4)));
+    for (int i = 0; i < SIMD_WIDTH; ++i)
+    {
+        v[i] = f(hits[i]);
+    }
+
+    return vfp_t(v);
+}
+
+
 /* Function for calculating the Fresnell componant */
 /**********************************************************
   direct_fresnell is a direct evaluation of the Fresnel term. This is
@@ -14,6 +14,18 @@ void phong_shader::generate_rays(const ray_trace_engine &r, ray &i, point_t<> *c
         r.generate_rays_to_light(i, h, l);
     }
     
+    /* Request reflections */
+    if (this->rf > 0.0f)
+    {
+        rl->number(i.reflect(rl->rays(), *n, this->rf, this->rfd));
+    }
+
+    /* Request refractions */
+    if (this->tran > 0.0f)
+    {
+        rf->number(i.refract(rf->rays(), *n, this->tran, this->ri, h, this->td));
+    }
+
     return;
 }
 
@@ -62,57 +74,101 @@ void phong_shader::shade(const ray_trace_engine &r, ray &i, const point_t<> &n,
     /* Add the ambient colour */
     /* Note Ka is stored in light_intensity in the format ( r, g, b ) */
     (*c) += this->ka;
-    
-    /* Reflect */
-    if (this->rf > 0.0f)
+}
+
+
+void phong_shader::combind_secondary_rays(const ray_trace_engine &r, ext_colour_t *const c, const secondary_ray_data &rl, const secondary_ray_data &rf) const
+{
+    /* Process reflection data */
+    if ((this->rf > 0.0f) && (rl.number() > 0.0f))
     {
-        ext_colour_t    average;
-        ray             rl[MAX_SECONDARY_RAYS];
-        
-        /* Ray reflection member */
-        float nr_rays = i.reflect(rl, n, this->rf, this->rfd);
-        
-        for (int i = 0; i< static_cast<int>(nr_rays); ++i)
-        {
-            ext_colour_t pixel;
-            r.ray_trace(rl[i], &pixel);
-            average += pixel;
-        }
+        (*c) += rl.average_colour() * this->rf;
+    }
 
-        /* Average the colours */
-        if (nr_rays > 0.0f)
-        {
-            (*c) += average * (this->rf / nr_rays);
-        }
+    /* Process refraction data */
+    if ((this->tran > 0.0f) && (rf.number() > 0.0f))
+    {
+        (*c) += rf.average_colour() * this->tran;
     }
 
-    /* Refract */
-    if (this->tran > 0.0f)
+    return;
+}
+
+
+void phong_shader::shade_batch(const ray_trace_engine &r, ray *const i, const point_t<> *const n, const hit_description *const h, ext_colour_t *const *const c, 
+    const point_t<> *const vt, const int *const hits, const int nr) const
+{
+    const light_list &lights = r.get_scene_lights();
+    for (int b = 0; b < nr; b += SIMD_WIDTH)
     {
-        ext_colour_t    average;
-        ray             rl[MAX_SECONDARY_RAYS];
-        
-        /* Ray refraction member */
-        float nr_rays = i.refract(rl, n, this->tran, this->ri, h, this->td);
-        
-        for (int i = 0; i< static_cast<int>(nr_rays); ++i)
+        /* Take SIMD_WIDTH hits, repeating the last to fill the vector */
+        const int lanes = std::min(SIMD_WIDTH, nr - b);
+        int lane[SIMD_WIDTH];
+        for (int j = 0; j < SIMD_WIDTH; ++j)
         {
-            ext_colour_t pixel;
-            r.ray_trace(rl[i], &pixel);
-            average += pixel;
+            lane[j] = hits[b + std::min(j, lanes - 1)];
         }
 
-        /* Average the colours */
-        if (nr_rays > 0.0f)
+        const vfp_t nx(gather_lanes(lane, [n](const int k) { return n[k].x; }));
+        const vfp_t ny(gather_lanes(lane, [n](const int k) { return n[k].y; }));
+        const vfp_t nz(gather_lanes(lane, [n](const int k) { return n[k].z; }));
+        const vfp_t ix(gather_lanes(lane, [i](const int k) { return i[k].get_x_grad(); }));
+        const vfp_t iy(gather_lanes(lane, [i](const int k) { return i[k].get_y_grad(); }));
+        const vfp_t iz(gather_lanes(lane, [i](const int k) { return i[k].get_z_grad(); }));
+        vfp_t cr(gather_lanes(lane, [c](const int k) { return c[k]->r; }));
+        vfp_t cg(gather_lanes(lane, [c](const int k) { return c[k]->g; }));
+        vfp_t cb(gather_lanes(lane, [c](const int k) { return c[k]->b; }));
+
+        /* For each light shade the objects */
+        for (unsigned int l = 0; l < lights.size(); ++l)
         {
-            (*c) += average * (this->tran / nr_rays);
-        }
-    }
-}
+            /* Query the scene to see if this light is visiable */
+            const vfp_t lx(gather_lanes(lane, [&r, l](const int k) { return r.get_illumination(l, k).get_x_grad();    }));
+            const vfp_t ly(gather_lanes(lane, [&r, l](const int k) { return r.get_illumination(l, k).get_y_grad();    }));
+            const vfp_t lz(gather_lanes(lane, [&r, l](const int k) { return r.get_illumination(l, k).get_z_grad();    }));
 
+            /* Cos(angle between normal and the ray), ignore lanes where the surface is facing away from the ray */
+            const vfp_t shade((lx * nx) + (ly * ny) + (lz * nz));
+            const vfp_t lit(shade >= vfp_zero);
+            if (move_mask(lit) == 0)
+            {
+                continue;
+            }
 
-void phong_shader::combind_secondary_rays(const ray_trace_engine &r, ext_colour_t *const c, const secondary_ray_data &rl, const secondary_ray_data &rf) const
-{
-    return;
+            /* Cos(angle between refelction and the ray) */
+            const vfp_t shade_x2(shade * vfp_t(2.0f));
+            const vfp_t ray_dot_reflection((ix * (lx - (nx * shade_x2))) + (iy * (ly - (ny * shade_x2))) + (iz * (lz - (nz * shade_x2))));
+
+            /* There is no SIMD pow so the specular power is taken a lane at a time */
+            float spec[SIMD_WIDTH] __attribute__ ((aligned(SIMD_WIDTH * 4)));
+            for (int j = 0; j < SIMD_WIDTH; ++j)
+            {
+                spec[j] = (ray_dot_reflection[j] > 0.0f) ? static_cast<float>(pow(ray_dot_reflection[j], this->s)) : 0.0f;
+            }
+            const vfp_t spec_v(spec);
+
+            /* Scale the diffuse and specular componants by the light intensity and visibility */
+            const vfp_t m(gather_lanes(lane, [&r, l](const int k) { return r.get_illumination(l, k).get_magnitude(); }));
+            const vfp_t d(gather_lanes(lane, [&r, l](const int k) { return r.get_illumination(l, k).get_length();    }));
+            vfp_t ir;
+            vfp_t ig;
+            vfp_t ib;
+            lights[l].get_light_intensity(&ir, &ig, &ib, lx, ly, lz, d);
+            cr += (ir * (((shade * vfp_t(this->kd.r)) + (spec_v * vfp_t(this->ks.r))) * m)) & lit;
+            cg += (ig * (((shade * vfp_t(this->kd.g)) + (spec_v * vfp_t(this->ks.g))) * m)) & lit;
+            cb += (ib * (((shade * vfp_t(this->kd.b)) + (spec_v * vfp_t(this->ks.b))) * m)) & lit;
+        }
+
+        /* Add the ambient colour */
+        cr += vfp_t(this->ka.r);
+        cg += vfp_t(this->ka.g);
+        cb += vfp_t(this->ka.b);
+        for (int j = 0; j < lanes; ++j)
+        {
+            c[lane[j]]->r = cr[j];
+            c[lane[j]]->g = cg[j];
+            c[lane[j]]->b = cb[j];
+        }
+    }
 }
 }; /* namespace raptor_raytracer */
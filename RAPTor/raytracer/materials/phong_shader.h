@@ -9,6 +9,9 @@
 
 namespace raptor_raytracer
 {
+/* Forward declarations */
+class scene_cache;
+
 /* Pure virtual class for material data and shading */
 class phong_shader : public material
 {
@@ -62,8 +65,14 @@ class phong_shader : public material
 
         /* Function to the allow the shader a combined SIMD packets traced secondary rays into the image */
         void combind_secondary_rays(const ray_trace_engine &r, ext_colour_t *const c, const secondary_ray_data &rl, const secondary_ray_data &rf) const override;
+
+        /* Shade SIMD_WIDTH hits at a time */
+        void shade_batch(const ray_trace_engine &r, ray *const i, const point_t<> *const n, const hit_description *const h, ext_colour_t *const *const c, 
+            const point_t<> *const vt, const int *const hits, const int nr) const override;
         
     private :
+        friend class scene_cache;
+
         const ext_colour_t  ka;     /* Ambient co-efficient         */
         const ext_colour_t  kd;     /* Diffuse co-efficient         */
         const ext_colour_t  ks;     /* Specular co-efficient        */
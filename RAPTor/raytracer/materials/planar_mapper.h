@@ -38,6 +38,10 @@ class planar_mapper : public image_texture_mapper
                 image_texture_mapper(img, c, point_t<>((u * s.x) + (v * s.y) + (n * s.z)), u, v, 1.0f / static_cast<float>(w), 1.0f / static_cast<float>(h), w, h, cpp, uw, vw, u_off, v_off, u_max, v_max), _n(n)
             {  };
 
+        planar_mapper(const cached_texture *const tex, const point_t<> &c, const point_t<> &n, const point_t<> &s, const texture_wrapping_mode_t uw, const texture_wrapping_mode_t vw) :
+            image_texture_mapper(tex, c, s, point_t<>(n.y + n.z, 0.0f, n.x), point_t<>(0.0f, n.x + n.z, n.y), 1.0f / static_cast<float>(tex->width()), 1.0f / static_cast<float>(tex->height()), uw, vw), _n(n)
+            {  };
+
         virtual ~planar_mapper() { };
     
     protected :
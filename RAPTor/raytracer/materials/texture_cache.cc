@@ -0,0 +1,321 @@
+/* Standard headers */
+#include <algorithm>
+
+/* System headers */
+#include <unistd.h>
+
+/* Common headers */
+#include "logging.h"
+
+/* Ray tracer headers */
+#include "texture_cache.h"
+#include "texture_mapper.h"
+#include "picture_functions.h"
+
+
+namespace raptor_raytracer
+{
+namespace
+{
+const int tile_size     = 1 << LOG2_TEXTURE_TILE_SIZE;
+const int tile_mask     = tile_size - 1;
+const int tile_texels   = tile_size * tile_size;
+
+/* Tiles each thread used last, checked before taking the cache lock */
+const int recent_tiles = 16;
+struct recent_tile
+{
+    std::uint64_t                   key = 0;
+    std::shared_ptr<const float>    data;
+};
+thread_local recent_tile recent[recent_tiles];
+
+/* Texture ids are unique across caches so a recent tile can never be mistaken for one of a new texture */
+std::atomic<std::uint64_t> next_texture_id(1);
+}
+
+
+cached_texture::cached_texture(texture_cache &c, const unsigned w, const unsigned h, const unsigned cpp, const long offset) :
+    _cache(c), _id(next_texture_id++), _offset(offset), _cpp(cpp)
+{
+    assert((w > 0) && (h > 0));
+
+    /* Halve the size, rounding up, until a single texel remains */
+    unsigned first_tile = 0;
+    unsigned lw = w;
+    unsigned lh = h;
+    while (true)
+    {
+        const unsigned tiles_x = (lw + tile_mask) >> LOG2_TEXTURE_TILE_SIZE;
+        const unsigned tiles_y = (lh + tile_mask) >> LOG2_TEXTURE_TILE_SIZE;
+        _levels.push_back({ lw, lh, tiles_x, first_tile });
+        first_tile += tiles_x * tiles_y;
+
+        if ((lw == 1) && (lh == 1))
+        {
+            break;
+        }
+
+        lw = (lw + 1) >> 1;
+        lh = (lh + 1) >> 1;
+    }
+}
+
+
+const float * cached_texture::tile_data(const int l, const int x, const int y) const
+{
+    assert((l >= 0) && (l < levels()));
+    assert((x >= 0) && (x < static_cast<int>(_levels[l].w)));
+    assert((y >= 0) && (y < static_cast<int>(_levels[l].h)));
+
+    /* Neighbouring lookups usually hit the same tile */
+    const level &lvl = _levels[l];
+    const unsigned tile = lvl.first_tile + (x >> LOG2_TEXTURE_TILE_SIZE) + ((y >> LOG2_TEXTURE_TILE_SIZE) * lvl.tiles_x);
+    const std::uint64_t key = (_id << 32) | tile;
+    recent_tile &r = recent[(tile ^ _id) & (recent_tiles - 1)];
+    if (r.key != key)
+    {
+        r.data  = _cache.tile(*this, tile);
+        r.key   = key;
+    }
+
+    return r.data.get();
+}
+
+
+void cached_texture::texel(float *const t, const int l, const int x, const int y) const
+{
+    const float *const d = tile_data(l, x, y) + (((x & tile_mask) + ((y & tile_mask) << LOG2_TEXTURE_TILE_SIZE)) * _cpp);
+    for (unsigned i = 0; i < _cpp; ++i)
+    {
+        t[i] = d[i];
+    }
+}
+
+
+void cached_texture::quad(float *const t, const int l, const int x0, const int y0, const int x1, const int y1) const
+{
+    /* Split over tiles, look each texel up */
+    if (((x0 ^ x1) | (y0 ^ y1)) >> LOG2_TEXTURE_TILE_SIZE)
+    {
+        texel(&t[0        ], l, x0, y0);
+        texel(&t[_cpp     ], l, x1, y0);
+        texel(&t[_cpp << 1], l, x0, y1);
+        texel(&t[_cpp * 3 ], l, x1, y1);
+        return;
+    }
+
+    /* In one tile */
+    const float *const d = tile_data(l, x0, y0);
+    const int a[4] = { (x0 & tile_mask) + ((y0 & tile_mask) << LOG2_TEXTURE_TILE_SIZE), (x1 & tile_mask) + ((y0 & tile_mask) << LOG2_TEXTURE_TILE_SIZE),
+                       (x0 & tile_mask) + ((y1 & tile_mask) << LOG2_TEXTURE_TILE_SIZE), (x1 & tile_mask) + ((y1 & tile_mask) << LOG2_TEXTURE_TILE_SIZE) };
+    for (int j = 0; j < 4; ++j)
+    {
+        for (unsigned i = 0; i < _cpp; ++i)
+        {
+            t[(j * _cpp) + i] = d[(a[j] * _cpp) + i];
+        }
+    }
+}
+
+
+texture_cache::texture_cache(const std::size_t budget) :
+    _spill(std::tmpfile()), _spill_size(0), _budget(budget), _resident(0), _tile_reads(0), _pixel_spread(0.0f)
+{
+    if (_spill == nullptr)
+    {
+        BOOST_LOG_TRIVIAL(error) << "Cannot create texture cache spill file";
+        assert(!"Cannot create texture cache spill file");
+    }
+}
+
+
+texture_cache::~texture_cache()
+{
+    if (_spill != nullptr)
+    {
+        std::fclose(_spill);
+    }
+}
+
+
+texture_cache & texture_cache::global()
+{
+    static texture_cache cache;
+    return cache;
+}
+
+
+const cached_texture * texture_cache::load(const std::string &f, const bool invert)
+{
+    /* Check if loaded */
+    const std::string name(f + (invert ? "_inv" : ""));
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        const auto found = _textures.find(name);
+        if (found != _textures.end())
+        {
+            return found->second.get();
+        }
+    }
+
+    /* Decode the image, only the tiles are kept */
+    BOOST_LOG_TRIVIAL(info) << "Reading: " << f;
+    float *img;
+    unsigned h;
+    unsigned w;
+    const unsigned cpp = read_image_file(&img, f, &h, &w);
+    const std::unique_ptr<float []> img_owner(img);
+    if (invert)
+    {
+        negative(img, cpp * h * w);
+    }
+
+    return add(name, img, w, h, cpp);
+}
+
+
+const cached_texture * texture_cache::add(const std::string &name, const float *const img, const unsigned w, const unsigned h, const unsigned cpp)
+{
+    assert((cpp == 1) || (cpp == 3) || (cpp == 4));
+
+    std::lock_guard<std::mutex> guard(_lock);
+    const auto found = _textures.find(name);
+    if (found != _textures.end())
+    {
+        return found->second.get();
+    }
+
+    /* Box filter each level from the last and write it out */
+    std::unique_ptr<cached_texture> tex(new cached_texture(*this, w, h, cpp, _spill_size));
+    write_tiles(*tex, 0, img);
+
+    std::vector<float> prev;
+    std::vector<float> next;
+    const float *src = img;
+    for (int l = 1; l < tex->levels(); ++l)
+    {
+        const int sw = tex->width(l - 1);
+        const int sh = tex->height(l - 1);
+        const int dw = tex->width(l);
+        const int dh = tex->height(l);
+        next.resize(dw * dh * cpp);
+        for (int y = 0; y < dh; ++y)
+        {
+            const int y0 = (y << 1) * sw;
+            const int y1 = std::min((y << 1) + 1, sh - 1) * sw;
+            for (int x = 0; x < dw; ++x)
+            {
+                const int x0 = x << 1;
+                const int x1 = std::min((x << 1) + 1, sw - 1);
+                for (unsigned i = 0; i < cpp; ++i)
+                {
+                    next[(((y * dw) + x) * cpp) + i] = (src[((y0 + x0) * cpp) + i] + src[((y0 + x1) * cpp) + i] +
+                        src[((y1 + x0) * cpp) + i] + src[((y1 + x1) * cpp) + i]) * 0.25f;
+                }
+            }
+        }
+
+        write_tiles(*tex, l, next.data());
+        prev.swap(next);
+        src = prev.data();
+    }
+
+    /* Tiles are read with pread so must be out of the stdio buffer */
+    std::fflush(_spill);
+    return _textures.emplace(name, std::move(tex)).first->second.get();
+}
+
+
+texture_cache & texture_cache::budget(const std::size_t b)
+{
+    std::lock_guard<std::mutex> guard(_lock);
+    _budget = b;
+    evict(0);
+    return *this;
+}
+
+
+texture_cache::tile_ptr texture_cache::tile(const cached_texture &x, const unsigned t)
+{
+    const std::uint64_t key = (x._id << 32) | t;
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        const auto found = _tiles.find(key);
+        if (found != _tiles.end())
+        {
+            _lru.splice(_lru.begin(), _lru, found->second.lru);
+            return found->second.data;
+        }
+    }
+
+    /* Read outside the lock so other threads can carry on */
+    const std::size_t bytes = tile_texels * x._cpp * sizeof(float);
+    std::shared_ptr<float> data(new float [tile_texels * x._cpp], std::default_delete<float []>());
+    const ssize_t read = pread(fileno(_spill), data.get(), bytes, x._offset + (t * bytes));
+    if (read != static_cast<ssize_t>(bytes))
+    {
+        BOOST_LOG_TRIVIAL(error) << "Cannot read texture tile " << t;
+        assert(!"Cannot read texture tile");
+        std::fill(data.get(), data.get() + (tile_texels * x._cpp), 0.0f);
+    }
+    ++_tile_reads;
+
+    /* If another thread read the tile meanwhile keep theirs */
+    std::lock_guard<std::mutex> guard(_lock);
+    const auto found = _tiles.find(key);
+    if (found != _tiles.end())
+    {
+        _lru.splice(_lru.begin(), _lru, found->second.lru);
+        return found->second.data;
+    }
+
+    evict(bytes);
+    _lru.push_front(key);
+    _tiles.emplace(key, tile_entry{ data, _lru.begin(), bytes });
+    _resident += bytes;
+    return data;
+}
+
+
+void texture_cache::evict(const std::size_t s)
+{
+    while (!_lru.empty() && ((_resident + s) > _budget))
+    {
+        const auto found = _tiles.find(_lru.back());
+        _resident -= found->second.bytes;
+        _tiles.erase(found);
+        _lru.pop_back();
+    }
+}
+
+
+void texture_cache::write_tiles(const cached_texture &x, const int l, const float *const img)
+{
+    /* Edge tiles are padded to full size so every tile of a texture is the same size */
+    const int w = x.width(l);
+    const int h = x.height(l);
+    const int row = tile_size * x._cpp;
+    std::vector<float> tile(tile_texels * x._cpp);
+    for (int ty = 0; ty < h; ty += tile_size)
+    {
+        for (int tx = 0; tx < w; tx += tile_size)
+        {
+            std::fill(tile.begin(), tile.end(), 0.0f);
+            const int tw = std::min(tile_size, w - tx);
+            const int th = std::min(tile_size, h - ty);
+            for (int y = 0; y < th; ++y)
+            {
+                std::copy(&img[(((ty + y) * w) + tx) * x._cpp], &img[(((ty + y) * w) + tx + tw) * x._cpp], &tile[y * row]);
+            }
+
+            if (std::fwrite(tile.data(), sizeof(float), tile.size(), _spill) != tile.size())
+            {
+                BOOST_LOG_TRIVIAL(error) << "Cannot write texture tile";
+                assert(!"Cannot write texture tile");
+            }
+            _spill_size += tile.size() * sizeof(float);
+        }
+    }
+}
+}; /* namespace raptor_raytracer */
@@ -0,0 +1,129 @@
+#pragma once
+
+/* Standard headers */
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/* Boost headers */
+#include "boost/noncopyable.hpp"
+
+/* Common headers */
+#include "common.h"
+
+
+namespace raptor_raytracer
+{
+/* Forward declarations */
+class texture_cache;
+
+/* A mip mapped image held by a texture_cache. Level 0 is the full image and each level after it is half the size of the last
+   down to 1 by 1. Texels are fetched through the cache which loads their tiles on demand */
+class cached_texture : private boost::noncopyable
+{
+    public :
+        /* Access functions */
+        unsigned        width(const int l = 0)  const { return _levels[l].w;    }
+        unsigned        height(const int l = 0) const { return _levels[l].h;    }
+        unsigned        components()            const { return _cpp;            }
+        int             levels()                const { return _levels.size();  }
+        texture_cache & cache()                 const { return _cache;          }
+
+        /* Fetch the texel at x, y of level l into t, which must hold components() floats */
+        void texel(float *const t, const int l, const int x, const int y) const;
+
+        /* Fetch the texels at x0, y0, x1, y0, x0, y1 and x1, y1 of level l for bilinear filtering into t, which must hold
+           4 * components() floats */
+        void quad(float *const t, const int l, const int x0, const int y0, const int x1, const int y1) const;
+
+    private :
+        friend class texture_cache;
+
+        struct level
+        {
+            unsigned    w;
+            unsigned    h;
+            unsigned    tiles_x;
+            unsigned    first_tile;
+        };
+
+        cached_texture(texture_cache &c, const unsigned w, const unsigned h, const unsigned cpp, const long offset);
+
+        /* Get the data of the tile holding x, y of level l */
+        const float * tile_data(const int l, const int x, const int y) const;
+
+        texture_cache &     _cache;     /* The cache holding the tiles                  */
+        std::vector<level>  _levels;    /* Size and first tile of each mip level        */
+        const std::uint64_t _id;        /* Unique id, keys the tiles in the cache       */
+        const long          _offset;    /* Offset of the first tile in the spill file   */
+        const unsigned      _cpp;       /* Componants per pixel                         */
+};
+
+/* Shared store of image textures. Images are decoded once, filtered into a mip pyramid and written out as square tiles to a
+   spill file, only the tiles that are looked up are read back. Tiles are kept in memory up to a budget and the least
+   recently used are evicted first. Each thread also holds on to the last few tiles it used so coherent lookups dont take
+   the lock, these may keep a handful of evicted tiles alive per thread */
+class texture_cache : private boost::noncopyable
+{
+    public :
+        explicit texture_cache(const std::size_t budget = TEXTURE_CACHE_BUDGET);
+        ~texture_cache();
+
+        /* The cache the parsers load textures into */
+        static texture_cache & global();
+
+        /* Find or load the image file f, invert stores the negative of the image */
+        const cached_texture * load(const std::string &f, const bool invert = false);
+
+        /* Find or add the already decoded image img with w by h pixels of cpp components */
+        const cached_texture * add(const std::string &name, const float *const img, const unsigned w, const unsigned h, const unsigned cpp);
+
+        /* Memory budget for tiles in bytes, shrinking it evicts immediately */
+        texture_cache & budget(const std::size_t b);
+        std::size_t budget()    const { return _budget;             }
+        std::size_t resident()  const { return _resident;           }
+        std::size_t tile_reads() const { return _tile_reads.load(); }
+
+        /* Angle between the rays through neighbouring pixels. Textures are filtered over the width this cone of rays covers */
+        texture_cache & pixel_spread(const float s) { _pixel_spread = s; return *this; }
+        float pixel_spread() const { return _pixel_spread; }
+
+    private :
+        friend class cached_texture;
+
+        typedef std::shared_ptr<const float> tile_ptr;
+        struct tile_entry
+        {
+            tile_ptr                            data;
+            std::list<std::uint64_t>::iterator  lru;
+            std::size_t                         bytes;
+        };
+
+        /* Get tile t of texture x, reading it from the spill file if needed */
+        tile_ptr tile(const cached_texture &x, const unsigned t);
+
+        /* Evict tiles until there is space for s bytes, the lock must be held */
+        void evict(const std::size_t s);
+
+        /* Write level l of x from the image img in tiles to the end of the spill file, the lock must be held */
+        void write_tiles(const cached_texture &x, const int l, const float *const img);
+
+        std::map<std::string, std::unique_ptr<cached_texture>>  _textures;      /* Textures by name                     */
+        std::unordered_map<std::uint64_t, tile_entry>           _tiles;         /* Resident tiles by key                */
+        std::list<std::uint64_t>                                _lru;           /* Tile keys most recently used first   */
+        std::mutex                                              _lock;          /* Guards everything above              */
+        std::FILE *                                             _spill;         /* Tiles of all textures                */
+        long                                                    _spill_size;    /* Bytes written to the spill file      */
+        std::size_t                                             _budget;        /* Bytes of tiles to keep resident      */
+        std::size_t                                             _resident;      /* Bytes of tiles resident              */
+        std::atomic<std::size_t>                                _tile_reads;    /* Tiles read from the spill file       */
+        float                                                   _pixel_spread;  /* Angle between neighbouring pixels    */
+};
+}; /* namespace raptor_raytracer */
@@ -13,6 +13,7 @@
 #include "ray.h"
 #include "ext_colour_t.h"
 #include "mapper_falloff.h"
+#include "texture_cache.h"
 
 /* C style headers */
 extern "C"
@@ -114,11 +115,18 @@ class image_texture_mapper : public texture_mapper
             const unsigned int w, const unsigned int h, const unsigned int cpp, const texture_wrapping_mode_t uw, const texture_wrapping_mode_t vw,
             const int u_off = 0, const int v_off = 0, const int u_max = -1, const int v_max = -1) : 
                 texture_mapper(), _img(img), _c(c), _s(s), _u(u), _v(v), _u_ps(std::fabs(dot_product(_s, _u)) * u_ps), _v_ps(std::fabs(dot_product(_s, _v)) * v_ps), _h(h), _w(w), _cpp(cpp), _u_max(u_max < 0 ? w : u_max), _v_max(v_max < 0 ? h : v_max),
-                _u_off(u_off), _v_off(v_off), _uw(uw), _vw(vw)
+                _u_off(u_off), _v_off(v_off), _uw(uw), _vw(vw), _tex(nullptr), _texel_density(texel_density())
             { 
                 assert((_cpp == 1) || (_cpp == 3) || (_cpp == 4));
             }
 
+        /* Mapper of a texture held in a texture_cache. The image is mip mapped and filtered over the footprint of the ray */
+        image_texture_mapper(const cached_texture *const tex, const point_t<> &c, const point_t<> &s, const point_t<> &u, const point_t<> &v, const float u_ps, const float v_ps,
+            const texture_wrapping_mode_t uw, const texture_wrapping_mode_t vw, const int u_off = 0, const int v_off = 0) : 
+                texture_mapper(), _c(c), _s(s), _u(u), _v(v), _u_ps(std::fabs(dot_product(_s, _u)) * u_ps), _v_ps(std::fabs(dot_product(_s, _v)) * v_ps), _h(tex->height()), _w(tex->width()), _cpp(tex->components()), _u_max(_w), _v_max(_h),
+                _u_off(u_off), _v_off(v_off), _uw(uw), _vw(vw), _tex(tex), _texel_density(texel_density())
+            {  }
+
         virtual ~image_texture_mapper() { };
 
     protected :
@@ -162,7 +170,14 @@ class image_texture_mapper : public texture_mapper
             }
 
             /* Texel lookup */
-            texel_lookup(c, u_co, v_co, u0, v0);
+            if (_tex == nullptr)
+            {
+                texel_lookup(c, u_co, v_co, u0, v0);
+            }
+            else
+            {
+                cached_lookup(c, u_co, v_co, u0, v0, level_of_detail(r, n, vt));
+            }
 
             return 1.0f;
         }
@@ -207,7 +222,14 @@ class image_texture_mapper : public texture_mapper
 
             /* Texel lookup */
             ext_colour_t c;
-            texel_lookup(&c, u_co, v_co, u0, v0);
+            if (_tex == nullptr)
+            {
+                texel_lookup(&c, u_co, v_co, u0, v0);
+            }
+            else
+            {
+                cached_lookup(&c, u_co, v_co, u0, v0, level_of_detail(r, n, vt));
+            }
 
             /* Average down from rgb image */
             p->x = x_off * _u_ps;
@@ -240,8 +262,100 @@ class image_texture_mapper : public texture_mapper
         const int                       _v_off; /* V offset to be added to every pixel  */
         const texture_wrapping_mode_t   _uw;    /* U wrapping mode                      */
         const texture_wrapping_mode_t   _vw;    /* V wrapping mode                      */
+        const cached_texture *          _tex;   /* Cached image data, if not in _img    */
+        const float                     _texel_density; /* Texels per unit length of the mapping */
 
     private :
+        /* Texels per unit of world space of the mapping, 0 if the mapping has no size */
+        float texel_density() const
+        {
+            const float su = std::fabs(dot_product(_s, _u));
+            const float sv = std::fabs(dot_product(_s, _v));
+            return ((su > 0.0f) && (sv > 0.0f)) ? std::sqrt((_w / su) * (_h / sv)) : 0.0f;
+        }
+
+        /* Mip level to sample for the hit of r on a surface with normal n. The width of the cone of rays through a pixel
+           is stretched across the surface at the hit and converted to texels, vt.z holds the texture co-ordinates per unit
+           of world space when vt is interpolated */
+        float level_of_detail(const ray &r, const point_t<> &n, const point_t<> &vt) const
+        {
+            const float density = (vt.x != MAX_DIST) ? (vt.z * std::sqrt(static_cast<float>(_w * _h))) : _texel_density;
+            const float cos_theta = std::max(std::fabs(dot_product(r.get_dir(), n)), 0.01f);
+            const float footprint = (_tex->cache().pixel_spread() * r.get_length() * density) / cos_theta;
+            return (footprint > 1.0f) ? std::min(std::log2(footprint), static_cast<float>(_tex->levels() - 1)) : 0.0f;
+        }
+
+        /* Bilinear lookup in level l of the cached image, u0 and v0 are u_co and v_co rounded down and wrapped */
+        void cached_bilinear(ext_colour_t *const c, const int l, const float u_co, const float v_co, const int u0, const int v0) const
+        {
+            const int w = _tex->width(l);
+            const int h = _tex->height(l);
+            const int u1 = std::min(u0 + 1, w - 1);
+            const int v1 = std::min(v0 + 1, h - 1);
+
+            /* Calculate weights */
+            const float fu = u_co - std::floor(u_co);
+            const float fv = v_co - std::floor(v_co);
+            const float w0 = (1.0f - fu) * (1.0f - fv);
+            const float w1 = fu * (1.0f - fv);
+            const float w2 = fv * (1.0f - fu);
+            const float w3 = fu * fv;
+
+            /* Weight and return */
+            float t[16];
+            _tex->quad(t, l, u0, v0, u1, v1);
+            const float *const t0 = &t[0];
+            const float *const t1 = &t[_cpp];
+            const float *const t2 = &t[_cpp << 1];
+            const float *const t3 = &t[_cpp * 3];
+            if (_cpp != 1)
+            {
+                (*c) = (ext_colour_t(t0[0], t0[1], t0[2]) * w0) + (ext_colour_t(t1[0], t1[1], t1[2]) * w1) + (ext_colour_t(t2[0], t2[1], t2[2]) * w2) + (ext_colour_t(t3[0], t3[1], t3[2]) * w3);
+            }
+            else
+            {
+                c->r = (t0[0] * w0) + (t1[0] * w1) + (t2[0] * w2) + (t3[0] * w3);
+                c->g = c->r;
+                c->b = c->r;
+            }
+        }
+
+        /* Trilinear lookup in the cached image at level of detail lod, u0 and v0 are u_co and v_co rounded down and wrapped */
+        void cached_lookup(ext_colour_t *const c, const float u_co, const float v_co, const int u0, const int v0, const float lod) const
+        {
+            /* Magnified, just level 0 */
+            if (lod <= 0.0f)
+            {
+                cached_bilinear(c, 0, u_co, v_co, u0, v0);
+                return;
+            }
+
+            /* Wrap once in level 0 so every level wraps the same way */
+            const float u_w = u0 + (u_co - std::floor(u_co));
+            const float v_w = v0 + (v_co - std::floor(v_co));
+
+            /* Blend the levels either side of lod */
+            const int l = static_cast<int>(lod);
+            const float f = lod - l;
+            cached_level(c, l, u_w, v_w);
+            if ((f > 0.0f) && ((l + 1) < _tex->levels()))
+            {
+                ext_colour_t c1;
+                cached_level(&c1, l + 1, u_w, v_w);
+                (*c) = ((*c) * (1.0f - f)) + (c1 * f);
+            }
+        }
+
+        /* Bilinear lookup in level l with u_w and v_w wrapped into level 0 */
+        void cached_level(ext_colour_t *const c, const int l, const float u_w, const float v_w) const
+        {
+            const float u_l = u_w * (static_cast<float>(_tex->width(l))  / static_cast<float>(_w));
+            const float v_l = v_w * (static_cast<float>(_tex->height(l)) / static_cast<float>(_h));
+            const int u0 = std::min(static_cast<int>(u_l), static_cast<int>(_tex->width(l))  - 1);
+            const int v0 = std::min(static_cast<int>(v_l), static_cast<int>(_tex->height(l)) - 1);
+            cached_bilinear(c, l, u_l, v_l, u0, v0);
+        }
+
         void texel_lookup(ext_colour_t *const c, const float u_co, const float v_co, const int u0, const int v0) const
         {
             /* Calculate upper coordinate */
@@ -70,25 +70,40 @@ class packet_ray
         
         vfp_t pack(const ray *const *const r)
         {
-            this->ogn[0]    = vfp_t(r[0]->get_x0(), r[1]->get_x0(), r[2]->get_x0(), r[3]->get_x0());
-            this->ogn[1]    = vfp_t(r[0]->get_y0(), r[1]->get_y0(), r[2]->get_y0(), r[3]->get_y0());
-            this->ogn[2]    = vfp_t(r[0]->get_z0(), r[1]->get_z0(), r[2]->get_z0(), r[3]->get_z0());
+            /* Gather the rays by component */
+            float data[12][SIMD_WIDTH] __attribute__ ((aligned(SIMD_WIDTH * 4)));
+            for (int i = 0; i < SIMD_WIDTH; ++i)
+            {
+                data[ 0][i] = r[i]->get_x0();
+                data[ 1][i] = r[i]->get_y0();
+                data[ 2][i] = r[i]->get_z0();
+                data[ 3][i] = r[i]->get_x_grad();
+                data[ 4][i] = r[i]->get_y_grad();
+                data[ 5][i] = r[i]->get_z_grad();
+                data[ 6][i] = r[i]->get_x1();
+                data[ 7][i] = r[i]->get_y1();
+                data[ 8][i] = r[i]->get_z1();
+                data[ 9][i] = r[i]->get_magnitude();
+                data[10][i] = static_cast<float>(r[i]->get_componant());
+                data[11][i] = r[i]->get_length();
+            }
+
+            this->ogn[0]    = vfp_t(data[0]);
+            this->ogn[1]    = vfp_t(data[1]);
+            this->ogn[2]    = vfp_t(data[2]);
 
-            this->dir[0]    = vfp_t(r[0]->get_x_grad(), r[1]->get_x_grad(), r[2]->get_x_grad(), r[3]->get_x_grad());
-            this->dir[1]    = vfp_t(r[0]->get_y_grad(), r[1]->get_y_grad(), r[2]->get_y_grad(), r[3]->get_y_grad());
-            this->dir[2]    = vfp_t(r[0]->get_z_grad(), r[1]->get_z_grad(), r[2]->get_z_grad(), r[3]->get_z_grad());
+            this->dir[0]    = vfp_t(data[3]);
+            this->dir[1]    = vfp_t(data[4]);
+            this->dir[2]    = vfp_t(data[5]);
 
-            this->dst[0]    = vfp_t(r[0]->get_x1(), r[1]->get_x1(), r[2]->get_x1(), r[3]->get_x1());
-            this->dst[1]    = vfp_t(r[0]->get_y1(), r[1]->get_y1(), r[2]->get_y1(), r[3]->get_y1());
-            this->dst[2]    = vfp_t(r[0]->get_z1(), r[1]->get_z1(), r[2]->get_z1(), r[3]->get_z1());
+            this->dst[0]    = vfp_t(data[6]);
+            this->dst[1]    = vfp_t(data[7]);
+            this->dst[2]    = vfp_t(data[8]);
             
-            this->magn      = vfp_t(r[0]->get_magnitude(), r[1]->get_magnitude(), r[2]->get_magnitude(), r[3]->get_magnitude());
-            this->componant = vfp_t(static_cast<float>(r[0]->get_componant()), 
-                                    static_cast<float>(r[1]->get_componant()), 
-                                    static_cast<float>(r[2]->get_componant()), 
-                                    static_cast<float>(r[3]->get_componant()));
+            this->magn      = vfp_t(data[9]);
+            this->componant = vfp_t(data[10]);
 
-            return vfp_t(r[0]->get_length(), r[1]->get_length(), r[2]->get_length(), r[3]->get_length());
+            return vfp_t(data[11]);
         }
         
         
@@ -124,25 +139,14 @@ class packet_ray
             const float *magn  = this->magn;
             const float *comp  = this->componant;
             
-            r[0].set_up(point_t(ogn_x[0], ogn_y[0], ogn_z[0]), 
-                        point_t(dst_x[0], dst_y[0], dst_z[0]), 
-                        point_t(dir_x[0], dir_y[0], dir_z[0]), 
-                        len[0], magn[0], (int)comp[0]);
-                       
-            r[1].set_up(point_t(ogn_x[1], ogn_y[1], ogn_z[1]), 
-                        point_t(dst_x[1], dst_y[1], dst_z[1]), 
-                        point_t(dir_x[1], dir_y[1], dir_z[1]), 
-                        len[1], magn[1], (int)comp[1]);
-                       
-            r[2].set_up(point_t(ogn_x[2], ogn_y[2], ogn_z[2]), 
-                        point_t(dst_x[2], dst_y[2], dst_z[2]), 
-                        point_t(dir_x[2], dir_y[2], dir_z[2]), 
-                        len[2], magn[2], (int)comp[2]);
-                       
-            r[3].set_up(point_t(ogn_x[3], ogn_y[3], ogn_z[3]), 
-                        point_t(dst_x[3], dst_y[3], dst_z[3]), 
-                        point_t(dir_x[3], dir_y[3], dir_z[3]), 
-                        len[3], magn[3], (int)comp[3]);
+            for (int i = 0; i < SIMD_WIDTH; ++i)
+            {
+                r[i].set_up(point_t(ogn_x[i], ogn_y[i], ogn_z[i]), 
+                            point_t(dst_x[i], dst_y[i], dst_z[i]), 
+                            point_t(dir_x[i], dir_y[i], dir_z[i]), 
+                            len[i], magn[i], (int)comp[i]);
+            }
+
             return *this;
         }
         
@@ -181,10 +185,11 @@ struct packet_hit_description
         const float *fp_v = this->v;
         const float *fp_d = this->d;
 
-        h[0] = hit_description(fp_d[0], hit_t::miss, fp_u[0], fp_v[0]);
-        h[1] = hit_description(fp_d[1], hit_t::miss, fp_u[1], fp_v[1]);
-        h[2] = hit_description(fp_d[2], hit_t::miss, fp_u[2], fp_v[2]);
-        h[3] = hit_description(fp_d[3], hit_t::miss, fp_u[3], fp_v[3]);
+        for (int i = 0; i < SIMD_WIDTH; ++i)
+        {
+            h[i] = hit_description(fp_d[i], hit_t::miss, fp_u[i], fp_v[i]);
+        }
+
         return *this;
     }
 
@@ -251,43 +256,62 @@ extern const packet_ray_to_pixel packet_ray_to_pixel_lut;
  (x,y) co-rodinates are looked up based of the packet
  address 'i'. This address should be added to packet 0
  (x,y) co-rodinates.
+
+ The offset of each lane of the vector is also provided
+ and should be added to the packets (x,y) co-ordinates.
 **********************************************************/
 class packet_ray_to_co_ordinate
 {
     public :
         packet_ray_to_co_ordinate()
         {
-            const unsigned int pkt_width = (unsigned int)std::sqrt(static_cast<float>(MAXIMUM_PACKET_SIZE)) >> 1;
-
             /* Foreach the biggest packet size */
             for (unsigned int i = 0; i < MAXIMUM_PACKET_SIZE; i++)
             {
-                /* Generate x, y addresses so any sub range forms a valid packet */
-                unsigned int x = 0;
-                unsigned int y = 0;
-                
-                unsigned int addr = i << 1;
-                unsigned int mask = 0x2;
-                for (unsigned int j = 0; j < pkt_width; j++)
-                {
-                    x += (addr & mask);
-                    addr >>= 1;
-                    
-                    y += (addr & mask);
-                    mask <<= 1;
-                }
-                
-                this->x_lut[i] = x;
-                this->y_lut[i] = y;
-            }       
+                /* Generate x, y addresses of the first ray of the packet so any sub range forms a valid packet */
+                morton_decode(i << LOG2_SIMD_WIDTH, &this->x_lut[i], &this->y_lut[i]);
+            }
+
+            /* Foreach lane of the vector */
+            float x_lane[SIMD_WIDTH] __attribute__ ((aligned(SIMD_WIDTH * 4)));
+            float y_lane[SIMD_WIDTH] __attribute__ ((aligned(SIMD_WIDTH * 4)));
+            for (unsigned int i = 0; i < SIMD_WIDTH; i++)
+            {
+                unsigned int x;
+                unsigned int y;
+                morton_decode(i, &x, &y);
+                x_lane[i] = static_cast<float>(x);
+                y_lane[i] = static_cast<float>(y);
+            }
+
+            this->x_lane = vfp_t(&x_lane[0]);
+            this->y_lane = vfp_t(&y_lane[0]);
         }
         
         
         /* Look up */
         unsigned int x_offset(unsigned int i) const { return this->x_lut[i];    }
         unsigned int y_offset(unsigned int i) const { return this->y_lut[i];    }
+        const vfp_t& x_lane_offset()          const { return this->x_lane;      }
+        const vfp_t& y_lane_offset()          const { return this->y_lane;      }
 
     private :
+        /* Split the bits of a ray address between x and y */
+        static void morton_decode(unsigned int addr, unsigned int *const x, unsigned int *const y)
+        {
+            *x = 0;
+            *y = 0;
+            for (unsigned int mask = 0x1; addr != 0; mask <<= 1)
+            {
+                *x += (addr & mask);
+                addr >>= 1;
+                
+                *y += (addr & mask);
+            }
+        }
+
+        vfp_t        x_lane;
+        vfp_t        y_lane;
         unsigned int x_lut[MAXIMUM_PACKET_SIZE];
         unsigned int y_lut[MAXIMUM_PACKET_SIZE];
 };
@@ -119,17 +119,13 @@ void cfg_parser(
                 break;
             
             case model_format_t::obj :
-                input_stream.open(input_file.c_str());
-                assert(input_stream.is_open());
                 last_slash  = input_file.find_last_of('/');
                 path        = input_file.substr(0, last_slash + 1);
-                obj_parser(input_stream, path, l, e, m, c);
+                obj_parser(input_file, path, l, e, m, c);
                 break;
 
             case model_format_t::ply :
-                input_stream.open(input_file.c_str());
-                assert(input_stream.is_open());
-                ply_parser(input_stream, l, e, m, c);
+                ply_parser(input_file, l, e, m, c);
                 break;
 
             default :
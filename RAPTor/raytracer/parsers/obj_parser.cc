@@ -1,5 +1,7 @@
 #include "common.h"
 #include "parser_common.h"
+#include "chunked_parser.h"
+#include "mapped_file.h"
 #include "polygon_to_triangles.h"
 
 #include "camera.h"
@@ -12,6 +14,7 @@
 /* Texture mappers */
 #include "coloured_mapper_shader.h"
 #include "planar_mapper.h"
+#include "texture_cache.h"
 
 
 namespace raptor_raytracer
@@ -75,75 +78,106 @@ bool is_triplet_delimiter(const char **c)
 }
 
 
-void parse_f_statement(light_list *l, primitive_store *e, std::vector<point_t<>> &vt, std::vector<point_t<>> &vn, std::vector<point_t<>> &v, material *const m, const char **c)
+/* Face indices are appended to f as the number of vertices, then the vertex, texture co-ordinate and normal index of each */
+/* Missing texture co-ordinates and normals are -1. v_size, vt_size and vn_size are the number of each parsed before the face */
+void parse_f_statement(std::vector<int> *const f, const int v_size, const int vt_size, const int vn_size, const char **c)
 {
 //    BOOST_LOG_TRIVIAL(trace) << "face: " << (*c)[0];
-    static std::vector<point_t<>> face;
-    static std::vector<point_t<>> face_t;
-    static std::vector<point_t<>> face_n;
+    const std::size_t nr_verts = f->size();
+    f->push_back(0);
 
     /* Parse all vextex data for the face */
     find_vertex(c);
     while (((**c) != '\n') && ((**c) != '\r'))
     {
         /* Parse vertex */
-        int vert_num = atoi(*c);
+        int vert_num = raptor_parsers::to_int(*c);
         if (vert_num < 0)
         {
-            vert_num = v.size() + vert_num;
+            vert_num = v_size + vert_num;
         }
         else
         {
             --vert_num;
         }
 //        BOOST_LOG_TRIVIAL(trace) << "vertex: " << vert_num;
-        assert(static_cast<unsigned int>(vert_num) < v.size());
-        face.push_back(v[vert_num]);
+        assert(static_cast<unsigned int>(vert_num) < static_cast<unsigned int>(v_size));
+        f->push_back(vert_num);
         
         /* Parse texture vertex */
+        int vert_text = -1;
+        int vert_norm = -1;
         if (is_triplet_delimiter(c))
         {
             if ((*c)[1] != '/')
             {
                 ++(*c);
-                int vert_text = atoi(*c);
+                vert_text = raptor_parsers::to_int(*c);
                 if (vert_text < 0)
                 {
-                    vert_text = vt.size() + vert_text;
+                    vert_text = vt_size + vert_text;
                 }
                 else
                 {
                     --vert_text;
                 }
 //                BOOST_LOG_TRIVIAL(trace) << "texture: " << vert_text;
-                assert(static_cast<unsigned int>(vert_text) < vt.size());
-                face_t.push_back(vt[vert_text]);
+                assert(vert_text < vt_size);
             }
         
             /* Parse vertex normal */
             if (is_triplet_delimiter(c))
             {
                 ++(*c);
-                int vert_norm = atoi(*c);
+                vert_norm = raptor_parsers::to_int(*c);
                 if (vert_norm < 0)
                 {
-                    vert_norm = vn.size() + vert_norm;
+                    vert_norm = vn_size + vert_norm;
                 }
                 else
                 {
                     --vert_norm;
                 }
 //                BOOST_LOG_TRIVIAL(trace) << "normal: " << vert_norm;
-                assert(static_cast<unsigned int>(vert_norm) < vn.size());
-                face_n.push_back(vn[vert_norm]);
+                assert(vert_norm < vn_size);
             }
         }
+        f->push_back(vert_text);
+        f->push_back(vert_norm);
+        ++(*f)[nr_verts];
+
 //        BOOST_LOG_TRIVIAL(trace) << "current: " << (*c)[0] << (*c)[1];
         find_vertex(c);
     }
 
     /* Move past the new line */
     ++(*c);
+}
+
+
+/* Create the polygon for the face indices at f, as written by parse_f_statement, and return the indices of the next face */
+/* Texture co-ordinates and vertex normals are held in the primitive store, starting from vt_base and vn_base for this file */
+const int * add_f_statement(light_list *l, primitive_store *e, const int vt_base, const int vn_base, const std::vector<point_t<>> &v, material *const m, const int *f)
+{
+    static std::vector<point_t<>> face;
+    static std::vector<int> face_t;
+    static std::vector<int> face_n;
+
+    /* Gather the vertex data for the face */
+    const int nr_verts = *f++;
+    for (int i = 0; i < nr_verts; ++i, f += 3)
+    {
+        face.push_back(v[f[0]]);
+        if (f[1] >= 0)
+        {
+            face_t.push_back(vt_base + f[1]);
+        }
+
+        if (f[2] >= 0)
+        {
+            face_n.push_back(vn_base + f[2]);
+        }
+    }
 
     /* Create the polygon */
     if (face.size() == 3)
@@ -162,34 +196,9 @@ void parse_f_statement(light_list *l, primitive_store *e, std::vector<point_t<>>
             cross_product(a, b, &c);
             if (dot_product(c, c) > 0.0f)
             {
-                if (face_n.empty())
-                {
-                    if (face_t.empty())
-                    {
-                        new_triangle(e, nullptr, m, face[0], face[1], face[2], false);
-                    }
-                    else
-                    {
-                        assert(face_t.size() == 3);
-                        point_t<> text[3] = { face_t[0], face_t[1], face_t[2] };
-                        new_triangle(e, nullptr, m, face[0], face[1], face[2], false, nullptr, &text[0]);
-                    }
-                }
-                else
-                {
-                    assert(face_n.size() == 3);
-                    point_t<> normals[3] = { face_n[0], face_n[1], face_n[2] };
-                    if (face_t.empty())
-                    {
-                        new_triangle(e, nullptr, m, face[0], face[1], face[2], false, &normals[0]);
-                    }
-                    else
-                    {
-                        assert(face_t.size() == 3);
-                        point_t<> text[3] = { face_t[0], face_t[1], face_t[2] };
-                        new_triangle(e, nullptr, m, face[0], face[1], face[2], false, &normals[0], &text[0]);
-                    }
-                }
+                assert(face_n.empty() || (face_n.size() == 3));
+                assert(face_t.empty() || (face_t.size() == 3));
+                new_indexed_triangle(e, nullptr, m, face[0], face[1], face[2], false, (face_n.empty() ? nullptr : &face_n[0]), (face_t.empty() ? nullptr : &face_t[0]));
             }
         }
     }
@@ -197,65 +206,35 @@ void parse_f_statement(light_list *l, primitive_store *e, std::vector<point_t<>>
     {
         assert((face_n.size() == face.size()) || (face_n.size() == 0));
         assert((face_t.size() == face.size()) || (face_t.size() == 0));
-        face_to_triangles(e, l, face, m, false, &face_n, &face_t);
+        indexed_face_to_triangles(e, l, face, m, false, &face_n, &face_t);
     }
 
     /* Clean up */
     face.clear();
     face_t.clear();
     face_n.clear();
-}
 
+    return f;
+}
 
-struct map_info
-{
-    boost::shared_array<float>  img;
-    unsigned int                img_width;
-    unsigned int                img_height;
-    unsigned int                cpp;
-};
 
-inline texture_mapper * load_image(std::map<std::string, map_info> *const cache, const std::string &name, const bool invert = false)
+/* Images are shared through the texture cache, which loads and filters them on demand */
+inline texture_mapper * load_image(const std::string &name, const bool invert = false)
 {
-    /* Check if loaded */
-    const std::string cache_name(name + (invert ? "_inv" : ""));
-    auto cache_iter = cache->find(cache_name);
-    if (cache_iter == cache->end())
-    {
-        BOOST_LOG_TRIVIAL(error) << "Reading: " << name;
-        /* Load image */
-        float *img;
-        map_info info;
-        info.cpp = read_image_file(&img, name, &info.img_height, &info.img_width);
-        info.img.reset(img);
-
-        /* Cache */
-        if (invert)
-        {
-            negative(img, info.cpp * info.img_height * info.img_width);
-        }
-        cache_iter = cache->emplace(cache_name, info).first;
-    }
-
-    const auto &info = cache_iter->second;
-    return new planar_mapper(info.img, point_t<>(0.0f), point_t<>(1.0f, 0.0f, 0.0f), point_t<>(0.0f), info.cpp, info.img_width, info.img_height, texture_wrapping_mode_t::mirror, texture_wrapping_mode_t::mirror);
+    const cached_texture *const tex = texture_cache::global().load(name, invert);
+    return new planar_mapper(tex, point_t<>(0.0f), point_t<>(1.0f, 0.0f, 0.0f), point_t<>(0.0f), texture_wrapping_mode_t::mirror, texture_wrapping_mode_t::mirror);
 }
 
 
-material * parse_mtllib(std::map<std::string, material *> *const s, std::ifstream &f, const std::string &p)
+material * parse_mtllib(std::map<std::string, material *> *const s, const std::string &f, const std::string &p)
 {
-    /* Find the size of the file */
-    f.seekg(0, std::ios::end);
-    size_t len = f.tellg();
-    f.seekg(0, std::ios::beg);
-       
-    /* Read the whole file into a buffer */
-    char *buffer = new char [len];
-    f.read((char *)buffer, len);
-    const char *at = &buffer[0];
+    /* Map the file */
+    const raptor_parsers::mapped_file file(f, true);
+    assert(file.is_open());
+    const char *at = file.data();
+    const char *const end = file.end() - 1;
 
     /* Image cache */
-    std::map<std::string, map_info> image_cache;
     
     /* Colour of current material */
     std::string     mn;
@@ -278,10 +257,10 @@ material * parse_mtllib(std::map<std::string, material *> *const s, std::ifstrea
     int             illum   = 0;        /* Illumination model               */
     
     /* Parse the file */
-    while (at < &buffer[len - 1])
+    while (at < end)
     {
-        at = find_next_statement(at, &buffer[len - 1]);
-        if (at >= &buffer[len - 1])
+        at = find_next_statement(at, end);
+        if (at >= end)
         {
             break;
         }
@@ -510,7 +489,7 @@ material * parse_mtllib(std::map<std::string, material *> *const s, std::ifstrea
             const std::string map_file(p + raptor_parsers::get_next_string(&at));
             BOOST_LOG_TRIVIAL(trace) << "map_Ka: " << map_file;
 
-            t_ka = load_image(&image_cache, map_file);
+            t_ka = load_image(map_file);
         }
         /* Diffuse texture map */
         else if (strncmp(at, "map_Kd", 6) == 0)
@@ -518,7 +497,7 @@ material * parse_mtllib(std::map<std::string, material *> *const s, std::ifstrea
             const std::string map_file(p + raptor_parsers::get_next_string(&at));
             BOOST_LOG_TRIVIAL(trace) << "map_Kd: " << map_file;
 
-            t_kd = load_image(&image_cache, map_file);
+            t_kd = load_image(map_file);
         }
         /* Specular texture map */
         else if (strncmp(at, "map_Ks", 6) == 0)
@@ -526,7 +505,7 @@ material * parse_mtllib(std::map<std::string, material *> *const s, std::ifstrea
             const std::string map_file(p + raptor_parsers::get_next_string(&at));
             BOOST_LOG_TRIVIAL(trace) << "map_Ks: " << map_file;
             
-            t_ks = load_image(&image_cache, map_file);
+            t_ks = load_image(map_file);
         }
         /* Reflection texture map */
         else if (strncmp(at, "map_refl", 8) == 0)
@@ -534,7 +513,7 @@ material * parse_mtllib(std::map<std::string, material *> *const s, std::ifstrea
             const std::string map_file(p + raptor_parsers::get_next_string(&at));
             BOOST_LOG_TRIVIAL(trace) << "map_refl: " << map_file;
 
-            t_rf = load_image(&image_cache, map_file);
+            t_rf = load_image(map_file);
         }
         /* Bump texture map */
         else if (strncmp(at, "map_bump", 8) == 0)
@@ -542,14 +521,14 @@ material * parse_mtllib(std::map<std::string, material *> *const s, std::ifstrea
             const std::string map_file(p + raptor_parsers::get_next_string(&at));
             BOOST_LOG_TRIVIAL(warning) << "map_bump: " << map_file << " (not handled)";
 
-            // t_kd = load_image(&image_cache, map_file);
+            // t_kd = load_image(map_file);
         }
         else if (strncmp(at, "bump", 4) == 0)
         {
             const std::string map_file(p + raptor_parsers::get_next_string(&at));
             BOOST_LOG_TRIVIAL(warning) << "bump: " << map_file << " (not handled)";
 
-            // t_kd = load_image(&image_cache, map_file);
+            // t_kd = load_image(map_file);
         }
         /* Opaqueness texture map */
         else if (strncmp(at, "map_d", 5) == 0)
@@ -557,11 +536,11 @@ material * parse_mtllib(std::map<std::string, material *> *const s, std::ifstrea
             const std::string map_file(p + raptor_parsers::get_next_string(&at));
             BOOST_LOG_TRIVIAL(trace) << "map_d: " << map_file;
 
-            t_tran = load_image(&image_cache, map_file, true);
+            t_tran = load_image(map_file, true);
         }
         else
         {
-            BOOST_LOG_TRIVIAL(error) << "Found unknown: " << std::string(&at[0], 6) << ", at: " << reinterpret_cast<long>(at) << ", of: " << reinterpret_cast<long>(&buffer[len - 1]);
+            BOOST_LOG_TRIVIAL(error) << "Found unknown: " << std::string(&at[0], 6) << ", at: " << reinterpret_cast<long>(at) << ", of: " << reinterpret_cast<long>(end);
             raptor_parsers::find_next_line(&at);
             assert(false);
         }
@@ -658,9 +637,6 @@ material * parse_mtllib(std::map<std::string, material *> *const s, std::ifstrea
         (*s)[mn] = m;
     }
 
-    /* Clean up */
-    delete [] buffer;
-    
     return m;
 }
 
@@ -676,14 +652,9 @@ material * parse_mtllib_statement(std::map<std::string, material *> *const s, co
         /* Get the material library to open */
         std::string mtllib = p + raptor_parsers::get_next_string(c);
         BOOST_LOG_TRIVIAL(trace) << "Opening material file: " << mtllib;
-        std::ifstream f(mtllib.c_str());
-        assert(f.is_open());
 
         /* Parse the file */    
-        m = parse_mtllib(s, f, p);
-    
-        /* Close the file */
-        f.close();
+        m = parse_mtllib(s, mtllib, p);
         (*c)--;
     }
     
@@ -714,134 +685,218 @@ void parse_usemtl_statement(std::map<std::string, material *> *const s, material
 }
 
 
-void parse_v_statement(std::vector<point_t<>> *const vs, const char **c)
+void parse_v_statement(point_t<> *const v, const char **c)
 {
-    point_t<> v;
-
-    v.x = raptor_parsers::get_next_float(c);
-    v.y = raptor_parsers::get_next_float(c);
-    v.z = raptor_parsers::get_next_float(c);
-//    BOOST_LOG_TRIVIAL(trace) << "Parsed v: " << v;
+    v->x = raptor_parsers::get_next_float(c);
+    v->y = raptor_parsers::get_next_float(c);
+    v->z = raptor_parsers::get_next_float(c);
+//    BOOST_LOG_TRIVIAL(trace) << "Parsed v: " << *v;
 
     raptor_parsers::find_next_line(c);
-
-    vs->push_back(v);
 }
 
 
-void parse_vt_statement(std::vector<point_t<>> *const vs, const char **c)
+void parse_vt_statement(point_t<> *const v, const char **c)
 {
-    point_t<> v;
-
-    v.x = raptor_parsers::get_next_float(c);
-    v.y = raptor_parsers::get_next_float(c);
-//    BOOST_LOG_TRIVIAL(trace) << "Parsed vt: " << v.x << ", " << v.y;
+    v->x = raptor_parsers::get_next_float(c);
+    v->y = raptor_parsers::get_next_float(c);
+//    BOOST_LOG_TRIVIAL(trace) << "Parsed vt: " << v->x << ", " << v->y;
 
     raptor_parsers::find_next_line(c);
-
-    vs->push_back(v);
 }
 
 
-void parse_vn_statement(std::vector<point_t<>> *const vs, const char **c)
+void parse_vn_statement(point_t<> *const v, const char **c)
 {
-    point_t<> v;
-
-    v.x = raptor_parsers::get_next_float(c);
-    v.y = raptor_parsers::get_next_float(c);
-    v.z = raptor_parsers::get_next_float(c);
-    normalise(&v);
-//    BOOST_LOG_TRIVIAL(trace) << "Parsed vn: " << v;
+    v->x = raptor_parsers::get_next_float(c);
+    v->y = raptor_parsers::get_next_float(c);
+    v->z = raptor_parsers::get_next_float(c);
+    normalise(v);
+//    BOOST_LOG_TRIVIAL(trace) << "Parsed vn: " << *v;
 
     raptor_parsers::find_next_line(c);
-
-    vs->push_back(v);
 }
 
 
+/* Faces and material statements parsed from one chunk of an obj file */
+struct obj_chunk
+{
+    std::vector<int>                            faces;      /* Face indices as written by parse_f_statement                 */
+    std::vector<std::pair<int, const char *>>   statements; /* Material statements and the number of faces in the chunk before them */
+};
+
+
+/**********************************************************
+ obj_parser is the main obj parsing function. The file is
+ mapped and split into chunks of lines. The chunks are first
+ counted and then parsed in parallel, vertices are written
+ straight to their place in the file and faces are kept per
+ chunk. Materials and polygons are then created in file 
+ order.
+**********************************************************/
 void obj_parser(
-    std::ifstream           &obj_file,
+    const std::string       &obj_file,
     std::string             p,
     light_list              &l, 
     primitive_store         &e,
     std::list<material *>   &m,
     camera                  **c)
 {
-    /* Find the size of the file */
-    obj_file.seekg(0, std::ios::end);
-    size_t len = obj_file.tellg();
-    obj_file.seekg(0, std::ios::beg);
-
-//    BOOST_LOG_TRIVIAL(trace) << "Parsing OBJ length: " << len;
-       
-    /* Read the whole file into a buffer */
-    char *buffer = new char [len];
-    obj_file.read((char *)buffer, len);
-    const char *at = &buffer[0];
-    
-    /* Vectors of vertice data */
-    std::vector<point_t<>>    vt;
-    std::vector<point_t<>>    vn;
-    std::vector<point_t<>>    v;
+    /* Map the file and split it into chunks */
+    const raptor_parsers::mapped_file file(obj_file, true);
+    assert(file.is_open());
+    const int nr_chunks = raptor_parsers::number_of_chunks(file.size());
+    const std::vector<const char *> chunks(raptor_parsers::split_lines(file.data(), file.end(), nr_chunks));
+
+    /* Count the vertices, texture co-ordinates and normals of each chunk */
+    std::vector<int> v_first(nr_chunks + 1, 0);
+    std::vector<int> vt_first(nr_chunks + 1, 0);
+    std::vector<int> vn_first(nr_chunks + 1, 0);
+    raptor_parsers::parallel_chunks(nr_chunks, [&](const int i)
+    {
+        const char *const end = chunks[i + 1];
+        for (const char *at = find_next_statement(chunks[i], end); at < end; at = find_next_statement(raptor_parsers::next_line(at, end), end))
+        {
+            if (*at == 'v')
+            {
+                if (at[1] == 'n')
+                {
+                    ++vn_first[i + 1];
+                }
+                else if (at[1] == 't')
+                {
+                    ++vt_first[i + 1];
+                }
+                else
+                {
+                    ++v_first[i + 1];
+                }
+            }
+        }
+    });
+    std::partial_sum(v_first.begin(), v_first.end(), v_first.begin());
+    std::partial_sum(vt_first.begin(), vt_first.end(), vt_first.begin());
+    std::partial_sum(vn_first.begin(), vn_first.end(), vn_first.begin());
+
+    /* Vectors of vertice data, texture co-ordinates and normals go into the primitive store to be shared */
+    std::vector<point_t<>>    v(v_first.back());
+    std::vector<point_t<>>    vt(vt_first.back());
+    std::vector<point_t<>>    vn(vn_first.back());
+    std::vector<obj_chunk>    parsed(nr_chunks);
+
+    /* Parse the chunks */
+    raptor_parsers::parallel_chunks(nr_chunks, [&](const int i)
+    {
+        obj_chunk &chunk    = parsed[i];
+        const char *at      = chunks[i];
+        const char *const end = chunks[i + 1];
+        int v_idx   = v_first[i];
+        int vt_idx  = vt_first[i];
+        int vn_idx  = vn_first[i];
+        int nr_f    = 0;
+        while (at < end)
+        {
+            at = find_next_statement(at, end);
+            if (at >= end)
+            {
+                break;
+            }
+
+            /* Material statements are kept to be applied in order */
+            if ((strncmp(at, "mtllib", 6) == 0) || (strncmp(at, "usemtl", 6) == 0))
+            {
+                chunk.statements.emplace_back(nr_f, at);
+                raptor_parsers::find_next_line(&at);
+            }
+            else if (strncmp(at, "vn", 2) == 0)
+            {
+                parse_vn_statement(&vn[vn_idx++], &at);
+            }
+            else if (strncmp(at, "vt", 2) == 0)
+            {
+                parse_vt_statement(&vt[vt_idx++], &at);
+            }
+            else if (*at == 'f')
+            {
+                parse_f_statement(&chunk.faces, v_idx, vt_idx, vn_idx, &at);
+                ++nr_f;
+            }
+            else if (*at == 'v')
+            {
+                parse_v_statement(&v[v_idx++], &at);
+            }
+            /* Group */
+            else if (*at == 'g')
+            {
+                raptor_parsers::find_next_line(&at);
+            }
+            /* Object */
+            else if (*at == 'o')
+            {
+                raptor_parsers::find_next_line(&at);
+            }
+            /* Smoothing group */
+            else if (*at == 's')
+            {
+                raptor_parsers::find_next_line(&at);
+            }
+            else
+            {
+                BOOST_LOG_TRIVIAL(error) << "Found unknown statement: " << std::string(at, raptor_parsers::next_line(at, end)) << ", at: " << reinterpret_cast<long>(at) << ", of: " << reinterpret_cast<long>(file.end());
+                raptor_parsers::find_next_line(&at);
+                assert(false);
+            }
+        }
+    });
+
+    /* Add the texture co-ordinates and normals to the primitive store */
+    const int vt_base = e.number_of_texture_coords();
+    const int vn_base = e.number_of_normals();
+    for (const auto &t : vt)
+    {
+        e.add_texture_coord(t);
+    }
+
+    for (const auto &n : vn)
+    {
+        e.add_normal(n);
+    }
     
     /* Map of shader names to shader */
     std::map<std::string, material *> shader_map;
     material *cur_mat = new phong_shader(ext_colour_t(0.0f, 0.0f, 0.0f), ext_colour_t(200.0f, 200.0f, 200.0f), ext_colour_t(0.0f, 0.0f, 0.0f), 0.0f);
     m.push_back(cur_mat);
-    
-    /* Parse the file */
-    while (at < &buffer[len - 1])
+
+    /* Create the materials and polygons in file order */
+    const auto parse_material_statement = [&](const char *at)
     {
-        at = find_next_statement(at, &buffer[len - 1]);
-        if (at >= &buffer[len - 1])
-        {
-            break;
-        }
-        
         if (strncmp(at, "mtllib", 6) == 0)
         {
             cur_mat = parse_mtllib_statement(&shader_map, p, &at);
         }
-        else if (strncmp(at, "usemtl", 6) == 0)
+        else
         {
             parse_usemtl_statement(&shader_map, &cur_mat, &at);
         }
-        else if (strncmp(at, "vn", 2) == 0)
-        {
-            parse_vn_statement(&vn, &at);
-        }
-        else if (strncmp(at, "vt", 2) == 0)
-        {
-            parse_vt_statement(&vt, &at);
-        }
-        else if (*at == 'f')
-        {
-            parse_f_statement(&l, &e, vt, vn, v, cur_mat, &at);
-        }
-        else if (*at == 'v')
-        {
-            parse_v_statement(&v, &at);
-        }
-        /* Group */
-        else if (*at == 'g')
-        {
-            raptor_parsers::find_next_line(&at);
-        }
-        /* Object */
-        else if (*at == 'o')
-        {
-            raptor_parsers::find_next_line(&at);
-        }
-        /* Smoothing group */
-        else if (*at == 's')
+    };
+
+    for (const auto &chunk : parsed)
+    {
+        auto statement = chunk.statements.begin();
+        const int *f = chunk.faces.data();
+        const int *const f_end = f + chunk.faces.size();
+        for (int i = 0; f != f_end; ++i)
         {
-            raptor_parsers::find_next_line(&at);
+            for (; (statement != chunk.statements.end()) && (statement->first == i); ++statement)
+            {
+                parse_material_statement(statement->second);
+            }
+            f = add_f_statement(&l, &e, vt_base, vn_base, v, cur_mat, f);
         }
-        else
+
+        for (; statement != chunk.statements.end(); ++statement)
         {
-            BOOST_LOG_TRIVIAL(error) << "Found unknown statement: " << at << ", at: " << reinterpret_cast<long>(at) << ", of: " << reinterpret_cast<long>(&buffer[len - 1]);
-            raptor_parsers::find_next_line(&at);
-            assert(false);
+            parse_material_statement(statement->second);
         }
     }
     
@@ -850,8 +905,5 @@ void obj_parser(
     {
         m.push_back((*i).second);
     }
- 
-    /* Tidy up */
-    delete [] buffer;
 }
 }; /* namespace raptor_raytracer */
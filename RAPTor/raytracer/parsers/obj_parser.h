@@ -5,7 +5,7 @@ namespace raptor_raytracer
 class camera;
 
 void obj_parser(
-    std::ifstream           &obj_file,
+    const std::string       &obj_file,
     std::string             p,
     light_list              &l, 
     primitive_store         &e,
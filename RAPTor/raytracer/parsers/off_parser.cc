@@ -1,5 +1,7 @@
 #include "common.h"
 #include "parser_common.h"
+#include "chunked_parser.h"
+#include "mapped_file.h"
 #include "polygon_to_triangles.h"
 
 #include "camera.h"
@@ -13,21 +15,16 @@
 namespace raptor_raytracer
 {
 void off_parser(
-    std::ifstream           &off_file,
+    const std::string       &off_file,
     light_list              &l, 
     primitive_store         &e,
     std::list<material *>   &m,
     camera                  *c)
 {
-    /* Find the size of the file */
-    off_file.seekg(0, std::ios::end);
-    size_t len = off_file.tellg();
-    off_file.seekg(0, std::ios::beg);
-    
-    /* Read the whole file into a buffer */
-    char *buffer = new char [len];
-    off_file.read(buffer, len);
-    const char *at = &buffer[0];
+    /* Map the file */
+    const raptor_parsers::mapped_file file(off_file, true);
+    assert(file.is_open());
+    const char *at = file.data();
 
     /* Build a default material */
     auto mat = new phong_shader(ext_colour_t(0.0f, 0.0f, 0.0f), ext_colour_t(170.0f, 170.0f, 170.0f), ext_colour_t(0.0f, 0.0f, 0.0f), 0.0f, 0.0f, 0.0f, 0.0f);
@@ -55,47 +52,56 @@ void off_parser(
     }
     raptor_parsers::find_next_line(&at);
 
-    /* Get vertices */
-    point_t<> vert;
-    std::vector<point_t<>> vertices;
-    vertices.reserve(nr_v);
-    for (unsigned int i = 0; i < nr_v; ++i)
+    /* Get vertices and faces in parallel, faces are held per chunk as the number of vertices then their indices */
+    const int nr_chunks = raptor_parsers::number_of_chunks(file.end() - at);
+    std::vector<point_t<>> vertices(nr_v);
+    std::vector<std::vector<int>> faces(nr_chunks);
+    raptor_parsers::parallel_for_lines(at, file.end(), nr_chunks, nr_v + nr_f, [&](const int chunk, const int i, const char *c)
     {
-        vert.x = raptor_parsers::get_this_float(&at);
-        vert.y = raptor_parsers::get_next_float(&at);
-        vert.z = raptor_parsers::get_next_float(&at);
-        vertices.push_back(vert);
-
-        raptor_parsers::find_next_line(&at);
-    }
-
-    /* Get faces */
-    std::vector<point_t<>> face;
-    for (unsigned int i = 0; i < nr_f; ++i)
-    {
-        const unsigned int nr_verts = raptor_parsers::get_this_unsigned(&at);
-        for (unsigned int j = 0; j < nr_verts; ++j)
+        if (i < static_cast<int>(nr_v))
         {
-            const unsigned int vert_idx = raptor_parsers::get_next_unsigned(&at);
-            face.push_back(vertices[vert_idx]);
+            point_t<> &vert = vertices[i];
+            vert.x = raptor_parsers::get_this_float(&c);
+            vert.y = raptor_parsers::get_next_float(&c);
+            vert.z = raptor_parsers::get_next_float(&c);
         }
-        raptor_parsers::find_next_line(&at);
-
-        /* Create the polygon */
-        if (face.size() == 3)
+        else
         {
-            new_triangle(&e, nullptr, mat, face[0], face[1], face[2], false);
+            std::vector<int> &face = faces[chunk];
+            const unsigned int nr_verts = raptor_parsers::get_this_unsigned(&c);
+            face.push_back(nr_verts);
+            for (unsigned int j = 0; j < nr_verts; ++j)
+            {
+                const unsigned int vert_idx = raptor_parsers::get_next_unsigned(&c);
+                assert(vert_idx < nr_v);
+                face.push_back(vert_idx);
+            }
         }
-        else if (face.size() > 3)
+    });
+
+    /* Create the polygons in file order */
+    std::vector<point_t<>> face;
+    for (const auto &chunk : faces)
+    {
+        for (auto f = chunk.begin(); f != chunk.end(); f += (*f) + 1)
         {
-            face_to_triangles(&e, &l, face, mat, false, nullptr, nullptr);
-        }
+            for (int j = 1; j <= *f; ++j)
+            {
+                face.push_back(vertices[f[j]]);
+            }
 
-        /* Clean up */
-        face.clear();
-    }
+            if (face.size() == 3)
+            {
+                new_triangle(&e, nullptr, mat, face[0], face[1], face[2], false);
+            }
+            else if (face.size() > 3)
+            {
+                face_to_triangles(&e, &l, face, mat, false, nullptr, nullptr);
+            }
 
-    /* Clean up */
-    delete [] buffer;
+            /* Clean up */
+            face.clear();
+        }
+    }
 }
 }; /* namespace raptor_raytracer */
@@ -5,7 +5,7 @@ namespace raptor_raytracer
 class camera;
 
 void off_parser(
-    std::ifstream           &off_file,
+    const std::string       &off_file,
     light_list              &l, 
     primitive_store         &e,
     std::list<material *>   &m,
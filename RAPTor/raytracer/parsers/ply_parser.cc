@@ -1,5 +1,7 @@
 #include "common.h"
 #include "parser_common.h"
+#include "chunked_parser.h"
+#include "mapped_file.h"
 #include "polygon_to_triangles.h"
 
 #include "camera.h"
@@ -230,6 +232,46 @@ unsigned parse_element_face(const char **c, unsigned *const pre_skip, unsigned *
 }
 
 
+/**********************************************************
+ add_face creates the triangles for a face. Triangles that
+ dont show movement in atleast 2 axes are discarded.
+
+ l is a list of lights in the scene, e is a list of all 
+ primitives in the scene. face is the vertices of the face
+ and m is the material to use.
+**********************************************************/
+void add_face(light_list *l, primitive_store *e, std::vector<point_t<>> &face, material *const m)
+{
+    if (face.size() == 3)
+    {
+        /* Check the points show movement in atleast 2 axes  */
+        point_t<> a = face[0];
+        point_t<> b = face[1];
+        point_t<> c = face[2];
+
+        if ((a != b) && (a != c) && (b != c))
+        {
+            a -= b;
+            b -= c;
+            normalise(&a);
+            normalise(&b);
+        
+            c  = a - b;
+            a += b;
+    
+            if ((c != 0) && (a != 0))
+            {
+                new_triangle(e, NULL, m, face[0], face[1], face[2], false);
+            }
+        }
+    }
+    else
+    {
+        face_to_triangles(e, l, face, m, false);
+    }
+}
+
+
 /**********************************************************
  parse_binary_face parses face information in binary 
  format. The face is assumed to be describred by a char 
@@ -285,33 +327,7 @@ void parse_binary_face(light_list *l, primitive_store *e, std::vector<point_t<>>
     }
 
     /* Create the polygon */
-    if (face.size() == 3)
-    {
-        /* Check the points show movement in atleast 2 axes  */
-        point_t<> a = face[0];
-        point_t<> b = face[1];
-        point_t<> c = face[2];
-
-        if ((a != b) && (a != c) && (b != c))
-        {
-            a -= b;
-            b -= c;
-            normalise(&a);
-            normalise(&b);
-        
-            c  = a - b;
-            a += b;
-    
-            if ((c != 0) && (a != 0))
-            {
-                new_triangle(e, NULL, m, face[0], face[1], face[2], false);
-            }
-        }
-    }
-    else
-    {
-        face_to_triangles(e, l, face, m, false);
-    }
+    add_face(l, e, face, m);
 }
 
 
@@ -331,7 +347,7 @@ void parse_face(light_list *l, primitive_store *e, std::vector<point_t<>> &vn, s
     static std::vector<point_t<>> face;
 
     /* Parse all vextex data for the face */
-    unsigned v_this_f = atoi(*c);
+    unsigned v_this_f = raptor_parsers::get_this_unsigned(c);
     face.resize(v_this_f);
     for (unsigned i = 0; i < v_this_f; i++)
     {
@@ -369,32 +385,27 @@ void parse_face(light_list *l, primitive_store *e, std::vector<point_t<>> &vn, s
     }
 
     /* Create the polygon */
-    if (face.size() == 3)
-    {
-        /* Check the points show movement in atleast 2 axes  */
-        point_t<> a = face[0];
-        point_t<> b = face[1];
-        point_t<> c = face[2];
+    add_face(l, e, face, m);
+}
 
-        if ((a != b) && (a != c) && (b != c))
-        {
-            a -= b;
-            b -= c;
-            normalise(&a);
-            normalise(&b);
-        
-            c  = a - b;
-            a += b;
-    
-            if ((c != 0) && (a != 0))
-            {
-                new_triangle(e, NULL, m, face[0], face[1], face[2], false);
-            }
-        }
-    }
-    else
+
+/**********************************************************
+ parse_face_indices parses the vertex indices of a face in
+ ascii format. The number of vertices is appended to f
+ followed by their indices.
+
+ f is the list of faces to append to, nr_v is the number of
+ vertices in the file and c is the start of the face.
+**********************************************************/
+void parse_face_indices(std::vector<int> *const f, const unsigned nr_v, const char *c)
+{
+    const unsigned v_this_f = raptor_parsers::get_this_unsigned(&c);
+    f->push_back(v_this_f);
+    for (unsigned i = 0; i < v_this_f; i++)
     {
-        face_to_triangles(e, l, face, m, false);
+        const unsigned vert_num = raptor_parsers::get_next_unsigned(&c);
+        assert(vert_num < nr_v);
+        f->push_back(vert_num);
     }
 }
 
@@ -403,32 +414,28 @@ void parse_face(light_list *l, primitive_store *e, std::vector<point_t<>> &vn, s
  parse_binary_vertex parses vertex information in binary 
  format. The vertex is assumed to be describred 3 floats.
 
- vs is a list of vertices to be appended too and c is a 
+ vs is the vertex to be written and vn its normal, c is a 
  pointer to the byte stream to be parsed.
 **********************************************************/
-void parse_binary_vertex(std::vector<point_t<>> *const vs, std::vector<point_t<>> *const vn, const char **c, const bool normal, const bool colour)
+void parse_binary_vertex(point_t<> *const vs, point_t<> *const vn, const char *c, const bool normal, const bool colour)
 {
-    point_t<> v;
-
     /* Parse the vertex position */
-    v.x = raptor_parsers::from_byte_stream<float>(c);
-    v.y = raptor_parsers::from_byte_stream<float>(c);
-    v.z = raptor_parsers::from_byte_stream<float>(c);
-    vs->push_back(v);
+    vs->x = raptor_parsers::from_byte_stream<float>(&c);
+    vs->y = raptor_parsers::from_byte_stream<float>(&c);
+    vs->z = raptor_parsers::from_byte_stream<float>(&c);
 
     /* Ignore the vertex colour */
     if (colour)
     {
-        (*c) += 3;
+        c += 3;
     }
 
     /* Parse the vertex normal */
     if (normal)
     {
-        v.x = raptor_parsers::from_byte_stream<float>(c);
-        v.y = raptor_parsers::from_byte_stream<float>(c);
-        v.z = raptor_parsers::from_byte_stream<float>(c);
-        vn->push_back(v);
+        vn->x = raptor_parsers::from_byte_stream<float>(&c);
+        vn->y = raptor_parsers::from_byte_stream<float>(&c);
+        vn->z = raptor_parsers::from_byte_stream<float>(&c);
     }
 }
 
@@ -437,57 +444,46 @@ void parse_binary_vertex(std::vector<point_t<>> *const vs, std::vector<point_t<>
  parse_vertex parses vertex information in ascii format. 
  The vertex is assumed to be describred 3 floats.
 
- vs is a list of vertices to be appended too and c is a 
+ vs is the vertex to be written and vn its normal, c is a 
  pointer to the byte stream to be parsed.
 **********************************************************/
-void parse_vertex(std::vector<point_t<>> *const vs, std::vector<point_t<>> *const vn, const char **c, const bool normal, const bool colour)
+void parse_vertex(point_t<> *const vs, point_t<> *const vn, const char *c, const bool normal, const bool colour)
 {
-    point_t<> v;
-
     /* Parse the vertex position */
-    v.x = atof(*c);
-    v.y = raptor_parsers::get_next_float(c);
-    v.z = raptor_parsers::get_next_float(c);
-    vs->push_back(v);
+    vs->x = raptor_parsers::get_this_float(&c);
+    vs->y = raptor_parsers::get_next_float(&c);
+    vs->z = raptor_parsers::get_next_float(&c);
     
     /* Parse the vertex normal */
     if (normal)
     {
-        v.x = raptor_parsers::get_next_float(c);
-        v.y = raptor_parsers::get_next_float(c);
-        v.z = raptor_parsers::get_next_float(c);
-        vn->push_back(v);
+        vn->x = raptor_parsers::get_next_float(&c);
+        vn->y = raptor_parsers::get_next_float(&c);
+        vn->z = raptor_parsers::get_next_float(&c);
     }
-
-    /* Move to the next line */
-    raptor_parsers::find_next_line(c);
 }
 
 
 /**********************************************************
- ply_parser is the main ply parsing function. It loads the 
- ply file into a byte array and parses through it. The full
- ply standard isnt supported only enough to load the most 
- common models, namely vertex and face data.
+ ply_parser is the main ply parsing function. It maps the 
+ ply file and parses through it. The full ply standard isnt
+ supported only enough to load the most common models, 
+ namely vertex and face data.
+
+ Vertices are parsed in parallel. Ascii faces are parsed in
+ parallel, but all triangles are created in file order.
 **********************************************************/
 void ply_parser(
-    std::ifstream           &ply_file,
+    const std::string       &ply_file,
     light_list              &l, 
     primitive_store         &e,
     std::list<material *>   &m,
     camera                  **c)
 {
-    /* Find the size of the file */
-    ply_file.seekg(0, std::ios::end);
-    size_t len = ply_file.tellg();
-    ply_file.seekg(0, std::ios::beg);
-
-//    std::cout << "Parsing PLY length: " << len << std::endl;
-       
-    /* Read the whole file into a buffer */
-    char *buffer = new char [len];
-    ply_file.read((char *)buffer, len);
-    const char *at = &buffer[0];
+    /* Map the file */
+    std::unique_ptr<raptor_parsers::mapped_file> file(new raptor_parsers::mapped_file(ply_file));
+    assert(file->is_open());
+    const char *at = file->data();
     
     /* Vectors of vertice data */
     std::vector<point_t<>>    vn;
@@ -506,6 +502,14 @@ void ply_parser(
     if (strncmp(at, "format ascii 1.0", 16) == 0)
     {
         binary = false;
+
+        /* Ascii files must end in a new line, map them as text if they dont */
+        if (file->end()[-1] != '\n')
+        {
+            const std::ptrdiff_t offset = at - file->data();
+            file.reset(new raptor_parsers::mapped_file(ply_file, true));
+            at = file->data() + offset;
+        }
     }
     else
     {
@@ -519,11 +523,11 @@ void ply_parser(
     bool     v_colour       = false;
     bool     v_normal       = false;
     unsigned nr_v = parse_element_vertex(&at, &v_skip, &v_normal, &v_colour);
-    v.reserve(nr_v);
+    v.resize(nr_v);
     
     if (v_normal)
     {
-        vn.reserve(nr_v);
+        vn.resize(nr_v);
     }
 
     /* Get the face information */
@@ -538,12 +542,18 @@ void ply_parser(
     /* Pick the file type and parse the data */
     if (binary)
     {
-        /* Parse vertices */
-        for (unsigned i = 0; i < nr_v; i++)
+        /* Parse vertices, they are all the same size so can be split by index */
+        const unsigned v_size = 12 + (v_colour ? 3 : 0) + (v_normal ? 12 : 0) + v_skip;
+        const int nr_chunks = raptor_parsers::number_of_chunks(nr_v * v_size);
+        raptor_parsers::parallel_chunks(nr_chunks, [&](const int chunk)
         {
-            parse_binary_vertex(&v, &vn, &at, v_normal, v_colour);
-            at += v_skip;
-        }
+            const unsigned end = (nr_v * (chunk + 1)) / nr_chunks;
+            for (unsigned i = (nr_v * chunk) / nr_chunks; i < end; ++i)
+            {
+                parse_binary_vertex(&v[i], v_normal ? &vn[i] : nullptr, at + (i * v_size), v_normal, v_colour);
+            }
+        });
+        at += nr_v * v_size;
     
         /* Parse faces */
         for (unsigned i = 0; i < nr_f; i++)
@@ -555,17 +565,51 @@ void ply_parser(
     }
     else
     {
-        /* Parse vertices */
-        for (unsigned i = 0; i < nr_v; i++)
+        /* Parse vertices and, if they dont have colour, faces in parallel */
+        const char *f_at = file->end();
+        const int nr_chunks = raptor_parsers::number_of_chunks(file->end() - at);
+        std::vector<std::vector<int>> faces(nr_chunks);
+        raptor_parsers::parallel_for_lines(at, file->end(), nr_chunks, nr_v + (f_colour ? 1 : nr_f), [&](const int chunk, const int i, const char *c)
         {
-            parse_vertex(&v, &vn, &at, v_normal, v_colour);
-        }
+            if (i < static_cast<int>(nr_v))
+            {
+                parse_vertex(&v[i], v_normal ? &vn[i] : nullptr, c, v_normal, v_colour);
+            }
+            else if (f_colour)
+            {
+                f_at = c;
+            }
+            else
+            {
+                parse_face_indices(&faces[chunk], nr_v, c + pre_f_skip);
+            }
+        });
     
-        /* Parse faces */
-        for (unsigned i = 0; i < nr_f; i++)
+        /* Create the faces in file order */
+        if (f_colour)
         {
-            at += pre_f_skip;
-            parse_face(&l, &e, vn, v, &shader_map, &at, f_colour);
+            for (unsigned i = 0; i < nr_f; i++)
+            {
+                f_at += pre_f_skip;
+                parse_face(&l, &e, vn, v, &shader_map, &f_at, f_colour);
+            }
+        }
+        else
+        {
+            std::vector<point_t<>> face;
+            for (const auto &chunk : faces)
+            {
+                for (auto f = chunk.begin(); f != chunk.end(); f += (*f) + 1)
+                {
+                    for (int j = 1; j <= *f; ++j)
+                    {
+                        face.push_back(v[f[j]]);
+                    }
+
+                    add_face(&l, &e, face, shader_map[0xdefa]);
+                    face.clear();
+                }
+            }
         }
     }
 
@@ -575,9 +619,5 @@ void ply_parser(
     {
         m.push_back(i->second);
     }
- 
-    /* Tidy up */
-    delete [] buffer;
-//    std::cout << "Parsing complete" << std::endl;
 }
 }; /* namespace raptor_raytracer */
@@ -5,7 +5,7 @@ namespace raptor_raytracer
 class camera;
 
 void ply_parser(
-    std::ifstream           &ply_file,
+    const std::string       &ply_file,
     light_list              &l, 
     primitive_store         &e,
     std::list<material *>   &m,
@@ -21,6 +21,17 @@ inline void new_triangle(primitive_store *e, std::vector<int> *t, material *m, c
 }
 
 
+/* Declare triangle with vertex normals and texture co-ordinates already in the primitive store */
+inline void new_indexed_triangle(primitive_store *e, std::vector<int> *t, material *m, const point_t<> &a, const point_t<> &b, const point_t<> &c, const bool li, const int *vn, const int *vt)
+{
+    const int idx = e->emplace_back(m, a, b, c, li, vn, vt);
+    if (li)
+    {
+        t->push_back(idx);
+    }
+}
+
+
 /* Declare light */
 inline void new_light(light_list *const l, const ext_colour_t &rgb, const point_t<> &c, const float d, const float r)
 {
@@ -237,7 +248,8 @@ inline void face_to_triangle_edges(std::vector<int> *const tris, std::vector<poi
 }
 
 
-inline void face_to_triangles(primitive_store *e, light_list *l, std::vector<point_t<>> &p, material *const m, const bool li, std::vector<point_t<>> *vn = nullptr, std::vector<point_t<>> *vt = nullptr, const float d = 0.0f)
+/* Triangulate a face whose vertex normals and texture co-ordinates, if any, are indices into the primitive store */
+inline void indexed_face_to_triangles(primitive_store *e, light_list *l, std::vector<point_t<>> &p, material *const m, const bool li, const std::vector<int> *vn = nullptr, const std::vector<int> *vt = nullptr, const float d = 0.0f)
 {
     /* Progress tracking */
     unsigned size = p.size();
@@ -245,10 +257,10 @@ inline void face_to_triangles(primitive_store *e, light_list *l, std::vector<poi
     memset(invalid.get(), 0, sizeof(char) * p.size());
 
     /* Vertex normal and texture arrays */
-    point_t<>  vn_a[3];
-    point_t<>  vt_a[3];
-    point_t<> *vn_p = nullptr;
-    point_t<> *vt_p = nullptr;
+    int  vn_a[3];
+    int  vt_a[3];
+    int *vn_p = nullptr;
+    int *vt_p = nullptr;
 
     if ((vn != nullptr) && (!vn->empty()))
     {    
@@ -341,7 +353,7 @@ inline void face_to_triangles(primitive_store *e, light_list *l, std::vector<poi
                     vt_a[2] = (*vt)[max_p1];
                 }
 
-                new_triangle(e, t, m, a, b, c, li, vn_p, vt_p);
+                new_indexed_triangle(e, t, m, a, b, c, li, vn_p, vt_p);
             }
             else
             {
@@ -387,4 +399,32 @@ inline void face_to_triangles(primitive_store *e, light_list *l, std::vector<poi
         new_light(l, e, ext_colour_t(255.0f, 255.0f, 255.0f), com, 0.0f, t);
     }
 }
+
+
+/* Triangulate a face, its vertex normals and texture co-ordinates are added to the primitive store */
+/* once so the triangles of the face share them */
+inline void face_to_triangles(primitive_store *e, light_list *l, std::vector<point_t<>> &p, material *const m, const bool li, std::vector<point_t<>> *vn = nullptr, std::vector<point_t<>> *vt = nullptr, const float d = 0.0f)
+{
+    std::vector<int> vn_idx;
+    if (vn != nullptr)
+    {
+        vn_idx.reserve(vn->size());
+        for (const auto &n : *vn)
+        {
+            vn_idx.push_back(e->add_normal(n));
+        }
+    }
+
+    std::vector<int> vt_idx;
+    if (vt != nullptr)
+    {
+        vt_idx.reserve(vt->size());
+        for (const auto &t : *vt)
+        {
+            vt_idx.push_back(e->add_texture_coord(t));
+        }
+    }
+
+    indexed_face_to_triangles(e, l, p, m, li, &vn_idx, &vt_idx, d);
+}
 }; /* namespace raptor_raytracer */
@@ -0,0 +1,130 @@
+#pragma once
+
+/* Standard headers */
+#include <vector>
+
+/* Boost headers */
+
+/* Common headers */
+#include "point_t.h"
+
+/* Ray tracer headers */
+#include "common.h"
+#include "ray.h"
+#include "triangle.h"
+#include "primitive_store.h"
+
+
+namespace raptor_raytracer
+{
+/* Intersection only copy of a triangle. Leaf nodes test rays against these so the intersector only */
+/* touches the data it needs. Shading data stays in the triangle and is looked up by index after a hit */
+class precomputed_triangle
+{
+    public :
+        precomputed_triangle(const triangle &t, const int idx) :
+            _a(t.get_vertex_a()), _e1(t.get_vertex_c() - t.get_vertex_a()), _e2(t.get_vertex_b() - t.get_vertex_a()),
+            _idx(idx), _occluder(!(t.get_light() || t.is_transparent()))
+        {  }
+
+        /* Allow default DTOR, copy CTOR and assignment operator (for using in vector) */
+
+        /* Access functions */
+        int     index()         const { return _idx;        }
+        bool    is_occluder()   const { return _occluder;   }
+
+        /* Ray tracing functions */
+        inline void is_intersecting(const ray *const r, hit_description *const h) const;
+
+    private :
+        point_t<>   _a;         /* Vertex a of the triangle                 */
+        point_t<>   _e1;        /* Edge from vertex a to vertex c           */
+        point_t<>   _e2;        /* Edge from vertex a to vertex b           */
+        int         _idx;       /* Index of the triangle in the store       */
+        bool        _occluder;  /* Whether this triangle casts shadows      */
+};
+
+
+/***********************************************************
+ is_intersecting updates h with the distance along the ray r
+ that the triangle and the ray intersect. If the triangle and
+ the ray do not intersect h->d is set to MAX_DIST.
+
+ This is the same Moller-Trumbore test as triangle, but with
+ the edges precomputed.
+************************************************************/
+inline void precomputed_triangle::is_intersecting(const ray *const r, hit_description *const h) const
+{
+    COUNT_TRAVERSAL(triangle_tests, 1);
+
+    /* Begin calculating determinant - also used to calculate u parameter */
+    const point_t<> P(cross_product(r->get_dir(), _e2));
+
+    /* if determinant is near zero, ray lies in plane of triangle */
+    const float det = dot_product(_e1, P);
+    if (det > -0.000001f && det < 0.000001f)
+    {
+        h->d = MAX_DIST;
+        return;
+    }
+    const float inv_det = 1.0f / det;
+
+    /* calculate distance from V1 to ray origin */
+    const point_t<> T(r->get_ogn() - _a);
+
+    /* Calculate u parameter and test bound */
+    const float u = dot_product(T, P) * inv_det;
+    if (u < 0.0f)
+    {
+        h->d = MAX_DIST;
+        return;
+    }
+
+    /* Calculate V parameter and test bound */
+    const point_t<> Q(cross_product(T, _e1));
+    const float v = dot_product(r->get_dir(), Q) * inv_det;
+    if ((v < 0.0f) || ((u + v) > 1.0f))
+    {
+        h->d = MAX_DIST;
+        return;
+    }
+
+    const float t = dot_product(_e2, Q) * inv_det;
+    if(t > EPSILON)
+    {
+        h->d = t;
+        h->u = u;
+        h->v = v;
+    }
+}
+
+
+/***********************************************************
+ Precompute every triangle in e in indirect order, the order
+ the leaves of the bih and bvh reference them in.
+************************************************************/
+inline void precompute_indirect_triangles(std::vector<precomputed_triangle> *const tris, const primitive_store &e)
+{
+    tris->clear();
+    tris->reserve(e.size());
+    for (int i = 0; i < e.size(); ++i)
+    {
+        tris->emplace_back(*e.indirect_primitive(i), e.indirection(i));
+    }
+}
+
+
+/***********************************************************
+ Precompute every triangle in e in store order, the order the
+ leaves of the kd tree reference them in.
+************************************************************/
+inline void precompute_triangles(std::vector<precomputed_triangle> *const tris, const primitive_store &e)
+{
+    tris->clear();
+    tris->reserve(e.size());
+    for (int i = 0; i < e.size(); ++i)
+    {
+        tris->emplace_back(*e.primitive(i), i);
+    }
+}
+}; /* namespace raptor_raytracer */
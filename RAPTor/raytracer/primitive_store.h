@@ -1,6 +1,7 @@
 #pragma once
 
 /* Standard headers */
+#include <deque>
 #include <vector>
 
 /* Boost headers */
@@ -14,6 +15,9 @@
 
 namespace raptor_raytracer
 {
+/* Forward declarations */
+class scene_cache;
+
 class primitive_store
 {
     public :
@@ -25,14 +29,76 @@ class primitive_store
             return *this;
         }
 
-        template<class ...Args>
-        int emplace_back(Args... args)
+        /* Add a primitive without vertex normals or texture co-ordinates */
+        int emplace_back(material *const m, const point_t<> &a, const point_t<> &b, const point_t<> &c, const bool l = false)
         {
-            _prims.emplace_back(args...);
-            _indirect.push_back(_indirect.size());
-            return _prims.size() - 1;
+            return add_primitive(m, a, b, c, l, nullptr);
+        }
+
+        /* Add a primitive indexing the shared vertex normals and texture co-ordinates, either may be null */
+        int emplace_back(material *const m, const point_t<> &a, const point_t<> &b, const point_t<> &c, const bool l, const int *const vn, const int *const vt)
+        {
+            if ((vn == nullptr) && (vt == nullptr))
+            {
+                return add_primitive(m, a, b, c, l, nullptr);
+            }
+
+            _attributes.push_back({ { nullptr, nullptr, nullptr }, { nullptr, nullptr, nullptr } });
+            vertex_attributes *const v = &_attributes.back();
+            for (int i = 0; i < 3; ++i)
+            {
+                if (vn != nullptr)
+                {
+                    v->vn[i] = &_normals[vn[i]];
+                }
+
+                if (vt != nullptr)
+                {
+                    v->vt[i] = &_texture_coords[vt[i]];
+                }
+            }
+
+            return add_primitive(m, a, b, c, l, v);
+        }
+
+        /* Add a primitive with its own vertex normals and texture co-ordinates, either may be null */
+        /* These are added to the shared arrays, but are not shared with other primitives */
+        int emplace_back(material *const m, const point_t<> &a, const point_t<> &b, const point_t<> &c, const bool l, const point_t<> *const vn, const point_t<> *const vt = nullptr)
+        {
+            int vn_idx[3];
+            int vt_idx[3];
+            for (int i = 0; i < 3; ++i)
+            {
+                if (vn != nullptr)
+                {
+                    vn_idx[i] = add_normal(vn[i]);
+                }
+
+                if (vt != nullptr)
+                {
+                    vt_idx[i] = add_texture_coord(vt[i]);
+                }
+            }
+
+            return emplace_back(m, a, b, c, l, ((vn == nullptr) ? nullptr : &vn_idx[0]), ((vt == nullptr) ? nullptr : &vt_idx[0]));
+        }
+
+        /* Shared vertex normals and texture co-ordinates, returns the index to add primitives with */
+        int add_normal(const point_t<> &n)
+        {
+            _normals.push_back(n);
+            return _normals.size() - 1;
+        }
+
+        int add_texture_coord(const point_t<> &t)
+        {
+            _texture_coords.push_back(t);
+            return _texture_coords.size() - 1;
         }
 
+        const point_t<> &   normal(const int i)         const { return _normals[i];         }
+        const point_t<> &   texture_coord(const int i)  const { return _texture_coords[i];  }
+
         /* Direct access to primitives */
         triangle *          primitive(const int i)          { return &_prims[i];    }
         const triangle *    primitive(const int i) const    { return &_prims[i];    }
@@ -86,6 +152,10 @@ class primitive_store
         int     size()      const { return _prims.size();       }
         int     capacity()  const { return _prims.capacity();   }
 
+        int     number_of_normals()             const { return _normals.size();         }
+        int     number_of_texture_coords()      const { return _texture_coords.size();  }
+        int     number_of_vertex_attributes()   const { return _attributes.size();      }
+
         /* Special */
         primitive_store& move_to_indirect()
         {
@@ -106,7 +176,20 @@ class primitive_store
 
 
     private :
-        std::vector<triangle>   _prims;
-        std::vector<int>        _indirect;
+        friend class scene_cache;
+
+        int add_primitive(material *const m, const point_t<> &a, const point_t<> &b, const point_t<> &c, const bool l, const vertex_attributes *const v)
+        {
+            _prims.emplace_back(m, a, b, c, l, v);
+            _indirect.push_back(_indirect.size());
+            return _prims.size() - 1;
+        }
+
+        /* Deques so triangles can point to vertex attributes that never move as more are added */
+        std::vector<triangle>           _prims;
+        std::vector<int>                _indirect;
+        std::deque<point_t<>>           _normals;
+        std::deque<point_t<>>           _texture_coords;
+        std::deque<vertex_attributes>   _attributes;
 };
 }; /* namespace raptor_raytracer */
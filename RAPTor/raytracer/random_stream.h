@@ -0,0 +1,75 @@
+#pragma once
+
+/* Standard headers */
+#include <cstdint>
+
+/* Boost headers */
+
+/* Common headers */
+
+
+namespace raptor_raytracer
+{
+/* Counter based random numbers. Each number is a hash of the stream key and how many numbers have been taken. */
+/* Streams seeded from a pixel give the same numbers whichever thread traces the pixel and whatever it traced    */
+/* before, so images dont depend on the number of threads. Each thread has its own stream so nothing is shared   */
+class random_stream
+{
+    public :
+        /* Types to meet UniformRandomBitGenerator so this can drive the std distributions */
+        using result_type = std::uint32_t;
+
+        explicit random_stream(const std::uint32_t s = 0) : _key(hash(s)), _ctr(0) {  }
+
+        static constexpr result_type min() { return 0;             }
+        static constexpr result_type max() { return 0xffffffff;    }
+
+        /* The stream for this thread */
+        static random_stream & thread_stream()
+        {
+            static thread_local random_stream stream;
+            return stream;
+        }
+
+        /* Restart the stream */
+        void seed(const std::uint32_t s = 0)
+        {
+            _key = hash(s);
+            _ctr = 0;
+        }
+
+        /* Restart the stream for the pixel or block of pixels at x, y */
+        void seed(const std::uint32_t x, const std::uint32_t y, const std::uint32_t s = 0)
+        {
+            _key = hash(hash(hash(s) + x) + y);
+            _ctr = 0;
+        }
+
+        /* Next 32 bit number in the stream */
+        result_type operator()()
+        {
+            return hash(_key + (_ctr++ * 0x9e3779b9u));
+        }
+
+        /* Next float in the range [0.0, 1.0) */
+        float next()
+        {
+            return static_cast<float>((*this)() >> 8) * (1.0f / 16777216.0f);
+        }
+
+    private :
+        /* 32 bit integer finaliser, every input bit affects every output bit */
+        static std::uint32_t hash(std::uint32_t x)
+        {
+            x ^= x >> 16;
+            x *= 0x7feb352du;
+            x ^= x >> 15;
+            x *= 0x846ca68bu;
+            x ^= x >> 16;
+            return x;
+        }
+
+        std::uint32_t   _key;
+        std::uint32_t   _ctr;
+};
+}; /* namespace raptor_raytracer */
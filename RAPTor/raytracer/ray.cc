@@ -1,6 +1,7 @@
 #include "ray.h"
 #include "triangle.h"
 #include "light.h"
+#include "random_stream.h"
 
 
 namespace raptor_raytracer
@@ -153,12 +154,13 @@ float ray::reflect(ray rays[], const point_t<> &n, const float r, const float dr
     cross_product(ref, perpen, &cross);
     
     /* Number of rays to create */
+    random_stream &rng = random_stream::thread_stream();
     int nr_rays = max(((int)DIFFUSE_REFLECTIONS/this->componant), 1);
     for (int i = 0; i < nr_rays; ++i)
     {
         /* Pick random offsets */
-        float r_off = gen_random_mersenne_twister() * dr;
-        float a_off = gen_random_mersenne_twister() * (2.0f * PI);
+        float r_off = rng.next() * dr;
+        float a_off = rng.next() * (2.0f * PI);
         float x_off = r_off * cos_lut.get_cos(a_off);
         float y_off = r_off * cos_lut.get_sin(a_off);
 
@@ -252,12 +254,13 @@ float ray::refract(ray rays[], const point_t<> &n, const float t, float ri, cons
     cross_product(ref, perpen, &cross);
 
     /* Create a number of rays with a little bit of noise added to their direction */
+    random_stream &rng = random_stream::thread_stream();
     int nr_rays = max(((int)DIFFUSE_REFLECTIONS/this->componant), 1);
     for (int i = 0; i < nr_rays; i++)
     {
         /* Pick random offsets */
-        float r_off = gen_random_mersenne_twister() * dr;
-        float a_off = gen_random_mersenne_twister() * (2.0f * PI);
+        float r_off = rng.next() * dr;
+        float a_off = rng.next() * (2.0f * PI);
         float x_off = r_off * cos_lut.get_cos(a_off);
         float y_off = r_off * cos_lut.get_sin(a_off);
 
@@ -0,0 +1,101 @@
+/* Standard headers */
+#include <algorithm>
+
+/* Common headers */
+#include "simd.h"
+
+/* Ray tracer headers */
+#include "ray_sorter.h"
+
+
+namespace raptor_raytracer
+{
+void ray_sorter::sort(const ray *const r, int *const order, const int n)
+{
+    if (n <= 0)
+    {
+        return;
+    }
+
+    /* Bound the origins, if they are all the same (camera rays) bound the directions instead */
+    point_t<> lo(r[0].get_ogn());
+    point_t<> hi(r[0].get_ogn());
+    for (int i = 1; i < n; ++i)
+    {
+        lo = min(lo, r[i].get_ogn());
+        hi = max(hi, r[i].get_ogn());
+    }
+
+    const bool by_dir = (lo == hi);
+    if (by_dir)
+    {
+        lo = r[0].get_dir();
+        hi = r[0].get_dir();
+        for (int i = 1; i < n; ++i)
+        {
+            lo = min(lo, r[i].get_dir());
+            hi = max(hi, r[i].get_dir());
+        }
+    }
+
+    /* Scale to 9 bits per axis */
+    const point_t<> width(hi - lo);
+    const float x_mul = (width.x > 0.0f) ? (511.0f / width.x) : 0.0f;
+    const float y_mul = (width.y > 0.0f) ? (511.0f / width.y) : 0.0f;
+    const float z_mul = (width.z > 0.0f) ? (511.0f / width.z) : 0.0f;
+
+    /* Build keys */
+    _keys.resize(n);
+    for (int i = 0; i < n; ++i)
+    {
+        const point_t<> o((by_dir ? r[i].get_dir() : r[i].get_ogn()) - lo);
+        const unsigned mc = morton_code(o.x, o.y, o.z, x_mul, y_mul, z_mul);
+        _keys[i] = (octant(r[i]) << 27) | mc;
+        order[i] = i;
+    }
+
+    radix_sort(order, n);
+}
+
+
+void ray_sorter::radix_sort(int *const order, const int n)
+{
+    _key_buffer.resize(n);
+    _order_buffer.resize(n);
+
+    unsigned *keys_from = _keys.data();
+    unsigned *keys_to   = _key_buffer.data();
+    int *order_from     = order;
+    int *order_to       = _order_buffer.data();
+    for (int shift = 0; shift < 30; shift += 10)
+    {
+        /* Histogram */
+        int hist[1025];
+        std::fill_n(&hist[0], 1025, 0);
+        for (int i = 0; i < n; ++i)
+        {
+            ++hist[((keys_from[i] >> shift) & 0x3ff) + 1];
+        }
+
+        /* Prefix sum to find where each bucket starts */
+        for (int i = 1; i < 1025; ++i)
+        {
+            hist[i] += hist[i - 1];
+        }
+
+        /* Scatter */
+        for (int i = 0; i < n; ++i)
+        {
+            const int pos = hist[(keys_from[i] >> shift) & 0x3ff]++;
+            keys_to[pos]    = keys_from[i];
+            order_to[pos]   = order_from[i];
+        }
+
+        std::swap(keys_from, keys_to);
+        std::swap(order_from, order_to);
+    }
+
+    /* Odd number of passes, so the result is in the buffer */
+    std::copy(&order_from[0], &order_from[n], &order[0]);
+}
+}; /* namespace raptor_raytracer */
@@ -0,0 +1,41 @@
+#pragma once
+
+/* Standard headers */
+#include <vector>
+
+/* Boost headers */
+#include "boost/noncopyable.hpp"
+
+/* Common headers */
+#include "common.h"
+
+/* Ray tracer headers */
+#include "ray.h"
+
+
+namespace raptor_raytracer
+{
+/* Class to order rays so that neighbouring rays are coherent. Rays are grouped by the octant of their
+   direction and then follow the Morton order of their origin within the bounds of all origins. Rays
+   from a single origin follow the Morton order of their direction instead */
+class ray_sorter : private boost::noncopyable
+{
+    public :
+        /* Sort n rays, order receives the indices of the rays in sorted order */
+        void sort(const ray *const r, int *const order, const int n);
+
+        /* The octant of a direction, bit 0 is set for negative x, bit 1 for y and bit 2 for z */
+        static int octant(const ray &r)
+        {
+            return (r.get_x_grad() < 0.0f) | ((r.get_y_grad() < 0.0f) << 1) | ((r.get_z_grad() < 0.0f) << 2);
+        }
+
+    private :
+        /* Sort keys are 3 bits of octant above a 27 bit Morton code, sorted 10 bits at a time */
+        void radix_sort(int *const order, const int n);
+
+        std::vector<unsigned>   _keys;
+        std::vector<unsigned>   _key_buffer;
+        std::vector<int>        _order_buffer;
+};
+}; /* namespace raptor_raytracer */
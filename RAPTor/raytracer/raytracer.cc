@@ -1,4 +1,7 @@
 /* Standard headers */
+#include <algorithm>
+#include <memory>
+#include <vector>
 
 /* Boost headers */
 
@@ -8,6 +11,8 @@
 #include "raytracer.h"
 #include "secondary_ray_data.h"
 #include "ssd.h"
+#include "random_stream.h"
+#include "texture_cache.h"
 
 
 namespace raptor_raytracer
@@ -17,6 +22,20 @@ namespace raptor_raytracer
     tbb::task_scheduler_init init(tbb::task_scheduler_init::automatic);
 #endif
 
+inline const triangle * ray_trace_engine::hit_primitive(const int i, const instance_transform **const xfm) const
+{
+    const triangle *const tri = _ssd->instanced_primitive(i, xfm);
+    if (tri != nullptr)
+    {
+        return tri;
+    }
+
+    assert(i >= 0);
+    assert(i < _prims.size());
+    return _prims.primitive(i);
+}
+
+
 void ray_trace_engine::ray_trace(ray &r, ext_colour_t *const c) const
 {
     /* Does the ray intersect any objects */
@@ -27,7 +46,8 @@ void ray_trace_engine::ray_trace(ray &r, ext_colour_t *const c) const
     /* If there was an intersection set the rays endpoint and call that objects shader */
     if (hit_type.d < MAX_DIST)
     {
-        const auto  *const tri = _prims.primitive(tri_idx);
+        const instance_transform *xfm;
+        const auto  *const tri = hit_primitive(tri_idx, &xfm);
         r.calculate_destination(hit_type.d);
         
         point_t<> vt;
@@ -38,7 +58,7 @@ void ray_trace_engine::ray_trace(ray &r, ext_colour_t *const c) const
         secondary_ray_data refr;
         refl.colours(&refl_colour[0]);
         refr.colours(&refr_colour[0]);
-        const point_t<> vn(tri->generate_rays(*this, r, &vt, &hit_type, &refl, &refr));
+        const point_t<> vn(tri->generate_rays(*this, r, &vt, &hit_type, &refl, &refr, xfm));
         
         /* Trace shadow rays */
         for (unsigned int i = 0; i < this->lights.size(); ++i)
@@ -59,7 +79,7 @@ void ray_trace_engine::ray_trace(ray &r, ext_colour_t *const c) const
             /* Collect the illumintation data */
             if (this->nr_pending_shadows[shader] > 0.0f)
             {
-                this->pending_shadows[ray_addr].set_magnitude(made_it / this->nr_pending_shadows[shader]);
+                this->pending_shadows[ray_addr].set_magnitude((made_it / this->nr_pending_shadows[shader]) * light_weight(shader));
             }
         }
 
@@ -91,7 +111,7 @@ void ray_trace_engine::ray_trace(ray &r, ext_colour_t *const c) const
 void ray_trace_engine::shoot_shadow_packet(packet_ray *const r, ray *const *const sr, vfp_t *const t, unsigned int *r_to_s, int *m, const int s, const int l) const
 {
     /* Coherency check */
-    bool    coherant = (s > 4);
+    bool    coherant = ((s << LOG2_SIMD_WIDTH) > 16);
     int     size[MAXIMUM_PACKET_SIZE];
 
     const int pkt_x_dir = move_mask(r[0].get_x_grad());
@@ -157,7 +177,7 @@ void ray_trace_engine::shoot_shadow_packet(packet_ray *const r, ray *const *cons
         _ssd->frustrum_found_nearer_object(&r[0], &t[0], &closer[0], s);
         for (int k = 0; k < (s << LOG2_SIMD_WIDTH); ++k)
         {
-            m[r_to_s[k]] += static_cast<int>(closer[k >> LOG2_SIMD_WIDTH][k & 0x3] == 0.0f);
+            m[r_to_s[k]] += static_cast<int>(closer[k >> LOG2_SIMD_WIDTH][k & (SIMD_WIDTH - 1)] == 0.0f);
         }
     }
     
@@ -165,14 +185,10 @@ void ray_trace_engine::shoot_shadow_packet(packet_ray *const r, ray *const *cons
 }
 
 
-void ray_trace_engine::ray_trace(packet_ray *const r, ext_colour_t *const c, const unsigned int *const ray_to_colour_lut, const int s) const
+void ray_trace_engine::find_nearest_packet(packet_ray *const r, int *const tri_idx, packet_hit_description *const h, const int s) const
 {
-    int tri_idx[MAXIMUM_PACKET_SIZE << LOG2_SIMD_WIDTH];
-    std::fill_n(&tri_idx[0], MAXIMUM_PACKET_SIZE << LOG2_SIMD_WIDTH, -1);
-    packet_hit_description h[MAXIMUM_PACKET_SIZE];
-
     /* Check co-herency */
-    bool coherant = (s > 4);
+    bool coherant = ((s << LOG2_SIMD_WIDTH) > 16);
     int size[MAXIMUM_PACKET_SIZE];
     const int pkt_x_dir = move_mask(r[0].get_x_grad());
     const int pkt_y_dir = move_mask(r[0].get_y_grad());
@@ -230,6 +246,16 @@ void ray_trace_engine::ray_trace(packet_ray *const r, ext_colour_t *const c, con
     {
         _ssd->frustrum_find_nearest_object(r, reinterpret_cast<vint_t *>(&tri_idx[0]), &h[0], s);
     }
+}
+
+
+void ray_trace_engine::ray_trace(packet_ray *const r, ext_colour_t *const c, const unsigned int *const ray_to_colour_lut, const int s) const
+{
+    int tri_idx[MAXIMUM_PACKET_SIZE << LOG2_SIMD_WIDTH] __attribute__ ((aligned(SIMD_WIDTH * 4)));
+    std::fill_n(&tri_idx[0], MAXIMUM_PACKET_SIZE << LOG2_SIMD_WIDTH, -1);
+    packet_hit_description h[MAXIMUM_PACKET_SIZE];
+
+    this->find_nearest_packet(r, &tri_idx[0], &h[0], s);
 
     /* Generate secondary rays */
     const triangle * tri[MAXIMUM_PACKET_SIZE << LOG2_SIMD_WIDTH];
@@ -256,13 +282,13 @@ void ray_trace_engine::ray_trace(packet_ray *const r, ext_colour_t *const c, con
             {
                 this->shader_nr = addr;
                 int ray_addr = addr * MAX_SECONDARY_RAYS;
-                assert(tri_idx[addr] >= 0);
-                assert(tri_idx[addr] < _prims.size());
-                tri[addr] = _prims.primitive(tri_idx[addr]);
-                vn[addr] = tri[addr]->generate_rays(*this, ray_p[addr], &vt[addr], &hit_p[addr], &refl[ray_addr], &refr[ray_addr]);
+                const instance_transform *xfm;
+                tri[addr] = hit_primitive(tri_idx[addr], &xfm);
+                vn[addr] = tri[addr]->generate_rays(*this, ray_p[addr], &vt[addr], &hit_p[addr], &refl[ray_addr], &refr[ray_addr], xfm);
             }
             else
             {
+                tri[addr] = nullptr;
                 for (unsigned int l = 0; l < this->lights.size(); ++l)
                 {
                     const unsigned int nr_addr          = (l * (MAXIMUM_PACKET_SIZE * SIMD_WIDTH)) + addr;
@@ -334,28 +360,23 @@ void ray_trace_engine::ray_trace(packet_ray *const r, ext_colour_t *const c, con
             
             if (this->nr_pending_shadows[shader] > 0.0f)
             {
-                this->pending_shadows[addr].set_magnitude(made_it[k] / this->nr_pending_shadows[shader]);
+                this->pending_shadows[addr].set_magnitude((made_it[k] / this->nr_pending_shadows[shader]) * light_weight(shader));
             }
         }
     }
     
 
-    /* If there was an intersection set the rays endpoint and call that objects shader */
+    /* Colour misses with the background colour and shade the hits a material at a time */
+    ext_colour_t *c_p[MAXIMUM_PACKET_SIZE << LOG2_SIMD_WIDTH];
     for (int i = 0; i < (s << LOG2_SIMD_WIDTH); ++i)
     {
-        const unsigned int addr = ray_to_colour_lut[i];
-        this->shader_nr = i;
-
-        if (hit_p[i].d < MAX_DIST)
-        {
-            tri[i]->shade(*this, ray_p[i], vn[i], vt[i], hit_p[i], &c[addr]);
-        }
-        /* Otherwise colour with the background colour */
-        else
+        c_p[i] = &c[ray_to_colour_lut[i]];
+        if (tri[i] == nullptr)
         {
-            c[addr] = this->c.shade(&ray_p[i]);
+            *c_p[i] = this->c.shade(&ray_p[i]);
         }
     }
+    this->shade_batch(tri, ray_p, vn, vt, hit_p, c_p, s << LOG2_SIMD_WIDTH);
 
     /* Recurse for reflections */
     /* Pack the rays into a packet */
@@ -463,6 +484,9 @@ void ray_trace_engine::ray_trace(packet_ray *const r, ext_colour_t *const c, con
 
 void ray_trace_engine::ray_trace_one_packet(const int x, const int y) const
 {
+    /* Sample from a stream for this packet so the image doesnt depend on the thread that traces it */
+    random_stream::thread_stream().seed(x, y);
+
     /* Create a packet of rays through the screen */
     packet_ray r[MAXIMUM_PACKET_SIZE];
     this->c.pixel_to_co_ordinate(r, x, y);
@@ -484,7 +508,7 @@ void ray_trace_engine::ray_trace_one_packet(const int x, const int y) const
 #endif /* #ifdef SIMD_PACKET_TRACING */
 
 
-inline void ray_trace_engine::ray_trace_one_pixel(const int x, const int y) const
+inline void ray_trace_engine::ray_trace_one_pixel(const int x, const int y, const int size) const
 {
     /* Convert to co-ordinate system */
     // point_t<> ray_dir(this->c.pixel_to_co_ordinate(x, y));
@@ -496,6 +520,9 @@ inline void ray_trace_engine::ray_trace_one_pixel(const int x, const int y) cons
     // ext_colour_t pixel_colour;
     // ray_trace(ray_0, &pixel_colour);
 
+    /* Sample from a stream for this pixel so the image doesnt depend on the thread that traces it */
+    random_stream::thread_stream().seed(x, y);
+
     int total_samples = 0;
     std::vector<ray> rays;
     ext_colour_t pixel_colour;
@@ -503,10 +530,9 @@ inline void ray_trace_engine::ray_trace_one_pixel(const int x, const int y) cons
     ext_colour_t mean;
     ext_colour_t stderr;
     const float tolerance = 1.0f;
-    static int max_sample = 0;
     do
     {
-        const int samples = c.pixel_to_co_ordinate(&rays, x, y, 1, 1, 16);
+        const int samples = c.pixel_to_co_ordinate(&rays, x, y, 0, 0, 16);
         total_samples += samples;
 
         /* Work on the pixel as a float and then saturate back to an unsigned char */
@@ -525,75 +551,641 @@ inline void ray_trace_engine::ray_trace_one_pixel(const int x, const int y) cons
         stderr = sqrt(var) * (1.96f / std::sqrt(total_samples));
     } while (stderr > (tolerance * tolerance));
 
-    max_sample = std::max(max_sample, total_samples);
-    std::cout << "pixel " << x << ", " << y << " samples " << total_samples << " max samples so far " << max_sample << std::endl;
-    pixel_colour = mean;
-
     /* Saturate colours and save output */
-    this->c.set_pixel(pixel_colour, x, y);
+    this->set_block(mean, x, y, size);
 }
 
 
-#ifdef THREADED_RAY_TRACE
-void ray_trace_engine::operator() (const tbb::blocked_range2d<unsigned>& r) const
+/* Call f and attribute the work it does tracing through the ssd to the pixels from (x0, y0) up to (x1, y1) */
+template<class F>
+inline void count_traversal(camera &c, const int x0, const int y0, const int x1, const int y1, const F &f)
+{
+#ifdef TRAVERSAL_STATISTICS
+    const traversal_statistics before(thread_traversal_statistics);
+    f();
+    c.add_traversal_statistics(thread_traversal_statistics - before, x0, y0, x1, y1);
+#else
+    f();
+#endif /* #ifdef TRAVERSAL_STATISTICS */
+}
+
+
+void ray_trace_engine::ray_trace_tile(const tile &t, const int step, const int prev_step) const
 {
 #ifdef SIMD_PACKET_TRACING
-    for (unsigned y = r.rows().begin(); y != r.rows().end(); ++y)
-    {     
-        for(unsigned x = r.cols().begin(); x != r.cols().end(); ++x)
+    /* Full resolution is traced in packets */
+    if (step == 1)
+    {
+        for (int y = t.y0; y < t.y1; y += PACKET_WIDTH)
         {
-            this->ray_trace_one_packet((x * PACKET_WIDTH), (y * PACKET_WIDTH));
-        }                     
+            for (int x = t.x0; x < t.x1; x += PACKET_WIDTH)
+            {
+                count_traversal(this->c, x, y, x + PACKET_WIDTH, y + PACKET_WIDTH, [this, x, y]()
+                {
+                    this->ray_trace_one_packet(x, y);
+                });
+            }
+        }
+        return;
     }
+#endif /* #ifdef SIMD_PACKET_TRACING */
 
-#else
-    /* Trace the square block specified in r */
-    for (unsigned y = r.rows().begin(); y != r.rows().end(); ++y)
-    {     
-        for(unsigned x = r.cols().begin(); x != r.cols().end(); ++x)
+    /* Tiles start on a multiple of all steps so pixels already traced are on a multiple of prev_step */
+    for (int y = t.y0; y < t.y1; y += step)
+    {
+        for (int x = t.x0; x < t.x1; x += step)
         {
-            this->ray_trace_one_pixel(x, y);
-        }                     
+            if ((prev_step > 0) && ((x % prev_step) == 0) && ((y % prev_step) == 0))
+            {
+                continue;
+            }
+
+            count_traversal(this->c, x, y, x + step, y + step, [this, x, y, step]()
+            {
+                this->ray_trace_one_pixel(x, y, step);
+            });
+        }
     }
-#endif /* #ifdef SIMD_PACKET_TRACING */
 }
-#endif /* #ifdef THREADED_RAY_TRACE */
 
-/* Ray tracer main function */
-void ray_tracer(const ssd *const sub_division, const light_list &lights, const primitive_store &everything, camera &c)
+
+void ray_trace_engine::ray_trace_tile_wavefront(const tile &t, const int step, const int prev_step) const
+{
+    /* Sample from a stream for this tile, the tile is traced in a fixed order so the image doesnt depend on the thread that traces it */
+    random_stream::thread_stream().seed(t.x0, t.y0);
+
+    /* Generate the camera rays of every pixel in the tile, depth of field gives many rays per pixel */
+    std::vector<ray> rays;
+    std::vector<ray> samples;
+    std::vector<int> first_sample;
+    for (int y = t.y0; y < t.y1; y += step)
+    {
+        for (int x = t.x0; x < t.x1; x += step)
+        {
+            if ((prev_step > 0) && ((x % prev_step) == 0) && ((y % prev_step) == 0))
+            {
+                continue;
+            }
+
+            first_sample.push_back(rays.size());
+            const int nr = c.pixel_to_co_ordinate(&samples, x, y, 0, 0, 16);
+            rays.insert(rays.end(), samples.begin(), samples.begin() + nr);
+        }
+    }
+    first_sample.push_back(rays.size());
+
+    /* Trace the tile as one wave */
+    std::vector<ext_colour_t> colours(rays.size());
+    this->ray_trace_wavefront(rays.data(), colours.data(), rays.size());
+
+    /* Average the samples and save output */
+    int pixel = 0;
+    for (int y = t.y0; y < t.y1; y += step)
+    {
+        for (int x = t.x0; x < t.x1; x += step)
+        {
+            if ((prev_step > 0) && ((x % prev_step) == 0) && ((y % prev_step) == 0))
+            {
+                continue;
+            }
+
+            ext_colour_t pixel_colour;
+            for (int i = first_sample[pixel]; i < first_sample[pixel + 1]; ++i)
+            {
+                pixel_colour += colours[i];
+            }
+
+            this->set_block(pixel_colour / static_cast<float>(first_sample[pixel + 1] - first_sample[pixel]), x, y, step);
+            ++pixel;
+        }
+    }
+}
+
+
+void ray_trace_engine::ray_trace_tile_adaptive(const tile &t, const std::vector<char> &refine, const trace_mode_t m) const
+{
+    /* Sample from a stream for this tile, but not the same one as the first sample of the pixels */
+    random_stream::thread_stream().seed(t.x0, t.y0, 1);
+
+    /* Generate the camera rays of the sub pixel samples not yet traced of each pixel being refined */
+    const int x_res     = this->c.x_number_of_rays();
+    const int x_samples = this->c.x_adaptive_samples();
+    const int y_samples = this->c.y_adaptive_samples();
+    std::vector<ray> rays;
+    std::vector<ray> samples;
+    std::vector<int> first_sample;
+    for (int y = t.y0; y < t.y1; ++y)
+    {
+        for (int x = t.x0; x < t.x1; ++x)
+        {
+            if (!refine[x + (y * x_res)])
+            {
+                continue;
+            }
+
+            for (int a_y = 0; a_y < y_samples; ++a_y)
+            {
+                for (int a_x = (a_y == 0); a_x < x_samples; ++a_x)
+                {
+                    first_sample.push_back(rays.size());
+                    const int nr = c.pixel_to_co_ordinate(&samples, x, y, a_x, a_y, 16);
+                    rays.insert(rays.end(), samples.begin(), samples.begin() + nr);
+                }
+            }
+        }
+    }
+    first_sample.push_back(rays.size());
+
+    /* Trace the samples */
+    std::vector<ext_colour_t> colours(rays.size());
+    if (m == trace_mode_t::wavefront)
+    {
+        this->ray_trace_wavefront(rays.data(), colours.data(), rays.size());
+    }
+    else
+    {
+        for (int i = 0; i < static_cast<int>(rays.size()); ++i)
+        {
+            this->ray_trace(rays[i], &colours[i]);
+        }
+    }
+
+    /* Average the new samples with the first sample and save output */
+    const int sub_samples = (x_samples * y_samples) - 1;
+    const float pixel_samples_inv = 1.0f / static_cast<float>(x_samples * y_samples);
+    int sample = 0;
+    for (int y = t.y0; y < t.y1; ++y)
+    {
+        for (int x = t.x0; x < t.x1; ++x)
+        {
+            if (!refine[x + (y * x_res)])
+            {
+                continue;
+            }
+
+            ext_colour_t pixel_colour(this->c.get_pixel(x, y));
+            for (int i = 0; i < sub_samples; ++i, ++sample)
+            {
+                ext_colour_t sample_colour;
+                for (int j = first_sample[sample]; j < first_sample[sample + 1]; ++j)
+                {
+                    sample_colour += colours[j];
+                }
+
+                pixel_colour += sample_colour / static_cast<float>(first_sample[sample + 1] - first_sample[sample]);
+            }
+
+            this->c.set_pixel(pixel_colour * pixel_samples_inv, x, y);
+        }
+    }
+}
+
+
+void ray_trace_engine::ray_trace_wavefront(ray *const r, ext_colour_t *const c, const int n) const
+{
+    if (n == 0)
+    {
+        return;
+    }
+
+    /* Find the nearest intersections in sorted order */
+    std::vector<int> order(n);
+    _sorter.sort(r, order.data(), n);
+
+    std::vector<int> tri_idx(n, -1);
+    std::vector<hit_description> h(n);
+    this->find_nearest_wavefront(r, order.data(), tri_idx.data(), h.data(), n);
+
+    /* Generate secondary and shadow rays, keeping the first shadow ray to each light for the shader */
+    const int nr_lights = this->lights.size();
+    std::vector<const triangle *>   tri(n, nullptr);
+    std::vector<point_t<>>          vn(n);
+    std::vector<point_t<>>          vt(n);
+    std::vector<secondary_ray_data> refl(n);
+    std::vector<secondary_ray_data> refr(n);
+    std::vector<ray>                illum(n * nr_lights);
+    std::vector<float>              nr_illum(n * nr_lights, 0.0f);
+    std::vector<float>              w_illum(n * nr_lights, 1.0f);
+    std::vector<ray>                shadows;
+    std::vector<int>                shadow_owner;
+    this->shader_nr = 0;
+    for (int i = 0; i < n; ++i)
+    {
+        if (h[i].d >= MAX_DIST)
+        {
+            continue;
+        }
+
+        r[i].calculate_destination(h[i].d);
+        const instance_transform *xfm;
+        tri[i] = hit_primitive(tri_idx[i], &xfm);
+        vn[i] = tri[i]->generate_rays(*this, r[i], &vt[i], &h[i], &refl[i], &refr[i], xfm);
+        for (int l = 0; l < nr_lights; ++l)
+        {
+            const int ray_addr  = (l * (SHADOW_ARRAY_SIZE * MAXIMUM_PACKET_SIZE * SIMD_WIDTH));
+            const int shader    = (l * (MAXIMUM_PACKET_SIZE * SIMD_WIDTH));
+            const int owner     = (i * nr_lights) + l;
+            illum[owner]    = this->pending_shadows[ray_addr];
+            nr_illum[owner] = this->nr_pending_shadows[shader];
+            w_illum[owner]  = light_weight(shader);
+            for (int k = 0; k < this->nr_pending_shadows[shader]; ++k)
+            {
+                shadows.push_back(this->pending_shadows[ray_addr + k]);
+                shadow_owner.push_back(owner);
+            }
+        }
+    }
+
+    /* Trace the shadow rays of the whole wave in sorted order */
+    std::vector<int> made_it(n * nr_lights, 0);
+    std::vector<int> shadow_order(shadows.size());
+    _sorter.sort(shadows.data(), shadow_order.data(), shadows.size());
+    this->found_nearer_wavefront(shadows.data(), shadow_order.data(), shadow_owner.data(), made_it.data(), shadows.size());
+
+    /* Shade as many hits at a time as there are shaders */
+    std::vector<ext_colour_t *> c_p(n);
+    for (int b = 0; b < n; b += (MAXIMUM_PACKET_SIZE * SIMD_WIDTH))
+    {
+        const int e = std::min(n, b + (MAXIMUM_PACKET_SIZE * SIMD_WIDTH));
+        for (int i = b; i < e; ++i)
+        {
+            /* Colour misses with the background colour */
+            c_p[i] = &c[i];
+            if (tri[i] == nullptr)
+            {
+                c[i] = this->c.shade(&r[i]);
+                continue;
+            }
+
+            /* Restore the illumintation data for the shader */
+            for (int l = 0; l < nr_lights; ++l)
+            {
+                const int ray_addr  = (l * (SHADOW_ARRAY_SIZE * MAXIMUM_PACKET_SIZE * SIMD_WIDTH)) + ((i - b) * SHADOW_ARRAY_SIZE);
+                const int shader    = (l * (MAXIMUM_PACKET_SIZE * SIMD_WIDTH)) + (i - b);
+                const int owner     = (i * nr_lights) + l;
+                this->pending_shadows[ray_addr]     = illum[owner];
+                this->nr_pending_shadows[shader]    = nr_illum[owner];
+                if (nr_illum[owner] > 0.0f)
+                {
+                    this->pending_shadows[ray_addr].set_magnitude((made_it[owner] / nr_illum[owner]) * w_illum[owner]);
+                }
+            }
+        }
+
+        this->shade_batch(&tri[b], &r[b], &vn[b], &vt[b], &h[b], &c_p[b], e - b);
+    }
+
+    /* Gather the reflected and refracted rays into the next wave */
+    int nr_next = 0;
+    for (int i = 0; i < n; ++i)
+    {
+        nr_next += static_cast<int>(refl[i].number()) + static_cast<int>(refr[i].number());
+    }
+
+    if (nr_next == 0)
+    {
+        return;
+    }
+
+    std::vector<ray>            next(nr_next);
+    std::vector<ext_colour_t>   next_colour(nr_next);
+    int addr = 0;
+    for (int i = 0; i < n; ++i)
+    {
+        refl[i].colours(&next_colour[addr]);
+        for (int j = 0; j < static_cast<int>(refl[i].number()); ++j)
+        {
+            next[addr++] = refl[i].rays()[j];
+        }
+
+        refr[i].colours(&next_colour[addr]);
+        for (int j = 0; j < static_cast<int>(refr[i].number()); ++j)
+        {
+            next[addr++] = refr[i].rays()[j];
+        }
+    }
+
+    /* Trace the next bounce and combine it in the shaders */
+    this->ray_trace_wavefront(next.data(), next_colour.data(), nr_next);
+    for (int i = 0; i < n; ++i)
+    {
+        if (tri[i] != nullptr)
+        {
+            tri[i]->combind_secondary_rays(*this, &c[i], refl[i], refr[i]);
+        }
+    }
+}
+
+
+void ray_trace_engine::find_nearest_wavefront(ray *const r, const int *const order, int *const tri_idx, hit_description *const h, const int n) const
 {
-    /* Make the screen 20 wide and 20 high ie/ -10 to 10 */
-#ifdef THREADED_RAY_TRACE
 #ifdef SIMD_PACKET_TRACING
-    tbb::parallel_for(tbb:blocked_range2d<unsigned>(0, (unsigned)c.y_number_of_rays()/PACKET_WIDTH, 4, 0, (unsigned)c.x_number_of_rays()/PACKET_WIDTH, 4), ray_trace_engine(everything, lights, c, sub_division));
+    packet_ray              packets[MAXIMUM_PACKET_SIZE];
+    packet_hit_description  packet_h[MAXIMUM_PACKET_SIZE];
+    int                     packet_idx[MAXIMUM_PACKET_SIZE << LOG2_SIMD_WIDTH] __attribute__ ((aligned(SIMD_WIDTH * 4)));
+    int                     ray_idx[MAXIMUM_PACKET_SIZE << LOG2_SIMD_WIDTH];
+    const ray *             rays_this_packet[SIMD_WIDTH];
+    const auto trace_packets = [&](const int s)
+    {
+        if (s == 0)
+        {
+            return;
+        }
 
-#else
-    /* Thread using blocked_range2d to specify the size and triangle of block to trace */
-    tbb::parallel_for(tbb:blocked_range2d<unsigned>(0, c.y_number_of_rays(), 32, 0, c.x_number_of_rays(), 32), ray_trace_engine(everything, lights, c, sub_division));
+        std::fill_n(&packet_idx[0], s << LOG2_SIMD_WIDTH, -1);
+        this->find_nearest_packet(packets, &packet_idx[0], &packet_h[0], s);
+        for (int i = 0; i < s; ++i)
+        {
+            hit_description hits[SIMD_WIDTH];
+            packet_h[i].extract(&hits[0]);
+            for (int j = 0; j < SIMD_WIDTH; ++j)
+            {
+                const int addr = (i << LOG2_SIMD_WIDTH) + j;
+                tri_idx[ray_idx[addr]]  = packet_idx[addr];
+                h[ray_idx[addr]]        = hits[j];
+            }
+        }
+    };
 
-#endif /* #ifdef SIMD_PACKET_TRACING */
+    /* Pack rays with directions in the same octant, the sort keeps them together */
+    for (int i = 0; i < n; )
+    {
+        const int octant = ray_sorter::octant(r[order[i]]);
+        int end = i + 1;
+        while ((end < n) && (ray_sorter::octant(r[order[end]]) == octant))
+        {
+            ++end;
+        }
+
+        int nr_of_packets = 0;
+        for (; (i + SIMD_WIDTH) <= end; i += SIMD_WIDTH)
+        {
+            for (int j = 0; j < SIMD_WIDTH; ++j)
+            {
+                ray_idx[(nr_of_packets << LOG2_SIMD_WIDTH) + j] = order[i + j];
+                rays_this_packet[j] = &r[order[i + j]];
+            }
+
+            packets[nr_of_packets].pack(&rays_this_packet[0]);
+            packet_h[nr_of_packets] = packet_hit_description();
+            if (++nr_of_packets == MAXIMUM_PACKET_SIZE)
+            {
+                trace_packets(nr_of_packets);
+                nr_of_packets = 0;
+            }
+        }
+        trace_packets(nr_of_packets);
+
+        /* Trace rays mod SIMD_WIDTH alone */
+        for (; i < end; ++i)
+        {
+            tri_idx[order[i]] = _ssd->find_nearest_object(&r[order[i]], &h[order[i]]);
+        }
+    }
 #else
-    /* Instantiate the ray trace engine */
-    ray_trace_engine engine(everything, lights, c, sub_division);
-    
-    /* Trace a ray through each pixel of the screen working bottom left to top right */
+    for (int i = 0; i < n; ++i)
+    {
+        tri_idx[order[i]] = _ssd->find_nearest_object(&r[order[i]], &h[order[i]]);
+    }
+#endif /* #ifdef SIMD_PACKET_TRACING */
+}
+
+
+void ray_trace_engine::found_nearer_wavefront(ray *const r, const int *const order, const int *const owner, int *const made_it, const int n) const
+{
 #ifdef SIMD_PACKET_TRACING
-    for(unsigned y = 0; y < c.y_number_of_rays(); y += PACKET_WIDTH)
+    packet_ray      packets[MAXIMUM_PACKET_SIZE];
+    vfp_t           t[MAXIMUM_PACKET_SIZE];
+    ray *           rays_this_packet[MAXIMUM_PACKET_SIZE * SIMD_WIDTH];
+    unsigned int    ray_to_shader[MAXIMUM_PACKET_SIZE * SIMD_WIDTH];
+
+    /* Pack rays with directions in the same octant, the sort keeps them together */
+    for (int i = 0; i < n; )
     {
-        for(unsigned x = 0; x < c.x_number_of_rays(); x += PACKET_WIDTH)
+        const int octant = ray_sorter::octant(r[order[i]]);
+        int end = i + 1;
+        while ((end < n) && (ray_sorter::octant(r[order[end]]) == octant))
         {
-            engine.ray_trace_one_packet(x, y);
+            ++end;
+        }
+
+        int nr_of_packets = 0;
+        for (; (i + SIMD_WIDTH) <= end; i += SIMD_WIDTH)
+        {
+            for (int j = 0; j < SIMD_WIDTH; ++j)
+            {
+                rays_this_packet[(nr_of_packets << LOG2_SIMD_WIDTH) + j]  = &r[order[i + j]];
+                ray_to_shader[(nr_of_packets << LOG2_SIMD_WIDTH) + j]     = owner[order[i + j]];
+            }
+
+            t[nr_of_packets] = packets[nr_of_packets].pack(&rays_this_packet[nr_of_packets << LOG2_SIMD_WIDTH]);
+            if (++nr_of_packets == MAXIMUM_PACKET_SIZE)
+            {
+                this->shoot_shadow_packet(packets, rays_this_packet, t, ray_to_shader, made_it, nr_of_packets, 0);
+                nr_of_packets = 0;
+            }
+        }
+
+        if (nr_of_packets > 0)
+        {
+            this->shoot_shadow_packet(packets, rays_this_packet, t, ray_to_shader, made_it, nr_of_packets, 0);
+        }
+
+        /* Shoot rays mod SIMD_WIDTH alone */
+        for (; i < end; ++i)
+        {
+            if (!_ssd->found_nearer_object(&r[order[i]], r[order[i]].get_length()))
+            {
+                ++made_it[owner[order[i]]];
+            }
         }
     }
 #else
-    for(unsigned y = 0; y < c.y_number_of_rays(); ++y)
+    for (int i = 0; i < n; ++i)
     {
-        for(unsigned x = 0; x < c.x_number_of_rays(); ++x)
+        if (!_ssd->found_nearer_object(&r[order[i]], r[order[i]].get_length()))
         {
-            engine.ray_trace_one_pixel(x, y);
+            ++made_it[owner[order[i]]];
         }
     }
 #endif /* #ifdef SIMD_PACKET_TRACING */
+}
+
+
+/* Call f for each tile of s until s is cancelled */
+void ray_trace_engine::shade_batch(const triangle *const *const tri, ray *const r, const point_t<> *const vn, const point_t<> *const vt, const hit_description *const h, 
+    ext_colour_t *const *const c, const int n) const
+{
+    /* Order the hits by material so each material shades all of its hits together */
+    int hits[MAXIMUM_PACKET_SIZE * SIMD_WIDTH];
+    int nr_hits = 0;
+    for (int i = 0; i < n; ++i)
+    {
+        if (tri[i] != nullptr)
+        {
+            hits[nr_hits++] = i;
+        }
+    }
+
+    std::sort(&hits[0], &hits[nr_hits], [tri](const int a, const int b)
+    {
+        const material *const m_a = tri[a]->get_shader();
+        const material *const m_b = tri[b]->get_shader();
+        return (m_a < m_b) || ((m_a == m_b) && (a < b));
+    });
+
+    /* Shade each run of hits of the same material */
+    for (int b = 0; b < nr_hits; )
+    {
+        const material *const m = tri[hits[b]]->get_shader();
+        int e = b + 1;
+        while ((e < nr_hits) && (tri[hits[e]]->get_shader() == m))
+        {
+            ++e;
+        }
+
+        m->shade_batch(*this, r, vn, h, c, vt, &hits[b], e - b);
+        b = e;
+    }
+}
+
+
+template<class F>
+void for_each_tile(const tile_scheduler &s, const F &f)
+{
+#ifdef THREADED_RAY_TRACE
+    /* Neighbouring tiles along the curve go to the same thread until the work is stolen */
+    tbb::parallel_for(tbb::blocked_range<int>(0, s.number_of_tiles(), 1), [f, &s](const tbb::blocked_range<int> &r)
+    {
+        for (int i = r.begin(); i != r.end(); ++i)
+        {
+            if (s.cancelled())
+            {
+                return;
+            }
+
+            f(s.get_tile(i));
+        }
+    }, tbb::simple_partitioner());
+#else
+    for (int i = 0; i < s.number_of_tiles(); ++i)
+    {
+        if (s.cancelled())
+        {
+            return;
+        }
+
+        f(s.get_tile(i));
+    }
 #endif /* #ifdef THREADED_RAY_TRACE */
 }
+
+
+/* Ray tracer main function */
+void ray_tracer(const ssd *const sub_division, const light_list &lights, const primitive_store &everything, camera &c, const trace_mode_t m)
+{
+    /* Trace everything at full resolution in a single pass */
+    const tile_scheduler s(c.x_number_of_rays(), c.y_number_of_rays());
+    ray_tracer(sub_division, lights, everything, c, s, 0, m);
+}
+
+
+bool ray_tracer(const ssd *const sub_division, const light_list &lights, const primitive_store &everything, camera &c, const tile_scheduler &s, const int p,
+    const trace_mode_t m)
+{
+    const int step      = s.pass_step(p);
+    const int prev_step = (p > 0) ? s.pass_step(p - 1) : 0;
+
+    /* With too many lights to shadow test them all pick some for each hit by their importance */
+    std::unique_ptr<light_tree> light_samples;
+    if (lights.size() > LIGHT_SAMPLES)
+    {
+        light_samples.reset(new light_tree(lights));
+    }
+
+    /* Filter textures over the width of a pixel */
+    texture_cache::global().pixel_spread(c.pixel_spread());
+
+#ifdef TRAVERSAL_STATISTICS
+    /* Start counting afresh with the first pass */
+    if (p == 0)
+    {
+        c.clear_traversal_statistics();
+    }
+#endif /* #ifdef TRAVERSAL_STATISTICS */
+
+    /* Instantiate the ray trace engine */
+    const ray_trace_engine engine(everything, lights, c, sub_division, light_samples.get());
+    for_each_tile(s, [engine, &c, step, prev_step, m](const tile &t)
+    {
+        if (m == trace_mode_t::wavefront)
+        {
+            /* The tile is traced as one wave so its work is spread over the whole tile */
+            count_traversal(c, t.x0, t.y0, t.x1, t.y1, [&engine, &t, step, prev_step]()
+            {
+                engine.ray_trace_tile_wavefront(t, step, prev_step);
+            });
+        }
+        else
+        {
+            engine.ray_trace_tile(t, step, prev_step);
+        }
+    });
+
+    /* After the last pass refine pixels that contrast with their neighbours */
+    if (c.adaptive() && (p == (s.number_of_passes() - 1)) && !s.cancelled())
+    {
+        /* Pick all the pixels before any are changed */
+        const int x_res = c.x_number_of_rays();
+        const int y_res = c.y_number_of_rays();
+        std::vector<char> refine(x_res * y_res);
+        for (int y = 0; y < y_res; ++y)
+        {
+            for (int x = 0; x < x_res; ++x)
+            {
+                refine[x + (y * x_res)] = c.needs_refinement(x, y);
+            }
+        }
+
+        for_each_tile(s, [engine, &c, &refine, m](const tile &t)
+        {
+            count_traversal(c, t.x0, t.y0, t.x1, t.y1, [&engine, &t, &refine, m]()
+            {
+                engine.ray_trace_tile_adaptive(t, refine, m);
+            });
+        });
+    }
+
+    return !s.cancelled();
+}
+
+
+void ray_tracer(const ssd *const sub_division, const light_list &lights, const primitive_store &everything, camera &c, const tile &t, const trace_mode_t m)
+{
+    /* With too many lights to shadow test them all pick some for each hit by their importance */
+    std::unique_ptr<light_tree> light_samples;
+    if (lights.size() > LIGHT_SAMPLES)
+    {
+        light_samples.reset(new light_tree(lights));
+    }
+
+    /* Filter textures over the width of a pixel */
+    texture_cache::global().pixel_spread(c.pixel_spread());
+
+    /* Split the tile so its parts can be traced in parallel */
+    const ray_trace_engine engine(everything, lights, c, sub_division, light_samples.get());
+    const tile_scheduler s(t.x1 - t.x0, t.y1 - t.y0);
+    for_each_tile(s, [engine, &t, m](const tile &part)
+    {
+        const tile offset_part(part.x0 + t.x0, part.y0 + t.y0, part.x1 + t.x0, part.y1 + t.y0);
+        if (m == trace_mode_t::wavefront)
+        {
+            engine.ray_trace_tile_wavefront(offset_part, 1, 0);
+        }
+        else
+        {
+            engine.ray_trace_tile(offset_part, 1, 0);
+        }
+    });
+}
 }; /* namespace raptor_raytracer */
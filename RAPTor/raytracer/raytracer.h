@@ -1,19 +1,27 @@
 #pragma once
 
+/* Standard headers */
+#include <algorithm>
+#include <vector>
+
 /* Common headers */
 #include "point_t.h"
 
 /* Ray tracer headers */
 #include "camera.h"
 #include "light.h"
+#include "light_tree.h"
 #include "primitive_store.h"
+#include "ray_sorter.h"
+#include "tile_scheduler.h"
 
 #include "scalable_allocator.h"
 
 #ifdef THREADED_RAY_TRACE
 #include "task_scheduler_init.h"
 #include "parallel_for.h"
-#include "blocked_range2d.h"
+#include "partitioner.h"
+#include "blocked_range.h"
 #endif /* #ifdef THREADED_RAY_TRACE */
 
 namespace raptor_raytracer
@@ -21,6 +29,9 @@ namespace raptor_raytracer
 /* Forward declarations */
 class ssd;
 
+/* How rays are traced, depth first per pixel or breadth first in sorted waves per tile */
+enum class trace_mode_t : char { recursive = 0, wavefront = 1 };
+
 /* Class for threaded ray tracing */
 class ray_trace_engine 
 {
@@ -28,34 +39,43 @@ class ray_trace_engine
         using light_iterator        = light_list::iterator;
         using const_light_iterator  = light_list::const_iterator;
 
-        ray_trace_engine(const primitive_store &prims, const light_list &l, camera &c, const ssd *const sub_division) :
-            _prims(prims), _ssd(sub_division), c(c), lights(l) 
+        /* If light_samples is given only the lights it picks are shadow tested, otherwise every light is */
+        ray_trace_engine(const primitive_store &prims, const light_list &l, camera &c, const ssd *const sub_division, const light_tree *const light_samples = nullptr) :
+            _prims(prims), _ssd(sub_division), c(c), lights(l), _light_samples(light_samples)
         {
             this->pending_shadows      = static_cast<ray *>(scalable_malloc(  this->lights.size() * (SHADOW_ARRAY_SIZE * MAXIMUM_PACKET_SIZE * SIMD_WIDTH * sizeof(ray))));
             this->nr_pending_shadows   = static_cast<float *>(scalable_malloc( this->lights.size() * (MAXIMUM_PACKET_SIZE * SIMD_WIDTH * sizeof(float))));
+            this->light_weights        = static_cast<float *>(scalable_malloc( this->lights.size() * (MAXIMUM_PACKET_SIZE * SIMD_WIDTH * sizeof(float))));
         }
 
         ray_trace_engine(const ray_trace_engine &r) :
-            _prims(r._prims), _ssd(r._ssd), c(r.c), lights(r.lights) 
+            _prims(r._prims), _ssd(r._ssd), c(r.c), lights(r.lights), _light_samples(r._light_samples)
         {
             this->pending_shadows       = static_cast<ray *>(scalable_malloc( this->lights.size() * (SHADOW_ARRAY_SIZE * MAXIMUM_PACKET_SIZE * SIMD_WIDTH * sizeof(ray))));
             this->nr_pending_shadows    = static_cast<float *>(scalable_malloc(this->lights.size() * (MAXIMUM_PACKET_SIZE * SIMD_WIDTH * sizeof(float))));
+            this->light_weights         = static_cast<float *>(scalable_malloc(this->lights.size() * (MAXIMUM_PACKET_SIZE * SIMD_WIDTH * sizeof(float))));
         }
 
         ~ray_trace_engine() 
         {
             scalable_free(this->pending_shadows);
             scalable_free(this->nr_pending_shadows);
+            scalable_free(this->light_weights);
         }
 
         /* Access functions */
         const light_list & get_scene_lights() const { return this->lights; }
-        
-#ifdef THREADED_RAY_TRACE
-        /* Operators for TBB to ray trace a 2-D blocks */
-        void operator() (const tbb::blocked_range2d<unsigned> &r) const;
-#endif /* #ifdef THREADED_RAY_TRACE */
-        
+
+        /* Trace the pixels of t at step, skipping those traced at prev_step */
+        void ray_trace_tile(const tile &t, const int step, const int prev_step) const;
+        void ray_trace_tile_wavefront(const tile &t, const int step, const int prev_step) const;
+
+        /* Trace the rest of the sub pixel samples of the pixels of t marked in refine for adaptive anti-aliasing */
+        void ray_trace_tile_adaptive(const tile &t, const std::vector<char> &refine, const trace_mode_t m) const;
+
+        /* Trace n rays breadth first, sorting the rays of each bounce and their shadow rays for coherence */
+        void ray_trace_wavefront(ray *const r, ext_colour_t *const c, const int n) const;
+
         /* Member to find nearest intersector and call the shader */
         void ray_trace(ray &r, ext_colour_t *const c) const;
 #ifdef SIMD_PACKET_TRACING
@@ -64,11 +84,28 @@ class ray_trace_engine
 #endif /* #ifdef SIMD_PACKET_TRACING */
 
         /* Secondary ray buffer write access */
+        /* Shaders must request light 0 first, when lights are sampled that is when they are picked for the hit */
         inline void generate_rays_to_light(const ray &r, const hit_t h, const unsigned int l) const
         {
             const int addr      = (l * (SHADOW_ARRAY_SIZE * MAXIMUM_PACKET_SIZE * SIMD_WIDTH)) + (this->shader_nr * SHADOW_ARRAY_SIZE);
             const int nr_addr   = (l * (MAXIMUM_PACKET_SIZE * SIMD_WIDTH)) + this->shader_nr;
 
+            if (this->_light_samples != nullptr)
+            {
+                if (l == 0)
+                {
+                    this->_light_samples->pick(&this->light_weights[this->shader_nr], r.get_dst(), random_stream::thread_stream(), LIGHT_SAMPLES, MAXIMUM_PACKET_SIZE * SIMD_WIDTH);
+                }
+
+                /* Lights that werent picked dont contribute, but the shader still needs the direction */
+                if (this->light_weights[nr_addr] == 0.0f)
+                {
+                    this->pending_shadows[addr].set_up(r.get_dst(), this->lights[l].get_centre(), 0.0f);
+                    this->nr_pending_shadows[nr_addr] = 0.0f;
+                    return;
+                }
+            }
+
             this->nr_pending_shadows[nr_addr]  = r.find_rays(&this->pending_shadows[addr], this->lights[l], h);
             return;
         }
@@ -76,31 +113,83 @@ class ray_trace_engine
         /* Secondary ray buffer read access */
         inline const ray& get_illumination(const unsigned int l) const
         {
-            const int addr  = (l * (SHADOW_ARRAY_SIZE * MAXIMUM_PACKET_SIZE * SIMD_WIDTH)) + (this->shader_nr * SHADOW_ARRAY_SIZE);
+            return get_illumination(l, this->shader_nr);
+        }
+
+        /* Secondary ray buffer read access for shader s when shading a batch */
+        inline const ray& get_illumination(const unsigned int l, const int s) const
+        {
+            const int addr  = (l * (SHADOW_ARRAY_SIZE * MAXIMUM_PACKET_SIZE * SIMD_WIDTH)) + (s * SHADOW_ARRAY_SIZE);
             return this->pending_shadows[addr];
         }
         
-        /* Member to ray trace a single pixel */
-        inline void ray_trace_one_pixel(const int x, const int y) const;
+        /* Member to ray trace a single pixel and fill the block of size pixels square from it */
+        inline void ray_trace_one_pixel(const int x, const int y, const int size = 1) const;
 
     private :
+        /* Materials without a batch shader pick the shader of each hit as they go */
+        friend class material;
+
         /* Prevent copying of this large class */
         ray_trace_engine& operator=(const ray_trace_engine &);
 
+        /* Shade the n hits a material at a time, hit i reads its illumination from shader i and misses have no tri */
+        void shade_batch(const triangle *const *const tri, ray *const r, const point_t<> *const vn, const point_t<> *const vt, const hit_description *const h, 
+            ext_colour_t *const *const c, const int n) const;
+
+        /* Saturate colours and fill the block of size pixels square from x, y */
+        void set_block(const ext_colour_t &p, const int x, const int y, const int size) const
+        {
+            const int x_end = std::min(x + size, static_cast<int>(this->c.x_number_of_rays()));
+            const int y_end = std::min(y + size, static_cast<int>(this->c.y_number_of_rays()));
+            for (int j = y; j < y_end; ++j)
+            {
+                for (int i = x; i < x_end; ++i)
+                {
+                    this->c.set_pixel(p, i, j);
+                }
+            }
+        }
+
+        /* Scale for the illumination of a light to keep light sampling unbiased */
+        float light_weight(const int nr_addr) const
+        {
+            return (this->_light_samples == nullptr) ? 1.0f : this->light_weights[nr_addr];
+        }
+
+        /* Look up the primitive hit, instanced primitives also return their transform to world space */
+        inline const triangle * hit_primitive(const int i, const instance_transform **const xfm) const;
+
+        /* Wavefront nearest and shadow intersection of n rays visited in order */
+        void find_nearest_wavefront(ray *const r, const int *const order, int *const tri_idx, hit_description *const h, const int n) const;
+        void found_nearer_wavefront(ray *const r, const int *const order, const int *const owner, int *const made_it, const int n) const;
+
 #ifdef SIMD_PACKET_TRACING
         inline void shoot_shadow_packet(packet_ray *const r, ray *const *const sr, vfp_t *const t, unsigned int *r_to_s, int *m, const int s, const int l) const;
+               void find_nearest_packet(packet_ray *const r, int *const tri_idx, packet_hit_description *const h, const int s) const;
 #endif
 
         const primitive_store & _prims;
         const ssd *const        _ssd;
         camera &                c;    
         const light_list &      lights;
+        const light_tree *const _light_samples;
         
         mutable ray *           pending_shadows;
         mutable float *         nr_pending_shadows;
+        mutable float *         light_weights;
         mutable int             shader_nr;
+        mutable ray_sorter      _sorter;
 };
 
 /* Main ray tracer function */
-void ray_tracer(const ssd *const sub_division, const light_list &lights, const primitive_store &everything, camera &c);
+void ray_tracer(const ssd *const sub_division, const light_list &lights, const primitive_store &everything, camera &c, const trace_mode_t m = trace_mode_t::recursive);
+
+/* Trace pass p of the tiles in s, returns false if s was cancelled before the pass completed */
+bool ray_tracer(const ssd *const sub_division, const light_list &lights, const primitive_store &everything, camera &c, const tile_scheduler &s, const int p,
+    const trace_mode_t m = trace_mode_t::recursive);
+
+/* Trace the pixels of t at full resolution, t must start on a multiple of the packet width */
+void ray_tracer(const ssd *const sub_division, const light_list &lights, const primitive_store &everything, camera &c, const tile &t, 
+    const trace_mode_t m = trace_mode_t::recursive);
 }; /* namespace raptor_raytracer */
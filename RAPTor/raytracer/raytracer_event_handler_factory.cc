@@ -21,6 +21,11 @@ void append_raytracer_camera_event_handler(std::map<SDL_Keycode, sdl_event_handl
             static unsigned int snapshot_nr = 0;
             std::ostringstream file_name(std::ostringstream::out);
 
+#ifdef TRAVERSAL_STATISTICS
+            /* Output the work done tracing each pixel of the last frame */
+            cam->write_traversal_heatmaps(output_file + "_" + std::to_string(snapshot_nr));
+#endif /* #ifdef TRAVERSAL_STATISTICS */
+
             /* Tone map */
             cam->tone_map(tone_mapping_mode_t::local_human_histogram);
             
@@ -139,29 +139,23 @@ struct regression_fixture : private boost::noncopyable
                     break;
                     
                 case model_format_t::obj :
-                    input_stream.open(input_path.c_str());
-                    assert(input_stream.is_open());
                     last_slash  = input_path.find_last_of('/');
                     path        = input_path.substr(0, last_slash + 1);
-                    obj_parser(input_stream, path, _lights, _everything, _materials, &_cam);
+                    obj_parser(input_path, path, _lights, _everything, _materials, &_cam);
                     
                     /* Camera is not set in the scene so do it here */
                     _cam = new camera(cam_p, x_vec, y_vec, z_vec, bg, screen_width, screen_height, 20, xr, yr, xa, ya, 0.0f, 0.0f);
                     break;
                     
                 case model_format_t::off :
-                    input_stream.open(input_path.c_str());
-                    assert(input_stream.is_open());
-                    off_parser(input_stream, _lights, _everything, _materials, _cam);
+                    off_parser(input_path, _lights, _everything, _materials, _cam);
                     
                     /* Camera is not set in the scene so do it here */
                     _cam = new camera(cam_p, x_vec, y_vec, z_vec, bg, screen_width, screen_height, 20, xr, yr, xa, ya, 0.0f, 0.0f);
                     break;
 
                 case model_format_t::ply :
-                    input_stream.open(input_path.c_str());
-                    assert(input_stream.is_open());
-                    ply_parser(input_stream, _lights, _everything, _materials, &_cam);
+                    ply_parser(input_path, _lights, _everything, _materials, &_cam);
                     
                     /* Camera is not set in the scene so do it here */
                     _cam = new camera(cam_p, x_vec, y_vec, z_vec, bg, screen_width, screen_height, 20, xr, yr, xa, ya, 0.0f, 0.0f);
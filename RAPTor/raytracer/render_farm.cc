@@ -0,0 +1,484 @@
+/* Standard headers */
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+/* Posix headers */
+#include <sys/socket.h>
+
+/* Boost headers */
+#include "boost/asio/connect.hpp"
+#include "boost/asio/read.hpp"
+#include "boost/asio/write.hpp"
+
+/* Common headers */
+#include "logging.h"
+
+/* Ray tracer headers */
+#include "render_farm.h"
+
+
+namespace raptor_raytracer
+{
+using boost::asio::ip::tcp;
+
+/* Bytes in the body of a job message, id, frame and tile */
+const std::uint32_t FARM_JOB_SIZE = 6 * sizeof(std::int32_t);
+
+/* Append v to b */
+template<class T>
+inline void write_value(std::vector<char> *const b, const T v)
+{
+    const char *const bytes = reinterpret_cast<const char *>(&v);
+    b->insert(b->end(), bytes, bytes + sizeof(T));
+}
+
+/* Read a value from p and move past it */
+template<class T>
+inline T read_value(const char **const p)
+{
+    T v;
+    memcpy(&v, *p, sizeof(T));
+    *p += sizeof(T);
+    return v;
+}
+
+/* Send a message of type t with body b */
+bool send_message(tcp::socket *const s, const char *const t, const std::vector<char> &b)
+{
+    const std::uint32_t size = b.size();
+    const std::array<boost::asio::const_buffer, 3> send_buf =
+    {{
+        boost::asio::buffer(t, FARM_MSG_TYPE_SIZE),
+        boost::asio::buffer(&size, sizeof(size)),
+        boost::asio::buffer(b)
+    }};
+
+    boost::system::error_code ec;
+    boost::asio::write(*s, send_buf, ec);
+    return !ec;
+}
+
+/* Receive a message, the type is written to t and the body to b */
+bool receive_message(tcp::socket *const s, char *const t, std::vector<char> *const b)
+{
+    std::uint32_t size;
+    const std::array<boost::asio::mutable_buffer, 2> head_buf =
+    {{
+        boost::asio::buffer(t, FARM_MSG_TYPE_SIZE),
+        boost::asio::buffer(&size, sizeof(size))
+    }};
+
+    boost::system::error_code ec;
+    boost::asio::read(*s, head_buf, ec);
+    if (ec)
+    {
+        return false;
+    }
+
+    b->resize(size);
+    boost::asio::read(*s, boost::asio::buffer(*b), ec);
+    return !ec;
+}
+
+/* Check the type of a received message */
+inline bool is_message(const char *const t, const char *const expected)
+{
+    return memcmp(t, expected, FARM_MSG_TYPE_SIZE) == 0;
+}
+
+
+struct render_coordinator::worker_connection
+{
+    worker_connection(boost::asio::io_service &io_service) : socket(io_service) {  }
+
+    tcp::socket socket;
+    std::thread thread;
+};
+
+
+render_coordinator::render_coordinator(const std::uint16_t port, const int x_res, const int y_res, const int frames, const int tile_size) :
+    _io_service(), _acceptor(_io_service, tcp::endpoint(tcp::v4(), port)), _job_time(0), _completed(0), _connected(0), _running(false), _stopping(false)
+{
+    /* Animations are split by frame, stills by tile */
+    if (frames > 1)
+    {
+        for (int i = 0; i < frames; ++i)
+        {
+            _jobs.emplace_back(i, i, tile(0, 0, x_res, y_res));
+        }
+    }
+    else
+    {
+        const tile_scheduler s(x_res, y_res, tile_size);
+        for (int i = 0; i < s.number_of_tiles(); ++i)
+        {
+            _jobs.emplace_back(i, 0, s.get_tile(i));
+        }
+    }
+
+    _issued.resize(_jobs.size());
+    _copies.resize(_jobs.size(), 0);
+    _done.resize(_jobs.size(), 0);
+    for (int i = 0; i < static_cast<int>(_jobs.size()); ++i)
+    {
+        _pending.push_back(i);
+    }
+
+    /* Workers may connect and load their scene before rendering starts */
+    _accept_thread = std::thread(&render_coordinator::accept_workers, this);
+}
+
+
+render_coordinator::~render_coordinator()
+{
+    {
+        /* Give workers returning duplicated jobs as long as a job should take, then they can be told to exit cleanly */
+        std::unique_lock<std::mutex> guard(_lock);
+        if (_completed > 0)
+        {
+            _changed.wait_for(guard, (_job_time / _completed) * FARM_STRAGGLER_FACTOR, [this]() { return _connected == 0; });
+        }
+
+        _stopping = true;
+        _changed.notify_all();
+    }
+
+    /* Wake the blocking accept and any reads from workers still rendering. Writes are still allowed so idle workers are told to exit */
+    ::shutdown(_acceptor.native_handle(), SHUT_RDWR);
+    _accept_thread.join();
+    for (auto &w : _workers)
+    {
+        ::shutdown(w->socket.native_handle(), SHUT_RD);
+        w->thread.join();
+    }
+}
+
+
+bool render_coordinator::run(const result_function &f, const int timeout_ms)
+{
+    const auto start = farm_clock::now();
+    std::unique_lock<std::mutex> guard(_lock);
+    _result     = f;
+    _running    = true;
+    _changed.notify_all();
+
+    /* Wait for the work to be done, giving up if there are no workers for too long */
+    auto idle_since = farm_clock::now();
+    while (_completed < static_cast<int>(_jobs.size()))
+    {
+        const auto now = farm_clock::now();
+        if (_connected > 0)
+        {
+            idle_since = now;
+        }
+        else if ((now - idle_since) > std::chrono::milliseconds(timeout_ms))
+        {
+            BOOST_LOG_TRIVIAL(error) << "Render farm had no workers for " << timeout_ms << "ms, " << _completed << " of " << _jobs.size() << " jobs complete";
+            return false;
+        }
+
+        _changed.wait_for(guard, std::chrono::milliseconds(100));
+    }
+
+    const float ms = std::chrono::duration_cast<std::chrono::microseconds>(farm_clock::now() - start).count() * 0.001f;
+    BOOST_LOG_TRIVIAL(info) << "Render farm completed " << _jobs.size() << " jobs in " << ms << "ms using " << _workers.size() << " workers";
+    return true;
+}
+
+
+void render_coordinator::accept_workers()
+{
+    while (true)
+    {
+        std::unique_ptr<worker_connection> w(new worker_connection(_io_service));
+        boost::system::error_code ec;
+        _acceptor.accept(w->socket, ec);
+
+        std::lock_guard<std::mutex> guard(_lock);
+        if (_stopping)
+        {
+            return;
+        }
+
+        if (ec)
+        {
+            BOOST_LOG_TRIVIAL(error) << "Render farm stopped accepting workers: " << ec.message();
+            return;
+        }
+
+        BOOST_LOG_TRIVIAL(info) << "Render farm worker connected from " << w->socket.remote_endpoint(ec).address().to_string();
+        ++_connected;
+        w->thread = std::thread(&render_coordinator::serve_worker, this, w.get());
+        _workers.push_back(std::move(w));
+        _changed.notify_all();
+    }
+}
+
+
+void render_coordinator::serve_worker(worker_connection *const w)
+{
+    char type[FARM_MSG_TYPE_SIZE];
+    std::vector<char> body;
+    std::vector<ext_colour_t> pixels;
+    std::deque<std::uint32_t> in_flight;
+    std::deque<farm_clock::time_point> sent;
+
+    /* Wait for the worker to load its scene */
+    bool connected = receive_message(&w->socket, type, &body) && is_message(type, FARM_MSG_READY);
+    auto last_result = farm_clock::now();
+    while (connected)
+    {
+        /* Top up the jobs queued at the worker, waiting for work if it has none */
+        std::vector<std::uint32_t> to_send;
+        bool finished = false;
+        {
+            std::unique_lock<std::mutex> guard(_lock);
+            while (true)
+            {
+                if (_running)
+                {
+                    int id;
+                    while ((in_flight.size() < FARM_JOBS_IN_FLIGHT) && ((id = next_job(in_flight)) >= 0))
+                    {
+                        ++_copies[id];
+                        _issued[id] = farm_clock::now();
+                        in_flight.push_back(id);
+                        sent.push_back(_issued[id]);
+                        to_send.push_back(id);
+                    }
+                }
+
+                if (!in_flight.empty())
+                {
+                    break;
+                }
+
+                if (_stopping || (_running && (_completed == static_cast<int>(_jobs.size()))))
+                {
+                    finished = true;
+                    break;
+                }
+
+                /* Wake now and then to look for jobs that have run too long */
+                _changed.wait_for(guard, std::chrono::milliseconds(100));
+            }
+        }
+
+        if (finished)
+        {
+            send_message(&w->socket, FARM_MSG_DONE, std::vector<char>());
+            break;
+        }
+
+        for (const std::uint32_t id : to_send)
+        {
+            const render_job &job = _jobs[id];
+            body.clear();
+            write_value<std::int32_t>(&body, job.id);
+            write_value<std::int32_t>(&body, job.frame);
+            write_value<std::int32_t>(&body, job.t.x0);
+            write_value<std::int32_t>(&body, job.t.y0);
+            write_value<std::int32_t>(&body, job.t.x1);
+            write_value<std::int32_t>(&body, job.t.y1);
+            connected &= send_message(&w->socket, FARM_MSG_JOB, body);
+        }
+
+        /* Wait for the oldest job, the worker renders them in order */
+        if (!connected || !receive_message(&w->socket, type, &body))
+        {
+            break;
+        }
+
+        const std::uint32_t id = in_flight.front();
+        const render_job &job = _jobs[id];
+        const char *p = body.data();
+        if (!is_message(type, FARM_MSG_PIXELS) || (body.size() != (sizeof(std::uint32_t) + (job.pixels() * 3 * sizeof(float)))) || (read_value<std::uint32_t>(&p) != id))
+        {
+            BOOST_LOG_TRIVIAL(error) << "Render farm worker returned an unexpected message, disconnecting it";
+            break;
+        }
+
+        pixels.resize(job.pixels());
+        for (auto &c : pixels)
+        {
+            c.r = read_value<float>(&p);
+            c.g = read_value<float>(&p);
+            c.b = read_value<float>(&p);
+        }
+
+        /* The job started once it was sent and the worker had finished the job before */
+        const auto now = farm_clock::now();
+        const auto job_time = now - std::max(sent.front(), last_result);
+        last_result = now;
+        in_flight.pop_front();
+        sent.pop_front();
+
+        /* Only the first copy of a job back is used */
+        bool first;
+        {
+            std::lock_guard<std::mutex> guard(_lock);
+            --_copies[id];
+            first = !_done[id];
+            _done[id] = true;
+            if (first)
+            {
+                _job_time += job_time;
+            }
+        }
+
+        if (first)
+        {
+            _result(job, pixels.data());
+
+            std::lock_guard<std::mutex> guard(_lock);
+            ++_completed;
+            _changed.notify_all();
+        }
+    }
+
+    /* Anything still queued at the worker must be done by someone else */
+    bool stopping;
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        stopping = _stopping;
+        if (!stopping && !in_flight.empty())
+        {
+            BOOST_LOG_TRIVIAL(warning) << "Render farm lost a worker with " << in_flight.size() << " jobs queued";
+        }
+
+        requeue(in_flight);
+        --_connected;
+        _changed.notify_all();
+    }
+
+    /* Workers still rendering when the farm stops are told to exit once they are done */
+    if (stopping && !in_flight.empty())
+    {
+        send_message(&w->socket, FARM_MSG_DONE, std::vector<char>());
+    }
+}
+
+
+int render_coordinator::next_job(const std::deque<std::uint32_t> &in_flight)
+{
+    /* Hand out new work first */
+    if (!_pending.empty())
+    {
+        const int id = _pending.front();
+        _pending.pop_front();
+        return id;
+    }
+
+    /* There is no timing to tell a slow job from a normal one yet */
+    if (_completed == 0)
+    {
+        return -1;
+    }
+
+    /* Duplicate the job that has run longest, if it has run far longer than an average job */
+    const auto now      = farm_clock::now();
+    const auto overdue  = (_job_time / _completed) * FARM_STRAGGLER_FACTOR;
+    int oldest = -1;
+    for (int i = 0; i < static_cast<int>(_jobs.size()); ++i)
+    {
+        if (_done[i] || (_copies[i] != 1) || ((now - _issued[i]) < overdue) || ((oldest >= 0) && (_issued[oldest] <= _issued[i])))
+        {
+            continue;
+        }
+
+        if (std::find(in_flight.begin(), in_flight.end(), i) == in_flight.end())
+        {
+            oldest = i;
+        }
+    }
+
+    return oldest;
+}
+
+
+void render_coordinator::requeue(const std::deque<std::uint32_t> &in_flight)
+{
+    /* Jobs are pending when they are neither done nor being run, put them at the front so they finish soon */
+    for (auto i = in_flight.rbegin(); i != in_flight.rend(); ++i)
+    {
+        if ((--_copies[*i] == 0) && !_done[*i])
+        {
+            _pending.push_front(*i);
+        }
+    }
+}
+
+
+bool render_worker::run(const render_function &f)
+{
+    /* Connect to the coordinator */
+    boost::system::error_code ec;
+    tcp::socket socket(_io_service);
+    tcp::resolver resolver(_io_service);
+    boost::asio::connect(socket, resolver.resolve(_addr, std::to_string(_port), ec), ec);
+    if (ec)
+    {
+        BOOST_LOG_TRIVIAL(error) << "Couldnt connect to render farm coordinator " << _addr << ":" << _port << ", " << ec.message();
+        return false;
+    }
+
+    if (!send_message(&socket, FARM_MSG_READY, std::vector<char>()))
+    {
+        return false;
+    }
+
+    /* Render jobs until there are no more */
+    char type[FARM_MSG_TYPE_SIZE];
+    std::vector<char> body;
+    std::vector<ext_colour_t> pixels;
+    while (receive_message(&socket, type, &body))
+    {
+        if (is_message(type, FARM_MSG_DONE))
+        {
+            return true;
+        }
+
+        if (!is_message(type, FARM_MSG_JOB) || (body.size() != FARM_JOB_SIZE))
+        {
+            BOOST_LOG_TRIVIAL(error) << "Render farm coordinator sent an unexpected message";
+            return false;
+        }
+
+        const char *p = body.data();
+        const std::uint32_t id      = read_value<std::int32_t>(&p);
+        const std::uint32_t frame   = read_value<std::int32_t>(&p);
+        const int x0 = read_value<std::int32_t>(&p);
+        const int y0 = read_value<std::int32_t>(&p);
+        const int x1 = read_value<std::int32_t>(&p);
+        const int y1 = read_value<std::int32_t>(&p);
+        const render_job job(id, frame, tile(x0, y0, x1, y1));
+
+        pixels.assign(job.pixels(), ext_colour_t());
+        if (!f(job, pixels.data()))
+        {
+            BOOST_LOG_TRIVIAL(info) << "Render worker dropped out of the farm";
+            return false;
+        }
+
+        body.clear();
+        body.reserve(sizeof(std::uint32_t) + (pixels.size() * 3 * sizeof(float)));
+        write_value<std::uint32_t>(&body, id);
+        for (const auto &c : pixels)
+        {
+            write_value<float>(&body, c.r);
+            write_value<float>(&body, c.g);
+            write_value<float>(&body, c.b);
+        }
+
+        if (!send_message(&socket, FARM_MSG_PIXELS, body))
+        {
+            break;
+        }
+        ++_rendered;
+    }
+
+    BOOST_LOG_TRIVIAL(error) << "Lost connection to render farm coordinator";
+    return false;
+}
+}; /* namespace raptor_raytracer */
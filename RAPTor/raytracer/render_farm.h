@@ -0,0 +1,130 @@
+#pragma once
+
+/* Standard headers */
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/* Boost headers */
+#include "boost/asio/io_service.hpp"
+#include "boost/asio/ip/tcp.hpp"
+#include "boost/noncopyable.hpp"
+
+/* Ray tracer headers */
+#include "ext_colour_t.h"
+#include "tile_scheduler.h"
+
+
+namespace raptor_raytracer
+{
+/* Message types, every message starts with one followed by the size of the rest of the message */
+const int FARM_MSG_TYPE_SIZE    = 3;
+const char FARM_MSG_READY[]     = "rdy";    /* Worker has loaded the scene and wants work           */
+const char FARM_MSG_JOB[]       = "job";    /* Coordinator asks a worker to render a job            */
+const char FARM_MSG_PIXELS[]    = "pix";    /* Worker returns the pixels of a job                   */
+const char FARM_MSG_DONE[]      = "don";    /* Coordinator has no more work, the worker should exit */
+
+/* A unit of work, a tile of the only frame or a whole frame of an animation */
+struct render_job
+{
+    render_job() : id(0), frame(0), t(0, 0, 0, 0) {  }
+    render_job(const std::uint32_t id, const std::uint32_t frame, const tile &t) : id(id), frame(frame), t(t) {  }
+
+    /* The number of pixels rendered by the job */
+    int pixels() const { return (t.x1 - t.x0) * (t.y1 - t.y0); }
+
+    std::uint32_t   id;
+    std::uint32_t   frame;
+    tile            t;
+};
+
+/* Class to hand out the tiles of one frame, or the frames of an animation, to render workers over tcp and collect the pixels they return.
+   Workers pull work so faster workers get more of it. Jobs held by a worker that disconnects are handed to other workers and once there
+   is no new work the longest running jobs are duplicated on idle workers, the first copy back is used. Messages are sent in host byte
+   order so the coordinator and workers must share it */
+class render_coordinator : private boost::noncopyable
+{
+    public :
+        /* Called with each job and its pixels, row by row, as each job completes. Calls may be concurrent but never for the same job */
+        typedef std::function<void (const render_job &, const ext_colour_t *const)> result_function;
+
+        /* Listen for workers on port, 0 picks a free port. With one frame the image is split into tiles of tile_size pixels */
+        render_coordinator(const std::uint16_t port, const int x_res, const int y_res, const int frames = 1, const int tile_size = 32);
+
+        /* Disconnects any remaining workers */
+        ~render_coordinator();
+
+        /* Access functions */
+        std::uint16_t   port()              const { return _acceptor.local_endpoint().port(); }
+        int             number_of_jobs()    const { return _jobs.size(); }
+
+        /* Render everything, calling f as jobs complete. Returns false if there were no workers for timeout_ms before everything was done */
+        bool run(const result_function &f, const int timeout_ms = 60000);
+
+    private :
+        struct worker_connection;
+
+        /* Accept workers until stopped */
+        void accept_workers();
+
+        /* Send jobs to and collect results from one worker */
+        void serve_worker(worker_connection *const w);
+
+        /* Pick the next job for a worker already running in_flight, -1 if there is nothing to do. Must hold _lock */
+        int next_job(const std::deque<std::uint32_t> &in_flight);
+
+        /* Return the unfinished jobs of a worker to the queue. Must hold _lock */
+        void requeue(const std::deque<std::uint32_t> &in_flight);
+
+        typedef std::chrono::steady_clock farm_clock;
+
+        boost::asio::io_service                             _io_service;
+        boost::asio::ip::tcp::acceptor                      _acceptor;
+        std::vector<render_job>                             _jobs;
+        std::vector<farm_clock::time_point>                 _issued;        /* When each job was last sent to a worker                  */
+        std::vector<char>                                   _copies;        /* Number of workers running each job                       */
+        std::vector<char>                                   _done;          /* Whether each job has been returned                       */
+        std::deque<std::uint32_t>                           _pending;       /* Jobs not yet sent or returned by a lost worker           */
+        std::vector<std::unique_ptr<worker_connection>>     _workers;
+        std::thread                                         _accept_thread;
+        std::mutex                                          _lock;
+        std::condition_variable                             _changed;
+        result_function                                     _result;
+        farm_clock::duration                                _job_time;      /* Total time taken by completed jobs                       */
+        int                                                 _completed;     /* Jobs whose results have been passed to _result           */
+        int                                                 _connected;     /* Workers currently connected                              */
+        bool                                                _running;
+        bool                                                _stopping;
+};
+
+/* Class to render jobs for a render_coordinator */
+class render_worker : private boost::noncopyable
+{
+    public :
+        /* Render the pixels of a job, row by row. Return false to drop out of the farm, unfinished jobs are rendered by other workers */
+        typedef std::function<bool (const render_job &, ext_colour_t *const)> render_function;
+
+        /* Work for the coordinator listening on port at addr, which may be a host name */
+        render_worker(const std::string &addr, const std::uint16_t port) : _addr(addr), _port(port), _rendered(0) {  }
+
+        /* Render jobs until the coordinator has no more work, which returns true. Returns false if the coordinator couldnt be reached, 
+           the connection was lost or f dropped out */
+        bool run(const render_function &f);
+
+        /* Number of jobs rendered */
+        int jobs_rendered() const { return _rendered; }
+
+    private :
+        boost::asio::io_service _io_service;
+        const std::string       _addr;
+        const std::uint16_t     _port;
+        int                     _rendered;
+};
+}; /* namespace raptor_raytracer */
@@ -0,0 +1,619 @@
+/* Standard headers */
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+#include <vector>
+
+/* Common headers */
+#include "logging.h"
+
+/* Parser headers */
+#include "mapped_file.h"
+
+/* Ray tracer headers */
+#include "scene_cache.h"
+#include "phong_shader.h"
+#include "coloured_mapper_shader.h"
+#include "kd_tree.h"
+#include "bvh.h"
+#include "bih.h"
+
+
+namespace raptor_raytracer
+{
+namespace
+{
+/* Sections of the cache, each is an array of one type */
+enum class cache_section_t : int { materials = 0, triangles = 1, normals = 2, texture_coords = 3, attributes = 4, indirection = 5,
+                                   lights = 6, light_triangles = 7, ssd_nodes = 8, ssd_triangles = 9, leaf_primitives = 10, number_of_sections = 11 };
+
+const char  cache_magic[8]  = "RAPTSCN";
+const int   cache_alignment = 64;
+
+struct cache_section
+{
+    std::uint64_t   offset;
+    std::uint64_t   bytes;
+};
+
+struct cache_header
+{
+    char            magic[8];
+    std::uint32_t   version;
+    std::uint32_t   layout;     /* Sizes of the cached types                        */
+    std::uint64_t   hash;       /* Hash of the scene file                           */
+    std::int32_t    ssd;        /* Type of the cached ssd, -1 if there isnt one     */
+    std::int32_t    root;       /* Root node of the bvh                             */
+    float           build_sah;  /* Sah cost of the bvh when it was built            */
+    point_t<>       lower;      /* Scene bounds of the ssd                          */
+    point_t<>       upper;
+    cache_section   sections[static_cast<int>(cache_section_t::number_of_sections)];
+};
+
+/* Types of material that can be cached */
+enum class cached_material_t : int { phong = 0, coloured_mapper = 1 };
+
+struct cached_material
+{
+    int             type;
+    ext_colour_t    ka;
+    ext_colour_t    kd;
+    ext_colour_t    ks;
+    float           s;
+    float           tran;
+    float           ri;
+    float           rf;
+    float           td;
+    float           rfd;
+};
+
+struct cached_triangle
+{
+    point_t<>   a;
+    point_t<>   b;
+    point_t<>   c;
+    int         mat;        /* Index of the material                    */
+    int         attr;       /* Index of the vertex attributes or -1     */
+    int         light;      /* Whether the triangle is a light          */
+};
+
+struct cached_attributes
+{
+    int vn[3];  /* Index of the normals or -1               */
+    int vt[3];  /* Index of the texture co-ordinates or -1  */
+};
+
+struct cached_light
+{
+    ext_colour_t    rgb;
+    point_t<>       c;
+    point_t<>       n;
+    float           r;
+    float           d;
+    float           s_a;
+    float           s_b;
+    int             n_dir;
+    int             tris_begin; /* Range of light triangles, -1 if there are none */
+    int             tris_end;
+};
+
+/* kd tree nodes with children and primitives as indices instead of pointers */
+struct cached_kdt_node
+{
+    float   split;
+    int     normal;
+    int     idx;    /* Left child, the right follows it, or the first leaf primitive */
+    int     size;   /* Number of leaf primitives */
+};
+
+
+/* The node types change size with compile options, so caches must be from the same build */
+std::uint32_t cache_layout()
+{
+    std::uint32_t layout = sizeof(cache_header);
+    for (const std::uint32_t s : { sizeof(cached_material), sizeof(cached_triangle), sizeof(cached_light), sizeof(precomputed_triangle), sizeof(bvh_node), sizeof(bih_block), sizeof(cached_kdt_node) })
+    {
+        layout = (layout * 31) + s;
+    }
+
+    return layout;
+}
+
+
+/* Read only memory map of a whole file */
+using raptor_parsers::mapped_file;
+
+
+template<class T>
+bool read_section(const mapped_file &f, const cache_header &h, const cache_section_t s, const T **const data, int *const size)
+{
+    const cache_section &sec = h.sections[static_cast<int>(s)];
+    if (((sec.offset + sec.bytes) > f.size()) || ((sec.offset % cache_alignment) != 0) || ((sec.bytes % sizeof(T)) != 0))
+    {
+        return false;
+    }
+
+    (*data) = reinterpret_cast<const T *>(f.data() + sec.offset);
+    (*size) = sec.bytes / sizeof(T);
+    return true;
+}
+
+
+template<class T>
+void write_section(std::ofstream *const out, cache_header *const h, const cache_section_t s, const T *const data, const std::size_t size)
+{
+    /* Pad so every section can be used in place from the memory map */
+    std::uint64_t offset = out->tellp();
+    while ((offset % cache_alignment) != 0)
+    {
+        out->put(0);
+        ++offset;
+    }
+
+    h->sections[static_cast<int>(s)] = { offset, size * sizeof(T) };
+    out->write(reinterpret_cast<const char *>(data), size * sizeof(T));
+}
+
+
+template<class T>
+void write_section(std::ofstream *const out, cache_header *const h, const cache_section_t s, const std::vector<T> &data)
+{
+    write_section(out, h, s, data.data(), data.size());
+}
+
+
+/* Number the nodes of a kd tree depth first, keeping siblings together */
+void flatten_kdt_node(const kdt_node &n, const int idx, std::vector<cached_kdt_node> *const nodes, std::vector<int> *const leaf_prims)
+{
+    if (n.get_normal() == axis_t::not_set)
+    {
+        const std::vector<int> &prims = n.get_primitives();
+        (*nodes)[idx] = { 0.0f, static_cast<int>(axis_t::not_set), static_cast<int>(leaf_prims->size()), static_cast<int>(prims.size()) };
+        leaf_prims->insert(leaf_prims->end(), prims.begin(), prims.end());
+        return;
+    }
+
+    const int left = nodes->size();
+    nodes->resize(left + 2);
+    (*nodes)[idx] = { n.get_split_position(), static_cast<int>(n.get_normal()), left, 0 };
+    flatten_kdt_node(*n.get_left(),  left,     nodes, leaf_prims);
+    flatten_kdt_node(*n.get_right(), left + 1, nodes, leaf_prims);
+}
+}; /* namespace */
+
+
+/**********************************************************
+ hash_file returns the 64 bit FNV-1a hash of the contents of
+ file. 0 is returned if the file cannot be read.
+**********************************************************/
+std::uint64_t scene_cache::hash_file(const std::string &file)
+{
+    const mapped_file f(file);
+    if (f.data() == nullptr)
+    {
+        return 0;
+    }
+
+    std::uint64_t hash = 0xcbf29ce484222325ULL;
+    for (std::size_t i = 0; i < f.size(); ++i)
+    {
+        hash ^= static_cast<unsigned char>(f.data()[i]);
+        hash *= 0x100000001b3ULL;
+    }
+
+    return hash;
+}
+
+
+/**********************************************************
+ load reads a cached scene.
+
+ The cache is memory mapped and only used if it has the
+ current version, was written by a build with the same
+ layout and has the same hash as the scene it is replacing.
+ Otherwise false is returned and nothing is changed.
+
+ If the cache contains a spatial sub division of type t it
+ is returned in s.
+**********************************************************/
+bool scene_cache::load(const std::string &cache, const std::uint64_t hash, const ssd_type_t t, light_list *const l, primitive_store *const e,
+    std::list<material *> *const m, std::unique_ptr<ssd> *const s)
+{
+    assert(e->empty());
+
+    /* Check the cache is for this scene */
+    const mapped_file f(cache);
+    if ((f.data() == nullptr) || (f.size() < sizeof(cache_header)))
+    {
+        return false;
+    }
+
+    cache_header h;
+    memcpy(&h, f.data(), sizeof(h));
+    if ((memcmp(h.magic, cache_magic, sizeof(h.magic)) != 0) || (h.version != SCENE_CACHE_VERSION) || (h.layout != cache_layout()) || (h.hash != hash))
+    {
+        BOOST_LOG_TRIVIAL(info) << "Scene cache " << cache << " is out of date";
+        return false;
+    }
+
+    /* Find all the sections */
+    const cached_material *     materials;
+    const cached_triangle *     triangles;
+    const point_t<> *           normals;
+    const point_t<> *           texture_coords;
+    const cached_attributes *   attributes;
+    const int *                 indirection;
+    const cached_light *        lights;
+    const int *                 light_triangles;
+    int nr_materials, nr_triangles, nr_normals, nr_texture_coords, nr_attributes, nr_indirection, nr_lights, nr_light_triangles;
+    if (!read_section(f, h, cache_section_t::materials,         &materials,         &nr_materials)          ||
+        !read_section(f, h, cache_section_t::triangles,         &triangles,         &nr_triangles)          ||
+        !read_section(f, h, cache_section_t::normals,           &normals,           &nr_normals)            ||
+        !read_section(f, h, cache_section_t::texture_coords,    &texture_coords,    &nr_texture_coords)     ||
+        !read_section(f, h, cache_section_t::attributes,        &attributes,        &nr_attributes)         ||
+        !read_section(f, h, cache_section_t::indirection,       &indirection,       &nr_indirection)        ||
+        !read_section(f, h, cache_section_t::lights,            &lights,            &nr_lights)             ||
+        !read_section(f, h, cache_section_t::light_triangles,   &light_triangles,   &nr_light_triangles)    ||
+        (nr_indirection != nr_triangles))
+    {
+        BOOST_LOG_TRIVIAL(warning) << "Scene cache " << cache << " is corrupt";
+        return false;
+    }
+
+    /* Check the indices before changing anything */
+    bool valid = true;
+    for (int i = 0; i < nr_triangles; ++i)
+    {
+        valid &= (triangles[i].mat >= 0) && (triangles[i].mat < nr_materials) && (triangles[i].attr < nr_attributes);
+    }
+
+    for (int i = 0; i < nr_attributes; ++i)
+    {
+        for (int j = 0; j < 3; ++j)
+        {
+            valid &= (attributes[i].vn[j] < nr_normals) && (attributes[i].vt[j] < nr_texture_coords);
+        }
+    }
+
+    for (int i = 0; i < nr_lights; ++i)
+    {
+        valid &= (lights[i].tris_begin < 0) || ((lights[i].tris_begin <= lights[i].tris_end) && (lights[i].tris_end <= nr_light_triangles));
+    }
+
+    if (!valid)
+    {
+        BOOST_LOG_TRIVIAL(warning) << "Scene cache " << cache << " is corrupt";
+        return false;
+    }
+
+    /* Materials */
+    std::vector<material *> mats;
+    mats.reserve(nr_materials);
+    for (int i = 0; i < nr_materials; ++i)
+    {
+        const cached_material &mat = materials[i];
+        if (mat.type == static_cast<int>(cached_material_t::coloured_mapper))
+        {
+            mats.push_back(new coloured_mapper_shader(mat.ka, mat.kd, mat.ks, mat.s, mat.tran, mat.ri, mat.rf, mat.td, mat.rfd));
+        }
+        else
+        {
+            mats.push_back(new phong_shader(mat.ka, mat.kd, mat.ks, mat.s, mat.tran, mat.ri, mat.rf, mat.td, mat.rfd));
+        }
+        m->push_back(mats.back());
+    }
+
+    /* Primitives and their vertex attributes */
+    for (int i = 0; i < nr_normals; ++i)
+    {
+        e->add_normal(normals[i]);
+    }
+
+    for (int i = 0; i < nr_texture_coords; ++i)
+    {
+        e->add_texture_coord(texture_coords[i]);
+    }
+
+    e->reserve(nr_triangles);
+    for (int i = 0; i < nr_triangles; ++i)
+    {
+        const cached_triangle &tri = triangles[i];
+        if (tri.attr < 0)
+        {
+            e->emplace_back(mats[tri.mat], tri.a, tri.b, tri.c, tri.light);
+        }
+        else
+        {
+            const cached_attributes &attr = attributes[tri.attr];
+            e->emplace_back(mats[tri.mat], tri.a, tri.b, tri.c, tri.light, ((attr.vn[0] < 0) ? nullptr : &attr.vn[0]), ((attr.vt[0] < 0) ? nullptr : &attr.vt[0]));
+        }
+    }
+
+    std::vector<int> indirect(indirection, indirection + nr_indirection);
+    e->swap(indirect);
+
+    /* Lights */
+    for (int i = 0; i < nr_lights; ++i)
+    {
+        const cached_light &li = lights[i];
+        const std::vector<int> *tris = nullptr;
+        if (li.tris_begin >= 0)
+        {
+            /* Lives as long as the scene, as for parsed lights */
+            tris = new std::vector<int>(&light_triangles[li.tris_begin], &light_triangles[li.tris_end]);
+        }
+
+        l->push_back(light(((tris == nullptr) ? nullptr : e), tris, li.rgb, li.c, li.n, li.r, li.d, li.s_a, li.s_b, static_cast<light_direction_t>(li.n_dir)));
+    }
+
+    /* Spatial sub division */
+    if (h.ssd != static_cast<int>(t))
+    {
+        BOOST_LOG_TRIVIAL(info) << "Loaded " << nr_triangles << " primitives from scene cache " << cache;
+        return true;
+    }
+
+    const precomputed_triangle *ssd_triangles;
+    int nr_ssd_triangles;
+    if (!read_section(f, h, cache_section_t::ssd_triangles, &ssd_triangles, &nr_ssd_triangles))
+    {
+        BOOST_LOG_TRIVIAL(warning) << "Scene cache " << cache << " has a corrupt spatial sub division";
+        return true;
+    }
+
+    std::shared_ptr<std::vector<precomputed_triangle>> tris(new std::vector<precomputed_triangle>(ssd_triangles, ssd_triangles + nr_ssd_triangles));
+    switch (t)
+    {
+        case ssd_type_t::kdt :
+        case ssd_type_t::bkdt :
+        {
+            const cached_kdt_node *cached_nodes;
+            const int *leaf_prims;
+            int nr_nodes, nr_leaf_prims;
+            bool valid_nodes = read_section(f, h, cache_section_t::ssd_nodes, &cached_nodes, &nr_nodes) && read_section(f, h, cache_section_t::leaf_primitives, &leaf_prims, &nr_leaf_prims);
+            for (int i = 0; valid_nodes && (i < nr_nodes); ++i)
+            {
+                /* Children must follow their parent so there are no cycles */
+                const cached_kdt_node &n = cached_nodes[i];
+                if (n.normal == static_cast<int>(axis_t::not_set))
+                {
+                    valid_nodes = (n.idx >= 0) && (n.size >= 0) && ((n.idx + n.size) <= nr_leaf_prims);
+                }
+                else
+                {
+                    valid_nodes = (n.idx > i) && ((n.idx + 1) < nr_nodes);
+                }
+            }
+
+            if (valid_nodes && (nr_nodes > 0))
+            {
+                std::shared_ptr<std::vector<kdt_node>> nodes(new std::vector<kdt_node>(nr_nodes));
+                for (int i = 0; i < nr_nodes; ++i)
+                {
+                    const cached_kdt_node &n = cached_nodes[i];
+                    if (n.normal == static_cast<int>(axis_t::not_set))
+                    {
+                        (*nodes)[i].set_primitives(new std::vector<int>(&leaf_prims[n.idx], &leaf_prims[n.idx + n.size]));
+                    }
+                    else
+                    {
+                        (*nodes)[i].split_node(&(*nodes)[n.idx], n.split, static_cast<axis_t>(n.normal));
+                    }
+                }
+                s->reset(new kd_tree(*e, nodes, tris, h.lower, h.upper));
+            }
+            break;
+        }
+        case ssd_type_t::bvh :
+        {
+            const bvh_node *cached_nodes;
+            int nr_nodes;
+            if (read_section(f, h, cache_section_t::ssd_nodes, &cached_nodes, &nr_nodes))
+            {
+                std::shared_ptr<std::vector<bvh_node>> nodes(new std::vector<bvh_node>(cached_nodes, cached_nodes + nr_nodes));
+                s->reset(new bvh(*e, nodes, tris, h.lower, h.upper, h.root, h.build_sah));
+            }
+            break;
+        }
+        case ssd_type_t::bih :
+        {
+            const bih_block *cached_blocks;
+            int nr_blocks;
+            if (read_section(f, h, cache_section_t::ssd_nodes, &cached_blocks, &nr_blocks))
+            {
+                std::shared_ptr<std::vector<bih_block>> blocks(new std::vector<bih_block>(cached_blocks, cached_blocks + nr_blocks));
+                s->reset(new bih(*e, blocks, tris, h.lower, h.upper));
+            }
+            break;
+        }
+        default :
+            break;
+    }
+
+    BOOST_LOG_TRIVIAL(info) << "Loaded " << nr_triangles << " primitives " << ((*s == nullptr) ? "" : "and spatial sub division ") << "from scene cache " << cache;
+    return true;
+}
+
+
+/**********************************************************
+ save writes a scene and its spatial sub division to a
+ cache.
+
+ Scenes with materials other than phong shaders or
+ coloured mapper shaders without textures are not cached. The spatial sub division is only cached if it is
+ a kd tree, bvh or bih, otherwise it must be rebuilt after
+ loading.
+
+ The cache is written to a temporary file and renamed so
+ a partially written cache is never loaded.
+**********************************************************/
+bool scene_cache::save(const std::string &cache, const std::uint64_t hash, const light_list &l, const int first_light, const primitive_store &e,
+    const std::list<material *> &m, const ssd_type_t t, const ssd *const s)
+{
+    cache_header h{};
+    memcpy(h.magic, cache_magic, sizeof(h.magic));
+    h.version   = SCENE_CACHE_VERSION;
+    h.layout    = cache_layout();
+    h.hash      = hash;
+    h.ssd       = -1;
+
+    /* Materials */
+    std::unordered_map<const material *, int> material_idx;
+    std::vector<cached_material> materials;
+    for (const material *const mat : m)
+    {
+        const phong_shader *const phong = dynamic_cast<const phong_shader *>(mat);
+        const coloured_mapper_shader *const mapper = dynamic_cast<const coloured_mapper_shader *>(mat);
+        if (phong != nullptr)
+        {
+            materials.push_back({ static_cast<int>(cached_material_t::phong), phong->ka, phong->kd, phong->ks, phong->s, phong->tran, phong->ri, phong->rf, phong->td, phong->rfd });
+        }
+        else if ((mapper != nullptr) && (mapper->t_ka == nullptr) && (mapper->t_kd == nullptr) && (mapper->t_ks == nullptr) && (mapper->t_ns == nullptr) &&
+                 (mapper->t_refl == nullptr) && (mapper->t_d == nullptr))
+        {
+            materials.push_back({ static_cast<int>(cached_material_t::coloured_mapper), mapper->ka, mapper->kd, mapper->ks, mapper->ns, mapper->tran, mapper->ri, mapper->rf, mapper->td, mapper->rfd });
+        }
+        else
+        {
+            BOOST_LOG_TRIVIAL(info) << "Scene not cached, only phong shaders and untextured coloured mapper shaders can be cached";
+            return false;
+        }
+
+        material_idx[mat] = materials.size() - 1;
+    }
+
+    /* Vertex attributes */
+    std::unordered_map<const point_t<> *, int> normal_idx;
+    const std::vector<point_t<>> normals(e._normals.begin(), e._normals.end());
+    for (int i = 0; i < static_cast<int>(e._normals.size()); ++i)
+    {
+        normal_idx[&e._normals[i]] = i;
+    }
+
+    std::unordered_map<const point_t<> *, int> texture_coord_idx;
+    const std::vector<point_t<>> texture_coords(e._texture_coords.begin(), e._texture_coords.end());
+    for (int i = 0; i < static_cast<int>(e._texture_coords.size()); ++i)
+    {
+        texture_coord_idx[&e._texture_coords[i]] = i;
+    }
+
+    std::unordered_map<const vertex_attributes *, int> attribute_idx;
+    std::vector<cached_attributes> attributes;
+    attributes.reserve(e._attributes.size());
+    for (const auto &attr : e._attributes)
+    {
+        cached_attributes c;
+        for (int i = 0; i < 3; ++i)
+        {
+            c.vn[i] = (attr.vn[i] == nullptr) ? -1 : normal_idx[attr.vn[i]];
+            c.vt[i] = (attr.vt[i] == nullptr) ? -1 : texture_coord_idx[attr.vt[i]];
+        }
+
+        attribute_idx[&attr] = attributes.size();
+        attributes.push_back(c);
+    }
+
+    /* Primitives */
+    std::vector<cached_triangle> triangles;
+    triangles.reserve(e.size());
+    for (const auto &tri : e)
+    {
+        const auto mat = material_idx.find(tri.get_material());
+        if (mat == material_idx.end())
+        {
+            BOOST_LOG_TRIVIAL(warning) << "Scene not cached, primitive has an unknown material";
+            return false;
+        }
+
+        triangles.push_back({ tri.vertex_a, tri.vertex_b, tri.vertex_c, mat->second, ((tri.vnt == nullptr) ? -1 : attribute_idx[tri.vnt]), tri.get_light() });
+    }
+
+    /* Lights */
+    std::vector<cached_light> lights;
+    std::vector<int> light_triangles;
+    for (int i = first_light; i < static_cast<int>(l.size()); ++i)
+    {
+        const light &li = l[i];
+        if ((li.e != nullptr) && (li.e != &e))
+        {
+            BOOST_LOG_TRIVIAL(warning) << "Scene not cached, light is made from other primitives";
+            return false;
+        }
+
+        lights.push_back({ li.rgb, li.c, li.n, li.r, li.d, li.s_a, li.s_b, static_cast<int>(li.n_dir), -1, -1 });
+        if (li.t != nullptr)
+        {
+            lights.back().tris_begin = light_triangles.size();
+            light_triangles.insert(light_triangles.end(), li.t->begin(), li.t->end());
+            lights.back().tris_end = light_triangles.size();
+        }
+    }
+
+    /* Write the scene */
+    const std::string tmp(cache + ".tmp");
+    std::ofstream out(tmp.c_str(), std::ios::binary | std::ios::trunc);
+    if (!out.is_open())
+    {
+        BOOST_LOG_TRIVIAL(warning) << "Scene not cached, cannot open " << tmp;
+        return false;
+    }
+
+    out.write(reinterpret_cast<const char *>(&h), sizeof(h));
+    write_section(&out, &h, cache_section_t::materials,        materials);
+    write_section(&out, &h, cache_section_t::triangles,        triangles);
+    write_section(&out, &h, cache_section_t::normals,          normals);
+    write_section(&out, &h, cache_section_t::texture_coords,   texture_coords);
+    write_section(&out, &h, cache_section_t::attributes,       attributes);
+    write_section(&out, &h, cache_section_t::indirection,      e._indirect);
+    write_section(&out, &h, cache_section_t::lights,           lights);
+    write_section(&out, &h, cache_section_t::light_triangles,  light_triangles);
+
+    /* Write the spatial sub division */
+    const kd_tree *const kdt = dynamic_cast<const kd_tree *>(s);
+    const bvh *const bv = dynamic_cast<const bvh *>(s);
+    const bih *const bi = dynamic_cast<const bih *>(s);
+    if (kdt != nullptr)
+    {
+        std::vector<cached_kdt_node> nodes(1);
+        std::vector<int> leaf_prims;
+        flatten_kdt_node((*kdt->_kdt_base)[0], 0, &nodes, &leaf_prims);
+        write_section(&out, &h, cache_section_t::ssd_nodes,         nodes);
+        write_section(&out, &h, cache_section_t::leaf_primitives,   leaf_prims);
+        write_section(&out, &h, cache_section_t::ssd_triangles,     *kdt->_tris);
+    }
+    else if (bv != nullptr)
+    {
+        write_section(&out, &h, cache_section_t::ssd_nodes,     *bv->_bvh_base);
+        write_section(&out, &h, cache_section_t::ssd_triangles, *bv->_tris);
+        h.root      = bv->_root_node;
+        h.build_sah = bv->_build_sah;
+    }
+    else if (bi != nullptr)
+    {
+        write_section(&out, &h, cache_section_t::ssd_nodes,     *bi->_bih_base);
+        write_section(&out, &h, cache_section_t::ssd_triangles, *bi->_tris);
+    }
+
+    if ((kdt != nullptr) || (bv != nullptr) || (bi != nullptr))
+    {
+        h.ssd   = static_cast<int>(t);
+        h.lower = s->scene_lower_bound();
+        h.upper = s->scene_upper_bound();
+    }
+
+    /* Rewrite the header now the sections are known */
+    out.seekp(0);
+    out.write(reinterpret_cast<const char *>(&h), sizeof(h));
+    out.close();
+    if (out.fail() || (std::rename(tmp.c_str(), cache.c_str()) != 0))
+    {
+        BOOST_LOG_TRIVIAL(warning) << "Scene not cached, cannot write " << cache;
+        std::remove(tmp.c_str());
+        return false;
+    }
+
+    BOOST_LOG_TRIVIAL(info) << "Saved " << e.size() << " primitives to scene cache " << cache;
+    return true;
+}
+}; /* namespace raptor_raytracer */
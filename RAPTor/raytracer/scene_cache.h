@@ -0,0 +1,48 @@
+#pragma once
+
+/* Standard headers */
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+
+/* Boost headers */
+
+/* Common headers */
+#include "common.h"
+
+/* Ray tracer headers */
+#include "light.h"
+#include "primitive_store.h"
+#include "ssd.h"
+
+
+namespace raptor_raytracer
+{
+/* Forward declarations */
+class material;
+
+/* Version of the cache format, caches of other versions are ignored */
+const std::uint32_t SCENE_CACHE_VERSION = 1;
+
+/* Binary cache of a parsed scene and the spatial sub division built over it. Caches are memory mapped */
+/* to load and record the hash of the file they were parsed from, so a changed scene is parsed again   */
+/* Untextured materials and kd tree, bvh and bih spatial sub divisions can be cached                   */
+class scene_cache
+{
+    public :
+        /* Hash of the contents of a file, 0 if it cant be read */
+        static std::uint64_t hash_file(const std::string &file);
+
+        /* Load a cached scene into the empty primitive store e, appending to the lights l and materials m */
+        /* s is set to the cached spatial sub division if it is of type t, otherwise it is left empty     */
+        /* Returns false without changing anything if there is no valid cache for the hash                */
+        static bool load(const std::string &cache, const std::uint64_t hash, const ssd_type_t t, light_list *const l, primitive_store *const e,
+            std::list<material *> *const m, std::unique_ptr<ssd> *const s);
+
+        /* Save a scene, the lights from first_light onwards came from the scene and are saved */
+        /* Returns false if the scene cant be cached or written                               */
+        static bool save(const std::string &cache, const std::uint64_t hash, const light_list &l, const int first_light, const primitive_store &e,
+            const std::list<material *> &m, const ssd_type_t t, const ssd *const s);
+};
+}; /* namespace raptor_raytracer */
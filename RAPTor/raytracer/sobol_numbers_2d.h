@@ -8,7 +8,7 @@ class sobol_numbers_2d
 {
     public :
         /* CTOR */
-        sobol_numbers_2d(const int n) : _l(ceil(std::log(static_cast<T>(n)) / log(2.0f))), _cur_n(0), _n(n)
+        sobol_numbers_2d(const int n) : _l(ceil(std::log2(static_cast<double>(n)))), _scramble_x(0), _scramble_y(0), _cur_n(0), _n(n)
         {
             /* First dimension */
             _v.reset(new unsigned int [_l << 1]);
@@ -30,6 +30,17 @@ class sobol_numbers_2d
         {
             _cur_n = 0;
         }
+
+        /* Restart with a new random digit scramble, each dimension is xor-ed with its scramble */
+        /* Only the digits that pick the strata are scrambled so the strata are visited in a different */
+        /* order, but the points stay at the start of their strata ready for jittering */
+        void reset(const unsigned int scramble_x, const unsigned int scramble_y)
+        {
+            const unsigned int mask = (_l > 0) ? (0xffffffffu << (32 - _l)) : 0;
+            _scramble_x = scramble_x & mask;
+            _scramble_y = scramble_y & mask;
+            _cur_n      = 0;
+        }
         
         /* Get the next number in all dimensions */
         void next(T &x, T &y)
@@ -42,8 +53,8 @@ class sobol_numbers_2d
             {
                 _last_x = 0;
                 _last_y = 0;
-                x = static_cast<T>(_last_x) * _pow_2_32_inv;
-                y = static_cast<T>(_last_y) * _pow_2_32_inv;
+                x = static_cast<T>(_last_x ^ _scramble_x) * _pow_2_32_inv;
+                y = static_cast<T>(_last_y ^ _scramble_y) * _pow_2_32_inv;
                 ++_cur_n;
                 return;
             }
@@ -57,10 +68,10 @@ class sobol_numbers_2d
             
             /* Create result and scale to -1.0 to 1.0 */
             _last_x ^= _v[c << 1];
-            x = static_cast<T>(_last_x) * _pow_2_32_inv;
+            x = static_cast<T>(_last_x ^ _scramble_x) * _pow_2_32_inv;
 
             _last_y ^= _v[(c << 1) + 1];
-            y = static_cast<T>(_last_y) * _pow_2_32_inv;
+            y = static_cast<T>(_last_y ^ _scramble_y) * _pow_2_32_inv;
             
             ++_cur_n;
             return;
@@ -72,6 +83,8 @@ class sobol_numbers_2d
         int                                 _l;
         unsigned int                        _last_x;
         unsigned int                        _last_y;
+        unsigned int                        _scramble_x;
+        unsigned int                        _scramble_y;
         int                                 _cur_n;
         const int                           _n;
 };
@@ -8,6 +8,7 @@
 
 /* Ray tracer headers */
 #include "bih.h"
+#include "traversal_statistics.h"
 
 
 namespace raptor_raytracer
@@ -48,11 +49,13 @@ inline int bih::find_leaf_node(const frustrum &r, bih_stack_element *const entry
             _mm_prefetch((char *)&(*_bih_base)[child_block + 7], _MM_HINT_T0);
         }
 
+        COUNT_TRAVERSAL(nodes_visited, 1);
         switch ((*_bih_base)[bih_block].get_split_axis(bih_node))
         {
             /* This node is not split in any plane, ie/ it is a leaf */
             case axis_t::not_set : 
             {
+                COUNT_TRAVERSAL(leaves_visited, 1);
                 /* update the state and return 1 for intersection testing */
                 *out = exit_point;
                 entry_point->idx = bih_index(bih_block, bih_node);
@@ -88,6 +91,7 @@ inline int bih::find_leaf_node(const frustrum &r, bih_stack_element *const entry
                 /* Empty space is traversed, return 0 to pop the stack */
                 if ((t_min > max_near_plane) && (t_max < min_far_plane))
                 {   
+                    COUNT_TRAVERSAL(frustrum_culls, 1);
                     *out = exit_point;
                     return 0;         
                 }
@@ -167,6 +171,7 @@ inline int bih::find_leaf_node(const frustrum &r, bih_stack_element *const entry
                 /* Empty space is traversed, return 0 to pop the stack */
                 if ((t_min > max_near_plane) && (t_max < min_far_plane))
                 {   
+                    COUNT_TRAVERSAL(frustrum_culls, 1);
                     *out = exit_point;
                     return 0;         
                 }
@@ -246,6 +251,7 @@ inline int bih::find_leaf_node(const frustrum &r, bih_stack_element *const entry
                 /* Empty space is traversed, return 0 to pop the stack */
                 if ((t_min > max_near_plane) && (t_max < min_far_plane))
                 {   
+                    COUNT_TRAVERSAL(frustrum_culls, 1);
                     *out = exit_point;
                     return 0;         
                 }
@@ -333,35 +339,35 @@ void bih::frustrum_find_nearest_object(const packet_ray *const r, vint_t *const
     /* Set the scene bounding box based on ray direction */
     if (f.get_min_x_grad() < 0)
     {
-        entry_point.u.x    = _builder.scene_lower_bound().x;
-        entry_point.l.x    = _builder.scene_upper_bound().x;
+        entry_point.u.x    = _scene_lower.x;
+        entry_point.l.x    = _scene_upper.x;
     }
     else
     {
-        entry_point.u.x    = _builder.scene_upper_bound().x;
-        entry_point.l.x    = _builder.scene_lower_bound().x;
+        entry_point.u.x    = _scene_upper.x;
+        entry_point.l.x    = _scene_lower.x;
     }
 
     if (f.get_min_y_grad() < 0)
     {
-        entry_point.u.y    = _builder.scene_lower_bound().y;
-        entry_point.l.y    = _builder.scene_upper_bound().y;
+        entry_point.u.y    = _scene_lower.y;
+        entry_point.l.y    = _scene_upper.y;
     }
     else
     {
-        entry_point.u.y    = _builder.scene_upper_bound().y;
-        entry_point.l.y    = _builder.scene_lower_bound().y;
+        entry_point.u.y    = _scene_upper.y;
+        entry_point.l.y    = _scene_lower.y;
     }
 
     if (f.get_min_z_grad() < 0)
     {
-        entry_point.u.z    = _builder.scene_lower_bound().z;
-        entry_point.l.z    = _builder.scene_upper_bound().z;
+        entry_point.u.z    = _scene_lower.z;
+        entry_point.l.z    = _scene_upper.z;
     }
     else
     {
-        entry_point.u.z    = _builder.scene_upper_bound().z;
-        entry_point.l.z    = _builder.scene_lower_bound().z;
+        entry_point.u.z    = _scene_upper.z;
+        entry_point.l.z    = _scene_lower.z;
     }
 
     /* Clip packet to the world */
@@ -415,6 +421,8 @@ void bih::frustrum_find_nearest_object(const packet_ray *const r, vint_t *const
                 const vfp_t exit_t = min(x_exit, min(x_exit, z_exit));
                 const vfp_t mask = entry_t <= exit_t;
           
+                COUNT_PACKET_LANES(move_mask(mask));
+
                 /* If packet enters leaf then test it */
                 if (move_mask(mask) != 0)
                 {
@@ -433,10 +441,12 @@ void bih::frustrum_find_nearest_object(const packet_ray *const r, vint_t *const
             }
 #endif
             /* Update furthest intersection */
-            static_assert(MAXIMUM_PACKET_SIZE == 16, "Error: Max expects MAXIMUM_PACKET_SIZE to be 16");
-            max_d = horizontal_max(
-                        max(max(max(max(h[0].d, h[1].d), max(h[ 2].d, h[ 3].d)), max(max(h[ 4].d, h[ 5].d), max(h[ 6].d, h[ 7].d))), 
-                            max(max(max(h[8].d, h[9].d), max(h[10].d, h[11].d)), max(max(h[12].d, h[13].d), max(h[14].d, h[15].d)))));
+            vfp_t vmax_d(h[0].d);
+            for (int i = 1; i < MAXIMUM_PACKET_SIZE; ++i)
+            {
+                vmax_d = max(vmax_d, h[i].d);
+            }
+            max_d = horizontal_max(vmax_d);
 
         }
         else if (cmd == -1)
@@ -524,35 +534,35 @@ void bih::frustrum_found_nearer_object(const packet_ray *const r, const vfp_t *t
     /* Set the scene bounding box based on ray direction */
     if (f.get_min_x_grad() < 0)
     {
-        entry_point.u.x    = _builder.scene_lower_bound().x;
-        entry_point.l.x    = _builder.scene_upper_bound().x;
+        entry_point.u.x    = _scene_lower.x;
+        entry_point.l.x    = _scene_upper.x;
     }
     else
     {
-        entry_point.u.x    = _builder.scene_upper_bound().x;
-        entry_point.l.x    = _builder.scene_lower_bound().x;
+        entry_point.u.x    = _scene_upper.x;
+        entry_point.l.x    = _scene_lower.x;
     }
 
     if (f.get_min_y_grad() < 0)
     {
-        entry_point.u.y    = _builder.scene_lower_bound().y;
-        entry_point.l.y    = _builder.scene_upper_bound().y;
+        entry_point.u.y    = _scene_lower.y;
+        entry_point.l.y    = _scene_upper.y;
     }
     else
     {
-        entry_point.u.y    = _builder.scene_upper_bound().y;
-        entry_point.l.y    = _builder.scene_lower_bound().y;
+        entry_point.u.y    = _scene_upper.y;
+        entry_point.l.y    = _scene_lower.y;
     }
 
     if (f.get_min_z_grad() < 0)
     {
-        entry_point.u.z    = _builder.scene_lower_bound().z;
-        entry_point.l.z    = _builder.scene_upper_bound().z;
+        entry_point.u.z    = _scene_lower.z;
+        entry_point.l.z    = _scene_upper.z;
     }
     else
     {
-        entry_point.u.z    = _builder.scene_upper_bound().z;
-        entry_point.l.z    = _builder.scene_lower_bound().z;
+        entry_point.u.z    = _scene_upper.z;
+        entry_point.l.z    = _scene_lower.z;
     }
 
     /* Traverse the whole tree */
@@ -600,6 +610,8 @@ void bih::frustrum_found_nearer_object(const packet_ray *const r, const vfp_t *t
                 const vfp_t exit_t = min(x_exit, min(x_exit, z_exit));
                 const vfp_t mask = entry_t <= exit_t;
                                    
+                COUNT_PACKET_LANES(move_mask(mask));
+
                 /* If packet enters leaf then test it */
                 if (move_mask(mask) != 0)
                 {
@@ -619,9 +631,11 @@ void bih::frustrum_found_nearer_object(const packet_ray *const r, const vfp_t *t
 #endif
 
             /* Update furthest intersection */
-            static_assert(MAXIMUM_PACKET_SIZE == 16, "Error: Max expects MAXIMUM_PACKET_SIZE to be 16");
-            vmax_d = max(max(max(max(h[0].d, h[1].d), max(h[ 2].d, h[ 3].d)), max(max(h[ 4].d, h[ 5].d), max(h[ 6].d, h[ 7].d))), 
-                         max(max(max(h[8].d, h[9].d), max(h[10].d, h[11].d)), max(max(h[12].d, h[13].d), max(h[14].d, h[15].d))));
+            vmax_d = h[0].d;
+            for (int i = 1; i < MAXIMUM_PACKET_SIZE; ++i)
+            {
+                vmax_d = max(vmax_d, h[i].d);
+            }
             max_d = horizontal_max(vmax_d);
             
             /* Early exit for all rays occluded */
@@ -699,11 +713,13 @@ inline bool bih::find_leaf_node(const packet_ray &r, bih_stack_element *const en
             _mm_prefetch((char *)&(*_bih_base)[child_block + 7], _MM_HINT_T0);
         }
 
+        COUNT_TRAVERSAL(nodes_visited, 1);
         switch ((*_bih_base)[bih_block].get_split_axis(bih_node))
         {
             /* This node is not split in any plane, ie/ it is a leaf */
             case axis_t::not_set : 
             {
+                COUNT_TRAVERSAL(leaves_visited, 1);
                 /* update the state and return 1 for intersection testing */
                 entry_point->idx = bih_index(bih_block, bih_node);
                 *out = exit_point;
@@ -729,6 +745,7 @@ inline bool bih::find_leaf_node(const packet_ray &r, bih_stack_element *const en
 
                 /* Empty space is traversed, return 0 to pop the stack */
                 int a_node = move_mask((t_min < near_plane) | (t_max > far_plane));
+                COUNT_PACKET_LANES(a_node);
                 if (!a_node)
                 {   
                    *out = exit_point;
@@ -786,6 +803,7 @@ inline bool bih::find_leaf_node(const packet_ray &r, bih_stack_element *const en
  
                 /* Empty space is traversed, return 0 to pop the stack */
                 int a_node = move_mask((t_min < near_plane) | (t_max > far_plane));
+                COUNT_PACKET_LANES(a_node);
                 if (!a_node)
                 {   
                    *out = exit_point;
@@ -843,6 +861,7 @@ inline bool bih::find_leaf_node(const packet_ray &r, bih_stack_element *const en
 
                 /* Empty space is traversed, return 0 to pop the stack */
                 int a_node = move_mask((t_min < near_plane) | (t_max > far_plane));
+                COUNT_PACKET_LANES(a_node);
                 if (!a_node)
                 {   
                     *out = exit_point;
@@ -1126,11 +1145,13 @@ inline bool bih::find_leaf_node(const ray &r, bih_stack_element *const entry_poi
             _mm_prefetch((char *)&(*_bih_base)[child_block + 7], _MM_HINT_T0);
         }
         
+        COUNT_TRAVERSAL(nodes_visited, 1);
         switch ((*_bih_base)[bih_block].get_split_axis(bih_node))
         {
             /* This node is not split in any plane, ie/ it is a leaf */
             case axis_t::not_set : 
             {
+                COUNT_TRAVERSAL(leaves_visited, 1);
                 /* update the state and return */
                 entry_point->idx = bih_index(bih_block, bih_node);
                 *out = exit_point;
@@ -1332,35 +1353,35 @@ int bih::find_nearest_object(const ray *const r, hit_description *const h) const
     /* Set the scene bounding box based on ray direction */
     if (r->get_x_grad() >= 0.0f)
     {
-        entry_point.u.x    = _builder.scene_lower_bound().x;
-        entry_point.l.x    = _builder.scene_upper_bound().x;
+        entry_point.u.x    = _scene_lower.x;
+        entry_point.l.x    = _scene_upper.x;
     }
     else
     {
-        entry_point.u.x    = _builder.scene_upper_bound().x;
-        entry_point.l.x    = _builder.scene_lower_bound().x;
+        entry_point.u.x    = _scene_upper.x;
+        entry_point.l.x    = _scene_lower.x;
     }
 
     if (r->get_y_grad() >= 0.0f)
     {
-        entry_point.u.y    = _builder.scene_lower_bound().y;
-        entry_point.l.y    = _builder.scene_upper_bound().y;
+        entry_point.u.y    = _scene_lower.y;
+        entry_point.l.y    = _scene_upper.y;
     }
     else
     {
-        entry_point.u.y    = _builder.scene_upper_bound().y;
-        entry_point.l.y    = _builder.scene_lower_bound().y;
+        entry_point.u.y    = _scene_upper.y;
+        entry_point.l.y    = _scene_lower.y;
     }
 
     if (r->get_z_grad() >= 0.0f)
     {
-        entry_point.u.z    = _builder.scene_lower_bound().z;
-        entry_point.l.z    = _builder.scene_upper_bound().z;
+        entry_point.u.z    = _scene_lower.z;
+        entry_point.l.z    = _scene_upper.z;
     }
     else
     {
-        entry_point.u.z    = _builder.scene_upper_bound().z;
-        entry_point.l.z    = _builder.scene_lower_bound().z;
+        entry_point.u.z    = _scene_upper.z;
+        entry_point.l.z    = _scene_lower.z;
     }
 
     /* Clip packet to the world */
@@ -1398,7 +1419,7 @@ int bih::find_nearest_object(const ray *const r, hit_description *const h) const
         if (leaf)
         {
             // BOOST_LOG_TRIVIAL(trace) << "Found leaf node";
-            const int intersecting_object = (*_bih_base)[block_index(entry_point.idx)].get_node(node_index(entry_point.idx))->test_leaf_node_nearest(_prims, r, &nearest_hit);
+            const int intersecting_object = (*_bih_base)[block_index(entry_point.idx)].get_node(node_index(entry_point.idx))->test_leaf_node_nearest(_tris->data(), r, &nearest_hit);
 
             /* If an intersecting object is found it is the closest so return */
             if (intersecting_object != -1)
@@ -1460,7 +1481,7 @@ bool bih::found_nearer_object(const ray *const r, const float t) const
         if (leaf)
         {
             // BOOST_LOG_TRIVIAL(trace) << "Testing leaf node: " << entry_point.idx << ", " << t;
-            const bool closer = (*_bih_base)[block_index(entry_point.idx)].get_node(node_index(entry_point.idx))->test_leaf_node_nearer(_prims, r, t);
+            const bool closer = (*_bih_base)[block_index(entry_point.idx)].get_node(node_index(entry_point.idx))->test_leaf_node_nearer(_tris->data(), r, t);
 
             /* If an intersecting object is found it is the closest so return */
             if (closer) 
@@ -1485,4 +1506,84 @@ bool bih::found_nearer_object(const ray *const r, const float t) const
         // BOOST_LOG_TRIVIAL(trace) << "Unwound one stack level";
     }
 }
+
+
+/**********************************************************
+ Count the nodes below and including idx. The number of leaf
+ nodes is accumulated in leaves.
+**********************************************************/
+inline int count_nodes(const std::vector<bih_block> &blocks, const int idx, int *const leaves)
+{
+    const int block = block_index(idx);
+    const int node  = node_index(idx);
+    if (blocks[block].get_split_axis(node) == axis_t::not_set)
+    {
+        ++(*leaves);
+        return 1;
+    }
+
+    int right_idx;
+    const int left_idx = blocks[block].get_siblings(&right_idx, block, node);
+    return 1 + count_nodes(blocks, left_idx, leaves) + count_nodes(blocks, right_idx, leaves);
+}
+
+
+/**********************************************************
+ 
+**********************************************************/
+int bih::number_of_nodes() const
+{
+    int leaves = 0;
+    return count_nodes(*_bih_base, 0, &leaves);
+}
+
+
+/**********************************************************
+ 
+**********************************************************/
+int bih::number_of_leaves() const
+{
+    int leaves = 0;
+    count_nodes(*_bih_base, 0, &leaves);
+    return leaves;
+}
+
+
+/**********************************************************
+ Sum the surface area weighted cost of the nodes below and
+ including idx, which is bounded by b and t.
+**********************************************************/
+inline float node_sah_cost(const std::vector<bih_block> &blocks, const int idx, const point_t<> &b, const point_t<> &t)
+{
+    const int block = block_index(idx);
+    const int node  = node_index(idx);
+    const float sa  = surface_area(b, t);
+    const axis_t normal = blocks[block].get_split_axis(node);
+    if (normal == axis_t::not_set)
+    {
+        const bih_node *const n = blocks[block].get_node(node);
+        return n->is_empty() ? 0.0f : (COST_OF_INTERSECTION * n->size() * sa);
+    }
+
+    /* Children are clipped to their split planes */
+    const int axis = static_cast<int>(normal) - 1;
+    point_t<> left_t(t);
+    point_t<> right_b(b);
+    left_t[axis]    = std::max(b[axis], std::min(t[axis], blocks[block].get_node(node)->get_left_split()));
+    right_b[axis]   = std::min(t[axis], std::max(b[axis], blocks[block].get_node(node)->get_right_split()));
+
+    int right_idx;
+    const int left_idx = blocks[block].get_siblings(&right_idx, block, node);
+    return (COST_OF_TRAVERSAL * sa) + node_sah_cost(blocks, left_idx, b, left_t) + node_sah_cost(blocks, right_idx, right_b, t);
+}
+
+
+/**********************************************************
+ 
+**********************************************************/
+float bih::sah_cost() const
+{
+    const float sa = surface_area(_scene_lower, _scene_upper);
+    return (sa > 0.0f) ? (node_sah_cost(*_bih_base, 0, _scene_lower, _scene_upper) / sa) : 0.0f;
+}
 }; /* namespace raptor_raytracer*/
@@ -15,24 +15,39 @@
 #include "bih_block.h"
 #include "bih_node.h"
 #include "bih_builder.h"
+#include "precomputed_triangle.h"
 
 
 namespace raptor_raytracer
 {
+/* Forward declarations */
+class scene_cache;
+
 class bih : public ssd
 {
     public :
         /* CTOR */
         // cppcheck-suppress uninitMemberVar
         bih(primitive_store &everything, const int max_node_size = MAX_BIH_NODE_SIZE) :
-        _prims(everything), _builder(), _bih_base(new std::vector<bih_block>())
+        _prims(everything), _bih_base(new std::vector<bih_block>()), _tris(new std::vector<precomputed_triangle>())
         {
             /* Build the heirarchy */
-            _builder.build(&everything, _bih_base.get());
+            bih_builder builder;
+            builder.build(&everything, _bih_base.get());
+            _scene_lower = builder.scene_lower_bound();
+            _scene_upper = builder.scene_upper_bound();
+
+            /* Pack the intersection data in leaf order */
+            precompute_indirect_triangles(_tris.get(), everything);
         }
 
+        /* CTOR from a previously built bih, see scene_cache */
+        bih(primitive_store &everything, const std::shared_ptr<std::vector<bih_block>> &blocks, const std::shared_ptr<std::vector<precomputed_triangle>> &tris,
+            const point_t<> &lower, const point_t<> &upper) :
+        _prims(everything), _bih_base(blocks), _tris(tris), _scene_lower(lower), _scene_upper(upper) {  }
+
         /* Copy CTOR */
-        bih(const bih&b) : _prims(b._prims), _bih_base(b._bih_base) {  }
+        bih(const bih&b) : _prims(b._prims), _bih_base(b._bih_base), _tris(b._tris), _scene_lower(b._scene_lower), _scene_upper(b._scene_upper) {  }
 
         /* Assignment prohibited by base class */
         /* Allow default DTOR */
@@ -52,7 +67,18 @@ class bih : public ssd
         int     find_nearest_object(const ray *const r, hit_description *const h) const override;
         bool    found_nearer_object(const ray *const r, const float t) const override;
 
+        /* bih statistics */
+        int     number_of_nodes()   const override;
+        int     number_of_leaves()  const override;
+        float   sah_cost()          const override;
+
+        /* Scene bounds */
+        const point_t<> & scene_lower_bound() const override { return _scene_lower; }
+        const point_t<> & scene_upper_bound() const override { return _scene_upper; }
+
     private :
+        friend class scene_cache;
+
         /* Stack element for tracing through the bih */
         struct bih_stack_element
         {
@@ -82,7 +108,9 @@ class bih : public ssd
         /* The stack is mutable because it will never be known to a user of this class */
         const primitive_store &                 _prims;
         mutable bih_stack_element               _bih_stack[MAX_BIH_STACK_HEIGHT];
-        bih_builder                             _builder;
         std::shared_ptr<std::vector<bih_block>> _bih_base;
+        std::shared_ptr<std::vector<precomputed_triangle>>  _tris;
+        point_t<>                               _scene_lower;
+        point_t<>                               _scene_upper;
 };
 }; /* namespace raptor_raytracer */
@@ -98,14 +98,26 @@ void bih_builder::bucket_build()
     std::fill_n(tr, histogram_size, point_t<>(-MAX_DIST, -MAX_DIST, -MAX_DIST));
     for (int i = 0; i <= (static_cast<int>(_primitives->size()) - SIMD_WIDTH); i += SIMD_WIDTH)
     {
+        /* Gather bounds */
+        float bounds[6][SIMD_WIDTH] __attribute__ ((aligned(SIMD_WIDTH * 4)));
+        for (int j = 0; j < SIMD_WIDTH; ++j)
+        {
+            bounds[0][j] = _bounds[i + j].low.x;
+            bounds[1][j] = _bounds[i + j].low.y;
+            bounds[2][j] = _bounds[i + j].low.z;
+            bounds[3][j] = _bounds[i + j].high.x;
+            bounds[4][j] = _bounds[i + j].high.y;
+            bounds[5][j] = _bounds[i + j].high.z;
+        }
+
         /* Calculate morton code*/
-        const vfp_t lo_x(_bounds[i].low.x, _bounds[i + 1].low.x, _bounds[i + 2].low.x, _bounds[i + 3].low.x);
-        const vfp_t lo_y(_bounds[i].low.y, _bounds[i + 1].low.y, _bounds[i + 2].low.y, _bounds[i + 3].low.y);
-        const vfp_t lo_z(_bounds[i].low.z, _bounds[i + 1].low.z, _bounds[i + 2].low.z, _bounds[i + 3].low.z);
+        const vfp_t lo_x(bounds[0]);
+        const vfp_t lo_y(bounds[1]);
+        const vfp_t lo_z(bounds[2]);
 
-        const vfp_t hi_x(_bounds[i].high.x, _bounds[i + 1].high.x, _bounds[i + 2].high.x, _bounds[i + 3].high.x);
-        const vfp_t hi_y(_bounds[i].high.y, _bounds[i + 1].high.y, _bounds[i + 2].high.y, _bounds[i + 3].high.y);
-        const vfp_t hi_z(_bounds[i].high.z, _bounds[i + 1].high.z, _bounds[i + 2].high.z, _bounds[i + 3].high.z);
+        const vfp_t hi_x(bounds[3]);
+        const vfp_t hi_y(bounds[4]);
+        const vfp_t hi_z(bounds[5]);
 
         const vfp_t x(((hi_x + lo_x) * 0.5f) - scene_lo_x);
         const vfp_t y(((hi_y + lo_y) * 0.5f) - scene_lo_y);
@@ -113,25 +125,16 @@ void bih_builder::bucket_build()
         vint_t mc(morton_code(x, y, z, x_mul, y_mul, z_mul));
         mc.store(&_morton_codes[i]);
 
-        /* Build histogram of morton codes */
-        const unsigned int pos_0 = _morton_codes[i    ] >> 20;
-        const unsigned int pos_1 = _morton_codes[i + 1] >> 20;
-        const unsigned int pos_2 = _morton_codes[i + 2] >> 20;
-        const unsigned int pos_3 = _morton_codes[i + 3] >> 20;
-        ++hist[pos_0];
-        ++hist[pos_1];
-        ++hist[pos_2];
-        ++hist[pos_3];
+        for (int j = i; j < (i + SIMD_WIDTH); ++j)
+        {
+            /* Build histogram of morton codes */
+            const unsigned int pos = _morton_codes[j] >> 20;
+            ++hist[pos];
 
-        /* Move and track primitive bounds */
-        bl[pos_0] = min(bl[pos_0], _bounds[i    ].low);
-        tr[pos_0] = max(tr[pos_0], _bounds[i    ].high);
-        bl[pos_1] = min(bl[pos_1], _bounds[i + 1].low);
-        tr[pos_1] = max(tr[pos_1], _bounds[i + 1].high);
-        bl[pos_2] = min(bl[pos_2], _bounds[i + 2].low);
-        tr[pos_2] = max(tr[pos_2], _bounds[i + 2].high);
-        bl[pos_3] = min(bl[pos_3], _bounds[i + 3].low);
-        tr[pos_3] = max(tr[pos_3], _bounds[i + 3].high);
+            /* Move and track primitive bounds */
+            bl[pos] = min(bl[pos], _bounds[j].low);
+            tr[pos] = max(tr[pos], _bounds[j].high);
+        }
     }
 
     for (int i = (static_cast<int>(_primitives->size()) & ~(SIMD_WIDTH - 1)); i < static_cast<int>(_primitives->size()); ++i)
@@ -11,6 +11,7 @@
 /* Ray tracer headers */
 #include "raytracer.h"
 #include "triangle.h"
+#include "precomputed_triangle.h"
 #include "ray.h"
 #include "packet_ray.h"
 #include "frustrum.h"
@@ -60,31 +61,31 @@ class bih_node
             return (this->e - this->b) + 1;
         }
 
-        int test_leaf_node_nearest(const primitive_store &e, const ray *const r, hit_description *const h) const
+        int test_leaf_node_nearest(const precomputed_triangle *const e, const ray *const r, hit_description *const h) const
         {
             int end = this->e;
             int intersecting_object = -1;
             for (int i = this->b; i <= end; ++i)
             {
                 hit_description hit_type(h->d);
-                e.indirect_primitive(i)->is_intersecting(r, &hit_type);
+                e[i].is_intersecting(r, &hit_type);
                 if (hit_type.d < h->d)
                 {
                     *h = hit_type;
-                    intersecting_object = e.indirection(i);
+                    intersecting_object = e[i].index();
                 }
             }
     
             return intersecting_object;
         }
 
-        bool test_leaf_node_nearer(const primitive_store &e, const ray *const r, const float max) const
+        bool test_leaf_node_nearer(const precomputed_triangle *const e, const ray *const r, const float max) const
         {
             int end = this->e;
             for (int i = this->b; i <= end; ++i)
             {
-                const auto *tri = e.indirect_primitive(i);
-                if (tri->get_light() || tri->is_transparent())
+                const auto *tri = &e[i];
+                if (!tri->is_occluder())
                 {
                     continue;
                 }
@@ -8,6 +8,7 @@
 
 /* Ray tracer headers */
 #include "bvh.h"
+#include "traversal_statistics.h"
 
 
 namespace raptor_raytracer
@@ -24,9 +25,11 @@ inline int bvh::find_leaf_node(const frustrum &f, const packet_ray *const r, bvh
 
     while (true)
     {
+        COUNT_TRAVERSAL(nodes_visited, 1);
         if ((*_bvh_base)[cur_idx].is_leaf())
         {
             /* This node is a leaf, update the state and return */
+            COUNT_TRAVERSAL(leaves_visited, 1);
             _entry_point.idx            = cur_idx;
             _entry_point.vt_min_ptr     = vt_min_0;
             exit_point[1].vt_min_ptr    = vt_min_1;
@@ -61,6 +64,7 @@ inline int bvh::find_leaf_node(const frustrum &f, const packet_ray *const r, bvh
                 traverse_0  += move_mask(vt_min_0[i] < h[i].d);
                 traverse_1  += move_mask(vt_min_1[i] < h[i].d);
                 first_0     += move_mask(vt_min_0[i] <= vt_min_1[i]);
+                COUNT_PACKET_LANES(move_mask((vt_min_0[i] < h[i].d) | (vt_min_1[i] < h[i].d)));
             }
 
             /* Nothing in range */
@@ -141,7 +145,7 @@ void bvh::frustrum_find_nearest_object(const packet_ray *const r, vint_t *const
     /* Build a frustrum to traverse */
     frustrum f(r, size);
     frustrum trav(r, size);
-    trav.adapt_to_leaf(r, _builder.scene_upper_bound(), _builder.scene_lower_bound(), clipped_r, size);
+    trav.adapt_to_leaf(r, _scene_upper, _scene_lower, clipped_r, size);
     
     /* Traverse the whole tree */
     while (true)
@@ -267,7 +271,7 @@ void bvh::frustrum_found_nearer_object(const packet_ray *const r, const vfp_t *t
     frustrum f(r, point_t<>(r[0].get_dst(0)[0], r[0].get_dst(1)[0], r[0].get_dst(2)[0]), size);
     frustrum trav(r, point_t<>(r[0].get_dst(0)[0], r[0].get_dst(1)[0], r[0].get_dst(2)[0]), size);
 #endif
-    trav.adapt_to_leaf(r, _builder.scene_upper_bound(), _builder.scene_lower_bound(), clipped_r, size);
+    trav.adapt_to_leaf(r, _scene_upper, _scene_lower, clipped_r, size);
 
     /* Traverse the whole tree */
     while (true)
@@ -313,9 +317,11 @@ void bvh::frustrum_found_nearer_object(const packet_ray *const r, const vfp_t *t
             // }
 
             /* Update furthest intersection */
-            static_assert(MAXIMUM_PACKET_SIZE == 16, "Error: Max expects MAXIMUM_PACKET_SIZE to be 16");
-            const vfp_t vmax_d(max(max(max(max(h[0].d, h[1].d), max(h[ 2].d, h[ 3].d)), max(max(h[ 4].d, h[ 5].d), max(h[ 6].d, h[ 7].d))), 
-                              max(max(max(h[8].d, h[9].d), max(h[10].d, h[11].d)), max(max(h[12].d, h[13].d), max(h[14].d, h[15].d)))));
+            vfp_t vmax_d(h[0].d);
+            for (int i = 1; i < MAXIMUM_PACKET_SIZE; ++i)
+            {
+                vmax_d = max(vmax_d, h[i].d);
+            }
             const float max_d = horizontal_max(vmax_d);
             
             /* Early exit for all rays occluded */
@@ -346,9 +352,11 @@ inline bool bvh::find_leaf_node(const packet_ray &r, bvh_stack_element *const en
 
     while (true)
     {
+        COUNT_TRAVERSAL(nodes_visited, 1);
         if ((*_bvh_base)[cur_idx].is_leaf())
         {
             /* This node is a leaf, update the state and return */
+            COUNT_TRAVERSAL(leaves_visited, 1);
             entry_point->idx = cur_idx;
             *out = exit_point;
             // BOOST_LOG_TRIVIAL(trace) << "Found leaf at index: " << entry_point->idx;
@@ -368,6 +376,7 @@ inline bool bvh::find_leaf_node(const packet_ray &r, bvh_stack_element *const en
 
             /* We never make it to these node */
             const int o_near = move_mask(near_dist < t_max);
+            COUNT_PACKET_LANES(o_near);
             if (!o_near)
             {   
                *out = exit_point;
@@ -377,7 +386,7 @@ inline bool bvh::find_leaf_node(const packet_ray &r, bvh_stack_element *const en
             /* The far node is too far away to traverse */
             const int o_same_order = move_mask(dist_0 < dist_1);
             const int o_far = move_mask(far_dist < t_max);
-            if (!o_far && (o_same_order == 0xf))
+            if (!o_far && (o_same_order == ((1 << SIMD_WIDTH) - 1)))
             {
                 cur_idx = near_idx;
                 // BOOST_LOG_TRIVIAL(trace) << "Traversing near node only";
@@ -592,9 +601,11 @@ inline bool bvh::find_leaf_node(const ray &r, bvh_stack_element *const entry_poi
 
     while (true)
     {
+        COUNT_TRAVERSAL(nodes_visited, 1);
         if ((*_bvh_base)[cur_idx].is_leaf())
         {
             /* This node is a leaf, update the state and return */
+            COUNT_TRAVERSAL(leaves_visited, 1);
             entry_point->idx = cur_idx;
             *out = exit_point;
             // BOOST_LOG_TRIVIAL(trace) << "Found leaf at index: " << entry_point->idx;
@@ -677,7 +688,7 @@ int bvh::find_nearest_object(const ray *const r, hit_description *const h) const
         if (leaf)
         {
             // BOOST_LOG_TRIVIAL(trace) << "Found leaf node";
-            const int intersecting_object = (*_bvh_base)[entry_point.idx].test_leaf_node_nearest(_prims, r, &nearest_hit);
+            const int intersecting_object = (*_bvh_base)[entry_point.idx].test_leaf_node_nearest(_tris->data(), r, &nearest_hit);
 
             /* If an intersecting object is found it is the closest so return */
             if (intersecting_object != -1)
@@ -731,7 +742,7 @@ bool bvh::found_nearer_object(const ray *const r, const float t) const
         if (leaf)
         {
             // BOOST_LOG_TRIVIAL(trace) << "Testing leaf node: " << entry_point.idx << ", " << t;
-            const bool closer = (*_bvh_base)[entry_point.idx].test_leaf_node_nearer(_prims, r, t);
+            const bool closer = (*_bvh_base)[entry_point.idx].test_leaf_node_nearer(_tris->data(), r, t);
 
             /* If an intersecting object is found it is the closest so return */
             if (closer) 
@@ -757,4 +768,273 @@ bool bvh::found_nearer_object(const ray *const r, const float t) const
 
     return false;
 }
+
+
+/**********************************************************
+ Count the nodes below and including idx. The number of leaf
+ nodes is accumulated in leaves.
+**********************************************************/
+inline int count_nodes(const std::vector<bvh_node> &nodes, const int idx, int *const leaves)
+{
+    if (nodes[idx].is_leaf())
+    {
+        ++(*leaves);
+        return 1;
+    }
+
+    return 1 + count_nodes(nodes, nodes[idx].left_index(), leaves) + count_nodes(nodes, nodes[idx].right_index(), leaves);
+}
+
+
+/**********************************************************
+ 
+**********************************************************/
+int bvh::number_of_nodes() const
+{
+    int leaves = 0;
+    return count_nodes(*_bvh_base, _root_node, &leaves);
+}
+
+
+/**********************************************************
+ 
+**********************************************************/
+int bvh::number_of_leaves() const
+{
+    int leaves = 0;
+    count_nodes(*_bvh_base, _root_node, &leaves);
+    return leaves;
+}
+
+
+/**********************************************************
+ Sum the surface area weighted cost of the nodes below and
+ including idx.
+**********************************************************/
+inline float node_sah_cost(const std::vector<bvh_node> &nodes, const int idx)
+{
+    const bvh_node &n = nodes[idx];
+    const float sa = surface_area(n.low_point(), n.high_point());
+    if (n.is_leaf())
+    {
+        return COST_OF_INTERSECTION * n.size() * sa;
+    }
+
+    return (COST_OF_TRAVERSAL * sa) + node_sah_cost(nodes, n.left_index()) + node_sah_cost(nodes, n.right_index());
+}
+
+
+/**********************************************************
+ 
+**********************************************************/
+float bvh::sah_cost() const
+{
+    const float sa = surface_area(_scene_lower, _scene_upper);
+    return (sa > 0.0f) ? (node_sah_cost(*_bvh_base, _root_node) / sa) : 0.0f;
+}
+
+
+/**********************************************************
+ Move the primitives the bvh was built over into new bounds
+ without changing the topology of the tree. Nodes are refit
+ bottom up and, if rotate is set, tree rotations are applied
+ to recover some of the quality lost.
+**********************************************************/
+void bvh::refit(const bool rotate)
+{
+    refit_node(_root_node, rotate, 0);
+    _scene_lower = (*_bvh_base)[_root_node].low_point();
+    _scene_upper = (*_bvh_base)[_root_node].high_point();
+
+    /* The leaves still reference the same primitives, but they have moved */
+    precompute_indirect_triangles(_tris.get(), _prims);
+}
+
+
+/**********************************************************
+ Build the bvh from scratch.
+**********************************************************/
+void bvh::rebuild()
+{
+    bvh_builder builder;
+    _root_node = builder.build(&_prims, _bvh_base.get());
+    _scene_lower = builder.scene_lower_bound();
+    _scene_upper = builder.scene_upper_bound();
+
+    /* Pack the intersection data in leaf order */
+    precompute_indirect_triangles(_tris.get(), _prims);
+
+    /* Remember the quality of the build to measure refits against */
+    _build_sah = sah_cost();
+}
+
+
+/**********************************************************
+ Refit and rotate the bvh after the primitives have moved.
+ If this has degraded the SAH cost by more than 
+ rebuild_factor the bvh is rebuilt.
+
+ Returns true if the bvh was rebuilt.
+**********************************************************/
+bool bvh::update(const float rebuild_factor)
+{
+    refit(true);
+    if (sah_degradation() > rebuild_factor)
+    {
+        rebuild();
+        return true;
+    }
+
+    return false;
+}
+
+
+/**********************************************************
+ 
+**********************************************************/
+float bvh::sah_degradation() const
+{
+    return (_build_sah > 0.0f) ? (sah_cost() / _build_sah) : 1.0f;
+}
+
+
+/**********************************************************
+ Refit the node idx at depth to the bounds of its children
+ and optionally rotate it. Returns the height of the sub tree.
+**********************************************************/
+int bvh::refit_node(const int idx, const bool rotate, const int depth)
+{
+    auto &nodes = *_bvh_base;
+    bvh_node &n = nodes[idx];
+    if (n.is_leaf())
+    {
+        /* Empty leaves have no bounds to update */
+        if (n.is_empty())
+        {
+            return 1;
+        }
+
+        point_t<> low(MAX_DIST, MAX_DIST, MAX_DIST);
+        point_t<> high(-MAX_DIST, -MAX_DIST, -MAX_DIST);
+        for (int i = n.begin_index(); i < n.end_index(); ++i)
+        {
+            const triangle *const tri = _prims.indirect_primitive(i);
+            low  = min(low, tri->low_bound());
+            high = max(high, tri->high_bound());
+        }
+
+        n.create_leaf_node(high, low, n.begin_index(), n.end_index());
+        return 1;
+    }
+
+    /* Refit the children first */
+    const int left  = n.left_index();
+    const int right = n.right_index();
+    int height = 1 + std::max(refit_node(left, rotate, depth + 1), refit_node(right, rotate, depth + 1));
+    n.create_generic_node(nodes, left, right);
+
+    /* Rotating may push a sub tree down one level, dont let this overflow the trace stack */
+    if (rotate && ((depth + height) < MAX_BVH_STACK_HEIGHT) && rotate_node(idx))
+    {
+        ++height;
+    }
+
+    return height;
+}
+
+
+/**********************************************************
+ Apply the rotation of the children and grand children of
+ idx that most reduces the SAH cost of idx.
+
+ Swapping a child with a grand child on the other side or
+ swapping grand children leaves the bounds of idx unchanged
+ so the SAH cost changes with the surface area of the 
+ children only.
+
+ Returns true if a sub tree was pushed down a level.
+**********************************************************/
+bool bvh::rotate_node(const int idx)
+{
+    auto &nodes = *_bvh_base;
+    const int l = nodes[idx].left_index();
+    const int r = nodes[idx].right_index();
+    const bool l_leaf = nodes[l].is_leaf();
+    const bool r_leaf = nodes[r].is_leaf();
+    if (l_leaf && r_leaf)
+    {
+        return false;
+    }
+
+    const int ll = l_leaf ? -1 : nodes[l].left_index();
+    const int lr = l_leaf ? -1 : nodes[l].right_index();
+    const int rl = r_leaf ? -1 : nodes[r].left_index();
+    const int rr = r_leaf ? -1 : nodes[r].right_index();
+    const float l_sa = surface_area(nodes[l].low_point(), nodes[l].high_point());
+    const float r_sa = surface_area(nodes[r].low_point(), nodes[r].high_point());
+
+    /* Find the rotation with the greatest reduction in surface area */
+    int     best_rot    = -1;
+    float   best_gain   = 0.0f;
+    const auto consider = [&best_rot, &best_gain](const int rot, const float gain)
+    {
+        if (gain > best_gain)
+        {
+            best_rot    = rot;
+            best_gain   = gain;
+        }
+    };
+
+    /* Swap l with a child of r */
+    if (!r_leaf)
+    {
+        consider(0, r_sa - nodes[l].combined_surface_area(nodes[rr]));
+        consider(1, r_sa - nodes[l].combined_surface_area(nodes[rl]));
+    }
+
+    /* Swap r with a child of l */
+    if (!l_leaf)
+    {
+        consider(2, l_sa - nodes[r].combined_surface_area(nodes[lr]));
+        consider(3, l_sa - nodes[r].combined_surface_area(nodes[ll]));
+    }
+
+    /* Swap grand children */
+    if (!l_leaf && !r_leaf)
+    {
+        consider(4, (l_sa + r_sa) - (nodes[rl].combined_surface_area(nodes[lr]) + nodes[ll].combined_surface_area(nodes[rr])));
+        consider(5, (l_sa + r_sa) - (nodes[rr].combined_surface_area(nodes[lr]) + nodes[rl].combined_surface_area(nodes[ll])));
+    }
+
+    /* Apply the rotation, children first */
+    switch (best_rot)
+    {
+        case 0 :
+            nodes[r].create_generic_node(nodes, l, rr);
+            nodes[idx].create_generic_node(nodes, rl, r);
+            return true;
+        case 1 :
+            nodes[r].create_generic_node(nodes, rl, l);
+            nodes[idx].create_generic_node(nodes, rr, r);
+            return true;
+        case 2 :
+            nodes[l].create_generic_node(nodes, r, lr);
+            nodes[idx].create_generic_node(nodes, l, ll);
+            return true;
+        case 3 :
+            nodes[l].create_generic_node(nodes, ll, r);
+            nodes[idx].create_generic_node(nodes, l, lr);
+            return true;
+        case 4 :
+            nodes[l].create_generic_node(nodes, rl, lr);
+            nodes[r].create_generic_node(nodes, ll, rr);
+            return false;
+        case 5 :
+            nodes[l].create_generic_node(nodes, rr, lr);
+            nodes[r].create_generic_node(nodes, rl, ll);
+            return false;
+        default :
+            return false;
+    }
+}
 }; /* namespace raptor_raytracer*/
@@ -13,26 +13,35 @@
 #include "common.h"
 #include "ssd.h"
 #include "bvh_node.h"
-#include "bvh_node.h"
 #include "bvh_builder.h"
+#include "precomputed_triangle.h"
 
 
 namespace raptor_raytracer
 {
+/* Forward declarations */
+class scene_cache;
+
 class bvh : public ssd
 {
     public :
         /* CTOR */
         // cppcheck-suppress uninitMemberVar
         bvh(primitive_store &everything) :
-        _prims(everything), _builder(), _bvh_base(new std::vector<bvh_node>()), _root_node(0)
+        _prims(everything), _bvh_base(new std::vector<bvh_node>()), _tris(new std::vector<precomputed_triangle>()), _root_node(0), _build_sah(0.0f)
         {
             /* Build the heirarchy */
-            _root_node = _builder.build(&everything, _bvh_base.get());
+            rebuild();
         }
 
+        /* CTOR from a previously built bvh, see scene_cache */
+        bvh(primitive_store &everything, const std::shared_ptr<std::vector<bvh_node>> &nodes, const std::shared_ptr<std::vector<precomputed_triangle>> &tris,
+            const point_t<> &lower, const point_t<> &upper, const int root, const float build_sah) :
+        _prims(everything), _bvh_base(nodes), _tris(tris), _scene_lower(lower), _scene_upper(upper), _root_node(root), _build_sah(build_sah) {  }
+
         /* Copy CTOR */
-        bvh(const bvh &b) : _prims(b._prims), _bvh_base(b._bvh_base), _root_node(0) {  }
+        bvh(const bvh &b) :
+        _prims(b._prims), _bvh_base(b._bvh_base), _tris(b._tris), _scene_lower(b._scene_lower), _scene_upper(b._scene_upper), _root_node(b._root_node), _build_sah(b._build_sah) {  }
 
         /* Assignment prohibited by base class */
         /* Allow default DTOR */
@@ -51,7 +60,27 @@ class bvh : public ssd
         int     find_nearest_object(const ray *const r, hit_description *const h) const override;
         bool    found_nearer_object(const ray *const r, const float t) const override;
 
+        /* bvh statistics */
+        int     number_of_nodes()   const override;
+        int     number_of_leaves()  const override;
+        float   sah_cost()          const override;
+
+        /* Scene bounds */
+        const point_t<> & scene_lower_bound() const override { return _scene_lower; }
+        const point_t<> & scene_upper_bound() const override { return _scene_upper; }
+
+        /* Animation, call after moving primitives in the store. The topology of the store must not change */
+        /* update refits the bvh and rebuilds it if the refit has degraded the SAH cost more than rebuild_factor */
+        bool    update(const float rebuild_factor = BVH_REBUILD_FACTOR);
+        void    refit(const bool rotate = true);
+        void    rebuild();
+
+        /* SAH cost relative to the cost just after the last build */
+        float   sah_degradation() const;
+
     private :
+        friend class scene_cache;
+
         /* Stack element for tracing through the bvh */
         struct bvh_stack_element
         {
@@ -79,12 +108,18 @@ class bvh : public ssd
 
         inline bool find_leaf_node(const ray &r, bvh_stack_element *const entry_point, bvh_stack_element **const out, const point_t<> &i_rd, const float t_max) const;
 
+        int         refit_node(const int idx, const bool rotate, const int depth);
+        bool        rotate_node(const int idx);
+
         /* The stack is mutable because it will never be known to a user of this class */
-        const primitive_store &                 _prims;
+        primitive_store &                       _prims;
         mutable bvh_stack_element               _bvh_stack[MAX_BVH_STACK_HEIGHT];
-        bvh_builder                             _builder;
         std::shared_ptr<std::vector<bvh_node>>  _bvh_base;
+        std::shared_ptr<std::vector<precomputed_triangle>>  _tris;
         mutable bvh_stack_element               _entry_point;
+        point_t<>                               _scene_lower;
+        point_t<>                               _scene_upper;
         int                                     _root_node;
+        float                                   _build_sah;
 };
 }; /* namespace raptor_raytracer */
@@ -58,16 +58,28 @@ int bvh_builder::build(primitive_store *const primitives, std::vector<bvh_node>
     const vfp_t scene_lo_x(_b.x);
     const vfp_t scene_lo_y(_b.y);
     const vfp_t scene_lo_z(_b.z);
-    for (int i = 0; i <= (_primitives->size() - SIMD_WIDTH); i += SIMD_WIDTH)
+    for (int i = 0; i <= (static_cast<int>(_primitives->size()) - SIMD_WIDTH); i += SIMD_WIDTH)
     {
+        /* Gather bounds */
+        float bounds[6][SIMD_WIDTH] __attribute__ ((aligned(SIMD_WIDTH * 4)));
+        for (int j = 0; j < SIMD_WIDTH; ++j)
+        {
+            bounds[0][j] = _bounds[i + j].low.x;
+            bounds[1][j] = _bounds[i + j].low.y;
+            bounds[2][j] = _bounds[i + j].low.z;
+            bounds[3][j] = _bounds[i + j].high.x;
+            bounds[4][j] = _bounds[i + j].high.y;
+            bounds[5][j] = _bounds[i + j].high.z;
+        }
+
         /* Calculate morton code*/
-        const vfp_t lo_x(_bounds[i].low.x, _bounds[i + 1].low.x, _bounds[i + 2].low.x, _bounds[i + 3].low.x);
-        const vfp_t lo_y(_bounds[i].low.y, _bounds[i + 1].low.y, _bounds[i + 2].low.y, _bounds[i + 3].low.y);
-        const vfp_t lo_z(_bounds[i].low.z, _bounds[i + 1].low.z, _bounds[i + 2].low.z, _bounds[i + 3].low.z);
+        const vfp_t lo_x(bounds[0]);
+        const vfp_t lo_y(bounds[1]);
+        const vfp_t lo_z(bounds[2]);
 
-        const vfp_t hi_x(_bounds[i].high.x, _bounds[i + 1].high.x, _bounds[i + 2].high.x, _bounds[i + 3].high.x);
-        const vfp_t hi_y(_bounds[i].high.y, _bounds[i + 1].high.y, _bounds[i + 2].high.y, _bounds[i + 3].high.y);
-        const vfp_t hi_z(_bounds[i].high.z, _bounds[i + 1].high.z, _bounds[i + 2].high.z, _bounds[i + 3].high.z);
+        const vfp_t hi_x(bounds[3]);
+        const vfp_t hi_y(bounds[4]);
+        const vfp_t hi_z(bounds[5]);
 
         const vfp_t x(((hi_x + lo_x) * 0.5f) - scene_lo_x);
         const vfp_t y(((hi_y + lo_y) * 0.5f) - scene_lo_y);
@@ -76,21 +88,12 @@ int bvh_builder::build(primitive_store *const primitives, std::vector<bvh_node>
         mc.store(&morton_codes[i]);
 
         /* Build histogram of morton codes */
-        ++hist0[ morton_codes[i    ]        & 0x3ff];
-        ++hist1[(morton_codes[i    ] >> 10) & 0x3ff];
-        ++hist2[ morton_codes[i    ] >> 20         ];
-
-        ++hist0[ morton_codes[i + 1]        & 0x3ff];
-        ++hist1[(morton_codes[i + 1] >> 10) & 0x3ff];
-        ++hist2[ morton_codes[i + 1] >> 20         ];
-
-        ++hist0[ morton_codes[i + 2]        & 0x3ff];
-        ++hist1[(morton_codes[i + 2] >> 10) & 0x3ff];
-        ++hist2[ morton_codes[i + 2] >> 20         ];
-
-        ++hist0[ morton_codes[i + 3]        & 0x3ff];
-        ++hist1[(morton_codes[i + 3] >> 10) & 0x3ff];
-        ++hist2[ morton_codes[i + 3] >> 20         ];
+        for (int j = i; j < (i + SIMD_WIDTH); ++j)
+        {
+            ++hist0[ morton_codes[j]        & 0x3ff];
+            ++hist1[(morton_codes[j] >> 10) & 0x3ff];
+            ++hist2[ morton_codes[j] >> 20         ];
+        }
     }
 
     for (int i = (static_cast<int>(_primitives->size()) & ~(SIMD_WIDTH - 1)); i < static_cast<int>(_primitives->size()); ++i)
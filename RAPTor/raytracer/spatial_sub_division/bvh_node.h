@@ -11,6 +11,7 @@
 /* Ray tracer headers */
 #include "raytracer.h"
 #include "triangle.h"
+#include "precomputed_triangle.h"
 #include "ray.h"
 #include "packet_ray.h"
 #include "frustrum.h"
@@ -136,6 +137,8 @@ class bvh_node
         const point_t<>& low_point()  const { return _low;    }
         int left_index()            const { return _left;   }
         int right_index()           const { return _right;  }
+        int begin_index()           const { return _b;      }
+        int end_index()             const { return _e;      }
         bool is_leaf()              const { return _leaf;   }
 
         /* Leaf node tests */
@@ -149,31 +152,31 @@ class bvh_node
             return _e - _b;
         }
 
-        int test_leaf_node_nearest(const primitive_store &e, const ray *const r, hit_description *const h) const
+        int test_leaf_node_nearest(const precomputed_triangle *const e, const ray *const r, hit_description *const h) const
         {
             const int end = _e;
             int intersecting_object = -1;
             for (int i = _b; i < end; ++i)
             {
                 hit_description hit_type(h->d);
-                e.indirect_primitive(i)->is_intersecting(r, &hit_type);
+                e[i].is_intersecting(r, &hit_type);
                 if (hit_type.d < h->d)
                 {
                     *h = hit_type;
-                    intersecting_object = e.indirection(i);
+                    intersecting_object = e[i].index();
                 }
             }
     
             return intersecting_object;
         }
 
-        bool test_leaf_node_nearer(const primitive_store &e, const ray *const r, const float max) const
+        bool test_leaf_node_nearer(const precomputed_triangle *const e, const ray *const r, const float max) const
         {
             const int end = _e;
             for (int i = _b; i < end; ++i)
             {
-                const auto *tri = e.indirect_primitive(i);
-                if (tri->get_light() || tri->is_transparent())
+                const auto *tri = &e[i];
+                if (!tri->is_occluder())
                 {
                     continue;
                 }
@@ -6,6 +6,7 @@
 
 /* Ray tracer headers */
 #include "kd_tree.h"
+#include "traversal_statistics.h"
 
 
 namespace raptor_raytracer
@@ -27,6 +28,8 @@ inline void kd_tree::find_leaf_node(const packet_ray *const r, kdt_stack_element
     
     while (current_node->get_normal() != axis_t::not_set)
     {
+        COUNT_TRAVERSAL(nodes_visited, 1);
+        COUNT_PACKET_LANES(move_mask(mask));
         int axis = (int)current_node->get_normal() - 1;
         vfp_t split_pos(current_node->get_split_position());
 
@@ -53,6 +56,8 @@ inline void kd_tree::find_leaf_node(const packet_ray *const r, kdt_stack_element
         }
     }
 
+    COUNT_TRAVERSAL(nodes_visited, 1);
+    COUNT_TRAVERSAL(leaves_visited, 1);
     entry_point->n  = current_node;
     *out            = exit_point;
     return;
@@ -310,12 +315,14 @@ inline bool kd_tree::find_leaf_node(const frustrum &r, kdt_stack_element *const
     float min_dist, max_dist;
     while (true)
     {
+        COUNT_TRAVERSAL(nodes_visited, 1);
         float split_pos = current_node->get_split_position();
         switch (current_node->get_normal())
         {
             /* This node is not split in any plane, ie/ it is a leaf */
             case axis_t::not_set : 
             {
+                COUNT_TRAVERSAL(leaves_visited, 1);
                 /* update the state and return 1 for intersection testing */
                 *out = exit_point;
                 entry_point->n = current_node;
@@ -504,35 +511,35 @@ void kd_tree::frustrum_find_nearest_object(const packet_ray *const r, vint_t *co
     /* Set the scene bounding box based on frustrum direction */
     if (f.get_min_x_grad() < 0)
     {
-        entry_point.u.x    = _builder.scene_lower_bound().x;
-        entry_point.l.x    = _builder.scene_upper_bound().x;
+        entry_point.u.x    = _scene_lower.x;
+        entry_point.l.x    = _scene_upper.x;
     }
     else
     {
-        entry_point.u.x    = _builder.scene_upper_bound().x;
-        entry_point.l.x    = _builder.scene_lower_bound().x;
+        entry_point.u.x    = _scene_upper.x;
+        entry_point.l.x    = _scene_lower.x;
     }
 
     if (f.get_min_y_grad() < 0)
     {
-        entry_point.u.y    = _builder.scene_lower_bound().y;
-        entry_point.l.y    = _builder.scene_upper_bound().y;
+        entry_point.u.y    = _scene_lower.y;
+        entry_point.l.y    = _scene_upper.y;
     }
     else
     {
-        entry_point.u.y    = _builder.scene_upper_bound().y;
-        entry_point.l.y    = _builder.scene_lower_bound().y;
+        entry_point.u.y    = _scene_upper.y;
+        entry_point.l.y    = _scene_lower.y;
     }
 
     if (f.get_min_z_grad() < 0)
     {
-        entry_point.u.z    = _builder.scene_lower_bound().z;
-        entry_point.l.z    = _builder.scene_upper_bound().z;
+        entry_point.u.z    = _scene_lower.z;
+        entry_point.l.z    = _scene_upper.z;
     }
     else
     {
-        entry_point.u.z    = _builder.scene_upper_bound().z;
-        entry_point.l.z    = _builder.scene_lower_bound().z;
+        entry_point.u.z    = _scene_upper.z;
+        entry_point.l.z    = _scene_lower.z;
     }
 
     /* Clip packet to the world */
@@ -588,6 +595,8 @@ void kd_tree::frustrum_find_nearest_object(const packet_ray *const r, vint_t *co
                                    ((z_entry > x_exit) | (x_entry > z_exit)) | 
                                    ((z_entry > y_exit) | (y_entry > z_exit));
           
+                COUNT_PACKET_LANES(~move_mask(mask) & ((1 << SIMD_WIDTH) - 1));
+
                 /* If packet enters leaf then test it */
                 if (move_mask(mask) != ((1 << SIMD_WIDTH) - 1))
                 {
@@ -619,7 +628,7 @@ void kd_tree::frustrum_find_nearest_object(const packet_ray *const r, vint_t *co
             {
                 vmax_d = max(vmax_d, h[i].d);
             }
-            max_d = std::max(std::max(vmax_d[0], vmax_d[1]), std::max(vmax_d[2], vmax_d[3]));
+            max_d = horizontal_max(vmax_d);
 
         }
         else
@@ -666,8 +675,8 @@ void kd_tree::frustrum_found_nearer_object(const packet_ray *const r, const vfp_
         vmin_d = min(vmin_d, t[i]);
         h[i].d = t[i];
     }
-    float max_d = std::max(std::max(vmax_d[0], vmax_d[1]), std::max(vmax_d[2], vmax_d[3]));
-    float min_d = std::min(std::min(vmin_d[0], vmin_d[1]), std::min(vmin_d[2], vmin_d[3]));
+    float max_d = horizontal_max(vmax_d);
+    float min_d = horizontal_min(vmin_d);
 
     /* state of stack */
     kdt_stack_element *exit_point = &(_kdt_stack[0]);
@@ -698,35 +707,35 @@ void kd_tree::frustrum_found_nearer_object(const packet_ray *const r, const vfp_
     /* Set the scene bounding box based on frustrum direction */
     if (f.get_min_x_grad() < 0)
     {
-        entry_point.u.x    = _builder.scene_lower_bound().x;
-        entry_point.l.x    = _builder.scene_upper_bound().x;
+        entry_point.u.x    = _scene_lower.x;
+        entry_point.l.x    = _scene_upper.x;
     }
     else
     {
-        entry_point.u.x    = _builder.scene_upper_bound().x;
-        entry_point.l.x    = _builder.scene_lower_bound().x;
+        entry_point.u.x    = _scene_upper.x;
+        entry_point.l.x    = _scene_lower.x;
     }
 
     if (f.get_min_y_grad() < 0)
     {
-        entry_point.u.y    = _builder.scene_lower_bound().y;
-        entry_point.l.y    = _builder.scene_upper_bound().y;
+        entry_point.u.y    = _scene_lower.y;
+        entry_point.l.y    = _scene_upper.y;
     }
     else
     {
-        entry_point.u.y    = _builder.scene_upper_bound().y;
-        entry_point.l.y    = _builder.scene_lower_bound().y;
+        entry_point.u.y    = _scene_upper.y;
+        entry_point.l.y    = _scene_lower.y;
     }
 
     if (f.get_min_z_grad() < 0)
     {
-        entry_point.u.z    = _builder.scene_lower_bound().z;
-        entry_point.l.z    = _builder.scene_upper_bound().z;
+        entry_point.u.z    = _scene_lower.z;
+        entry_point.l.z    = _scene_upper.z;
     }
     else
     {
-        entry_point.u.z    = _builder.scene_upper_bound().z;
-        entry_point.l.z    = _builder.scene_lower_bound().z;
+        entry_point.u.z    = _scene_upper.z;
+        entry_point.l.z    = _scene_lower.z;
     }
 
     /* Frustrum direction LUT */
@@ -776,6 +785,8 @@ void kd_tree::frustrum_found_nearer_object(const packet_ray *const r, const vfp_
                                    ((z_entry > x_exit) | (x_entry > z_exit)) | 
                                    ((z_entry > y_exit) | (y_entry > z_exit));
           
+                COUNT_PACKET_LANES(~move_mask(mask) & ((1 << SIMD_WIDTH) - 1));
+
                 /* If packet enters leaf then test it */
                 if (move_mask(mask) != ((1 << SIMD_WIDTH) - 1))
                 {
@@ -807,7 +818,7 @@ void kd_tree::frustrum_found_nearer_object(const packet_ray *const r, const vfp_
             {
                 vmax_d = max(vmax_d, h[i].d);
             }
-            max_d = std::max(std::max(vmax_d[0], vmax_d[1]), std::max(vmax_d[2], vmax_d[3]));
+            max_d = horizontal_max(vmax_d);
             
             /* Early exit for all rays occluded */
             if (max_d < min_d)
@@ -860,6 +871,7 @@ inline void kd_tree::find_leaf_node(const ray *const r, const kdt_node **const n
     float dist;
     while (true)
     {
+        COUNT_TRAVERSAL(nodes_visited, 1);
         float split_pos = current_node->get_split_position();
 
         /* Based on the normal of the plane and which side of the plane
@@ -869,6 +881,7 @@ inline void kd_tree::find_leaf_node(const ray *const r, const kdt_node **const n
             /* This node is not split in any plane, ie/ it is a leaf */
             case axis_t::not_set: 
             {
+                COUNT_TRAVERSAL(leaves_visited, 1);
                 *n   = current_node;
                 *out = exit_point;
                 return;
@@ -1069,7 +1082,7 @@ int kd_tree::find_nearest_object(const ray *const r, hit_description *const h) c
         {
             nearest_hit.d = exit_point->d;
             
-            const int intersecting_object = current_node->test_leaf_node_nearest(_prims, r, &nearest_hit, entry_point->d);
+            const int intersecting_object = current_node->test_leaf_node_nearest(_tris->data(), r, &nearest_hit, entry_point->d);
             /* If an intersecting object is found it is the closest so return */
             if (intersecting_object != -1) 
             {
@@ -1127,7 +1140,7 @@ bool kd_tree::found_nearer_object(const ray *const r, const float t) const
         /* If the leaf contains objects find the closest intersecting object */
         if (!current_node->is_empty())
         {
-            bool closer = current_node->test_leaf_node_nearer(_prims, r, t);
+            bool closer = current_node->test_leaf_node_nearer(_tris->data(), r, t);
             /* If an intersecting object is found it is the closest so return */
             if (closer) 
             {
@@ -1149,4 +1162,72 @@ bool kd_tree::found_nearer_object(const ray *const r, const float t) const
         exit_point = exit_point->s;
     }
 }
+
+
+/**********************************************************
+ Count the nodes below and including n. The number of leaf
+ nodes is accumulated in leaves.
+**********************************************************/
+inline int count_nodes(const kdt_node &n, int *const leaves)
+{
+    if (n.get_normal() == axis_t::not_set)
+    {
+        ++(*leaves);
+        return 1;
+    }
+
+    return 1 + count_nodes(*n.get_left(), leaves) + count_nodes(*n.get_right(), leaves);
+}
+
+
+/**********************************************************
+ 
+**********************************************************/
+int kd_tree::number_of_nodes() const
+{
+    int leaves = 0;
+    return count_nodes((*_kdt_base)[0], &leaves);
+}
+
+
+/**********************************************************
+ 
+**********************************************************/
+int kd_tree::number_of_leaves() const
+{
+    int leaves = 0;
+    count_nodes((*_kdt_base)[0], &leaves);
+    return leaves;
+}
+
+
+/**********************************************************
+ Sum the surface area weighted cost of the nodes below and
+ including n, which is bounded by b and t.
+**********************************************************/
+inline float node_sah_cost(const kdt_node &n, const point_t<> &b, const point_t<> &t)
+{
+    const float sa = surface_area(b, t);
+    if (n.get_normal() == axis_t::not_set)
+    {
+        return COST_OF_INTERSECTION * n.get_size() * sa;
+    }
+
+    const int axis = static_cast<int>(n.get_normal()) - 1;
+    point_t<> left_t(t);
+    point_t<> right_b(b);
+    left_t[axis]    = n.get_split_position();
+    right_b[axis]   = n.get_split_position();
+    return (COST_OF_TRAVERSAL * sa) + node_sah_cost(*n.get_left(), b, left_t) + node_sah_cost(*n.get_right(), right_b, t);
+}
+
+
+/**********************************************************
+ 
+**********************************************************/
+float kd_tree::sah_cost() const
+{
+    const float sa = surface_area(_scene_lower, _scene_upper);
+    return (sa > 0.0f) ? (node_sah_cost((*_kdt_base)[0], _scene_lower, _scene_upper) / sa) : 0.0f;
+}
 }; /* namespace raptor_raytracer */
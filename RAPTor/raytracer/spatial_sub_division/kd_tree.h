@@ -13,22 +13,52 @@
 #include "ssd.h"
 #include "kdt_node.h"
 #include "kdt_builder.h"
+#include "kdt_binned_builder.h"
+#include "precomputed_triangle.h"
 
 
 namespace raptor_raytracer
 {
+/* Forward declarations */
+class scene_cache;
+
+/* How to build a kd tree, adaptively sampling the SAH or binning it */
+enum class kdt_build_t : char { adaptive = 0, binned = 1 };
+
 class kd_tree : public ssd
 {
     public :
         /* CTOR, build the tree */
         // cppcheck-suppress uninitMemberVar
-        kd_tree(const primitive_store &everything) :
-        _prims(everything), _builder(), _kdt_base(new std::vector<kdt_node>())
+        kd_tree(const primitive_store &everything, const kdt_build_t build = kdt_build_t::adaptive) :
+        _prims(everything), _kdt_base(new std::vector<kdt_node>()), _tris(new std::vector<precomputed_triangle>())
         {
             /* Build the heirarchy */
-            _builder.build(&everything, _kdt_base.get(), axis_t::x_axis);
+            if (build == kdt_build_t::binned)
+            {
+                kdt_binned_builder builder;
+                builder.build(&everything, _kdt_base.get());
+                _scene_lower = builder.scene_lower_bound();
+                _scene_upper = builder.scene_upper_bound();
+            }
+            else
+            {
+                kdt_builder builder;
+                builder.build(&everything, _kdt_base.get(), axis_t::x_axis);
+                _scene_lower = builder.scene_lower_bound();
+                _scene_upper = builder.scene_upper_bound();
+            }
+
+            /* Pack the intersection data, leaves index the store directly */
+            precompute_triangles(_tris.get(), everything);
         }
 
+        /* CTOR from a previously built tree, see scene_cache */
+        // cppcheck-suppress uninitMemberVar
+        kd_tree(const primitive_store &everything, const std::shared_ptr<std::vector<kdt_node>> &nodes, const std::shared_ptr<std::vector<precomputed_triangle>> &tris,
+            const point_t<> &lower, const point_t<> &upper) :
+        _prims(everything), _scene_lower(lower), _scene_upper(upper), _kdt_base(nodes), _tris(tris) {  }
+
 #ifdef SIMD_PACKET_TRACING
         /* SIMD KD-tree traversal */
         void    find_nearest_object(const packet_ray *const r, vint_t *const i_o, packet_hit_description *const h) const override;
@@ -42,7 +72,18 @@ class kd_tree : public ssd
         int     find_nearest_object(const ray *const r, hit_description *const h) const override;
         bool    found_nearer_object(const ray *const r, const float t) const override;
 
+        /* kdt statistics */
+        int     number_of_nodes()   const override;
+        int     number_of_leaves()  const override;
+        float   sah_cost()          const override;
+
+        /* Scene bounds */
+        const point_t<> & scene_lower_bound() const override { return _scene_lower; }
+        const point_t<> & scene_upper_bound() const override { return _scene_upper; }
+
     private :
+        friend class scene_cache;
+
         /* Stack element for tracing through the kd tree */
         struct kdt_stack_element
         {
@@ -75,7 +116,9 @@ class kd_tree : public ssd
         /* The stack is mutable because it will never be known to a user of this class */
         const primitive_store &                 _prims;
         mutable kdt_stack_element               _kdt_stack[MAX_KDT_STACK_HEIGHT];
-        kdt_builder                             _builder;
+        point_t<>                               _scene_lower;
+        point_t<>                               _scene_upper;
         std::shared_ptr<std::vector<kdt_node>>  _kdt_base;
+        std::shared_ptr<std::vector<precomputed_triangle>>  _tris;
 };
 }; /* namespace raptor_raytracer */
@@ -0,0 +1,258 @@
+/* Standard headers */
+
+/* Boost headers */
+
+/* Common headers */
+
+/* Ray tracer headers */
+#include "kdt_binned_builder.h"
+
+#ifdef THREADED_RAY_TRACE
+#include "blocked_range.h"
+#include "parallel_invoke.h"
+#include "parallel_reduce.h"
+#endif /* #ifdef THREADED_RAY_TRACE */
+
+
+namespace raptor_raytracer
+{
+void kdt_binned_builder::build(const primitive_store *const objects, std::vector<kdt_node> *const nodes)
+{
+    _primitives = objects;
+    _nodes      = nodes;
+
+    /* Cache primitive bounds */
+    const int nr_primitives = objects->size();
+    _b = point_t<>( MAX_DIST,  MAX_DIST,  MAX_DIST);
+    _t = point_t<>(-MAX_DIST, -MAX_DIST, -MAX_DIST);
+    std::vector<voxel_aab_data> prims(nr_primitives);
+    for (int i = 0; i < nr_primitives; ++i)
+    {
+        prims[i].prim = i;
+        prims[i].low  = objects->primitive(i)->low_bound();
+        prims[i].high = objects->primitive(i)->high_bound();
+        _b            = min(_b, prims[i].low);
+        _t            = max(_t, prims[i].high);
+    }
+
+    if (nr_primitives == 0)
+    {
+        _b = point_t<>(0.0f, 0.0f, 0.0f);
+        _t = point_t<>(0.0f, 0.0f, 0.0f);
+    }
+
+    const point_t<> scene_width(_t - _b);
+    const float sa = (scene_width.x * scene_width.y) + (scene_width.x * scene_width.z) + (scene_width.y * scene_width.z);
+    _sa_inv = (sa > 0.0f) ? (1.0f / sa) : 0.0f;
+
+    /* Build the tree, top down */
+    std::vector<binned_node> tree;
+    tree.reserve(std::max(1, nr_primitives << 1));
+    divide(&tree, &prims, _b, _t, 0);
+
+    /* Copy to kd tree nodes with siblings next to each other */
+    _nodes->resize(tree.size());
+    int child_idx = 1;
+    flatten(tree, 0, 0, &child_idx);
+    assert(child_idx == static_cast<int>(tree.size()));
+}
+
+
+void kdt_binned_builder::bin(bin_counts *const c, const voxel_aab_data *const prims, const int n, const point_t<> &b, const point_t<> &k) const
+{
+    for (int i = 0; i < n; ++i)
+    {
+        for (int j = 0; j < 3; ++j)
+        {
+            const int low   = std::min(std::max(static_cast<int>((prims[i].low[j]  - b[j]) * k[j]), 0), KDT_BUILDER_BINS - 1);
+            const int high  = std::min(std::max(static_cast<int>((prims[i].high[j] - b[j]) * k[j]), 0), KDT_BUILDER_BINS - 1);
+            ++c->low[j][low];
+            ++c->high[j][high];
+        }
+    }
+}
+
+
+void kdt_binned_builder::divide(std::vector<binned_node> *const tree, std::vector<voxel_aab_data> *const prims, const point_t<> &b, const point_t<> &t, const int depth) const
+{
+    const int node_idx = tree->size();
+    tree->push_back({ nullptr, 0.0f, 0, axis_t::not_set });
+
+    /* Calculate the cost of this node */
+    const int nr_prims = prims->size();
+    const point_t<> width(t - b);
+    const float sa = (width.x * width.y) + (width.x * width.z) + (width.y * width.z);
+    float lowest_cost = COST_OF_INTERSECTION * nr_prims * sa * _sa_inv;
+    const float cost_before = lowest_cost;
+
+    /* Find the lowest cost plane */
+    int     best_axis   = -1;
+    float   best_split  = 0.0f;
+#ifdef SIMD_PACKET_TRACING
+    const bool small_node = (nr_prims <= MIN_KDT_NODE_SIZE);
+#else
+    const bool small_node = (nr_prims <= 1);
+#endif /* #ifdef SIMD_PACKET_TRACING */
+    if (((depth + 1) < MAX_KDT_STACK_HEIGHT) && !small_node)
+    {
+        point_t<> k;
+        for (int i = 0; i < 3; ++i)
+        {
+            k[i] = (width[i] > 0.0f) ? (KDT_BUILDER_BINS / width[i]) : 0.0f;
+        }
+
+        /* Bin the primitives, in parallel for large nodes */
+        bin_counts counts;
+#ifdef THREADED_RAY_TRACE
+        if (nr_prims >= KDT_BUILDER_PARALLEL_SIZE)
+        {
+            const voxel_aab_data *const data = prims->data();
+            counts = tbb::parallel_reduce(tbb::blocked_range<int>(0, nr_prims, KDT_BUILDER_PARALLEL_SIZE >> 2), bin_counts(),
+                [this, data, &b, &k](const tbb::blocked_range<int> &r, bin_counts c)
+                {
+                    bin(&c, &data[r.begin()], r.size(), b, k);
+                    return c;
+                },
+                [](bin_counts l, const bin_counts &r)
+                {
+                    return l += r;
+                });
+        }
+        else
+#endif /* #ifdef THREADED_RAY_TRACE */
+        {
+            bin(&counts, prims->data(), nr_prims, b, k);
+        }
+
+        /* Sweep the planes between bins */
+        for (int i = 0; i < 3; ++i)
+        {
+            if (width[i] <= 0.0f)
+            {
+                continue;
+            }
+
+            const int   j       = (i + 1) % 3;
+            const int   l       = (i + 2) % 3;
+            const float other   = width[j] * width[l];
+            const float perim   = width[j] + width[l];
+            int nr_left     = 0;
+            int nr_right    = nr_prims;
+            for (int m = 1; m < KDT_BUILDER_BINS; ++m)
+            {
+                nr_left     += counts.low[i][m - 1];
+                nr_right    -= counts.high[i][m - 1];
+
+                const float left_width  = (width[i] * m) / KDT_BUILDER_BINS;
+                const float right_width = width[i] - left_width;
+                const float left_area   = other + (left_width  * perim);
+                const float right_area  = other + (right_width * perim);
+
+                /* cost of traversal + cost of intersection * (left cell count * left area + right cell count * right area) */
+                const float cost = COST_OF_TRAVERSAL + (COST_OF_INTERSECTION * ((nr_left * left_area) + (nr_right * right_area)) * _sa_inv);
+                if (cost < lowest_cost)
+                {
+                    lowest_cost = cost;
+                    best_axis   = i;
+                    best_split  = b[i] + left_width;
+                }
+            }
+        }
+    }
+
+    /* Stop splitting if the cost metric cannot be reduced */
+    if ((lowest_cost >= cost_before) || (best_axis < 0) || (best_split <= b[best_axis]) || (best_split >= t[best_axis]))
+    {
+        auto leaf_prims = new std::vector<int>(nr_prims);
+        for (int i = 0; i < nr_prims; ++i)
+        {
+            (*leaf_prims)[i] = (*prims)[i].prim;
+        }
+        (*tree)[node_idx].prims = leaf_prims;
+        return;
+    }
+
+    /* Divide the primitives */
+    const axis_t normal = static_cast<axis_t>(best_axis + 1);
+    std::vector<voxel_aab_data> left;
+    std::vector<voxel_aab_data> right;
+    left.reserve(nr_prims);
+    right.reserve(nr_prims);
+    for (const auto &p : *prims)
+    {
+        if (p.high[best_axis] <= best_split)
+        {
+            left.push_back(p);
+        }
+        else if (p.low[best_axis] >= best_split)
+        {
+            right.push_back(p);
+        }
+        else
+        {
+            voxel_aab_data l(p);
+            voxel_aab_data r(p);
+            if (_clip)
+            {
+                clip_triangle(_primitives->primitive(p.prim), &r.low, &r.high, &l.low, &l.high, best_split, normal);
+            }
+            else
+            {
+                l.high[best_axis]   = best_split;
+                r.low[best_axis]    = best_split;
+            }
+
+            left.push_back(l);
+            right.push_back(r);
+        }
+    }
+
+    /* Release this nodes primitives before recursing */
+    std::vector<voxel_aab_data>().swap(*prims);
+
+    point_t<> left_t(t);
+    point_t<> right_b(b);
+    left_t[best_axis]   = best_split;
+    right_b[best_axis]  = best_split;
+    (*tree)[node_idx].split     = best_split;
+    (*tree)[node_idx].normal    = normal;
+
+    /* Recurse, building large subtrees in parallel */
+#ifdef THREADED_RAY_TRACE
+    if (nr_prims >= KDT_BUILDER_PARALLEL_SIZE)
+    {
+        std::vector<binned_node> right_tree;
+        tbb::parallel_invoke(
+            [this, tree, &left, &b, &left_t, depth]()           { divide(tree, &left, b, left_t, depth + 1);                  },
+            [this, &right_tree, &right, &right_b, &t, depth]()  { divide(&right_tree, &right, right_b, t, depth + 1);     });
+
+        (*tree)[node_idx].right = tree->size() - node_idx;
+        tree->insert(tree->end(), right_tree.begin(), right_tree.end());
+        return;
+    }
+#endif /* #ifdef THREADED_RAY_TRACE */
+
+    divide(tree, &left, b, left_t, depth + 1);
+    (*tree)[node_idx].right = tree->size() - node_idx;
+    divide(tree, &right, right_b, t, depth + 1);
+}
+
+
+void kdt_binned_builder::flatten(const std::vector<binned_node> &tree, const int idx, const int node_idx, int *const child_idx) const
+{
+    const binned_node &n = tree[idx];
+    if (n.normal == axis_t::not_set)
+    {
+        (*_nodes)[node_idx].set_primitives(n.prims);
+        return;
+    }
+
+    /* Siblings are allocated in pairs */
+    const int left_idx = *child_idx;
+    (*child_idx) += 2;
+    (*_nodes)[node_idx].split_node(&(*_nodes)[left_idx], n.split, n.normal);
+
+    flatten(tree, idx + 1, left_idx, child_idx);
+    flatten(tree, idx + n.right, left_idx + 1, child_idx);
+}
+}; /* namespace raptor_raytracer */
@@ -0,0 +1,85 @@
+#pragma once
+
+/* Standard headers */
+#include <algorithm>
+#include <vector>
+
+/* Boost headers */
+
+/* Common headers */
+#include "common.h"
+#include "point_t.h"
+
+/* Ray tracer headers */
+#include "kdt_node.h"
+#include "primitive_store.h"
+#include "voxel.h"
+
+
+namespace raptor_raytracer
+{
+/* Build a kd tree evaluating the SAH at KDT_BUILDER_BINS planes per axis. Primitives of large nodes are
+   binned in parallel and subtrees are built in parallel. Primitives straddling a split are optionally
+   clipped to each side, otherwise their bounds are clamped to the split */
+class kdt_binned_builder
+{
+    public :
+        kdt_binned_builder(const bool clip = true) :
+            _primitives(nullptr), _nodes(nullptr), _sa_inv(0.0f), _clip(clip) {  }
+
+        /* Function to build a kd tree containg the object given in objects */
+        void build(const primitive_store *const objects, std::vector<kdt_node> *const nodes);
+
+        /* Access to the trees bounds */
+        const point_t<> & scene_upper_bound() const { return _t; }
+        const point_t<> & scene_lower_bound() const { return _b; }
+
+    private :
+        /* Count of primitives starting and ending in each bin of each axis */
+        struct bin_counts
+        {
+            bin_counts()
+            {
+                std::fill_n(&low[0][0],  3 * KDT_BUILDER_BINS, 0);
+                std::fill_n(&high[0][0], 3 * KDT_BUILDER_BINS, 0);
+            }
+
+            bin_counts& operator+=(const bin_counts &rhs)
+            {
+                for (int i = 0; i < 3; ++i)
+                {
+                    for (int j = 0; j < KDT_BUILDER_BINS; ++j)
+                    {
+                        low[i][j]  += rhs.low[i][j];
+                        high[i][j] += rhs.high[i][j];
+                    }
+                }
+
+                return *this;
+            }
+
+            int low[3][KDT_BUILDER_BINS];
+            int high[3][KDT_BUILDER_BINS];
+        };
+
+        /* Nodes are built depth first, the left child follows its parent and right is the offset to the right child */
+        struct binned_node
+        {
+            std::vector<int> *  prims;
+            float               split;
+            int                 right;
+            axis_t              normal;
+        };
+
+        void divide(std::vector<binned_node> *const tree, std::vector<voxel_aab_data> *const prims, const point_t<> &b, const point_t<> &t, const int depth) const;
+        void bin(bin_counts *const c, const voxel_aab_data *const prims, const int n, const point_t<> &b, const point_t<> &k) const;
+        void flatten(const std::vector<binned_node> &tree, const int idx, const int node_idx, int *const child_idx) const;
+
+        const primitive_store * _primitives;
+        std::vector<kdt_node> * _nodes;
+        point_t<>               _t;
+        point_t<>               _b;
+        float                   _sa_inv;
+        bool                    _clip;
+};
+}; /* namespace raptor_raytracer */
@@ -2,6 +2,7 @@
 
 #include "common.h"
 #include "triangle.h"
+#include "precomputed_triangle.h"
 #include "ray.h"
 #include "raytracer.h"
 
@@ -34,6 +35,7 @@ class kdt_node
         
         /* Access functions */
         std::vector<int>&   get_primitives()              { return *this->p;            }
+        const std::vector<int>& get_primitives()    const { return *this->p;            }
         kdt_node *          get_left()              const { return &this->c[0];         }
         kdt_node *          get_right()             const { return &this->c[1];         }
         float               get_split_position()    const { return this->split_pos;     }
@@ -53,13 +55,13 @@ class kdt_node
         /* test_leaf_node_nearest tests this object if is a leaf node and returns a pointer 
            to the nearest object found. The distance to this object is returned in m. If no 
            object is found nullptr is returned */
-        int test_leaf_node_nearest(const primitive_store &e, const ray *const r, hit_description *const h, const float min) const
+        int test_leaf_node_nearest(const precomputed_triangle *const e, const ray *const r, hit_description *const h, const float min) const
         {
             int intersecting_object = -1;
             for (int i : (*this->p))
             {
                 hit_description hit_type;
-                e.primitive(i)->is_intersecting(r, &hit_type);
+                e[i].is_intersecting(r, &hit_type);
                 if ((hit_type.d < ((h->d) + (1.0f * EPSILON))) && (hit_type.d > (min - (1.0f * EPSILON))))
                 {
                     *h = hit_type;
@@ -73,12 +75,12 @@ class kdt_node
         /* test_leaf_node_nearer tests this object if it is a leaf node to find an object
            that intersects with the ray r and is closer than max. If a closer intersecting 
            obeject is found true is return otherwise false is returned */
-        bool test_leaf_node_nearer(const primitive_store &e, const ray *const r, const float max) const
+        bool test_leaf_node_nearer(const precomputed_triangle *const e, const ray *const r, const float max) const
         {
             for (int i : (*this->p))
             {
-                const auto *const tri = e.primitive(i);
-                if (tri->get_light() || tri->is_transparent())
+                const auto *const tri = &e[i];
+                if (!tri->is_occluder())
                 {
                     continue;
                 }
@@ -6,6 +6,7 @@
 #include "boost/noncopyable.hpp"
 
 /* Common headers */
+#include "point_t.h"
 
 /* Raytracer headers */
 
@@ -17,15 +18,26 @@ namespace raptor_raytracer
 {
 /* Forward declarations */
 class hit_description;
+class instance_transform;
 class packet_hit_description;
 class packet_ray;
 class ray;
 class triangle;
 
+/* Half the surface area of the box from b to t, as used by the SAH */
+inline float surface_area(const point_t<> &b, const point_t<> &t)
+{
+    const point_t<> w(t - b);
+    return (w.x * w.y) + (w.x * w.z) + (w.y * w.z);
+}
+
 /* Vritual class to be implemented by all types of spatial sub division */
 class ssd : private boost::noncopyable
 {
     public :
+        /* Allow ssds to be owned through the base class */
+        virtual ~ssd() { };
+
         /* Traversal functions */
 #ifdef SIMD_PACKET_TRACING
         /* SIMD traversal */
@@ -40,6 +52,25 @@ class ssd : private boost::noncopyable
         virtual int     find_nearest_object(const ray *const r, hit_description *const h) const = 0;
         virtual bool    found_nearer_object(const ray *const r, const float t) const = 0;
 
+        /* Statistics */
+        virtual int     number_of_nodes()   const = 0;
+        virtual int     number_of_leaves()  const = 0;
+
+        /* Expected cost of tracing a ray through the scene bounds, using the SAH cost of traversal and intersection */
+        virtual float   sah_cost()          const = 0;
+
+        /* Bounds of everything in the ssd */
+        virtual const point_t<> & scene_lower_bound() const = 0;
+        virtual const point_t<> & scene_upper_bound() const = 0;
+
+        /* Hits normally index the primitives the ssd was built over. An ssd of instances returns the primitive */
+        /* hit and the transform of its instance to world space, otherwise nullptr */
+        virtual const triangle * instanced_primitive(const int i, const instance_transform **const xfm) const
+        {
+            (*xfm) = nullptr;
+            return nullptr;
+        }
+
     private :
 };
 }; /* namespace raptor_raytracer */
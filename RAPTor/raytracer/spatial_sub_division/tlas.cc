@@ -0,0 +1,425 @@
+/* Standard headers */
+#include <algorithm>
+#include <climits>
+
+/* Boost headers */
+
+/* Common headers */
+
+/* Ray tracer headers */
+#include "tlas.h"
+
+
+namespace raptor_raytracer
+{
+#ifdef SIMD_PACKET_TRACING
+void tlas::frustrum_find_nearest_object(const packet_ray *const r, vint_t *const i_o, packet_hit_description *const h, int size) const
+{
+    for (int i = 0; i < size; ++i)
+    {
+        find_nearest_object(&r[i], &i_o[i], &h[i]);
+    }
+}
+
+void tlas::frustrum_found_nearer_object(const packet_ray *const r, const vfp_t *t, vfp_t *closer, const unsigned int size) const
+{
+    for (int i = 0; i < static_cast<int>(size); ++i)
+    {
+        closer[i] = found_nearer_object(&r[i], t[i]);
+    }
+}
+
+void tlas::find_nearest_object(const packet_ray *const r, vint_t *const i_o, packet_hit_description *const h) const
+{
+    /* Trace each ray in turn */
+    int hit_objects[SIMD_WIDTH] __attribute__ ((aligned(SIMD_WIDTH * 4)));
+    i_o->store(&hit_objects[0]);
+    for (int i = 0; i < SIMD_WIDTH; ++i)
+    {
+        const ray ray_i(r->extract(i));
+        hit_description hit_i(h->d[i]);
+        const int intersecting_object = find_nearest_object(&ray_i, &hit_i);
+        if (intersecting_object != -1)
+        {
+            hit_objects[i] = intersecting_object;
+            h->d[i] = hit_i.d;
+            h->u[i] = hit_i.u;
+            h->v[i] = hit_i.v;
+        }
+    }
+
+    *i_o = vint_t(&hit_objects[0]);
+}
+
+vfp_t tlas::found_nearer_object(const packet_ray *const r, const vfp_t &t) const
+{
+    /* Trace each ray in turn */
+    vfp_t closer(vfp_zero);
+    for (int i = 0; i < SIMD_WIDTH; ++i)
+    {
+        const ray ray_i(r->extract(i));
+        closer[i] = found_nearer_object(&ray_i, t[i]) ? 1.0f : 0.0f;
+    }
+
+    return closer > vfp_zero;
+}
+#endif /* #ifdef SIMD_PACKET_TRACING */
+
+
+/**********************************************************
+ Find the nearest primitive hit by r, nearer than h->d. The
+ index of the primitive is returned and h updated.
+
+ The top level is traversed nearest child first. Each
+ instance reached is traced in its own space and the hit
+ distance scaled back to world space.
+**********************************************************/
+int tlas::find_nearest_object(const ray *const r, hit_description *const h) const
+{
+    const point_t<> i_rd(1.0f / r->get_dir());
+
+    tlas_stack_element stack[MAX_BVH_STACK_HEIGHT + 1];
+    int exit_point = 0;
+    stack[0].t_min  = _nodes[_root_node].intersection_distance(*r, i_rd);
+    stack[0].idx    = _root_node;
+
+    int intersecting_object = -1;
+    while (exit_point >= 0)
+    {
+        const tlas_stack_element entry_point = stack[exit_point--];
+        if (entry_point.t_min >= h->d)
+        {
+            continue;
+        }
+
+        /* Trace the instances */
+        const bvh_node &n = _nodes[entry_point.idx];
+        if (n.is_leaf())
+        {
+            for (int i = n.begin_index(); i < n.end_index(); ++i)
+            {
+                const int inst_idx = _order[i];
+                const instance &inst = _instances[inst_idx];
+                const ray obj_r(inst.transform().ray_to_object(*r));
+                hit_description obj_h;
+                const int obj_i = inst.sub_division()->find_nearest_object(&obj_r, &obj_h);
+                const float d = inst.transform().distance_to_world(obj_h.d);
+                if (d < h->d)
+                {
+                    *h      = obj_h;
+                    h->d    = d;
+                    intersecting_object = _offsets[inst_idx] + obj_i;
+                }
+            }
+
+            continue;
+        }
+
+        /* Push the far child so the near child is traced first */
+        const float l_t = _nodes[n.left_index()].intersection_distance(*r, i_rd);
+        const float r_t = _nodes[n.right_index()].intersection_distance(*r, i_rd);
+        const bool left_near = (l_t <= r_t);
+        stack[++exit_point].t_min   = left_near ? r_t : l_t;
+        stack[exit_point].idx       = left_near ? n.right_index() : n.left_index();
+        stack[++exit_point].t_min   = left_near ? l_t : r_t;
+        stack[exit_point].idx       = left_near ? n.left_index() : n.right_index();
+    }
+
+    return intersecting_object;
+}
+
+
+/**********************************************************
+ Find if any occluding primitive is hit by r nearer than t.
+**********************************************************/
+bool tlas::found_nearer_object(const ray *const r, const float t) const
+{
+    const point_t<> i_rd(1.0f / r->get_dir());
+
+    tlas_stack_element stack[MAX_BVH_STACK_HEIGHT + 1];
+    int exit_point = 0;
+    stack[0].t_min  = _nodes[_root_node].intersection_distance(*r, i_rd);
+    stack[0].idx    = _root_node;
+    while (exit_point >= 0)
+    {
+        const tlas_stack_element entry_point = stack[exit_point--];
+        if (entry_point.t_min >= t)
+        {
+            continue;
+        }
+
+        /* Trace the instances */
+        const bvh_node &n = _nodes[entry_point.idx];
+        if (n.is_leaf())
+        {
+            for (int i = n.begin_index(); i < n.end_index(); ++i)
+            {
+                const instance &inst = _instances[_order[i]];
+                const ray obj_r(inst.transform().ray_to_object(*r));
+                if (inst.sub_division()->found_nearer_object(&obj_r, inst.transform().distance_to_object(t)))
+                {
+                    return true;
+                }
+            }
+
+            continue;
+        }
+
+        /* Any hit will do, so just push both children */
+        stack[++exit_point].t_min   = _nodes[n.left_index()].intersection_distance(*r, i_rd);
+        stack[exit_point].idx       = n.left_index();
+        stack[++exit_point].t_min   = _nodes[n.right_index()].intersection_distance(*r, i_rd);
+        stack[exit_point].idx       = n.right_index();
+    }
+
+    return false;
+}
+
+
+/**********************************************************
+ Look up the primitive hit and the transform to world space
+ of the instance it belongs to.
+**********************************************************/
+const triangle * tlas::instanced_primitive(const int i, const instance_transform **const xfm) const
+{
+    /* The last instance starting at or before i, empty instances start where the next one does */
+    const int inst_idx = std::distance(_offsets.begin(), std::upper_bound(_offsets.begin(), _offsets.end(), i)) - 1;
+    assert((inst_idx >= 0) && (inst_idx < static_cast<int>(_instances.size())));
+
+    const instance &inst = _instances[inst_idx];
+    (*xfm) = &inst.transform();
+    return inst.primitives()->primitive(i - _offsets[inst_idx]);
+}
+
+
+/**********************************************************
+
+**********************************************************/
+int tlas::number_of_nodes() const
+{
+    return _nodes.size();
+}
+
+
+/**********************************************************
+
+**********************************************************/
+int tlas::number_of_leaves() const
+{
+    return std::count_if(_nodes.begin(), _nodes.end(), [](const bvh_node &n) { return n.is_leaf(); });
+}
+
+
+/**********************************************************
+ Sum the surface area weighted cost of the nodes below and
+ including idx. Instances cost the expected cost of tracing
+ through their own ssd.
+**********************************************************/
+float tlas::node_sah_cost(const int idx) const
+{
+    const bvh_node &n = _nodes[idx];
+    const float sa = surface_area(n.low_point(), n.high_point());
+    if (n.is_leaf())
+    {
+        float cost = 0.0f;
+        for (int i = n.begin_index(); i < n.end_index(); ++i)
+        {
+            cost += _costs[_order[i]];
+        }
+
+        return cost * sa;
+    }
+
+    return (COST_OF_TRAVERSAL * sa) + node_sah_cost(n.left_index()) + node_sah_cost(n.right_index());
+}
+
+
+/**********************************************************
+
+**********************************************************/
+float tlas::sah_cost() const
+{
+    const float sa = surface_area(_scene_lower, _scene_upper);
+    return (sa > 0.0f) ? (node_sah_cost(_root_node) / sa) : 0.0f;
+}
+
+
+/**********************************************************
+ Build the top level over the current instance placements.
+**********************************************************/
+void tlas::build()
+{
+    const int nr_instances = _instances.size();
+
+    /* Number the hits through each instance in turn */
+    long long nr_prims = 0;
+    _offsets.resize(nr_instances);
+    _costs.resize(nr_instances);
+    for (int i = 0; i < nr_instances; ++i)
+    {
+        _offsets[i] = nr_prims;
+        nr_prims += _instances[i].primitives()->size();
+    }
+    assert(nr_prims <= INT_MAX);
+
+    /* Cache world space instance bounds */
+    _scene_lower = point_t<>( MAX_DIST,  MAX_DIST,  MAX_DIST);
+    _scene_upper = point_t<>(-MAX_DIST, -MAX_DIST, -MAX_DIST);
+    std::vector<tlas_build_data> data(nr_instances);
+    for (int i = 0; i < nr_instances; ++i)
+    {
+        _instances[i].bounds(&data[i].low, &data[i].high);
+        data[i].centre  = (data[i].low + data[i].high) * 0.5f;
+        data[i].idx     = i;
+
+        /* The ray must be moved into the instance and then traced through it */
+        _costs[i]       = COST_OF_TRAVERSAL + _instances[i].sub_division()->sah_cost();
+        data[i].cost    = _costs[i];
+
+        _scene_lower    = min(_scene_lower, data[i].low);
+        _scene_upper    = max(_scene_upper, data[i].high);
+    }
+
+    _nodes.clear();
+    _nodes.reserve(std::max(1, (nr_instances << 1) - 1));
+    if (nr_instances == 0)
+    {
+        _scene_lower = point_t<>(0.0f, 0.0f, 0.0f);
+        _scene_upper = point_t<>(0.0f, 0.0f, 0.0f);
+        _nodes.emplace_back();
+        _nodes[0].create_leaf_node(_scene_upper, _scene_lower, 0, 0);
+        _order.clear();
+        _root_node = 0;
+        return;
+    }
+
+    /* Build top down and record the leaf order */
+    _root_node = divide(&data, 0, nr_instances, 0);
+    _order.resize(nr_instances);
+    for (int i = 0; i < nr_instances; ++i)
+    {
+        _order[i] = data[i].idx;
+    }
+}
+
+
+/**********************************************************
+ Build the node for instances b to e of data and return its
+ index. Instances are binned by centre on the widest axis
+ and divided at the plane with the lowest SAH cost.
+**********************************************************/
+int tlas::divide(std::vector<tlas_build_data> *const data, const int b, const int e, const int depth)
+{
+    const int node_idx = _nodes.size();
+    _nodes.emplace_back();
+
+    /* Bound the instances and their centres */
+    point_t<> low((*data)[b].low);
+    point_t<> high((*data)[b].high);
+    point_t<> centre_low((*data)[b].centre);
+    point_t<> centre_high((*data)[b].centre);
+    float leaf_cost = 0.0f;
+    for (int i = b; i < e; ++i)
+    {
+        low         = min(low, (*data)[i].low);
+        high        = max(high, (*data)[i].high);
+        centre_low  = min(centre_low, (*data)[i].centre);
+        centre_high = max(centre_high, (*data)[i].centre);
+        leaf_cost  += (*data)[i].cost;
+    }
+
+    /* Find the widest axis of the centres */
+    const point_t<> width(centre_high - centre_low);
+    const int axis = (width.x >= width.y) ? ((width.x >= width.z) ? 0 : 2) : ((width.y >= width.z) ? 1 : 2);
+    if (((e - b) == 1) || ((depth + 1) >= MAX_BVH_STACK_HEIGHT) || (width[axis] <= 0.0f))
+    {
+        _nodes[node_idx].create_leaf_node(high, low, b, e);
+        return node_idx;
+    }
+
+    /* Bin the instances */
+    int         counts[TLAS_BUILDER_BINS];
+    float       costs[TLAS_BUILDER_BINS];
+    point_t<>   bin_low[TLAS_BUILDER_BINS];
+    point_t<>   bin_high[TLAS_BUILDER_BINS];
+    std::fill_n(&counts[0], TLAS_BUILDER_BINS, 0);
+    std::fill_n(&costs[0], TLAS_BUILDER_BINS, 0.0f);
+    std::fill_n(&bin_low[0], TLAS_BUILDER_BINS, point_t<>( MAX_DIST,  MAX_DIST,  MAX_DIST));
+    std::fill_n(&bin_high[0], TLAS_BUILDER_BINS, point_t<>(-MAX_DIST, -MAX_DIST, -MAX_DIST));
+
+    const float k = (TLAS_BUILDER_BINS * 0.99999f) / width[axis];
+    const auto bin_of = [k, axis, &centre_low](const tlas_build_data &d)
+    {
+        return std::min(static_cast<int>((d.centre[axis] - centre_low[axis]) * k), TLAS_BUILDER_BINS - 1);
+    };
+
+    for (int i = b; i < e; ++i)
+    {
+        const int bin = bin_of((*data)[i]);
+        ++counts[bin];
+        costs[bin]     += (*data)[i].cost;
+        bin_low[bin]    = min(bin_low[bin], (*data)[i].low);
+        bin_high[bin]   = max(bin_high[bin], (*data)[i].high);
+    }
+
+    /* Sweep from the right to find the cost right of each plane */
+    float right_cost[TLAS_BUILDER_BINS];
+    point_t<> sweep_low( MAX_DIST,  MAX_DIST,  MAX_DIST);
+    point_t<> sweep_high(-MAX_DIST, -MAX_DIST, -MAX_DIST);
+    float sweep_cost = 0.0f;
+    for (int i = TLAS_BUILDER_BINS - 1; i > 0; --i)
+    {
+        sweep_low   = min(sweep_low, bin_low[i]);
+        sweep_high  = max(sweep_high, bin_high[i]);
+        sweep_cost += costs[i];
+        right_cost[i] = (sweep_cost > 0.0f) ? (sweep_cost * surface_area(sweep_low, sweep_high)) : 0.0f;
+    }
+
+    /* Sweep from the left to find the best plane */
+    const float sa_inv = 1.0f / surface_area(low, high);
+    float   lowest_cost = leaf_cost;
+    int     best_split  = -1;
+    int     nr_left     = 0;
+    sweep_low   = point_t<>( MAX_DIST,  MAX_DIST,  MAX_DIST);
+    sweep_high  = point_t<>(-MAX_DIST, -MAX_DIST, -MAX_DIST);
+    sweep_cost  = 0.0f;
+    for (int i = 1; i < TLAS_BUILDER_BINS; ++i)
+    {
+        sweep_low   = min(sweep_low, bin_low[i - 1]);
+        sweep_high  = max(sweep_high, bin_high[i - 1]);
+        sweep_cost += costs[i - 1];
+        nr_left    += counts[i - 1];
+        if ((nr_left == 0) || (nr_left == (e - b)))
+        {
+            continue;
+        }
+
+        /* cost of traversal + (left cost * left area + right cost * right area) / area */
+        const float cost = COST_OF_TRAVERSAL + (((sweep_cost * surface_area(sweep_low, sweep_high)) + right_cost[i]) * sa_inv);
+        if (cost < lowest_cost)
+        {
+            lowest_cost = cost;
+            best_split  = i;
+        }
+    }
+
+    /* Stop if splitting doesnt help */
+    if (best_split < 0)
+    {
+        _nodes[node_idx].create_leaf_node(high, low, b, e);
+        return node_idx;
+    }
+
+    /* Divide and recurse */
+    const auto mid = std::partition(data->begin() + b, data->begin() + e, [&bin_of, best_split](const tlas_build_data &d)
+        {
+            return bin_of(d) < best_split;
+        });
+    const int m = std::distance(data->begin(), mid);
+
+    const int left  = divide(data, b, m, depth + 1);
+    const int right = divide(data, m, e, depth + 1);
+    _nodes[node_idx].create_generic_node(_nodes, left, right);
+    return node_idx;
+}
+}; /* namespace raptor_raytracer */
@@ -0,0 +1,137 @@
+#pragma once
+
+/* Standard headers */
+#include <memory>
+#include <vector>
+
+/* Boost headers */
+
+/* Common headers */
+#include "point_t.h"
+#include "simd.h"
+
+/* Ray tracer headers */
+#include "common.h"
+#include "ssd.h"
+#include "bvh_node.h"
+#include "instance_transform.h"
+#include "primitive_store.h"
+
+
+namespace raptor_raytracer
+{
+/* A placement of a model in the world. The primitives of the model and the ssd built over them are shared between instances */
+class instance
+{
+    public :
+        instance(const std::shared_ptr<const ssd> &s, const std::shared_ptr<const primitive_store> &p, const instance_transform &t = instance_transform()) :
+            _ssd(s), _prims(p), _xfm(t) {  }
+
+        /* Allow default DTOR, copy CTOR and assignment operator (for using in vector) */
+
+        /* Access functions */
+        const ssd *                 sub_division()  const { return _ssd.get();      }
+        const primitive_store *     primitives()    const { return _prims.get();    }
+        const instance_transform &  transform()     const { return _xfm;            }
+
+        instance & move(const instance_transform &t)
+        {
+            _xfm = t;
+            return *this;
+        }
+
+        /* World space bounds of the instance */
+        void bounds(point_t<> *const b, point_t<> *const t) const
+        {
+            (*b) = _ssd->scene_lower_bound();
+            (*t) = _ssd->scene_upper_bound();
+            _xfm.bounds_to_world(b, t);
+        }
+
+    private :
+        std::shared_ptr<const ssd>              _ssd;
+        std::shared_ptr<const primitive_store>  _prims;
+        instance_transform                      _xfm;
+};
+
+
+/* Top level acceleration structure, a bvh over instances of other ssds. Rays reaching an instance are moved into */
+/* its space and traced through its ssd. When instances move only the top level needs to be rebuilt */
+/* Hits are numbered through the primitives of all instances in turn */
+class tlas : public ssd
+{
+    public :
+        /* CTOR */
+        tlas(const std::vector<instance> &instances) :
+        _instances(instances), _root_node(0)
+        {
+            build();
+        }
+
+        /* Copy and assignment prohibited by base class */
+        /* Allow default DTOR */
+
+        /* Animation, move instances and then rebuild the top level once */
+        void    move_instance(const int i, const instance_transform &t) { _instances[i].move(t);  }
+        void    rebuild()                                               { build();                }
+
+        const instance &    get_instance(const int i)   const { return _instances[i];       }
+        int                 number_of_instances()       const { return _instances.size();   }
+
+        /* Traversal functions */
+#ifdef SIMD_PACKET_TRACING
+        /* Packets are traced ray by ray, the rays of a packet diverge once they are moved into an instance */
+        void    frustrum_find_nearest_object(const packet_ray *const r, vint_t *const i_o, packet_hit_description *const h, int size) const override;
+        void    frustrum_found_nearer_object(const packet_ray *const r, const vfp_t *t, vfp_t *closer, const unsigned int size) const override;
+
+        void    find_nearest_object(const packet_ray *const r, vint_t *const i_o, packet_hit_description *const h) const override;
+        vfp_t   found_nearer_object(const packet_ray *const r, const vfp_t &t) const override;
+#endif /* #ifdef SIMD_PACKET_TRACING */
+
+        int     find_nearest_object(const ray *const r, hit_description *const h) const override;
+        bool    found_nearer_object(const ray *const r, const float t) const override;
+
+        /* Top level statistics */
+        int     number_of_nodes()   const override;
+        int     number_of_leaves()  const override;
+        float   sah_cost()          const override;
+
+        /* Scene bounds */
+        const point_t<> & scene_lower_bound() const override { return _scene_lower; }
+        const point_t<> & scene_upper_bound() const override { return _scene_upper; }
+
+        /* Shading look up */
+        const triangle * instanced_primitive(const int i, const instance_transform **const xfm) const override;
+
+    private :
+        /* Stack element for tracing through the top level */
+        struct tlas_stack_element
+        {
+            float   t_min;
+            int     idx;
+        };
+
+        /* Instance data for building the top level */
+        struct tlas_build_data
+        {
+            point_t<>   low;
+            point_t<>   high;
+            point_t<>   centre;
+            float       cost;
+            int         idx;
+        };
+
+        void    build();
+        int     divide(std::vector<tlas_build_data> *const data, const int b, const int e, const int depth);
+        float   node_sah_cost(const int idx) const;
+
+        std::vector<instance>   _instances;
+        std::vector<bvh_node>   _nodes;
+        std::vector<int>        _order;     /* Instances in leaf order                  */
+        std::vector<int>        _offsets;   /* Index of the first hit in each instance  */
+        std::vector<float>      _costs;     /* Cost of tracing each instance            */
+        point_t<>               _scene_lower;
+        point_t<>               _scene_upper;
+        int                     _root_node;
+};
+}; /* namespace raptor_raytracer */
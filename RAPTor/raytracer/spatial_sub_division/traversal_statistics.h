@@ -0,0 +1,56 @@
+#pragma once
+
+/* Standard headers */
+#include <cstdint>
+
+/* Common headers */
+#include "simd.h"
+
+
+namespace raptor_raytracer
+{
+/* Work done tracing rays through an ssd. Triangle tests are counted per ray or per packet of SIMD_WIDTH rays */
+struct traversal_statistics
+{
+    enum counter_t { nodes_visited = 0, leaves_visited = 1, triangle_tests = 2, active_lanes = 3, packet_lanes = 4, frustrum_culls = 5, number_of_counters = 6 };
+
+    traversal_statistics & operator+=(const traversal_statistics &rhs)
+    {
+        for (int i = 0; i < number_of_counters; ++i)
+        {
+            counts[i] += rhs.counts[i];
+        }
+
+        return *this;
+    }
+
+    traversal_statistics operator-(const traversal_statistics &rhs) const
+    {
+        traversal_statistics ret;
+        for (int i = 0; i < number_of_counters; ++i)
+        {
+            ret.counts[i] = counts[i] - rhs.counts[i];
+        }
+
+        return ret;
+    }
+
+    std::uint64_t counts[number_of_counters] = {};
+};
+
+/* Names of the counters */
+const char *const traversal_counter_names[traversal_statistics::number_of_counters] = { "nodes", "leaves", "triangles", "active_lanes", "packet_lanes", "frustrum_culls" };
+
+/* Counters of the calling thread. Only the owning thread touches them so traversal doesnt need atomics, the work done */
+/* tracing something is the difference in the counters before and after */
+inline thread_local traversal_statistics thread_traversal_statistics;
+}; /* namespace raptor_raytracer */
+
+/* Counting is compiled out unless TRAVERSAL_STATISTICS is defined */
+#ifdef TRAVERSAL_STATISTICS
+#define COUNT_TRAVERSAL(C, N)   (raptor_raytracer::thread_traversal_statistics.counts[raptor_raytracer::traversal_statistics::C] += (N))
+#define COUNT_PACKET_LANES(M)   (COUNT_TRAVERSAL(active_lanes, __builtin_popcount(M)), COUNT_TRAVERSAL(packet_lanes, SIMD_WIDTH))
+#else
+#define COUNT_TRAVERSAL(C, N)
+#define COUNT_PACKET_LANES(M)
+#endif /* #ifdef TRAVERSAL_STATISTICS */
@@ -1,4 +1,5 @@
 /* Standard header */
+#include <algorithm>
 
 /* Boost headers */
 
@@ -9,6 +10,11 @@
 #include "voxel.h"
 
 
+/* Samples are counted at least 8 at a time in whole vectors */
+#define SAMPLE_VECTORS          ((8 + SIMD_WIDTH - 1) >> LOG2_SIMD_WIDTH)
+#define SAMPLE_BUCKET_SIZE      (SAMPLE_VECTORS << LOG2_SIMD_WIDTH)
+
+
 namespace raptor_raytracer
 {
 void clip_line(point_t<> *const i_l, point_t<> *const i_r, const point_t<> &a, const point_t<> &m, const float dist, const float norm)
@@ -658,10 +664,9 @@ float voxel::approximate_split_one_axis(float *const s, const axis_t normal) con
 float voxel::brute_force_split_all_axis(float *s, axis_t * normal) const
 {
     /* Find the best split position of the primitives */
-    alignas(16) float sample[9];
-    vfp_t valid_mask[2];
+    float sample[SAMPLE_BUCKET_SIZE + 1] __attribute__ ((aligned(SIMD_WIDTH * 4)));
 
-    vfp_t l_vec[2], r_vec[2], s_vec[2];
+    vfp_t l_vec[SAMPLE_VECTORS], r_vec[SAMPLE_VECTORS], s_vec[SAMPLE_VECTORS];
     vfp_t lc_vec(*s);
     vfp_t ba_vec(static_cast<float>(axis_t::not_set));
     vfp_t bs_vec(MAX_DIST);
@@ -682,12 +687,14 @@ float voxel::brute_force_split_all_axis(float *s, axis_t * normal) const
         }
         
         /* Check for bucket full */
-        if (bucketted > 7)
+        if (bucketted >= SAMPLE_BUCKET_SIZE)
         {
-            s_vec[0] = &sample[0];
-            s_vec[1] = &sample[SIMD_WIDTH];
+            for (int j = 0; j < SAMPLE_VECTORS; ++j)
+            {
+                s_vec[j] = &sample[j << LOG2_SIMD_WIDTH];
+            }
             count_primitives(l_vec, r_vec, s_vec, axis_t::x_axis);
-            for (int j = 0; j < 2; j++)
+            for (int j = 0; j < SAMPLE_VECTORS; j++)
             {
                 vfp_t cost(calculate_sah_cost(l_vec[j], r_vec[j], s_vec[j], axis_t::x_axis));
                 vfp_t mask(cost < lc_vec);
@@ -698,9 +705,9 @@ float voxel::brute_force_split_all_axis(float *s, axis_t * normal) const
             }
             
             /* Move down any overflow */
-            if (bucketted == 9)
+            if (bucketted == (SAMPLE_BUCKET_SIZE + 1))
             {
-                sample[0] = sample[8];
+                sample[0] = sample[SAMPLE_BUCKET_SIZE];
                 bucketted = 1;
             }
             else
@@ -711,16 +718,18 @@ float voxel::brute_force_split_all_axis(float *s, axis_t * normal) const
     }
     
     /*  Process left over samples */
-    s_vec[0] = &sample[0];
-    s_vec[1] = &sample[SIMD_WIDTH];
-    valid_mask[0] = (bucketted & SIMD_WIDTH) ? vfp_true : index_to_mask_lut[bucketted];
-    valid_mask[1] = (bucketted & SIMD_WIDTH) ? index_to_mask_lut[bucketted - SIMD_WIDTH] : vfp_zero;
+    for (int j = 0; j < SAMPLE_VECTORS; ++j)
+    {
+        s_vec[j] = &sample[j << LOG2_SIMD_WIDTH];
+    }
     
     count_primitives(l_vec, r_vec, s_vec, axis_t::x_axis);
-    for (int j = 0; j < ((bucketted >> LOG2_SIMD_WIDTH) + (int)(bucketted > 0)); j++)
+    for (int j = 0; j < ((bucketted + SIMD_WIDTH - 1) >> LOG2_SIMD_WIDTH); ++j)
     {
+        const int valid = bucketted - (j << LOG2_SIMD_WIDTH);
+        const vfp_t valid_mask((valid >= SIMD_WIDTH) ? vfp_true : index_to_mask_lut[valid]);
         vfp_t cost(calculate_sah_cost(l_vec[j], r_vec[j], s_vec[j], axis_t::x_axis));
-        vfp_t mask((cost < lc_vec) & valid_mask[j]);
+        vfp_t mask((cost < lc_vec) & valid_mask);
 
         lc_vec = mov_p(mask, cost,                lc_vec);
         bs_vec = mov_p(mask, s_vec[j],            bs_vec);
@@ -743,12 +752,14 @@ float voxel::brute_force_split_all_axis(float *s, axis_t * normal) const
         }
         
         /* Check for bucket full */
-        if (bucketted > 7)
+        if (bucketted >= SAMPLE_BUCKET_SIZE)
         {
-            s_vec[0] = &sample[0];
-            s_vec[1] = &sample[SIMD_WIDTH];
+            for (int j = 0; j < SAMPLE_VECTORS; ++j)
+            {
+                s_vec[j] = &sample[j << LOG2_SIMD_WIDTH];
+            }
             count_primitives(l_vec, r_vec, s_vec, axis_t::y_axis);
-            for (int j = 0; j < 2; j++)
+            for (int j = 0; j < SAMPLE_VECTORS; j++)
             {
                 vfp_t cost(calculate_sah_cost(l_vec[j], r_vec[j], s_vec[j], axis_t::y_axis));
                 vfp_t mask(cost < lc_vec);
@@ -759,9 +770,9 @@ float voxel::brute_force_split_all_axis(float *s, axis_t * normal) const
             }
             
             /* Move down any overflow */
-            if (bucketted == 9)
+            if (bucketted == (SAMPLE_BUCKET_SIZE + 1))
             {
-                sample[0] = sample[8];
+                sample[0] = sample[SAMPLE_BUCKET_SIZE];
                 bucketted = 1;
             }
             else
@@ -772,16 +783,18 @@ float voxel::brute_force_split_all_axis(float *s, axis_t * normal) const
     }
     
     /*  Process left over samples */
-    s_vec[0] = &sample[0];
-    s_vec[1] = &sample[SIMD_WIDTH];
-    valid_mask[0] = (bucketted & SIMD_WIDTH) ? vfp_true : index_to_mask_lut[bucketted];
-    valid_mask[1] = (bucketted & SIMD_WIDTH) ? index_to_mask_lut[bucketted - SIMD_WIDTH] : vfp_zero;
+    for (int j = 0; j < SAMPLE_VECTORS; ++j)
+    {
+        s_vec[j] = &sample[j << LOG2_SIMD_WIDTH];
+    }
     
     count_primitives(l_vec, r_vec, s_vec, axis_t::y_axis);
-    for (int j = 0; j < ((bucketted >> LOG2_SIMD_WIDTH) + (int)(bucketted > 0)); j++)
+    for (int j = 0; j < ((bucketted + SIMD_WIDTH - 1) >> LOG2_SIMD_WIDTH); ++j)
     {
+        const int valid = bucketted - (j << LOG2_SIMD_WIDTH);
+        const vfp_t valid_mask((valid >= SIMD_WIDTH) ? vfp_true : index_to_mask_lut[valid]);
         vfp_t cost(calculate_sah_cost(l_vec[j], r_vec[j], s_vec[j], axis_t::y_axis));
-        vfp_t mask((cost < lc_vec) & valid_mask[j]);
+        vfp_t mask((cost < lc_vec) & valid_mask);
 
         lc_vec = mov_p(mask, cost,                lc_vec);
         bs_vec = mov_p(mask, s_vec[j],            bs_vec);
@@ -804,12 +817,14 @@ float voxel::brute_force_split_all_axis(float *s, axis_t * normal) const
         }
         
         /* Check for bucket full */
-        if (bucketted > 7)
+        if (bucketted >= SAMPLE_BUCKET_SIZE)
         {
-            s_vec[0] = &sample[0];
-            s_vec[1] = &sample[SIMD_WIDTH];
+            for (int j = 0; j < SAMPLE_VECTORS; ++j)
+            {
+                s_vec[j] = &sample[j << LOG2_SIMD_WIDTH];
+            }
             count_primitives(l_vec, r_vec, s_vec, axis_t::z_axis);
-            for (int j = 0; j < 2; j++)
+            for (int j = 0; j < SAMPLE_VECTORS; j++)
             {
                 vfp_t cost(calculate_sah_cost(l_vec[j], r_vec[j], s_vec[j], axis_t::z_axis));
                 vfp_t mask(cost < lc_vec);
@@ -820,9 +835,9 @@ float voxel::brute_force_split_all_axis(float *s, axis_t * normal) const
             }
             
             /* Move down any overflow */
-            if (bucketted == 9)
+            if (bucketted == (SAMPLE_BUCKET_SIZE + 1))
             {
-                sample[0] = sample[8];
+                sample[0] = sample[SAMPLE_BUCKET_SIZE];
                 bucketted = 1;
             }
             else
@@ -833,16 +848,18 @@ float voxel::brute_force_split_all_axis(float *s, axis_t * normal) const
     }
     
     /*  Process left over samples */
-    s_vec[0] = &sample[0];
-    s_vec[1] = &sample[SIMD_WIDTH];
-    valid_mask[0] = (bucketted & SIMD_WIDTH) ? vfp_true : index_to_mask_lut[bucketted];
-    valid_mask[1] = (bucketted & SIMD_WIDTH) ? index_to_mask_lut[bucketted - SIMD_WIDTH] : vfp_zero;
+    for (int j = 0; j < SAMPLE_VECTORS; ++j)
+    {
+        s_vec[j] = &sample[j << LOG2_SIMD_WIDTH];
+    }
     
     count_primitives(l_vec, r_vec, s_vec, axis_t::z_axis);
-    for (int j = 0; j < ((bucketted >> LOG2_SIMD_WIDTH) + static_cast<int>(bucketted > 0)); ++j)
+    for (int j = 0; j < ((bucketted + SIMD_WIDTH - 1) >> LOG2_SIMD_WIDTH); ++j)
     {
+        const int valid = bucketted - (j << LOG2_SIMD_WIDTH);
+        const vfp_t valid_mask((valid >= SIMD_WIDTH) ? vfp_true : index_to_mask_lut[valid]);
         vfp_t cost(calculate_sah_cost(l_vec[j], r_vec[j], s_vec[j], axis_t::z_axis));
-        vfp_t mask((cost < lc_vec) & valid_mask[j]);
+        vfp_t mask((cost < lc_vec) & valid_mask);
 
         lc_vec = mov_p(mask, cost,                lc_vec);
         bs_vec = mov_p(mask, s_vec[j],            bs_vec);
@@ -852,7 +869,7 @@ float voxel::brute_force_split_all_axis(float *s, axis_t * normal) const
     /* Collect results */
     (*s) = horizontal_min(lc_vec);
 
-    const int index = mask_to_index_lut[move_mask(vfp_t(*s) == lc_vec)];
+    const int index = __builtin_ctz(move_mask(vfp_t(*s) == lc_vec));
     (*normal) = static_cast<axis_t>(ba_vec[index]);
     return bs_vec[index];
 }
@@ -860,69 +877,43 @@ float voxel::brute_force_split_all_axis(float *s, axis_t * normal) const
 // __attribute__((optimize("unroll-loops")))
 void voxel::count_primitives(float *const l, float *const r, const float *const s, const int len, const axis_t n) const
 {
-    assert(len == 8);
-    vfp_t l_vec[2] = { vfp_zero, vfp_zero };
-    vfp_t r_vec[2] = { vfp_zero, vfp_zero };
-    vfp_t s_vec[2] = { &s[0], &s[SIMD_WIDTH] };
+    assert(len <= SAMPLE_BUCKET_SIZE);
 
+    /* Pad the samples to whole vectors */
+    float padded[SAMPLE_BUCKET_SIZE] __attribute__ ((aligned(SIMD_WIDTH * 4)));
+    std::copy(&s[0], &s[len], &padded[0]);
+    std::fill(&padded[len], &padded[SAMPLE_BUCKET_SIZE], s[len - 1]);
 
-    /* Count in the given axis */
-    switch (n)
+    vfp_t l_vec[SAMPLE_VECTORS];
+    vfp_t r_vec[SAMPLE_VECTORS];
+    vfp_t s_vec[SAMPLE_VECTORS];
+    for (int i = 0; i < SAMPLE_VECTORS; ++i)
     {
-        case axis_t::x_axis:
-            for (int i = _ping_idx; i < static_cast<int>(_ping_idx + _nr_prims); ++i)
-            {
-                const vfp_t lo((*_ping)[i].low.x);
-                const vfp_t hi((*_ping)[i].high.x);
-                l_vec[0] += (lo <= s_vec[0]) & vfp_one;
-                r_vec[0] += (hi >  s_vec[0]) & vfp_one;
-                l_vec[1] += (lo <= s_vec[1]) & vfp_one;
-                r_vec[1] += (hi >  s_vec[1]) & vfp_one;
-            }
-            break;
-
-        case axis_t::y_axis:
-            for (int i = _ping_idx; i < static_cast<int>(_ping_idx + _nr_prims); ++i)
-            {
-                const vfp_t lo((*_ping)[i].low.y);
-                const vfp_t hi((*_ping)[i].high.y);
-                l_vec[0] += (lo <= s_vec[0]) & vfp_one;
-                r_vec[0] += (hi >  s_vec[0]) & vfp_one;
-                l_vec[1] += (lo <= s_vec[1]) & vfp_one;
-                r_vec[1] += (hi >  s_vec[1]) & vfp_one;
-            }
-            break;
-
-        case axis_t::z_axis:
-            for (int i = _ping_idx; i < static_cast<int>(_ping_idx + _nr_prims); ++i)
-            {
-                const vfp_t lo((*_ping)[i].low.z);
-                const vfp_t hi((*_ping)[i].high.z);
-                l_vec[0] += (lo <= s_vec[0]) & vfp_one;
-                r_vec[0] += (hi >  s_vec[0]) & vfp_one;
-                l_vec[1] += (lo <= s_vec[1]) & vfp_one;
-                r_vec[1] += (hi >  s_vec[1]) & vfp_one;
-            }
-            break;
-        default :
-            assert(false);
-            break;
+        s_vec[i] = &padded[i << LOG2_SIMD_WIDTH];
     }
 
+    count_primitives(l_vec, r_vec, s_vec, n);
+
     /* Save results */
-    l_vec[0].store(&l[0]);
-    l_vec[1].store(&l[SIMD_WIDTH]);
+    float l_all[SAMPLE_BUCKET_SIZE] __attribute__ ((aligned(SIMD_WIDTH * 4)));
+    float r_all[SAMPLE_BUCKET_SIZE] __attribute__ ((aligned(SIMD_WIDTH * 4)));
+    for (int i = 0; i < SAMPLE_VECTORS; ++i)
+    {
+        l_vec[i].store(&l_all[i << LOG2_SIMD_WIDTH]);
+        r_vec[i].store(&r_all[i << LOG2_SIMD_WIDTH]);
+    }
 
-    r_vec[0].store(&r[0]);
-    r_vec[1].store(&r[SIMD_WIDTH]);
+    std::copy(&l_all[0], &l_all[len], &l[0]);
+    std::copy(&r_all[0], &r_all[len], &r[0]);
 }
 
 void voxel::count_primitives(vfp_t *const l, vfp_t *const r, const vfp_t *const s, const axis_t n) const
 {
-    l[0] = vfp_zero;
-    l[1] = vfp_zero;
-    r[0] = vfp_zero;
-    r[1] = vfp_zero;
+    for (int j = 0; j < SAMPLE_VECTORS; ++j)
+    {
+        l[j] = vfp_zero;
+        r[j] = vfp_zero;
+    }
 
     /* Count in the given axis */
     switch (n)
@@ -932,10 +923,11 @@ void voxel::count_primitives(vfp_t *const l, vfp_t *const r, const vfp_t *const
             {
                 const vfp_t lo((*_ping)[i].low.x);
                 const vfp_t hi((*_ping)[i].high.x);
-                l[0] += (lo <= s[0]) & vfp_one;
-                r[0] += (hi >  s[0]) & vfp_one;
-                l[1] += (lo <= s[1]) & vfp_one;
-                r[1] += (hi >  s[1]) & vfp_one;
+                for (int j = 0; j < SAMPLE_VECTORS; ++j)
+                {
+                    l[j] += (lo <= s[j]) & vfp_one;
+                    r[j] += (hi >  s[j]) & vfp_one;
+                }
             }
             break;
 
@@ -944,10 +936,11 @@ void voxel::count_primitives(vfp_t *const l, vfp_t *const r, const vfp_t *const
             {
                 const vfp_t lo((*_ping)[i].low.y);
                 const vfp_t hi((*_ping)[i].high.y);
-                l[0] += (lo <= s[0]) & vfp_one;
-                r[0] += (hi >  s[0]) & vfp_one;
-                l[1] += (lo <= s[1]) & vfp_one;
-                r[1] += (hi >  s[1]) & vfp_one;
+                for (int j = 0; j < SAMPLE_VECTORS; ++j)
+                {
+                    l[j] += (lo <= s[j]) & vfp_one;
+                    r[j] += (hi >  s[j]) & vfp_one;
+                }
             }
             break;
 
@@ -956,10 +949,11 @@ void voxel::count_primitives(vfp_t *const l, vfp_t *const r, const vfp_t *const
             {
                 const vfp_t lo((*_ping)[i].low.z);
                 const vfp_t hi((*_ping)[i].high.z);
-                l[0] += (lo <= s[0]) & vfp_one;
-                r[0] += (hi >  s[0]) & vfp_one;
-                l[1] += (lo <= s[1]) & vfp_one;
-                r[1] += (hi >  s[1]) & vfp_one;
+                for (int j = 0; j < SAMPLE_VECTORS; ++j)
+                {
+                    l[j] += (lo <= s[j]) & vfp_one;
+                    r[j] += (hi >  s[j]) & vfp_one;
+                }
             }
             break;
         default :
@@ -0,0 +1,295 @@
+/* Standard headers */
+
+/* Boost headers */
+
+/* Comonn heders */
+#include "logging.h"
+
+/* Ray tracer headers */
+#include "wide_bvh.h"
+#include "traversal_statistics.h"
+
+
+namespace raptor_raytracer
+{
+/* Find the nearest of size primitives from b that r intersects */
+inline int test_leaf_nearest(const precomputed_triangle *const e, const ray *const r, hit_description *const h, const int b, const int size)
+{
+    const int end = b + size;
+    int intersecting_object = -1;
+    for (int i = b; i < end; ++i)
+    {
+        hit_description hit_type(h->d);
+        e[i].is_intersecting(r, &hit_type);
+        if (hit_type.d < h->d)
+        {
+            *h = hit_type;
+            intersecting_object = e[i].index();
+        }
+    }
+
+    return intersecting_object;
+}
+
+
+/* Check if any of size primitives from b occlude r before max */
+inline bool test_leaf_nearer(const precomputed_triangle *const e, const ray *const r, const float max, const int b, const int size)
+{
+    const int end = b + size;
+    for (int i = b; i < end; ++i)
+    {
+        const auto *tri = &e[i];
+        if (!tri->is_occluder())
+        {
+            continue;
+        }
+
+        hit_description hit_type(max);
+        tri->is_intersecting(r, &hit_type);
+        if (hit_type.d < max)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+#ifdef SIMD_PACKET_TRACING
+void wide_bvh::frustrum_find_nearest_object(const packet_ray *const r, vint_t *const i_o, packet_hit_description *const h, int size) const
+{
+    for (int i = 0; i < size; ++i)
+    {
+        find_nearest_object(&r[i], &i_o[i], &h[i]);
+    }
+}
+
+void wide_bvh::frustrum_found_nearer_object(const packet_ray *const r, const vfp_t *t, vfp_t *closer, const unsigned int size) const
+{
+    for (int i = 0; i < static_cast<int>(size); ++i)
+    {
+        closer[i] = found_nearer_object(&r[i], t[i]);
+    }
+}
+
+void wide_bvh::find_nearest_object(const packet_ray *const r, vint_t *const i_o, packet_hit_description *const h) const
+{
+    /* Trace each ray in turn */
+    int hit_objects[SIMD_WIDTH] __attribute__ ((aligned(SIMD_WIDTH * 4)));
+    i_o->store(&hit_objects[0]);
+    for (int i = 0; i < SIMD_WIDTH; ++i)
+    {
+        const ray ray_i(r->extract(i));
+        hit_description hit_i;
+        const int intersecting_object = find_nearest_object(&ray_i, &hit_i);
+        if (intersecting_object != -1)
+        {
+            hit_objects[i] = intersecting_object;
+        }
+
+        h->d[i] = hit_i.d;
+        h->u[i] = hit_i.u;
+        h->v[i] = hit_i.v;
+    }
+
+    *i_o = vint_t(&hit_objects[0]);
+}
+
+vfp_t wide_bvh::found_nearer_object(const packet_ray *const r, const vfp_t &t) const
+{
+    /* Trace each ray in turn */
+    vfp_t closer(vfp_zero);
+    for (int i = 0; i < SIMD_WIDTH; ++i)
+    {
+        const ray ray_i(r->extract(i));
+        closer[i] = found_nearer_object(&ray_i, t[i]) ? 1.0f : 0.0f;
+    }
+
+    return closer > vfp_zero;
+}
+#endif /* #ifdef SIMD_PACKET_TRACING */
+
+
+int wide_bvh::find_nearest_object(const ray *const r, hit_description *const h) const
+{
+    /* Take the inverse direction of the ray for faster traversal */
+    const point_t<> ray_dir_inv(1.0f / r->get_dir());
+    const wide_bvh_ray wr(*r, ray_dir_inv);
+
+    /* State of stack, start at the root */
+    int exit_point = 0;
+    _wbvh_stack[0].t_min    = 0.0f;
+    _wbvh_stack[0].idx      = 0;
+    _wbvh_stack[0].size     = 0;
+
+    /* Traverse the whole tree */
+    float           t_min[SIMD_WIDTH] __attribute__ ((aligned(SIMD_WIDTH * 4)));
+    hit_description nearest_hit;
+    int             hit_object = -1;
+    do
+    {
+        /* Pop the stack, skipping anything beyond the nearest hit */
+        const wide_bvh_stack_element entry_point(_wbvh_stack[exit_point--]);
+        const float t_max = nearest_hit.d + (100.0f * EPSILON);
+        if (entry_point.t_min > t_max)
+        {
+            continue;
+        }
+
+        /* If the leaf contains objects find the closest intersecting object */
+        if (entry_point.size > 0)
+        {
+            COUNT_TRAVERSAL(leaves_visited, 1);
+            const int intersecting_object = test_leaf_nearest(_tris->data(), r, &nearest_hit, entry_point.idx, entry_point.size);
+            if (intersecting_object != -1)
+            {
+                hit_object = intersecting_object;
+            }
+            continue;
+        }
+
+        /* Intersect all children at once */
+        const wide_bvh_node &node = (*_wbvh_base)[entry_point.idx];
+        COUNT_TRAVERSAL(nodes_visited, 1);
+        vfp_t vt_min;
+        const int hits = node.intersection_distance(wr, t_max, &vt_min);
+        if (!hits)
+        {
+            continue;
+        }
+        vt_min.store(&t_min[0]);
+
+        /* Push children far to near so the nearest is traversed first */
+        const std::uint64_t order = node.order(wr.octant);
+        for (int i = SIMD_WIDTH - 1; i >= 0; --i)
+        {
+            const int child = (order >> (i << 2)) & 0xf;
+            if (hits & (1 << child))
+            {
+                wide_bvh_stack_element *const push = &_wbvh_stack[++exit_point];
+                push->t_min = t_min[child];
+                push->idx   = node.child(child);
+                push->size  = node.size(child);
+            }
+        }
+    } while (exit_point >= 0);
+
+    *h = nearest_hit;
+    return hit_object;
+}
+
+bool wide_bvh::found_nearer_object(const ray *const r, const float t) const
+{
+    /* Take the inverse direction of the ray for faster traversal */
+    const point_t<> ray_dir_inv(1.0f / r->get_dir());
+    const wide_bvh_ray wr(*r, ray_dir_inv);
+
+    /* State of stack, start at the root */
+    int exit_point = 0;
+    _wbvh_stack[0].t_min    = 0.0f;
+    _wbvh_stack[0].idx      = 0;
+    _wbvh_stack[0].size     = 0;
+
+    /* Traverse the whole tree */
+    const float t_max = t + (100.0f * EPSILON);
+    do
+    {
+        const wide_bvh_stack_element entry_point(_wbvh_stack[exit_point--]);
+
+        /* If any object in the leaf occludes the ray return */
+        if (entry_point.size > 0)
+        {
+            COUNT_TRAVERSAL(leaves_visited, 1);
+            if (test_leaf_nearer(_tris->data(), r, t, entry_point.idx, entry_point.size))
+            {
+                return true;
+            }
+            continue;
+        }
+
+        /* Intersect all children at once */
+        const wide_bvh_node &node = (*_wbvh_base)[entry_point.idx];
+        COUNT_TRAVERSAL(nodes_visited, 1);
+        vfp_t vt_min;
+        const int hits = node.intersection_distance(wr, t_max, &vt_min);
+        if (!hits)
+        {
+            continue;
+        }
+
+        /* Push children far to near, any hit will do but near children are more likely to occlude */
+        const std::uint64_t order = node.order(wr.octant);
+        for (int i = SIMD_WIDTH - 1; i >= 0; --i)
+        {
+            const int child = (order >> (i << 2)) & 0xf;
+            if (hits & (1 << child))
+            {
+                wide_bvh_stack_element *const push = &_wbvh_stack[++exit_point];
+                push->idx   = node.child(child);
+                push->size  = node.size(child);
+            }
+        }
+    } while (exit_point >= 0);
+
+    return false;
+}
+
+
+/**********************************************************
+ The nodes are allocated exactly so count them all
+**********************************************************/
+int wide_bvh::number_of_nodes() const
+{
+    return _wbvh_base->size();
+}
+
+
+/**********************************************************
+ Count the leaf children of all nodes
+**********************************************************/
+int wide_bvh::number_of_leaves() const
+{
+    int leaves = 0;
+    for (const auto &n : *_wbvh_base)
+    {
+        for (int i = 0; i < SIMD_WIDTH; ++i)
+        {
+            leaves += n.is_leaf(i);
+        }
+    }
+
+    return leaves;
+}
+
+
+/**********************************************************
+ Sum the surface area weighted cost of all nodes, children
+ are costed using their bounds in the parent
+**********************************************************/
+float wide_bvh::sah_cost() const
+{
+    const float sa = surface_area(_builder.scene_lower_bound(), _builder.scene_upper_bound());
+    if (sa <= 0.0f)
+    {
+        return 0.0f;
+    }
+
+    float cost = COST_OF_TRAVERSAL * sa;
+    for (const auto &n : *_wbvh_base)
+    {
+        for (int i = 0; i < SIMD_WIDTH; ++i)
+        {
+            if (n.is_empty(i))
+            {
+                continue;
+            }
+
+            const float child_sa = surface_area(n.low_point(i), n.high_point(i));
+            cost += n.is_leaf(i) ? (COST_OF_INTERSECTION * n.size(i) * child_sa) : (COST_OF_TRAVERSAL * child_sa);
+        }
+    }
+
+    return cost / sa;
+}
+}; /* namespace raptor_raytracer */
@@ -0,0 +1,83 @@
+#pragma once
+
+/* Standard headers */
+#include <vector>
+
+/* Boost headers */
+
+/* Common headers */
+#include "point_t.h"
+#include "simd.h"
+
+/* Ray tracer headers */
+#include "common.h"
+#include "ssd.h"
+#include "wide_bvh_node.h"
+#include "wide_bvh_builder.h"
+#include "precomputed_triangle.h"
+
+
+namespace raptor_raytracer
+{
+/* A bvh with SIMD_WIDTH children per node, collapsed from a binary bvh, for fast single ray traversal */
+class wide_bvh : public ssd
+{
+    public :
+        /* CTOR */
+        // cppcheck-suppress uninitMemberVar
+        wide_bvh(primitive_store &everything) :
+        _prims(everything), _builder(), _wbvh_base(new std::vector<wide_bvh_node>()), _tris(new std::vector<precomputed_triangle>())
+        {
+            /* Build the heirarchy */
+            _builder.build(&everything, _wbvh_base.get());
+
+            /* Pack the intersection data in leaf order */
+            precompute_indirect_triangles(_tris.get(), everything);
+        }
+
+        /* Copy CTOR */
+        wide_bvh(const wide_bvh &b) : _prims(b._prims), _wbvh_base(b._wbvh_base), _tris(b._tris) {  }
+
+        /* Assignment prohibited by base class */
+        /* Allow default DTOR */
+
+        /* Traversal functions */
+#ifdef SIMD_PACKET_TRACING
+        /* SIMD traversal, rays are traversed one at a time */
+        void    frustrum_find_nearest_object(const packet_ray *const r, vint_t *const i_o, packet_hit_description *const h, int size) const override;
+        void    frustrum_found_nearer_object(const packet_ray *const r, const vfp_t *t, vfp_t *closer, const unsigned int size) const override;
+
+        void    find_nearest_object(const packet_ray *const r, vint_t *const i_o, packet_hit_description *const h) const override;
+        vfp_t   found_nearer_object(const packet_ray *const r, const vfp_t &t) const override;
+#endif /* #ifdef SIMD_PACKET_TRACING */
+
+        /* Wide bvh traversal */
+        int     find_nearest_object(const ray *const r, hit_description *const h) const override;
+        bool    found_nearer_object(const ray *const r, const float t) const override;
+
+        /* Wide bvh statistics */
+        int     number_of_nodes()   const override;
+        int     number_of_leaves()  const override;
+        float   sah_cost()          const override;
+
+        /* Scene bounds */
+        const point_t<> & scene_lower_bound() const override { return _builder.scene_lower_bound(); }
+        const point_t<> & scene_upper_bound() const override { return _builder.scene_upper_bound(); }
+
+    private :
+        /* Stack element for tracing through the wide bvh */
+        struct wide_bvh_stack_element
+        {
+            float   t_min;
+            int     idx;
+            int     size;
+        };
+
+        /* The stack is mutable because it will never be known to a user of this class */
+        const primitive_store &                             _prims;
+        mutable wide_bvh_stack_element                      _wbvh_stack[MAX_WIDE_BVH_STACK_HEIGHT];
+        wide_bvh_builder                                    _builder;
+        std::shared_ptr<std::vector<wide_bvh_node>>         _wbvh_base;
+        std::shared_ptr<std::vector<precomputed_triangle>>  _tris;
+};
+}; /* namespace raptor_raytracer */
@@ -0,0 +1,154 @@
+/* Standard headers */
+#include <algorithm>
+
+/* Boost headers */
+
+/* Common headers */
+#include "logging.h"
+
+/* Ray tracer headers */
+#include "wide_bvh_builder.h"
+
+
+namespace raptor_raytracer
+{
+/* Surface area of a binary bvh node */
+inline float surface_area(const bvh_node &n)
+{
+    const point_t<> dist(n.high_point() - n.low_point());
+    return (dist.x * dist.y) + (dist.x * dist.z) + (dist.y * dist.z);
+}
+
+
+/* Build a binary bvh and collapse it into nodes */
+int wide_bvh_builder::build(primitive_store *const primitives, std::vector<wide_bvh_node> *const nodes)
+{
+    /* Build binary tree */
+    std::vector<bvh_node> binary;
+    const int binary_root = _builder.build(primitives, &binary);
+
+    /* Guess at the number of wide nodes, the root is always first */
+    _binary = &binary;
+    _nodes  = nodes;
+    _nodes->clear();
+    _nodes->reserve((primitives->size() / (SIMD_WIDTH - 1)) + 1);
+    _nodes->emplace_back();
+
+    /* A single leaf, put it under an otherwise empty root */
+    const bvh_node &root = binary[binary_root];
+    if (root.is_leaf())
+    {
+        if (!root.is_empty())
+        {
+            (*_nodes)[0].create_leaf_child(0, root.low_point(), root.high_point(), root.begin_index(), root.end_index());
+        }
+    }
+    else
+    {
+        collapse(binary_root, 0);
+    }
+
+    /* Done with the binary tree */
+    _binary = nullptr;
+    // BOOST_LOG_TRIVIAL(trace) << "Collapsed " << binary.size() << " binary nodes to " << _nodes->size() << " wide nodes";
+
+    return 0;
+}
+
+
+/* Collapse the children of binary node binary_idx into wide node wide_idx */
+void wide_bvh_builder::collapse(const int binary_idx, const int wide_idx)
+{
+    /* Open the largest generic child until the node is full */
+    int children[SIMD_WIDTH];
+    int nr_children = 2;
+    children[0] = (*_binary)[binary_idx].left_index();
+    children[1] = (*_binary)[binary_idx].right_index();
+    while (nr_children < SIMD_WIDTH)
+    {
+        int largest = -1;
+        float largest_sa = -1.0f;
+        for (int i = 0; i < nr_children; ++i)
+        {
+            const bvh_node &child = (*_binary)[children[i]];
+            if (!child.is_leaf())
+            {
+                const float sa = surface_area(child);
+                if (sa > largest_sa)
+                {
+                    largest     = i;
+                    largest_sa  = sa;
+                }
+            }
+        }
+
+        /* All children are leaves */
+        if (largest < 0)
+        {
+            break;
+        }
+
+        const int opened = children[largest];
+        children[largest]       = (*_binary)[opened].left_index();
+        children[nr_children++] = (*_binary)[opened].right_index();
+    }
+
+    /* Create the children, generic children are collapsed depth first */
+    for (int i = 0; i < nr_children; ++i)
+    {
+        const bvh_node &child = (*_binary)[children[i]];
+        if (child.is_leaf())
+        {
+            if (!child.is_empty())
+            {
+                (*_nodes)[wide_idx].create_leaf_child(i, child.low_point(), child.high_point(), child.begin_index(), child.end_index());
+            }
+        }
+        else
+        {
+            /* Careful, this invalidates references to _nodes */
+            const int child_idx = _nodes->size();
+            _nodes->emplace_back();
+            (*_nodes)[wide_idx].create_generic_child(i, child.low_point(), child.high_point(), child_idx);
+            collapse(children[i], child_idx);
+        }
+    }
+
+    order_children(wide_idx);
+}
+
+
+/* Find the front to back order of the children for rays in each octant */
+void wide_bvh_builder::order_children(const int wide_idx)
+{
+    wide_bvh_node &node = (*_nodes)[wide_idx];
+
+    /* Child centres, empty children go last */
+    point_t<> centres[SIMD_WIDTH];
+    for (int i = 0; i < SIMD_WIDTH; ++i)
+    {
+        centres[i] = (node.low_point(i) + node.high_point(i)) * 0.5f;
+    }
+
+    for (int o = 0; o < 8; ++o)
+    {
+        const point_t<> dir(((o & 0x1) ? -1.0f : 1.0f), ((o & 0x2) ? -1.0f : 1.0f), ((o & 0x4) ? -1.0f : 1.0f));
+        float dist[SIMD_WIDTH];
+        int   order[SIMD_WIDTH];
+        for (int i = 0; i < SIMD_WIDTH; ++i)
+        {
+            dist[i]     = node.is_empty(i) ? MAX_DIST : dot_product(dir, centres[i]);
+            order[i]    = i;
+        }
+
+        std::stable_sort(&order[0], &order[SIMD_WIDTH], [&dist](const int l, const int r) { return dist[l] < dist[r]; });
+
+        std::uint64_t packed = 0;
+        for (int i = 0; i < SIMD_WIDTH; ++i)
+        {
+            packed |= static_cast<std::uint64_t>(order[i]) << (i << 2);
+        }
+        node.set_order(o, packed);
+    }
+}
+}; /* namespace raptor_raytracer */
@@ -0,0 +1,39 @@
+#pragma once
+
+/* Standard headers */
+#include <vector>
+
+/* Boost headers */
+
+/* Ray tracer headers */
+#include "bvh_builder.h"
+#include "bvh_node.h"
+#include "wide_bvh_node.h"
+#include "primitive_store.h"
+
+
+namespace raptor_raytracer
+{
+/* Build a binary bvh and collapse it into nodes with SIMD_WIDTH children */
+class wide_bvh_builder
+{
+    public :
+        wide_bvh_builder(const float alpha = 0.4f, const float delta = 20.0f, const float max_leaf_sah_factor = 0.00000000009f, const int max_down_phase_depth = 35) :
+        _builder(alpha, delta, max_leaf_sah_factor, max_down_phase_depth), _binary(nullptr), _nodes(nullptr) {  }
+
+        /* Returns the index of the root node, which is always 0 */
+        int build(primitive_store *const primitives, std::vector<wide_bvh_node> *const nodes);
+
+        /* Access to the trees bounds */
+        const point_t<> & scene_upper_bound() const { return _builder.scene_upper_bound(); }
+        const point_t<> & scene_lower_bound() const { return _builder.scene_lower_bound(); }
+
+    private :
+        void collapse(const int binary_idx, const int wide_idx);
+        void order_children(const int wide_idx);
+
+        bvh_builder                         _builder;
+        const std::vector<bvh_node> *       _binary;
+        std::vector<wide_bvh_node> *        _nodes;
+};
+}; /* namespace raptor_raytracer */
@@ -0,0 +1,140 @@
+#pragma once
+
+/* Standard headers */
+#include <cstdint>
+
+/* Boost headers */
+
+/* Common headers */
+#include "common.h"
+#include "simd.h"
+
+/* Ray tracer headers */
+#include "ray.h"
+
+
+namespace raptor_raytracer
+{
+/* The child ordering of a node is packed 4 bits per child */
+static_assert(SIMD_WIDTH <= 16, "Error: Wide bvh child order doesnt fit in 64 bits");
+
+/* A ray with everything needed to intersect the children of a wide bvh node precomputed */
+struct wide_bvh_ray
+{
+    wide_bvh_ray(const ray &r, const point_t<> &i_rd) :
+        ogn_x(r.get_x0()), ogn_y(r.get_y0()), ogn_z(r.get_z0()), i_rd_x(i_rd.x), i_rd_y(i_rd.y), i_rd_z(i_rd.z),
+        near_x((i_rd.x < 0.0f) ? 3 : 0), near_y((i_rd.y < 0.0f) ? 4 : 1), near_z((i_rd.z < 0.0f) ? 5 : 2),
+        octant((i_rd.x < 0.0f) | ((i_rd.y < 0.0f) << 1) | ((i_rd.z < 0.0f) << 2))
+    {  }
+
+    vfp_t   ogn_x;      /* Ray origin broadcast to all lanes                */
+    vfp_t   ogn_y;
+    vfp_t   ogn_z;
+    vfp_t   i_rd_x;     /* Inverse ray direction broadcast to all lanes     */
+    vfp_t   i_rd_y;
+    vfp_t   i_rd_z;
+    int     near_x;     /* Index of the bounds to enter each axis through   */
+    int     near_y;
+    int     near_z;
+    int     octant;     /* Octant of the ray direction                      */
+};
+
+
+/* A bvh node with SIMD_WIDTH children whose bounds are held as structure of arrays so they can be tested together */
+class wide_bvh_node
+{
+    public :
+        wide_bvh_node()
+        {
+            for (int i = 0; i < SIMD_WIDTH; ++i)
+            {
+                clear_child(i);
+            }
+
+            for (int i = 0; i < 8; ++i)
+            {
+                _order[i] = 0;
+            }
+        }
+
+        /* Allow default DTOR, copy CTOR and assignment operator (for using in vector) */
+
+        /* Tree construction */
+        void clear_child(const int i)
+        {
+            /* Inverted bounds that no ray can hit */
+            _bounds[0][i]   =  MAX_DIST;
+            _bounds[1][i]   =  MAX_DIST;
+            _bounds[2][i]   =  MAX_DIST;
+            _bounds[3][i]   = -MAX_DIST;
+            _bounds[4][i]   = -MAX_DIST;
+            _bounds[5][i]   = -MAX_DIST;
+            _child[i]       = -1;
+            _size[i]        = 0;
+        }
+
+        void create_leaf_child(const int i, const point_t<> &low, const point_t<> &high, const int b, const int e)
+        {
+            assert(e > b);
+            set_bounds(i, low, high);
+            _child[i]   = b;
+            _size[i]    = e - b;
+        }
+
+        void create_generic_child(const int i, const point_t<> &low, const point_t<> &high, const int idx)
+        {
+            set_bounds(i, low, high);
+            _child[i]   = idx;
+            _size[i]    = 0;
+        }
+
+        void set_order(const int octant, const std::uint64_t order)
+        {
+            _order[octant] = order;
+        }
+
+        /* Tree traversal */
+        int             child(const int i)          const { return _child[i];               }
+        int             size(const int i)           const { return _size[i];                }
+        bool            is_empty(const int i)       const { return _child[i] < 0;           }
+        bool            is_leaf(const int i)        const { return _size[i] > 0;            }
+        std::uint64_t   order(const int octant)     const { return _order[octant];          }
+        point_t<>       low_point(const int i)      const { return point_t<>(_bounds[0][i], _bounds[1][i], _bounds[2][i]);  }
+        point_t<>       high_point(const int i)     const { return point_t<>(_bounds[3][i], _bounds[4][i], _bounds[5][i]);  }
+
+        /* Intersect all children with r returning a mask of those hit before t_max, t_min gets the entry distances */
+        int intersection_distance(const wide_bvh_ray &r, const float t_max, vfp_t *const t_min) const
+        {
+            /* Distance to the entry and exit planes */
+            /* Rays in the plane of a bound give NaNs, min and max return their second argument for NaNs so keep the clamps second */
+            const vfp_t near_x((vfp_t(_bounds[r.near_x]) - r.ogn_x) * r.i_rd_x);
+            const vfp_t near_y((vfp_t(_bounds[r.near_y]) - r.ogn_y) * r.i_rd_y);
+            const vfp_t near_z((vfp_t(_bounds[r.near_z]) - r.ogn_z) * r.i_rd_z);
+            const vfp_t far_x((vfp_t(_bounds[3 - r.near_x]) - r.ogn_x) * r.i_rd_x);
+            const vfp_t far_y((vfp_t(_bounds[5 - r.near_y]) - r.ogn_y) * r.i_rd_y);
+            const vfp_t far_z((vfp_t(_bounds[7 - r.near_z]) - r.ogn_z) * r.i_rd_z);
+
+            /* Hit if exit after enter */
+            const vfp_t enter_t(max(max(near_x, near_y), max(near_z, vfp_zero)));
+            const vfp_t exit_t(min(min(far_x, far_y), min(far_z, vfp_t(t_max))));
+            *t_min = enter_t;
+            return move_mask(enter_t <= exit_t);
+        }
+
+    private :
+        void set_bounds(const int i, const point_t<> &low, const point_t<> &high)
+        {
+            _bounds[0][i] = low.x;
+            _bounds[1][i] = low.y;
+            _bounds[2][i] = low.z;
+            _bounds[3][i] = high.x;
+            _bounds[4][i] = high.y;
+            _bounds[5][i] = high.z;
+        }
+
+        float           _bounds[6][SIMD_WIDTH]; /* Low x, y, z then high x, y, z of each child                  */
+        int             _child[SIMD_WIDTH];     /* Index of the child node or first primitive of a leaf         */
+        int             _size[SIMD_WIDTH];      /* Number of primitives in a leaf, 0 for generic nodes          */
+        std::uint64_t   _order[8];              /* Front to back child order for each octant, 4 bits per child  */
+} __attribute__ ((aligned(64)));
+}; /* namespace raptor_raytracer */
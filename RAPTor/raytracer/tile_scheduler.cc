@@ -0,0 +1,117 @@
+/* Standard headers */
+#include <algorithm>
+
+/* Ray tracer headers */
+#include "tile_scheduler.h"
+
+
+namespace raptor_raytracer
+{
+tile_scheduler::tile_scheduler(const int x_res, const int y_res, const int tile_size, const int coarsest, const tile_order_t order) :
+    _cancelled(false), _x_res(x_res), _y_res(y_res), _tile_size(tile_size), _coarsest(coarsest), _passes(0)
+{
+    assert((tile_size & (tile_size - 1)) == 0);
+    assert((coarsest  & (coarsest  - 1)) == 0);
+    assert((tile_size % coarsest) == 0);
+
+    /* One pass per power of 2 from coarsest to 1 */
+    for (int s = coarsest; s > 0; s >>= 1)
+    {
+        ++_passes;
+    }
+
+    /* Order the tiles */
+    const int x_tiles = (x_res + tile_size - 1) / tile_size;
+    const int y_tiles = (y_res + tile_size - 1) / tile_size;
+    _tiles.reserve(x_tiles * y_tiles);
+    switch (order)
+    {
+        case tile_order_t::hilbert :
+            hilbert_order(x_tiles, y_tiles);
+            break;
+        case tile_order_t::spiral :
+            spiral_order(x_tiles, y_tiles);
+            break;
+        default :
+            assert(!"Error unknown tile order");
+            break;
+    }
+    assert(static_cast<int>(_tiles.size()) == (x_tiles * y_tiles));
+}
+
+
+/* Walk a Hilbert curve over the smallest power of 2 square covering the tiles, skipping those outside the image */
+void tile_scheduler::hilbert_order(const int x_tiles, const int y_tiles)
+{
+    int n = 1;
+    while ((n < x_tiles) || (n < y_tiles))
+    {
+        n <<= 1;
+    }
+
+    for (int d = 0; d < (n * n); ++d)
+    {
+        /* Convert distance along the curve to co-ordinates */
+        int x = 0;
+        int y = 0;
+        for (int s = 1, t = d; s < n; s <<= 1, t >>= 2)
+        {
+            const int rx = 1 & (t >> 1);
+            const int ry = 1 & (t ^ rx);
+            if (ry == 0)
+            {
+                if (rx == 1)
+                {
+                    x = s - 1 - x;
+                    y = s - 1 - y;
+                }
+                std::swap(x, y);
+            }
+
+            x += s * rx;
+            y += s * ry;
+        }
+
+        if ((x < x_tiles) && (y < y_tiles))
+        {
+            add_tile(x, y);
+        }
+    }
+}
+
+
+/* Walk outwards from the centre tile in an ever larger square, skipping tiles outside the image */
+void tile_scheduler::spiral_order(const int x_tiles, const int y_tiles)
+{
+    const int dx[4] = { 1, 0, -1,  0 };
+    const int dy[4] = { 0, 1,  0, -1 };
+
+    int x = (x_tiles - 1) >> 1;
+    int y = (y_tiles - 1) >> 1;
+    add_tile(x, y);
+
+    const int total = x_tiles * y_tiles;
+    for (int leg = 0; static_cast<int>(_tiles.size()) < total; ++leg)
+    {
+        /* Legs grow by 1 every other turn */
+        const int length = (leg >> 1) + 1;
+        for (int i = 0; i < length; ++i)
+        {
+            x += dx[leg & 0x3];
+            y += dy[leg & 0x3];
+            if ((x >= 0) && (x < x_tiles) && (y >= 0) && (y < y_tiles))
+            {
+                add_tile(x, y);
+            }
+        }
+    }
+}
+
+
+void tile_scheduler::add_tile(const int x, const int y)
+{
+    const int x0 = x * _tile_size;
+    const int y0 = y * _tile_size;
+    _tiles.emplace_back(x0, y0, std::min(x0 + _tile_size, _x_res), std::min(y0 + _tile_size, _y_res));
+}
+}; /* namespace raptor_raytracer */
@@ -0,0 +1,67 @@
+#pragma once
+
+/* Standard headers */
+#include <atomic>
+#include <vector>
+
+/* Boost headers */
+#include "boost/noncopyable.hpp"
+
+/* Common headers */
+#include "common.h"
+
+
+namespace raptor_raytracer
+{
+/* Order to trace tiles in */
+enum class tile_order_t : char { hilbert = 0, spiral = 1 };
+
+/* A rectangle of pixels, the last row and column of tiles may be clipped by the image */
+struct tile
+{
+    tile(const int x0, const int y0, const int x1, const int y1) : x0(x0), y0(y0), x1(x1), y1(y1) {  }
+
+    int x0;
+    int y0;
+    int x1;
+    int y1;
+};
+
+/* Class to split an image into tiles and order them along a space filling curve for tracing.
+   The image is traced in passes, each pass traces one pixel from each block of pass_step() pixels
+   square and fills the block so a rough image is available quickly. Tracing may be cancelled from
+   any thread, tracing stops at the next tile */
+class tile_scheduler : private boost::noncopyable
+{
+    public :
+        /* CTOR, tile_size must be a power of 2 and a multiple of coarsest and PACKET_WIDTH */
+        tile_scheduler(const int x_res, const int y_res, const int tile_size = 32, const int coarsest = 1, const tile_order_t order = tile_order_t::hilbert);
+
+        /* Access functions */
+        const tile &    get_tile(const int i)   const { return _tiles[i];                   }
+        int number_of_tiles()                   const { return _tiles.size();               }
+        int number_of_passes()                  const { return _passes;                     }
+        int tile_size()                         const { return _tile_size;                  }
+
+        /* The size of the block of pixels each sample fills in pass p */
+        int pass_step(const int p)              const { return _coarsest >> p;             }
+
+        /* Cancellation, this is the only part of the class that is thread safe */
+        tile_scheduler& cancel()                      { _cancelled.store(true);  return *this; }
+        tile_scheduler& reset()                       { _cancelled.store(false); return *this; }
+        bool cancelled()                        const { return _cancelled.load(std::memory_order_relaxed); }
+
+    private :
+        void hilbert_order(const int x_tiles, const int y_tiles);
+        void spiral_order(const int x_tiles, const int y_tiles);
+        void add_tile(const int x, const int y);
+
+        std::vector<tile>   _tiles;
+        std::atomic<bool>   _cancelled;
+        const int           _x_res;
+        const int           _y_res;
+        const int           _tile_size;
+        const int           _coarsest;
+        int                 _passes;
+};
+}; /* namespace raptor_raytracer */
@@ -5,9 +5,12 @@
 
 /* Ray tracer headers */
 #include "common.h"
+#include "instance_transform.h"
 #include "line.h"
+#include "random_stream.h"
 #include "ray.h"
 #include "secondary_ray_data.h"
+#include "traversal_statistics.h"
 #ifdef SIMD_PACKET_TRACING
 #include "packet_ray.h"
 #include "frustrum.h"
@@ -17,24 +20,27 @@
 
 namespace raptor_raytracer
 {
+/* Forward declarations */
+class scene_cache;
+
+/* Vertex normals and texture co-ordinates of a triangle. These point into the arrays */
+/* shared between all triangles in a primitive_store. Either set may be absent        */
+struct vertex_attributes
+{
+    const point_t<> *   vn[3];
+    const point_t<> *   vt[3];
+};
+
+
 class triangle : boost::noncopyable
 {
     public :
-        triangle(material *const m, const point_t<> &a, const point_t<> &b, const point_t<> &c, bool l = false, const point_t<> *v_n = nullptr, const point_t<> *v_t = nullptr);
-        ~triangle()
-        {
-            /* REVISIT -- Consider using indices for these */
-            if (this->vnt != nullptr)
-            {
-                delete [] this->vnt;
-            }
-        };
+        triangle(material *const m, const point_t<> &a, const point_t<> &b, const point_t<> &c, bool l = false, const vertex_attributes *const v = nullptr);
 
+        /* Allow default DTOR, the vertex attributes are owned by the primitive_store */
         triangle(triangle &&r) :
-            m(r.m), vnt(r.vnt), vertex_a(r.vertex_a), vertex_b(r.vertex_b), vertex_c(r.vertex_c), n(r.n)
-        {
-            r.vnt = nullptr;
-        }
+            m(r.m), vnt(r.vnt), vertex_a(r.vertex_a), vertex_b(r.vertex_b), vertex_c(r.vertex_c)
+        {  }
         
         /* Find out if this is a light/transparent object for shadow rays to ignore */
         bool get_light()            const { return this->m & 0x1;                           }
@@ -55,6 +61,9 @@ class triangle : boost::noncopyable
 
         point_t<> low_bound()         const { return min(vertex_a, min(vertex_b, vertex_c));  }
         point_t<> high_bound()        const { return max(vertex_a, max(vertex_b, vertex_c));  }
+
+        /* Animation, the vertex normals and texture co-ordinates are unchanged */
+        inline void move_vertices(const point_t<> &a, const point_t<> &b, const point_t<> &c);
         
         /* Ray tracing functions */
         inline void is_intersecting(const ray *const r, hit_description *const h) const;
@@ -62,20 +71,22 @@ class triangle : boost::noncopyable
         inline void is_intersecting(const packet_ray *const r, packet_hit_description *const h, vint_t *const i_o, const unsigned int size, const int tri_idx) const;
         inline void is_intersecting(const frustrum &f, const packet_ray *const r, packet_hit_description *const h, vint_t *const i_o, const unsigned *c, const unsigned size, const int tri_idx) const;
 #endif
-        inline point_t<> normal_at_point(ray *const r, hit_description *const h) const;
+        inline point_t<> normal_at_point(ray *const r, hit_description *const h, const instance_transform *const xfm = nullptr) const;
         inline void find_rays(ray *const r, const point_t<> &d, const int n) const;
         
-        /* Generate secondary rays for packet tracing */
-        inline point_t<> generate_rays(const ray_trace_engine &r, ray &i, point_t<> *const text, hit_description *const h, secondary_ray_data *const rl, secondary_ray_data *const rf) const
+        /* Generate secondary rays for packet tracing, instanced triangles pass the transform to world space */
+        inline point_t<> generate_rays(const ray_trace_engine &r, ray &i, point_t<> *const text, hit_description *const h, secondary_ray_data *const rl, secondary_ray_data *const rf, const instance_transform *const xfm = nullptr) const
         {
             /* Calculate the normal */
-            point_t<> norm(normal_at_point(&i, h));
+            point_t<> norm(normal_at_point(&i, h, xfm));
 
             /* Interpolate the texture co-ordinate if possible */
+            /* The third componant is replaced by the texture co-ordinates per unit length of the triangle for filtering */
             point_t<> vt(MAX_DIST);
-            if ((this->vnt != nullptr) && (this->vnt[3].x != MAX_DIST))
+            if ((this->vnt != nullptr) && (this->vnt->vt[0] != nullptr))
             {
-                vt = (h->u * this->vnt[5]) + (h->v * this->vnt[4]) + ((1.0f - (h->u + h->v)) * this->vnt[3]);
+                vt = (h->u * (*this->vnt->vt[2])) + (h->v * (*this->vnt->vt[1])) + ((1.0f - (h->u + h->v)) * (*this->vnt->vt[0]));
+                vt.z = texture_density();
             }
 
             get_material()->generate_rays(r, i, &norm, vt, h->h, rl, rf);
@@ -96,19 +107,43 @@ class triangle : boost::noncopyable
             get_material()->combind_secondary_rays(r, c, rl, rf);
         }
 
+        /* The material, hits sharing it are shaded together */
+        const material * get_shader() const { return get_material(); }
+
     private : 
+        friend class scene_cache;
+
         material * get_material() const
         {
             return reinterpret_cast<material *>(this->m & ~0x1);
         }
 
+        /* The normal is only needed for shading so it is calculated on demand rather than stored */
+        point_t<> geometry_normal() const
+        {
+            point_t<> n;
+            const point_t<> dir_b(this->vertex_b - this->vertex_a);
+            const point_t<> dir_c(this->vertex_c - this->vertex_a);
+            cross_product(dir_b, dir_c, &n);
+            normalise(&n);
+            return n;
+        }
+
+        /* Square root of the ratio of the area of the triangle in texture space to its area */
+        float texture_density() const
+        {
+            const point_t<> &vt_a = *this->vnt->vt[0];
+            const float vt_area = std::fabs(((this->vnt->vt[1]->x - vt_a.x) * (this->vnt->vt[2]->y - vt_a.y)) - ((this->vnt->vt[2]->x - vt_a.x) * (this->vnt->vt[1]->y - vt_a.y)));
+            const float area = magnitude(cross_product(this->vertex_b - this->vertex_a, this->vertex_c - this->vertex_a));
+            return (area > 0.0f) ? std::sqrt(vt_area / area) : 0.0f;
+        }
+
         static_assert(sizeof(std::int64_t) == sizeof(material *), "Error: Material pointers dont fit in std::int64_t");
-        std::int64_t    m;          /* Pointer to the triangles shader          */
-        point_t<>       * vnt;        /* Pointer to vertex normals and textures   */
-        point_t<>         vertex_a;   /* Vertex a of the triangle                 */
-        point_t<>         vertex_b;   /* Vertex b of the triangle                 */
-        point_t<>         vertex_c;   /* Vertex c of the triangle                 */
-        point_t<>         n;          /* Normal of the triangle                   */
+        std::int64_t                m;          /* Pointer to the triangles shader          */
+        const vertex_attributes *   vnt;        /* Pointer to vertex normals and textures   */
+        point_t<>                   vertex_a;   /* Vertex a of the triangle                 */
+        point_t<>                   vertex_b;   /* Vertex b of the triangle                 */
+        point_t<>                   vertex_c;   /* Vertex c of the triangle                 */
 };
 
 
@@ -116,63 +151,40 @@ class triangle : boost::noncopyable
  Constructor for the triangle.
  
  The constructor takes 3 points defining the vetices of the 
- triangle.
- 
- The normal and the bounding box of the triangle are 
- precomputed.
+ triangle and optionally its vertex normals and texture
+ co-ordinates, which must outlive the triangle.
 ************************************************************/
-inline triangle::triangle(material *const m, const point_t<> &a, const point_t<> &b, const point_t<> &c, bool l, const point_t<> *v_n, const point_t<> *v_t) : 
-    m(reinterpret_cast<std::int64_t>(m)), vertex_a(a), vertex_b(b), vertex_c(c)
+inline triangle::triangle(material *const m, const point_t<> &a, const point_t<> &b, const point_t<> &c, bool l, const vertex_attributes *const v) : 
+    m(reinterpret_cast<std::int64_t>(m)), vnt(v), vertex_a(a), vertex_b(b), vertex_c(c)
 { 
     /* Vertex checks */
     assert(this->vertex_a != this->vertex_b);
     assert(this->vertex_a != this->vertex_c);
     assert(this->vertex_b != this->vertex_c);
+    assert(geometry_normal() != 0.0f);
 
     if (l)
     {
         this->m |= 0x1;
     }
+}
 
-    if ((v_n != nullptr) || (v_t != nullptr))
-    {
-        this->vnt = new point_t<> [6];
-    }
-    else
-    {
-        this->vnt = nullptr;
-    }
-
-    /* Store vertex normals */
-    if (v_n != nullptr)
-    {
-        this->vnt[0] = v_n[0];
-        this->vnt[1] = v_n[1];
-        this->vnt[2] = v_n[2];
-    }
-    else if (v_t != nullptr)
-    {
-        this->vnt[0].x = MAX_DIST;
-    }
 
-    /* Store texture vertex */
-    if (v_t != nullptr)
-    {
-        this->vnt[3] = v_t[0];
-        this->vnt[4] = v_t[1];
-        this->vnt[5] = v_t[2];
-    }
-    else if (v_n != nullptr)
-    {
-        this->vnt[3].x = MAX_DIST;
-    }
+/***********************************************************
+ move_vertices moves the triangle to the vertices a, b and c.
 
-    /* Calculate the normal */
-    const point_t<> dir_b(this->vertex_b - this->vertex_a);
-    const point_t<> dir_c(this->vertex_c - this->vertex_a);
-    cross_product(dir_b, dir_c, &this->n);
-    assert(this->n != 0.0f);
-    normalise(&this->n);
+ Any spatial sub division containing the triangle must be
+ refit or rebuilt before tracing again.
+************************************************************/
+inline void triangle::move_vertices(const point_t<> &a, const point_t<> &b, const point_t<> &c)
+{
+    this->vertex_a = a;
+    this->vertex_b = b;
+    this->vertex_c = c;
+    assert(this->vertex_a != this->vertex_b);
+    assert(this->vertex_a != this->vertex_c);
+    assert(this->vertex_b != this->vertex_c);
+    assert(geometry_normal() != 0.0f);
 }
 
 
@@ -189,6 +201,8 @@ inline triangle::triangle(material *const m, const point_t<> &a, const point_t<>
 ************************************************************/
 inline void triangle::is_intersecting(const ray *const r, hit_description *const h) const 
 {
+    COUNT_TRAVERSAL(triangle_tests, 1);
+
     /* Find vectors for two edges sharing V1 */
     const point_t<> e1(vertex_c - vertex_a);
     const point_t<> e2(vertex_b - vertex_a);
@@ -241,6 +255,8 @@ inline void triangle::is_intersecting(const ray *const r, hit_description *const
 ************************************************************/
 inline void triangle::is_intersecting(const packet_ray *const r, packet_hit_description *const h, vint_t *const i_o, const unsigned int size, const int tri_idx) const 
 {
+    COUNT_TRAVERSAL(triangle_tests, size);
+
     /* Find vectors for two edges sharing V1 */
     const vfp_t e1_x(vertex_c.x - vertex_a.x);
     const vfp_t e1_y(vertex_c.y - vertex_a.y);
@@ -310,6 +326,8 @@ inline void triangle::is_intersecting(const packet_ray *const r, packet_hit_desc
 ************************************************************/
 inline void triangle::is_intersecting(const frustrum &f, const packet_ray *const r, packet_hit_description *const h, vint_t *const i_o, const unsigned *c, const unsigned size, const int tri_idx) const 
 {
+    COUNT_TRAVERSAL(triangle_tests, size);
+
     /* Edge culling */
     /* Frustrum dot triangle */
 //     const vfp_t full_fdn(((f.get_dir(0) * vfp_t(n.x)) + (f.get_dir(1) * vfp_t(n.y)) + (f.get_dir(2) * vfp_t(n.z))));
@@ -457,27 +475,36 @@ inline void triangle::is_intersecting(const frustrum &f, const packet_ray *const
  point p. h is used to determine from which side the triangle 
  is hit.
  
- Return the precalculated normal or the interpolated normal
+ Return the geometry normal or the interpolated normal
  if vertex normals are used. Also set weather the ray is
  entering of leaving the triangle.
 ************************************************************/
-inline point_t<> triangle::normal_at_point(ray *const r, hit_description *const h) const
+inline point_t<> triangle::normal_at_point(ray *const r, hit_description *const h, const instance_transform *const xfm) const
 {
-    const float denom  = dot_product(this->n, r->get_dir());
+    /* Move the plane of instanced triangles to world space */
+    const point_t<> n(geometry_normal());
+    const point_t<> geom_norm((xfm == nullptr) ? n : xfm->direction_to_world(n));
+    const point_t<> plane_point((xfm == nullptr) ? this->vertex_c : xfm->point_to_world(this->vertex_c));
+
+    const float denom  = dot_product(geom_norm, r->get_dir());
     /* Re-calculate the intesection of the ray with the plane of the triangle */
     /* This gives a more accurate hit point to adjust the ray to */
-    const float num    = dot_product(this->n, (this->vertex_c - r->get_dst()));
+    const float num    = dot_product(geom_norm, (plane_point - r->get_dst()));
     r->change_length(num / denom);
 
     /* Interpolate the vertex normals */
     point_t<> shader_norm;
-    if ((this->vnt != nullptr) && (this->vnt[0].x != MAX_DIST))
+    if ((this->vnt != nullptr) && (this->vnt->vn[0] != nullptr))
     {
-        shader_norm = (h->u * this->vnt[2]) + (h->v * this->vnt[1]) + ((1.0f - (h->u + h->v)) * this->vnt[0]);
+        shader_norm = (h->u * (*this->vnt->vn[2])) + (h->v * (*this->vnt->vn[1])) + ((1.0f - (h->u + h->v)) * (*this->vnt->vn[0]));
+        if (xfm != nullptr)
+        {
+            shader_norm = xfm->direction_to_world(shader_norm);
+        }
     }
     else
     {
-        shader_norm = this->n;
+        shader_norm = geom_norm;
     }
 
     /* If the line is leaving the volume enclosed by 
@@ -485,12 +512,12 @@ inline point_t<> triangle::normal_at_point(ray *const r, hit_description *const
     if (denom > 0.0f)
     {
         shader_norm = -shader_norm;
-        r->set_geometry_normal(-this->n);
+        r->set_geometry_normal(-geom_norm);
         h->h = hit_t::in_out;
     }
     else
     {
-        r->set_geometry_normal(this->n);
+        r->set_geometry_normal(geom_norm);
         h->h = hit_t::out_in;
     }
     
@@ -508,12 +535,13 @@ inline void triangle::find_rays(ray *const r, const point_t<> &d, const int n) c
     const float gamma_scale   = 1.0f / static_cast<float>((n >> 4) + ((n & 0xc) != 0) + 1);
 
     /* Create n rays, each with a random offset in a fixed volume */
+    random_stream &rng = random_stream::thread_stream();
     for (int i = 0; i < n; i++)
     {
         /* Generate a legal barycenrtic co-ordinate */
         const int eigths    = (i >> 2) & ~0x1;
-        const float beta    = gen_random_mersenne_twister() * (beta_scale  * static_cast<float>(eigths + (i & 0x1)));
-        const float gamma   = gen_random_mersenne_twister() * (gamma_scale * static_cast<float>(eigths + (i & 0x2))) * (1.0f - beta);
+        const float beta    = rng.next() * (beta_scale  * static_cast<float>(eigths + (i & 0x1)));
+        const float gamma   = rng.next() * (gamma_scale * static_cast<float>(eigths + (i & 0x2))) * (1.0f - beta);
         const float alpha   = 1.0f - (beta + gamma);
 
         /* Convert to cartesian co-ordinates */
@@ -0,0 +1,190 @@
+#ifdef STAND_ALONE
+#define BOOST_TEST_MODULE bvh test
+
+/* Common headers */
+#include "logging.h"
+
+/* Initialise logger */
+const raptor_physics::init_logger init_logger;
+#endif /* #ifdef STAND_ALONE */
+
+/* Standard headers */
+#include <vector>
+
+/* Boost headerrs */
+#include "boost/test/unit_test.hpp"
+
+/* Ray tracer headers */
+#include "phong_shader.h"
+#include "bvh.h"
+
+
+namespace raptor_raytracer
+{
+namespace test
+{
+const float result_tolerance = 0.00001f;
+
+struct bvh_fixture
+{
+    bvh_fixture() :
+    mat(new phong_shader(ext_colour_t(255.0f, 255.0f, 255.0f)))
+    {
+        /* Layers of squares */
+        for (int i = 0; i < 10; ++i)
+        {
+            for (int j = 0; j < 10; ++j)
+            {
+                for (int k = 0; k < 4; ++k)
+                {
+                    const float x = static_cast<float>(k * 3);
+                    const float y = static_cast<float>(i);
+                    const float z = static_cast<float>(j) + (k * 0.25f);
+                    geometry.push_back(point_t<>(x, y, z));
+                    geometry.push_back(point_t<>(x, y + 0.9f, z));
+                    geometry.push_back(point_t<>(x, y + 0.9f, z + 0.9f));
+                    geometry.push_back(point_t<>(x, y, z));
+                    geometry.push_back(point_t<>(x, y + 0.9f, z + 0.9f));
+                    geometry.push_back(point_t<>(x, y, z + 0.9f));
+                }
+            }
+        }
+
+        for (auto *s : { &uut_store, &rot_store, &exp_store })
+        {
+            for (int i = 0; i < static_cast<int>(geometry.size()); i += 3)
+            {
+                s->emplace_back(mat.get(), geometry[i], geometry[i + 1], geometry[i + 2], false);
+            }
+        }
+    }
+
+    /* Move triangle i to where triangle (i * stride) % n was built, plus offset */
+    void move(primitive_store *const s, const int stride, const point_t<> &offset) const
+    {
+        const int n = s->size();
+        for (int i = 0; i < n; ++i)
+        {
+            const int j = ((i * stride) % n) * 3;
+            s->primitive(i)->move_vertices(geometry[j] + offset, geometry[j + 1] + offset, geometry[j + 2] + offset);
+        }
+    }
+
+    /* Fire rays in all octants from a few origins and check uut finds the same hits as exp */
+    void check_rays(const bvh &uut, const bvh &exp) const
+    {
+        const point_t<> origins[3] = { point_t<>(-5.0f, 4.5f, 5.0f), point_t<>(15.0f, -2.0f, 12.0f), point_t<>(4.5f, 4.5f, 4.5f) };
+        for (const auto &o : origins)
+        {
+            for (int i = -4; i <= 4; ++i)
+            {
+                for (int j = -4; j <= 4; ++j)
+                {
+                    for (int k = -1; k <= 1; k += 2)
+                    {
+                        const ray r(o, static_cast<float>(k), i * 0.23f, j * 0.19f);
+                        hit_description uut_h;
+                        hit_description exp_h;
+                        const int uut_i = uut.find_nearest_object(&r, &uut_h);
+                        const int exp_i = exp.find_nearest_object(&r, &exp_h);
+                        BOOST_CHECK((uut_i == -1) == (exp_i == -1));
+                        BOOST_CHECK_CLOSE(uut_h.d, exp_h.d, result_tolerance);
+                        BOOST_CHECK(uut.found_nearer_object(&r, 30.0f) == exp.found_nearer_object(&r, 30.0f));
+                    }
+                }
+            }
+        }
+    }
+
+    std::unique_ptr<material>   mat;
+    std::vector<point_t<>>      geometry;
+    primitive_store             uut_store;
+    primitive_store             rot_store;
+    primitive_store             exp_store;
+};
+
+BOOST_FIXTURE_TEST_SUITE( bvh_tests, bvh_fixture );
+
+BOOST_AUTO_TEST_CASE( refit_translate_test )
+{
+    bvh uut(uut_store);
+    const int nodes     = uut.number_of_nodes();
+    const int leaves    = uut.number_of_leaves();
+    BOOST_CHECK_CLOSE(uut.sah_degradation(), 1.0f, result_tolerance);
+
+    /* Translating everything shouldnt change the quality of the tree */
+    const point_t<> offset(2.0f, 1.0f, -3.0f);
+    move(&uut_store, 1, offset);
+    move(&exp_store, 1, offset);
+    uut.refit(false);
+    BOOST_CHECK(uut.number_of_nodes()  == nodes);
+    BOOST_CHECK(uut.number_of_leaves() == leaves);
+    BOOST_CHECK_CLOSE(uut.sah_degradation(), 1.0f, 0.01f);
+
+    bvh exp(exp_store);
+    check_rays(uut, exp);
+}
+
+BOOST_AUTO_TEST_CASE( refit_shuffle_test )
+{
+    bvh uut(uut_store);
+
+    /* Shuffling the triangles should degrade the tree, but it must still be correct */
+    move(&uut_store, 7, point_t<>(0.0f, 0.0f, 0.0f));
+    move(&exp_store, 7, point_t<>(0.0f, 0.0f, 0.0f));
+    uut.refit(false);
+    BOOST_CHECK(uut.sah_degradation() > 1.0f);
+
+    bvh exp(exp_store);
+    check_rays(uut, exp);
+}
+
+BOOST_AUTO_TEST_CASE( rotate_test )
+{
+    bvh uut(uut_store);
+    bvh rot(rot_store);
+
+    /* Rotations should recover some of the quality lost, without changing the number of nodes */
+    move(&uut_store, 7, point_t<>(0.0f, 0.0f, 0.0f));
+    move(&rot_store, 7, point_t<>(0.0f, 0.0f, 0.0f));
+    move(&exp_store, 7, point_t<>(0.0f, 0.0f, 0.0f));
+    uut.refit(false);
+    rot.refit(true);
+    BOOST_CHECK(rot.sah_cost() < uut.sah_cost());
+    BOOST_CHECK(rot.number_of_nodes()  == uut.number_of_nodes());
+    BOOST_CHECK(rot.number_of_leaves() == uut.number_of_leaves());
+
+    /* Repeated rotations should never make things worse */
+    const float sah = rot.sah_cost();
+    rot.refit(true);
+    BOOST_CHECK(rot.sah_cost() <= sah);
+
+    bvh exp(exp_store);
+    check_rays(rot, exp);
+}
+
+BOOST_AUTO_TEST_CASE( update_test )
+{
+    bvh uut(uut_store);
+    bvh rot(rot_store);
+
+    /* Nothing moved, nothing to rebuild */
+    BOOST_CHECK(!uut.update());
+
+    /* Shuffle, rebuilding if there is any degradation or only if it is huge */
+    move(&uut_store, 7, point_t<>(0.0f, 0.0f, 0.0f));
+    move(&rot_store, 7, point_t<>(0.0f, 0.0f, 0.0f));
+    move(&exp_store, 7, point_t<>(0.0f, 0.0f, 0.0f));
+    BOOST_CHECK( uut.update(1.0f));
+    BOOST_CHECK_CLOSE(uut.sah_degradation(), 1.0f, result_tolerance);
+    BOOST_CHECK(!rot.update(1000.0f));
+    BOOST_CHECK(rot.sah_degradation() > 1.0f);
+
+    bvh exp(exp_store);
+    check_rays(uut, exp);
+    check_rays(rot, exp);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+}; /* namespace test */
+}; /* namespace raptor_raytracer */
@@ -24,6 +24,7 @@ namespace raptor_raytracer
 namespace test
 {
 const float result_tolerance = 0.001f;
+const float mean_tolerance = 0.005f;    /* The mean of a run is random, a radius 5 circle sampled 10^6 times has a standard error of 0.0025 */
 
 /* Support class shared_normal tests */
 struct circle_sampler_fixture
@@ -56,14 +57,14 @@ BOOST_FIXTURE_TEST_SUITE( circle_sampler_tests, circle_sampler_fixture )
 BOOST_AUTO_TEST_CASE( random_unit_test )
 {
     circle_sampler::seed();
-    BOOST_CHECK(rand_unit_uut.sample().close(point_t<>( 0.13154f, 0.0f,  0.0f    ), result_tolerance));
-    BOOST_CHECK(rand_unit_uut.sample().close(point_t<>( 0.01615f, 0.0f,  0.45837f), result_tolerance));
-    BOOST_CHECK(rand_unit_uut.sample().close(point_t<>(-0.21435f, 0.0f,  0.04476f), result_tolerance));
-    BOOST_CHECK(rand_unit_uut.sample().close(point_t<>( 0.64942f, 0.0f, -0.19776f), result_tolerance));
-    BOOST_CHECK(rand_unit_uut.sample().close(point_t<>(-0.40171f, 0.0f,  0.84397f), result_tolerance));
-    BOOST_CHECK(rand_unit_uut.sample().close(point_t<>(-0.38637f, 0.0f, -0.34715f), result_tolerance));
-    BOOST_CHECK(rand_unit_uut.sample().close(point_t<>( 0.01684f, 0.0f,  0.03020f), result_tolerance));
-    BOOST_CHECK(rand_unit_uut.sample().close(point_t<>( 0.50010f, 0.0f, -0.17460f), result_tolerance));
+    BOOST_CHECK(rand_unit_uut.sample().close(point_t<>( 0.00777f, 0.0f,  0.0f    ), result_tolerance));
+    BOOST_CHECK(rand_unit_uut.sample().close(point_t<>( 0.06028f, 0.0f, -0.00739f), result_tolerance));
+    BOOST_CHECK(rand_unit_uut.sample().close(point_t<>(-0.01886f, 0.0f, -0.01029f), result_tolerance));
+    BOOST_CHECK(rand_unit_uut.sample().close(point_t<>(-0.38817f, 0.0f, -0.41490f), result_tolerance));
+    BOOST_CHECK(rand_unit_uut.sample().close(point_t<>(-0.09908f, 0.0f, -0.09455f), result_tolerance));
+    BOOST_CHECK(rand_unit_uut.sample().close(point_t<>(-0.23751f, 0.0f, -0.35389f), result_tolerance));
+    BOOST_CHECK(rand_unit_uut.sample().close(point_t<>( 0.25295f, 0.0f, -0.82799f), result_tolerance));
+    BOOST_CHECK(rand_unit_uut.sample().close(point_t<>( 0.42354f, 0.0f,  0.71394f), result_tolerance));
 }
 
 /* Then give it a longer run to test the statistics */
@@ -86,20 +87,20 @@ BOOST_AUTO_TEST_CASE( random_unit_run_test )
     BOOST_LOG_TRIVIAL(fatal) << "PERF 1 - Runtime us: " << std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count();
 
     c *= 1.0f / size;
-    BOOST_CHECK(c.close(point_t<>(0.0f, 0.0f, 0.0f), result_tolerance));
+    BOOST_CHECK(c.close(point_t<>(0.0f, 0.0f, 0.0f), mean_tolerance));
 }
 
 BOOST_AUTO_TEST_CASE( random_radius_test )
 {
     circle_sampler::seed();
-    BOOST_CHECK(rand_radius_uut.sample().close(point_t<>( 0.65769f,  0.0f,     0.0f), result_tolerance));
-    BOOST_CHECK(rand_radius_uut.sample().close(point_t<>( 0.08075f, -2.29183f, 0.0f), result_tolerance));
-    BOOST_CHECK(rand_radius_uut.sample().close(point_t<>(-1.07167f, -0.22381f, 0.0f), result_tolerance));
-    BOOST_CHECK(rand_radius_uut.sample().close(point_t<>( 3.24711f,  0.98878f, 0.0f), result_tolerance));
-    BOOST_CHECK(rand_radius_uut.sample().close(point_t<>(-2.00854f, -4.21984f, 0.0f), result_tolerance));
-    BOOST_CHECK(rand_radius_uut.sample().close(point_t<>(-1.93185f,  1.73574f, 0.0f), result_tolerance));
-    BOOST_CHECK(rand_radius_uut.sample().close(point_t<>( 0.08420f, -0.15097f, 0.0f), result_tolerance));
-    BOOST_CHECK(rand_radius_uut.sample().close(point_t<>( 2.50048f,  0.87302f, 0.0f), result_tolerance));
+    BOOST_CHECK(rand_radius_uut.sample().close(point_t<>( 0.03883f,  0.0f,     0.0f), result_tolerance));
+    BOOST_CHECK(rand_radius_uut.sample().close(point_t<>( 0.30140f,  0.03696f, 0.0f), result_tolerance));
+    BOOST_CHECK(rand_radius_uut.sample().close(point_t<>(-0.09428f,  0.05145f, 0.0f), result_tolerance));
+    BOOST_CHECK(rand_radius_uut.sample().close(point_t<>(-1.94086f,  2.07450f, 0.0f), result_tolerance));
+    BOOST_CHECK(rand_radius_uut.sample().close(point_t<>(-0.49540f,  0.47276f, 0.0f), result_tolerance));
+    BOOST_CHECK(rand_radius_uut.sample().close(point_t<>(-1.18754f,  1.76947f, 0.0f), result_tolerance));
+    BOOST_CHECK(rand_radius_uut.sample().close(point_t<>( 1.26475f,  4.13994f, 0.0f), result_tolerance));
+    BOOST_CHECK(rand_radius_uut.sample().close(point_t<>( 2.11769f, -3.56972f, 0.0f), result_tolerance));
 }
 
 BOOST_AUTO_TEST_CASE( random_radius_run_test )
@@ -121,29 +122,30 @@ BOOST_AUTO_TEST_CASE( random_radius_run_test )
     BOOST_LOG_TRIVIAL(fatal) << "PERF 1 - Runtime us: " << std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count();
 
     c *= 1.0f / size;
-    BOOST_CHECK_MESSAGE(c.close(point_t<>(0.0f, 0.0f, 0.0f), result_tolerance), c);
+    BOOST_CHECK_MESSAGE(c.close(point_t<>(0.0f, 0.0f, 0.0f), mean_tolerance), c);
 }
 
 /* A bit easier for sobol sampling, atleast we should be in the right sector */
 BOOST_AUTO_TEST_CASE( sobol_unit_test )
 {
     circle_sampler::seed();
-    BOOST_CHECK(sobol_unit_uut.sample().close(point_t<>( 0.0f,     0.0f,  0.0f    ), result_tolerance));
-    BOOST_CHECK(sobol_unit_uut.sample().close(point_t<>(-0.51129f, 0.0f,  0.02304f), result_tolerance));
-    BOOST_CHECK(sobol_unit_uut.sample().close(point_t<>(-0.01630f, 0.0f, -0.75815f), result_tolerance));
-    BOOST_CHECK(sobol_unit_uut.sample().close(point_t<>( 0.01670f, 0.0f,  0.25018f), result_tolerance));
-    BOOST_CHECK(sobol_unit_uut.sample().close(point_t<>(-0.29651f, 0.0f, -0.24654f), result_tolerance));
-    BOOST_CHECK(sobol_unit_uut.sample().close(point_t<>( 0.65390f, 0.0f,  0.59039f), result_tolerance));
-    BOOST_CHECK(sobol_unit_uut.sample().close(point_t<>( 0.44959f, 0.0f, -0.45265f), result_tolerance));
-    BOOST_CHECK(sobol_unit_uut.sample().close(point_t<>(-0.08423f, 0.0f,  0.09349f), result_tolerance));
-    BOOST_CHECK(sobol_unit_uut.sample().close(point_t<>(-0.07590f, 0.0f, -0.18286f), result_tolerance));
-    BOOST_CHECK(sobol_unit_uut.sample().close(point_t<>( 0.26959f, 0.0f,  0.63895f), result_tolerance));
-    BOOST_CHECK(sobol_unit_uut.sample().close(point_t<>( 0.84584f, 0.0f, -0.41920f), result_tolerance));
-    BOOST_CHECK(sobol_unit_uut.sample().close(point_t<>(-0.39539f, 0.0f,  0.20788f), result_tolerance));
-    BOOST_CHECK(sobol_unit_uut.sample().close(point_t<>( 0.10892f, 0.0f, -0.30697f), result_tolerance));
-    BOOST_CHECK(sobol_unit_uut.sample().close(point_t<>(-0.26260f, 0.0f,  0.77041f), result_tolerance));
-    BOOST_CHECK(sobol_unit_uut.sample().close(point_t<>(-0.53942f, 0.0f, -0.18107f), result_tolerance));
-    BOOST_CHECK(sobol_unit_uut.sample().close(point_t<>( 0.07288f, 0.0f,  0.02398f), result_tolerance));
+    sobol_unit_uut.reset(point_t<>(0.0f, 1.0f, 0.0f), point_t<>(1.0f, 0.0f, 0.0f));
+    BOOST_CHECK(sobol_unit_uut.sample().close(point_t<>( 0.00030f, 0.0f,  0.0f    ), result_tolerance));
+    BOOST_CHECK(sobol_unit_uut.sample().close(point_t<>(-0.50657f, 0.0f,  0.00107f), result_tolerance));
+    BOOST_CHECK(sobol_unit_uut.sample().close(point_t<>(-0.04214f, 0.0f, -0.75460f), result_tolerance));
+    BOOST_CHECK(sobol_unit_uut.sample().close(point_t<>( 0.00344f, 0.0f,  0.25589f), result_tolerance));
+    BOOST_CHECK(sobol_unit_uut.sample().close(point_t<>(-0.27998f, 0.0f, -0.25748f), result_tolerance));
+    BOOST_CHECK(sobol_unit_uut.sample().close(point_t<>( 0.67143f, 0.0f,  0.56600f), result_tolerance));
+    BOOST_CHECK(sobol_unit_uut.sample().close(point_t<>( 0.41294f, 0.0f, -0.48640f), result_tolerance));
+    BOOST_CHECK(sobol_unit_uut.sample().close(point_t<>(-0.08794f, 0.0f,  0.09263f), result_tolerance));
+    BOOST_CHECK(sobol_unit_uut.sample().close(point_t<>(-0.08988f, 0.0f, -0.17244f), result_tolerance));
+    BOOST_CHECK(sobol_unit_uut.sample().close(point_t<>( 0.29181f, 0.0f,  0.63616f), result_tolerance));
+    BOOST_CHECK(sobol_unit_uut.sample().close(point_t<>( 0.86844f, 0.0f, -0.39056f), result_tolerance));
+    BOOST_CHECK(sobol_unit_uut.sample().close(point_t<>(-0.40619f, 0.0f,  0.20053f), result_tolerance));
+    BOOST_CHECK(sobol_unit_uut.sample().close(point_t<>( 0.10235f, 0.0f, -0.29580f), result_tolerance));
+    BOOST_CHECK(sobol_unit_uut.sample().close(point_t<>(-0.31658f, 0.0f,  0.76498f), result_tolerance));
+    BOOST_CHECK(sobol_unit_uut.sample().close(point_t<>(-0.54529f, 0.0f, -0.16594f), result_tolerance));
+    BOOST_CHECK(sobol_unit_uut.sample().close(point_t<>( 0.06747f, 0.0f,  0.02739f), result_tolerance));
 }
 
 /* Then give it a longer run to test the statistics */
@@ -171,28 +173,29 @@ BOOST_AUTO_TEST_CASE( sobol_unit_run_test )
     BOOST_LOG_TRIVIAL(fatal) << "PERF 1 - Runtime us: " << std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count();
 
     c *= 1.0f / size;
-    BOOST_CHECK_MESSAGE(c.close(point_t<>(0.0f, 0.0f, 0.0f), result_tolerance), c);
+    BOOST_CHECK_MESSAGE(c.close(point_t<>(0.0f, 0.0f, 0.0f), mean_tolerance), c);
 }
 
 BOOST_AUTO_TEST_CASE( sobol_radius_test )
 {
     circle_sampler::seed();
-    BOOST_CHECK(sobol_radius_uut.sample().close(point_t<>( 0.0f,      0.0f,     0.0f), result_tolerance));
-    BOOST_CHECK(sobol_radius_uut.sample().close(point_t<>(-2.55644f, -0.11519f, 0.0f), result_tolerance));
-    BOOST_CHECK(sobol_radius_uut.sample().close(point_t<>(-0.08150f,  3.79075f, 0.0f), result_tolerance));
-    BOOST_CHECK(sobol_radius_uut.sample().close(point_t<>( 0.08349f, -1.25089f, 0.0f), result_tolerance));
-    BOOST_CHECK(sobol_radius_uut.sample().close(point_t<>(-1.48255f,  1.23269f, 0.0f), result_tolerance));
-    BOOST_CHECK(sobol_radius_uut.sample().close(point_t<>( 3.26949f, -2.95196f, 0.0f), result_tolerance));
-    BOOST_CHECK(sobol_radius_uut.sample().close(point_t<>( 2.24794f,  2.26326f, 0.0f), result_tolerance));
-    BOOST_CHECK(sobol_radius_uut.sample().close(point_t<>(-0.42117f, -0.46742f, 0.0f), result_tolerance));
-    BOOST_CHECK(sobol_radius_uut.sample().close(point_t<>(-0.37952f,  0.91429f, 0.0f), result_tolerance));
-    BOOST_CHECK(sobol_radius_uut.sample().close(point_t<>( 1.34793f, -3.19473f, 0.0f), result_tolerance));
-    BOOST_CHECK(sobol_radius_uut.sample().close(point_t<>( 4.22921f,  2.09601f, 0.0f), result_tolerance));
-    BOOST_CHECK(sobol_radius_uut.sample().close(point_t<>(-1.97693f, -1.03939f, 0.0f), result_tolerance));
-    BOOST_CHECK(sobol_radius_uut.sample().close(point_t<>( 0.54461f,  1.53485f, 0.0f), result_tolerance));
-    BOOST_CHECK(sobol_radius_uut.sample().close(point_t<>(-1.31298f, -3.85207f, 0.0f), result_tolerance));
-    BOOST_CHECK(sobol_radius_uut.sample().close(point_t<>(-2.69710f,  0.90536f, 0.0f), result_tolerance));
-    BOOST_CHECK(sobol_radius_uut.sample().close(point_t<>( 0.36440f, -0.11990f, 0.0f), result_tolerance));
+    sobol_radius_uut.reset(point_t<>(0.0f, 0.0f, 1.0f), point_t<>(5.0f, 0.0f, 0.0f));
+    BOOST_CHECK(sobol_radius_uut.sample().close(point_t<>( 0.00152f,  0.00001f, 0.0f), result_tolerance));
+    BOOST_CHECK(sobol_radius_uut.sample().close(point_t<>(-2.53285f, -0.00534f, 0.0f), result_tolerance));
+    BOOST_CHECK(sobol_radius_uut.sample().close(point_t<>(-0.21068f,  3.77301f, 0.0f), result_tolerance));
+    BOOST_CHECK(sobol_radius_uut.sample().close(point_t<>( 0.01720f, -1.27947f, 0.0f), result_tolerance));
+    BOOST_CHECK(sobol_radius_uut.sample().close(point_t<>(-1.39991f,  1.28740f, 0.0f), result_tolerance));
+    BOOST_CHECK(sobol_radius_uut.sample().close(point_t<>( 3.35717f, -2.83001f, 0.0f), result_tolerance));
+    BOOST_CHECK(sobol_radius_uut.sample().close(point_t<>( 2.06472f,  2.43200f, 0.0f), result_tolerance));
+    BOOST_CHECK(sobol_radius_uut.sample().close(point_t<>(-0.43970f, -0.46315f, 0.0f), result_tolerance));
+    BOOST_CHECK(sobol_radius_uut.sample().close(point_t<>(-0.44938f,  0.86222f, 0.0f), result_tolerance));
+    BOOST_CHECK(sobol_radius_uut.sample().close(point_t<>( 1.45906f, -3.18082f, 0.0f), result_tolerance));
+    BOOST_CHECK(sobol_radius_uut.sample().close(point_t<>( 4.34219f,  1.95282f, 0.0f), result_tolerance));
+    BOOST_CHECK(sobol_radius_uut.sample().close(point_t<>(-2.03094f, -1.00265f, 0.0f), result_tolerance));
+    BOOST_CHECK(sobol_radius_uut.sample().close(point_t<>( 0.51173f,  1.47902f, 0.0f), result_tolerance));
+    BOOST_CHECK(sobol_radius_uut.sample().close(point_t<>(-1.58288f, -3.82488f, 0.0f), result_tolerance));
+    BOOST_CHECK(sobol_radius_uut.sample().close(point_t<>(-2.72644f,  0.82972f, 0.0f), result_tolerance));
+    BOOST_CHECK(sobol_radius_uut.sample().close(point_t<>( 0.33737f, -0.13693f, 0.0f), result_tolerance));
 }
 
 BOOST_AUTO_TEST_CASE( sobol_radius_run_test )
@@ -219,7 +222,7 @@ BOOST_AUTO_TEST_CASE( sobol_radius_run_test )
     BOOST_LOG_TRIVIAL(fatal) << "PERF 1 - Runtime us: " << std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count();
 
     c *= 1.0f / size;
-    BOOST_CHECK_MESSAGE(c.close(point_t<>(0.0f, 0.0f, 0.0f), result_tolerance), c);
+    BOOST_CHECK_MESSAGE(c.close(point_t<>(0.0f, 0.0f, 0.0f), mean_tolerance), c);
 }
 
 #define CHECK_NUMBER_OF_SAMPLES(s, r, t, n) \
@@ -287,59 +290,59 @@ BOOST_AUTO_TEST_CASE( strat_unit_test )
 
     /* Ring 0 */
     CHECK_SAMPLE(strat_unit_uut, point_t<>( 0.0f,     0.0f,  0.0f    ), 0.0f, 0.5f);
-    CHECK_SAMPLE(strat_unit_uut, point_t<>( 0.27287f, 0.0f, -0.26130f), 0.0f, 0.5f);
-    CHECK_SAMPLE(strat_unit_uut, point_t<>( 0.10593f, 0.0f, -0.24442f), 0.0f, 0.5f);
-    CHECK_SAMPLE(strat_unit_uut, point_t<>(-0.00819f, 0.0f, -0.02205f), 0.0f, 0.5f);
-    CHECK_SAMPLE(strat_unit_uut, point_t<>(-0.28817f, 0.0f, -0.17978f), 0.0f, 0.5f);
-    CHECK_SAMPLE(strat_unit_uut, point_t<>(-0.18571f, 0.0f, -0.04774f), 0.0f, 0.5f);
-    CHECK_SAMPLE(strat_unit_uut, point_t<>(-0.41542f, 0.0f,  0.00752f), 0.0f, 0.5f);
-    CHECK_SAMPLE(strat_unit_uut, point_t<>(-0.01861f, 0.0f,  0.01919f), 0.0f, 0.5f);
-    CHECK_SAMPLE(strat_unit_uut, point_t<>(-0.16662f, 0.0f,  0.29129f), 0.0f, 0.5f);
-    CHECK_SAMPLE(strat_unit_uut, point_t<>( 0.00671f, 0.0f,  0.19159f), 0.0f, 0.5f);
-    CHECK_SAMPLE(strat_unit_uut, point_t<>( 0.16131f, 0.0f,  0.13249f), 0.0f, 0.5f);
-    CHECK_SAMPLE(strat_unit_uut, point_t<>( 0.29429f, 0.0f,  0.01072f), 0.0f, 0.5f);
+    CHECK_SAMPLE(strat_unit_uut, point_t<>( 0.00825f, 0.0f, -0.00512f), 0.0f, 0.5f);
+    CHECK_SAMPLE(strat_unit_uut, point_t<>( 0.10307f, 0.0f, -0.18325f), 0.0f, 0.5f);
+    CHECK_SAMPLE(strat_unit_uut, point_t<>(-0.05418f, 0.0f, -0.17673f), 0.0f, 0.5f);
+    CHECK_SAMPLE(strat_unit_uut, point_t<>(-0.10619f, 0.0f, -0.15679f), 0.0f, 0.5f);
+    CHECK_SAMPLE(strat_unit_uut, point_t<>(-0.16433f, 0.0f, -0.05091f), 0.0f, 0.5f);
+    CHECK_SAMPLE(strat_unit_uut, point_t<>(-0.09116f, 0.0f,  0.04441f), 0.0f, 0.5f);
+    CHECK_SAMPLE(strat_unit_uut, point_t<>(-0.24011f, 0.0f,  0.34168f), 0.0f, 0.5f);
+    CHECK_SAMPLE(strat_unit_uut, point_t<>(-0.03276f, 0.0f,  0.08082f), 0.0f, 0.5f);
+    CHECK_SAMPLE(strat_unit_uut, point_t<>( 0.10047f, 0.0f,  0.19877f), 0.0f, 0.5f);
+    CHECK_SAMPLE(strat_unit_uut, point_t<>( 0.26247f, 0.0f,  0.29751f), 0.0f, 0.5f);
+    CHECK_SAMPLE(strat_unit_uut, point_t<>( 0.44020f, 0.0f,  0.16769f), 0.0f, 0.5f);
     
     /* Ring 1 */
-    CHECK_SAMPLE(strat_unit_uut, point_t<>( 0.64971f, 0.0f, -0.18395f), 0.5f, std::sqrt(0.5f));
-    CHECK_SAMPLE(strat_unit_uut, point_t<>( 0.33628f, 0.0f, -0.39538f), 0.5f, std::sqrt(0.5f));
-    CHECK_SAMPLE(strat_unit_uut, point_t<>( 0.09133f, 0.0f, -0.57900f), 0.5f, std::sqrt(0.5f));
-    CHECK_SAMPLE(strat_unit_uut, point_t<>(-0.26755f, 0.0f, -0.63443f), 0.5f, std::sqrt(0.5f));
-    CHECK_SAMPLE(strat_unit_uut, point_t<>(-0.28902f, 0.0f, -0.47305f), 0.5f, std::sqrt(0.5f));
-    CHECK_SAMPLE(strat_unit_uut, point_t<>(-0.61250f, 0.0f, -0.22479f), 0.5f, std::sqrt(0.5f));
-    CHECK_SAMPLE(strat_unit_uut, point_t<>(-0.58218f, 0.0f,  0.24344f), 0.5f, std::sqrt(0.5f));
-    CHECK_SAMPLE(strat_unit_uut, point_t<>(-0.53258f, 0.0f,  0.46232f), 0.5f, std::sqrt(0.5f));
-    CHECK_SAMPLE(strat_unit_uut, point_t<>(-0.00504f, 0.0f,  0.55114f), 0.5f, std::sqrt(0.5f));
-    CHECK_SAMPLE(strat_unit_uut, point_t<>( 0.24967f, 0.0f,  0.59978f), 0.5f, std::sqrt(0.5f));
-    CHECK_SAMPLE(strat_unit_uut, point_t<>( 0.33816f, 0.0f,  0.53739f), 0.5f, std::sqrt(0.5f));
-    CHECK_SAMPLE(strat_unit_uut, point_t<>( 0.62967f, 0.0f,  0.03806f), 0.5f, std::sqrt(0.5f));
+    CHECK_SAMPLE(strat_unit_uut, point_t<>( 0.66224f, 0.0f, -0.24278f), 0.5f, std::sqrt(0.5f));
+    CHECK_SAMPLE(strat_unit_uut, point_t<>( 0.33769f, 0.0f, -0.37785f), 0.5f, std::sqrt(0.5f));
+    CHECK_SAMPLE(strat_unit_uut, point_t<>( 0.35099f, 0.0f, -0.61033f), 0.5f, std::sqrt(0.5f));
+    CHECK_SAMPLE(strat_unit_uut, point_t<>(-0.29708f, 0.0f, -0.52028f), 0.5f, std::sqrt(0.5f));
+    CHECK_SAMPLE(strat_unit_uut, point_t<>(-0.33920f, 0.0f, -0.53893f), 0.5f, std::sqrt(0.5f));
+    CHECK_SAMPLE(strat_unit_uut, point_t<>(-0.54193f, 0.0f, -0.21432f), 0.5f, std::sqrt(0.5f));
+    CHECK_SAMPLE(strat_unit_uut, point_t<>(-0.61551f, 0.0f,  0.09385f), 0.5f, std::sqrt(0.5f));
+    CHECK_SAMPLE(strat_unit_uut, point_t<>(-0.34338f, 0.0f,  0.56542f), 0.5f, std::sqrt(0.5f));
+    CHECK_SAMPLE(strat_unit_uut, point_t<>(-0.25801f, 0.0f,  0.53266f), 0.5f, std::sqrt(0.5f));
+    CHECK_SAMPLE(strat_unit_uut, point_t<>( 0.04438f, 0.0f,  0.50277f), 0.5f, std::sqrt(0.5f));
+    CHECK_SAMPLE(strat_unit_uut, point_t<>( 0.35311f, 0.0f,  0.58638f), 0.5f, std::sqrt(0.5f));
+    CHECK_SAMPLE(strat_unit_uut, point_t<>( 0.59998f, 0.0f,  0.10364f), 0.5f, std::sqrt(0.5f));
     
     /* Ring 2 */
-    CHECK_SAMPLE(strat_unit_uut, point_t<>( 0.73094f, 0.0f, -0.17000f), std::sqrt(0.5f), std::sqrt(0.75f));
-    CHECK_SAMPLE(strat_unit_uut, point_t<>( 0.59293f, 0.0f, -0.57926f), std::sqrt(0.5f), std::sqrt(0.75f));
-    CHECK_SAMPLE(strat_unit_uut, point_t<>( 0.27606f, 0.0f, -0.69185f), std::sqrt(0.5f), std::sqrt(0.75f));
-    CHECK_SAMPLE(strat_unit_uut, point_t<>(-0.06654f, 0.0f, -0.76130f), std::sqrt(0.5f), std::sqrt(0.75f));
-    CHECK_SAMPLE(strat_unit_uut, point_t<>(-0.65735f, 0.0f, -0.42804f), std::sqrt(0.5f), std::sqrt(0.75f));
-    CHECK_SAMPLE(strat_unit_uut, point_t<>(-0.75063f, 0.0f, -0.40220f), std::sqrt(0.5f), std::sqrt(0.75f));
-    CHECK_SAMPLE(strat_unit_uut, point_t<>(-0.82136f, 0.0f,  0.22217f), std::sqrt(0.5f), std::sqrt(0.75f));
-    CHECK_SAMPLE(strat_unit_uut, point_t<>(-0.60831f, 0.0f,  0.50272f), std::sqrt(0.5f), std::sqrt(0.75f));
-    CHECK_SAMPLE(strat_unit_uut, point_t<>(-0.22623f, 0.0f,  0.83376f), std::sqrt(0.5f), std::sqrt(0.75f));
-    CHECK_SAMPLE(strat_unit_uut, point_t<>( 0.03559f, 0.0f,  0.74856f), std::sqrt(0.5f), std::sqrt(0.75f));
-    CHECK_SAMPLE(strat_unit_uut, point_t<>( 0.45722f, 0.0f,  0.72570f), std::sqrt(0.5f), std::sqrt(0.75f));
-    CHECK_SAMPLE(strat_unit_uut, point_t<>( 0.74613f, 0.0f,  0.24930f), std::sqrt(0.5f), std::sqrt(0.75f));
+    CHECK_SAMPLE(strat_unit_uut, point_t<>( 0.73411f, 0.0f, -0.10177f), std::sqrt(0.5f), std::sqrt(0.75f));
+    CHECK_SAMPLE(strat_unit_uut, point_t<>( 0.53148f, 0.0f, -0.56114f), std::sqrt(0.5f), std::sqrt(0.75f));
+    CHECK_SAMPLE(strat_unit_uut, point_t<>( 0.21912f, 0.0f, -0.68320f), std::sqrt(0.5f), std::sqrt(0.75f));
+    CHECK_SAMPLE(strat_unit_uut, point_t<>(-0.25464f, 0.0f, -0.78951f), std::sqrt(0.5f), std::sqrt(0.75f));
+    CHECK_SAMPLE(strat_unit_uut, point_t<>(-0.63775f, 0.0f, -0.57895f), std::sqrt(0.5f), std::sqrt(0.75f));
+    CHECK_SAMPLE(strat_unit_uut, point_t<>(-0.74928f, 0.0f, -0.20923f), std::sqrt(0.5f), std::sqrt(0.75f));
+    CHECK_SAMPLE(strat_unit_uut, point_t<>(-0.76658f, 0.0f,  0.07270f), std::sqrt(0.5f), std::sqrt(0.75f));
+    CHECK_SAMPLE(strat_unit_uut, point_t<>(-0.62123f, 0.0f,  0.57870f), std::sqrt(0.5f), std::sqrt(0.75f));
+    CHECK_SAMPLE(strat_unit_uut, point_t<>(-0.41739f, 0.0f,  0.74301f), std::sqrt(0.5f), std::sqrt(0.75f));
+    CHECK_SAMPLE(strat_unit_uut, point_t<>( 0.09481f, 0.0f,  0.72334f), std::sqrt(0.5f), std::sqrt(0.75f));
+    CHECK_SAMPLE(strat_unit_uut, point_t<>( 0.58366f, 0.0f,  0.52685f), std::sqrt(0.5f), std::sqrt(0.75f));
+    CHECK_SAMPLE(strat_unit_uut, point_t<>( 0.67402f, 0.0f,  0.27808f), std::sqrt(0.5f), std::sqrt(0.75f));
     
     /* Ring 3 */
-    CHECK_SAMPLE(strat_unit_uut, point_t<>( 0.80173f, 0.0f, -0.41583f), std::sqrt(0.75f), std::sqrt(1.0f));
-    CHECK_SAMPLE(strat_unit_uut, point_t<>( 0.67478f, 0.0f, -0.65011f), std::sqrt(0.75f), std::sqrt(1.0f));
-    CHECK_SAMPLE(strat_unit_uut, point_t<>( 0.47335f, 0.0f, -0.87189f), std::sqrt(0.75f), std::sqrt(1.0f));
-    CHECK_SAMPLE(strat_unit_uut, point_t<>(-0.37990f, 0.0f, -0.89039f), std::sqrt(0.75f), std::sqrt(1.0f));
-    CHECK_SAMPLE(strat_unit_uut, point_t<>(-0.54291f, 0.0f, -0.81219f), std::sqrt(0.75f), std::sqrt(1.0f));
-    CHECK_SAMPLE(strat_unit_uut, point_t<>(-0.85663f, 0.0f, -0.14099f), std::sqrt(0.75f), std::sqrt(1.0f));
-    CHECK_SAMPLE(strat_unit_uut, point_t<>(-0.92946f, 0.0f,  0.31798f), std::sqrt(0.75f), std::sqrt(1.0f));
-    CHECK_SAMPLE(strat_unit_uut, point_t<>(-0.59705f, 0.0f,  0.75769f), std::sqrt(0.75f), std::sqrt(1.0f));
-    CHECK_SAMPLE(strat_unit_uut, point_t<>(-0.05831f, 0.0f,  0.99823f), std::sqrt(0.75f), std::sqrt(1.0f));
-    CHECK_SAMPLE(strat_unit_uut, point_t<>( 0.14330f, 0.0f,  0.88575f), std::sqrt(0.75f), std::sqrt(1.0f));
-    CHECK_SAMPLE(strat_unit_uut, point_t<>( 0.65010f, 0.0f,  0.64112f), std::sqrt(0.75f), std::sqrt(1.0f));
-    CHECK_SAMPLE(strat_unit_uut, point_t<>( 0.94215f, 0.0f,  0.07614f), std::sqrt(0.75f), std::sqrt(1.0f));
+    CHECK_SAMPLE(strat_unit_uut, point_t<>( 0.87833f, 0.0f, -0.14791f), std::sqrt(0.75f), std::sqrt(1.0f));
+    CHECK_SAMPLE(strat_unit_uut, point_t<>( 0.69074f, 0.0f, -0.61912f), std::sqrt(0.75f), std::sqrt(1.0f));
+    CHECK_SAMPLE(strat_unit_uut, point_t<>( 0.23570f, 0.0f, -0.91102f), std::sqrt(0.75f), std::sqrt(1.0f));
+    CHECK_SAMPLE(strat_unit_uut, point_t<>(-0.14115f, 0.0f, -0.94214f), std::sqrt(0.75f), std::sqrt(1.0f));
+    CHECK_SAMPLE(strat_unit_uut, point_t<>(-0.56146f, 0.0f, -0.80423f), std::sqrt(0.75f), std::sqrt(1.0f));
+    CHECK_SAMPLE(strat_unit_uut, point_t<>(-0.96194f, 0.0f, -0.14256f), std::sqrt(0.75f), std::sqrt(1.0f));
+    CHECK_SAMPLE(strat_unit_uut, point_t<>(-0.78762f, 0.0f,  0.43791f), std::sqrt(0.75f), std::sqrt(1.0f));
+    CHECK_SAMPLE(strat_unit_uut, point_t<>(-0.66216f, 0.0f,  0.59904f), std::sqrt(0.75f), std::sqrt(1.0f));
+    CHECK_SAMPLE(strat_unit_uut, point_t<>(-0.28776f, 0.0f,  0.91783f), std::sqrt(0.75f), std::sqrt(1.0f));
+    CHECK_SAMPLE(strat_unit_uut, point_t<>( 0.33857f, 0.0f,  0.84236f), std::sqrt(0.75f), std::sqrt(1.0f));
+    CHECK_SAMPLE(strat_unit_uut, point_t<>( 0.50252f, 0.0f,  0.79355f), std::sqrt(0.75f), std::sqrt(1.0f));
+    CHECK_SAMPLE(strat_unit_uut, point_t<>( 0.80141f, 0.0f,  0.34401f), std::sqrt(0.75f), std::sqrt(1.0f));
 }
 
 /* Then give it a longer run to test the statistics */
@@ -367,7 +370,7 @@ BOOST_AUTO_TEST_CASE( strat_unit_run_test )
     BOOST_LOG_TRIVIAL(fatal) << "PERF 1 - Runtime us: " << std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count();
 
     c *= 1.0f / size;
-    BOOST_CHECK(c.close(point_t<>(0.0f, 0.0f, 0.0f), result_tolerance));
+    BOOST_CHECK_MESSAGE(c.close(point_t<>(0.0f, 0.0f, 0.0f), mean_tolerance), c);
 }
 
 
@@ -425,60 +428,60 @@ BOOST_AUTO_TEST_CASE( strat_radius_test )
     CHECK_NUMBER_OF_SAMPLES_RADIUS(48, 4, 12, 48);
 
     /* Ring 0 */
-    CHECK_SAMPLE(strat_radius_uut, point_t<>( 0.0f,     0.0f,  0.0f    ), 0.0f, 3.0f);
-    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f, -1.56780f,  1.63721f), 0.0f, 3.0f);
-    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f, -1.46650f,  0.63556f), 0.0f, 3.0f);
-    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f, -0.13231f, -0.04912f), 0.0f, 3.0f);
-    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f, -1.07869f, -1.72900f), 0.0f, 3.0f);
-    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f, -0.28646f, -1.11427f), 0.0f, 3.0f);
-    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f,  0.04512f, -2.49249f), 0.0f, 3.0f);
-    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f,  0.11516f, -0.11163f), 0.0f, 3.0f);
-    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f,  1.74774f, -0.99969f), 0.0f, 3.0f);
-    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f,  1.14954f,  0.04025f), 0.0f, 3.0f);
-    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f,  0.79492f,  0.96786f), 0.0f, 3.0f);
-    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f,  0.06434f,  1.76576f), 0.0f, 3.0f);
+    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f,  0.0f,      0.0f    ), 0.0f, 3.0f);
+    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f, -0.03072f,  0.04951f), 0.0f, 3.0f);
+    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f, -1.09951f,  0.61842f), 0.0f, 3.0f);
+    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f, -1.06040f, -0.32511f), 0.0f, 3.0f);
+    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f, -0.94071f, -0.63712f), 0.0f, 3.0f);
+    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f, -0.30547f, -0.98599f), 0.0f, 3.0f);
+    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f,  0.26646f, -0.54698f), 0.0f, 3.0f);
+    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f,  2.05009f, -1.44063f), 0.0f, 3.0f);
+    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f,  0.48492f, -0.19659f), 0.0f, 3.0f);
+    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f,  1.19265f,  0.60284f), 0.0f, 3.0f);
+    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f,  1.78507f,  1.57482f), 0.0f, 3.0f);
+    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f,  1.00612f,  2.64123f), 0.0f, 3.0f);
     
     /* Ring 1 */
-    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f, -1.10367f,  3.89826f), 3.0f, 6.0f * std::sqrt(0.5f));
-    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f, -2.37226f,  2.01770f), 3.0f, 6.0f * std::sqrt(0.5f));
-    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f, -3.47398f,  0.54801f), 3.0f, 6.0f * std::sqrt(0.5f));
-    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f, -3.80656f, -1.60529f), 3.0f, 6.0f * std::sqrt(0.5f));
-    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f, -2.83830f, -1.73413f), 3.0f, 6.0f * std::sqrt(0.5f));
-    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f, -1.34872f, -3.67501f), 3.0f, 6.0f * std::sqrt(0.5f));
-    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f,  1.46063f, -3.49306f), 3.0f, 6.0f * std::sqrt(0.5f));
-    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f,  2.77390f, -3.19549f), 3.0f, 6.0f * std::sqrt(0.5f));
-    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f,  3.30684f, -0.03021f), 3.0f, 6.0f * std::sqrt(0.5f));
-    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f,  3.59866f,  1.49803f), 3.0f, 6.0f * std::sqrt(0.5f));
-    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f,  3.22435f,  2.02895f), 3.0f, 6.0f * std::sqrt(0.5f));
-    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f,  0.22834f,  3.77800f), 3.0f, 6.0f * std::sqrt(0.5f));
+    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f, -1.45670f,  3.97342f), 3.0f, 6.0f * std::sqrt(0.5f));
+    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f, -2.26709f,  2.02613f), 3.0f, 6.0f * std::sqrt(0.5f));
+    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f, -3.66198f,  2.10593f), 3.0f, 6.0f * std::sqrt(0.5f));
+    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f, -3.12169f, -1.78249f), 3.0f, 6.0f * std::sqrt(0.5f));
+    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f, -3.23359f, -2.03518f), 3.0f, 6.0f * std::sqrt(0.5f));
+    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f, -1.28592f, -3.25157f), 3.0f, 6.0f * std::sqrt(0.5f));
+    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f,  0.56309f, -3.69305f), 3.0f, 6.0f * std::sqrt(0.5f));
+    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f,  3.39251f, -2.06030f), 3.0f, 6.0f * std::sqrt(0.5f));
+    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f,  3.19595f, -1.54804f), 3.0f, 6.0f * std::sqrt(0.5f));
+    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f,  3.01662f,  0.26628f), 3.0f, 6.0f * std::sqrt(0.5f));
+    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f,  3.51826f,  2.11866f), 3.0f, 6.0f * std::sqrt(0.5f));
+    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f,  0.62184f,  3.59988f), 3.0f, 6.0f * std::sqrt(0.5f));
     
     /* Ring 2 */
-    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f, -1.01995f,  4.38563f), 6.0f * std::sqrt(0.5f), 6.0f * std::sqrt(0.75f));
-    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f, -3.47555f,  3.55756f), 6.0f * std::sqrt(0.5f), 6.0f * std::sqrt(0.75f));
-    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f, -4.15110f,  1.65636f), 6.0f * std::sqrt(0.5f), 6.0f * std::sqrt(0.75f));
-    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f, -4.56779f, -0.39925f), 6.0f * std::sqrt(0.5f), 6.0f * std::sqrt(0.75f));
-    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f, -2.56821f, -3.94409f), 6.0f * std::sqrt(0.5f), 6.0f * std::sqrt(0.75f));
-    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f, -2.41321f, -4.50380f), 6.0f * std::sqrt(0.5f), 6.0f * std::sqrt(0.75f));
-    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f,  1.33301f, -4.92814f), 6.0f * std::sqrt(0.5f), 6.0f * std::sqrt(0.75f));
-    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f,  3.01631f, -3.64985f), 6.0f * std::sqrt(0.5f), 6.0f * std::sqrt(0.75f));
-    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f,  5.00254f, -1.35735f), 6.0f * std::sqrt(0.5f), 6.0f * std::sqrt(0.75f));
-    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f,  4.49134f,  0.21353f), 6.0f * std::sqrt(0.5f), 6.0f * std::sqrt(0.75f));
-    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f,  4.35421f,  2.74331f), 6.0f * std::sqrt(0.5f), 6.0f * std::sqrt(0.75f));
-    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f,  1.49580f,  4.47679f), 6.0f * std::sqrt(0.5f), 6.0f * std::sqrt(0.75f));
+    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f, -0.61064f,  4.40469f), 6.0f * std::sqrt(0.5f), 6.0f * std::sqrt(0.75f));
+    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f, -3.36685f,  3.18887f), 6.0f * std::sqrt(0.5f), 6.0f * std::sqrt(0.75f));
+    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f, -4.09918f,  1.31474f), 6.0f * std::sqrt(0.5f), 6.0f * std::sqrt(0.75f));
+    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f, -4.73709f, -1.52783f), 6.0f * std::sqrt(0.5f), 6.0f * std::sqrt(0.75f));
+    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f, -3.47370f, -3.82651f), 6.0f * std::sqrt(0.5f), 6.0f * std::sqrt(0.75f));
+    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f, -1.25538f, -4.49565f), 6.0f * std::sqrt(0.5f), 6.0f * std::sqrt(0.75f));
+    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f,  0.43619f, -4.59949f), 6.0f * std::sqrt(0.5f), 6.0f * std::sqrt(0.75f));
+    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f,  3.47222f, -3.72738f), 6.0f * std::sqrt(0.5f), 6.0f * std::sqrt(0.75f));
+    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f,  4.45805f, -2.50435f), 6.0f * std::sqrt(0.5f), 6.0f * std::sqrt(0.75f));
+    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f,  4.34002f,  0.56886f), 6.0f * std::sqrt(0.5f), 6.0f * std::sqrt(0.75f));
+    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f,  3.16108f,  3.50195f), 6.0f * std::sqrt(0.5f), 6.0f * std::sqrt(0.75f));
+    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f,  1.66847f,  4.04411f), 6.0f * std::sqrt(0.5f), 6.0f * std::sqrt(0.75f));
     
     /* Ring 3 */
-    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f, -2.49499f,  4.81034f), 6.0f * std::sqrt(0.75f ), 6.0f);
-    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f, -3.90066f,  4.04866f), 6.0f * std::sqrt(0.75f), 6.0f);
-    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f, -5.23133f,  2.84008f), 6.0f * std::sqrt(0.75f), 6.0f);
-    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f, -5.34235f, -2.27938f), 6.0f * std::sqrt(0.75f), 6.0f);
-    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f, -4.87311f, -3.25746f), 6.0f * std::sqrt(0.75f), 6.0f);
-    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f, -0.84594f, -5.13976f), 6.0f * std::sqrt(0.75f), 6.0f);
-    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f,  1.90787f, -5.57677f), 6.0f * std::sqrt(0.75f), 6.0f);
-    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f,  4.54616f, -3.58231f), 6.0f * std::sqrt(0.75f), 6.0f);
-    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f,  5.98936f, -0.34984f), 6.0f * std::sqrt(0.75f), 6.0f);
-    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f,  5.31451f,  0.85978f), 6.0f * std::sqrt(0.75f), 6.0f);
-    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f,  3.84674f,  3.90058f), 6.0f * std::sqrt(0.75f), 6.0f);
-    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f,  0.45686f,  5.65289f), 6.0f * std::sqrt(0.75f), 6.0f);
+    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f, -0.88745f,  5.26999f), 6.0f * std::sqrt(0.75f ), 6.0f);
+    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f, -3.71471f,  4.14445f), 6.0f * std::sqrt(0.75f), 6.0f);
+    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f, -5.46615f,  1.41417f), 6.0f * std::sqrt(0.75f), 6.0f);
+    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f, -5.65286f, -0.84690f), 6.0f * std::sqrt(0.75f), 6.0f);
+    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f, -4.82537f, -3.36879f), 6.0f * std::sqrt(0.75f), 6.0f);
+    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f, -0.85533f, -5.77163f), 6.0f * std::sqrt(0.75f), 6.0f);
+    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f,  2.62747f, -4.72575f), 6.0f * std::sqrt(0.75f), 6.0f);
+    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f,  3.59427f, -3.97296f), 6.0f * std::sqrt(0.75f), 6.0f);
+    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f,  5.50696f, -1.72658f), 6.0f * std::sqrt(0.75f), 6.0f);
+    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f,  5.05416f,  2.03141f), 6.0f * std::sqrt(0.75f), 6.0f);
+    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f,  4.76132f,  3.01515f), 6.0f * std::sqrt(0.75f), 6.0f);
+    CHECK_SAMPLE(strat_radius_uut, point_t<>(0.0f,  2.06403f,  4.80847f), 6.0f * std::sqrt(0.75f), 6.0f);
 }
 
 BOOST_AUTO_TEST_CASE( strat_radius_run_test )
@@ -505,7 +508,7 @@ BOOST_AUTO_TEST_CASE( strat_radius_run_test )
     BOOST_LOG_TRIVIAL(fatal) << "PERF 1 - Runtime us: " << std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count();
 
     c *= 1.0f / size;
-    BOOST_CHECK_MESSAGE(c.close(point_t<>(0.0f, 0.0f, 0.0f), result_tolerance), c);
+    BOOST_CHECK_MESSAGE(c.close(point_t<>(0.0f, 0.0f, 0.0f), mean_tolerance), c);
 }
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,202 @@
+#ifdef STAND_ALONE
+#define BOOST_TEST_MODULE light_tree test
+
+/* Common headers */
+#include "logging.h"
+
+/* Initialise logger */
+const raptor_physics::init_logger init_logger;
+#endif /* #ifdef STAND_ALONE */
+
+/* Standard headers */
+#include <vector>
+
+/* Boost headers */
+#include "boost/test/unit_test.hpp"
+
+/* Ray tracer headers */
+#include "light_tree.h"
+#include "random_stream.h"
+
+
+namespace raptor_raytracer
+{
+namespace test
+{
+const float result_tolerance = 0.0005f;
+
+struct light_tree_fixture
+{
+    light_tree_fixture()
+    {
+        /* A grid of spherical lights with a directional light in the middle */
+        for (int i = 0; i < 8; ++i)
+        {
+            for (int j = 0; j < 8; ++j)
+            {
+                lights.emplace_back(ext_colour_t(255.0f, 200.0f, 100.0f), point_t<>(i * 10.0f, 5.0f, j * 10.0f), 0.1f, 1.0f);
+            }
+
+            if (i == 3)
+            {
+                lights.emplace_back(ext_colour_t(255.0f, 255.0f, 255.0f), point_t<>(0.0f, -1.0f, 0.0f), 0.0f);
+            }
+        }
+    }
+
+    light_list lights;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( light_tree_tests, light_tree_fixture );
+
+
+BOOST_AUTO_TEST_CASE( ctor_test )
+{
+    const light_tree uut(lights);
+    BOOST_CHECK(uut.number_of_lights() == 65);
+    BOOST_CHECK(uut.number_of_directional() == 1);
+}
+
+BOOST_AUTO_TEST_CASE( directional_test )
+{
+    const light_tree uut(lights);
+    BOOST_CHECK(uut.probability(point_t<>(0.0f, 0.0f, 0.0f), 32) == 1.0f);
+
+    /* Always picked with weight 1 */
+    random_stream rng;
+    std::vector<float> w(lights.size());
+    for (int i = 0; i < 100; ++i)
+    {
+        uut.pick(w.data(), point_t<>(i * 0.5f, 0.0f, 20.0f), rng, 4);
+        BOOST_CHECK(w[32] == 1.0f);
+    }
+}
+
+BOOST_AUTO_TEST_CASE( probability_sum_test )
+{
+    const light_tree uut(lights);
+    const point_t<> points[] = { point_t<>(0.0f, 0.0f, 0.0f), point_t<>(35.0f, 5.0f, 35.0f), point_t<>(-100.0f, 50.0f, 12.0f), point_t<>(70.0f, 5.0f, 70.0f) };
+    for (const auto &p : points)
+    {
+        float sum = 0.0f;
+        for (int i = 0; i < static_cast<int>(lights.size()); ++i)
+        {
+            if (i != 32)
+            {
+                const float pdf = uut.probability(p, i);
+                BOOST_CHECK(pdf > 0.0f);
+                sum += pdf;
+            }
+        }
+        BOOST_CHECK_CLOSE(sum, 1.0f, result_tolerance);
+    }
+}
+
+BOOST_AUTO_TEST_CASE( sample_test )
+{
+    /* Sampling should report the same probability as looking the light up */
+    const light_tree uut(lights);
+    const point_t<> p(12.0f, 0.0f, 51.0f);
+    for (int i = 0; i < 1000; ++i)
+    {
+        float pdf;
+        const int l = uut.sample(p, i / 1000.0f, &pdf);
+        BOOST_REQUIRE(l >= 0);
+        BOOST_REQUIRE(l < static_cast<int>(lights.size()));
+        BOOST_CHECK(l != 32);
+        BOOST_CHECK_CLOSE(pdf, uut.probability(p, l), result_tolerance);
+    }
+}
+
+BOOST_AUTO_TEST_CASE( importance_test )
+{
+    /* Nearer lights are more likely */
+    const light_tree uut(lights);
+    const point_t<> p(0.0f, 5.0f, 0.0f);
+    BOOST_CHECK(uut.probability(p, 0) > uut.probability(p, 1));
+    BOOST_CHECK(uut.probability(p, 1) > uut.probability(p, 7));
+    BOOST_CHECK(uut.probability(p, 0) > uut.probability(p, 64));
+
+    /* Brighter lights are more likely */
+    light_list pair;
+    pair.emplace_back(ext_colour_t(255.0f, 255.0f, 255.0f), point_t<>(100.0f, 0.0f, 0.0f), 0.1f, 1.0f);
+    pair.emplace_back(ext_colour_t(25.5f, 25.5f, 25.5f), point_t<>(-100.0f, 0.0f, 0.0f), 0.1f, 1.0f);
+    const light_tree bright(pair);
+    BOOST_CHECK_CLOSE(bright.probability(point_t<>(0.0f, 0.0f, 0.0f), 0), 10.0f / 11.0f, result_tolerance);
+    BOOST_CHECK_CLOSE(bright.probability(point_t<>(0.0f, 0.0f, 0.0f), 1),  1.0f / 11.0f, result_tolerance);
+}
+
+BOOST_AUTO_TEST_CASE( triangle_light_test )
+{
+    /* Triangle lights are bounded by their triangles */
+    primitive_store prims;
+    prims.emplace_back(nullptr, point_t<>(100.0f, 0.0f, 0.0f), point_t<>(101.0f, 0.0f, 0.0f), point_t<>(100.0f, 1.0f, 0.0f), true);
+    const std::vector<int> tris = { 0 };
+    lights.emplace_back(&prims, ext_colour_t(255.0f, 255.0f, 255.0f), point_t<>(100.3f, 0.3f, 0.0f), 0.1f, &tris);
+
+    const light_tree uut(lights);
+    BOOST_CHECK(uut.probability(point_t<>(100.5f, 0.5f, 0.0f), 65) > uut.probability(point_t<>(70.0f, 5.0f, 70.0f), 65));
+}
+
+BOOST_AUTO_TEST_CASE( unbiased_test )
+{
+    /* Averaged over many picks the weight of every light should be 1 */
+    const light_tree uut(lights);
+    const point_t<> p(22.0f, 3.0f, 41.0f);
+    const int picks = 20000;
+    random_stream rng(7);
+    std::vector<float> w(lights.size());
+    std::vector<double> sum(lights.size(), 0.0);
+    for (int i = 0; i < picks; ++i)
+    {
+        uut.pick(w.data(), p, rng, 8);
+        for (int j = 0; j < static_cast<int>(lights.size()); ++j)
+        {
+            sum[j] += w[j];
+        }
+    }
+
+    for (int j = 0; j < static_cast<int>(lights.size()); ++j)
+    {
+        BOOST_CHECK_MESSAGE(std::fabs((sum[j] / picks) - 1.0) < 0.1, j << ": " << (sum[j] / picks));
+    }
+}
+
+BOOST_AUTO_TEST_CASE( stride_test )
+{
+    /* Weights can be interleaved with other data */
+    const light_tree uut(lights);
+    random_stream rng;
+    std::vector<float> w(lights.size() * 3, -1.0f);
+    uut.pick(w.data(), point_t<>(10.0f, 0.0f, 10.0f), rng, 4, 3);
+
+    int picked = 0;
+    for (int i = 0; i < static_cast<int>(lights.size()); ++i)
+    {
+        BOOST_CHECK(w[(i * 3) + 0] >= 0.0f);
+        BOOST_CHECK(w[(i * 3) + 1] == -1.0f);
+        BOOST_CHECK(w[(i * 3) + 2] == -1.0f);
+        picked += (w[i * 3] > 0.0f);
+    }
+
+    /* The directional light plus at most 4 others */
+    BOOST_CHECK(picked >= 2);
+    BOOST_CHECK(picked <= 5);
+}
+
+BOOST_AUTO_TEST_CASE( single_light_test )
+{
+    light_list single;
+    single.emplace_back(ext_colour_t(255.0f, 255.0f, 255.0f), point_t<>(0.0f, 0.0f, 0.0f), 0.1f, 1.0f);
+    const light_tree uut(single);
+    BOOST_CHECK(uut.probability(point_t<>(10.0f, 0.0f, 0.0f), 0) == 1.0f);
+
+    float pdf;
+    BOOST_CHECK(uut.sample(point_t<>(10.0f, 0.0f, 0.0f), 0.5f, &pdf) == 0);
+    BOOST_CHECK(pdf == 1.0f);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+}; /* namespace test */
+}; /* namespace raptor_raytracer */
@@ -0,0 +1,188 @@
+#ifdef STAND_ALONE
+#define BOOST_TEST_MODULE parser test
+
+/* Common headers */
+#include "logging.h"
+
+/* Initialise logger */
+const raptor_physics::init_logger init_logger;
+#endif /* #ifdef STAND_ALONE */
+
+/* Standard headers */
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <list>
+#include <random>
+#include <string>
+
+/* Boost headerrs */
+#include "boost/test/unit_test.hpp"
+
+/* Parser headers */
+#include "parser_common.h"
+#include "chunked_parser.h"
+
+/* Ray tracer headers */
+#include "light.h"
+#include "primitive_store.h"
+#include "phong_shader.h"
+#include "obj_parser.h"
+#include "off_parser.h"
+
+
+namespace raptor_raytracer
+{
+namespace test
+{
+struct parser_fixture
+{
+    parser_fixture() : file("parser_tests.tmp") {  }
+
+    ~parser_fixture()
+    {
+        std::remove(file.c_str());
+    }
+
+    void write(const std::string &s)
+    {
+        std::ofstream out(file.c_str(), std::ios::binary);
+        out << s;
+    }
+
+    const std::string file;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( parser_tests, parser_fixture );
+
+
+/* Number parsing tests */
+BOOST_AUTO_TEST_CASE( to_float_test )
+{
+    const char *const numbers[] = { "0", "1", "-1", "0.5", "-0.0", "3.14159", "+7.25", "  2.5", "\t-12.125", ".5", "5.", "0.1", "0.2", "0.3", "1e3", "1E3", "-2.5e-3",
+        "6.02214076e23", "1.17549435e-38", "3.40282e+38", "0.000001", "123456.789", "16777217", "0.30000001192092896", "1234567890123456789012345", "1.5 2.5", "7\n", "8\r\n" };
+    for (const char *n : numbers)
+    {
+        BOOST_CHECK_MESSAGE(raptor_parsers::to_float(n) == std::strtof(n, nullptr), n);
+    }
+
+    /* Things atof handles that arent plain numbers */
+    BOOST_CHECK(std::isinf(raptor_parsers::to_float("inf")));
+    BOOST_CHECK(std::isnan(raptor_parsers::to_float("nan")));
+    BOOST_CHECK(raptor_parsers::to_float("x") == 0.0f);
+}
+
+BOOST_AUTO_TEST_CASE( to_float_random_test )
+{
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<float> dist(-1000.0f, 1000.0f);
+    char buf[64];
+    for (int i = 0; i < 10000; ++i)
+    {
+        snprintf(buf, sizeof(buf), (i & 0x1) ? "%.6f" : "%.9g", dist(gen));
+        BOOST_REQUIRE_MESSAGE(raptor_parsers::to_float(buf) == std::strtof(buf, nullptr), buf);
+    }
+}
+
+BOOST_AUTO_TEST_CASE( to_int_test )
+{
+    const char *const numbers[] = { "0", "1", "-1", "+12", "  345", "-2147483647", "12/3/4", "7\n", "x" };
+    for (const char *n : numbers)
+    {
+        BOOST_CHECK_MESSAGE(raptor_parsers::to_int(n) == std::atoi(n), n);
+    }
+}
+
+
+/* Chunking tests */
+BOOST_AUTO_TEST_CASE( split_lines_test )
+{
+    const std::string text("a\nbb\nccc\ndddd\neeeee\n");
+    const char *const b = text.data();
+    const char *const e = b + text.size();
+    for (int n = 1; n < 30; ++n)
+    {
+        const auto chunks = raptor_parsers::split_lines(b, e, n);
+        BOOST_REQUIRE(chunks.size() == static_cast<unsigned>(n + 1));
+        BOOST_CHECK(chunks.front() == b);
+        BOOST_CHECK(chunks.back() == e);
+        for (int i = 1; i <= n; ++i)
+        {
+            BOOST_CHECK(chunks[i] >= chunks[i - 1]);
+            BOOST_CHECK((chunks[i] == e) || (chunks[i][-1] == '\n'));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE( parallel_for_lines_test )
+{
+    std::string text;
+    for (int i = 0; i < 1000; ++i)
+    {
+        text += std::to_string(i) + " x\n";
+    }
+
+    for (int n = 1; n < 8; ++n)
+    {
+        std::vector<int> lines(1000, -1);
+        raptor_parsers::parallel_for_lines(text.data(), text.data() + text.size(), n, 900, [&lines](const int, const int i, const char *c)
+        {
+            lines[i] = raptor_parsers::to_int(c);
+        });
+
+        for (int i = 0; i < 1000; ++i)
+        {
+            BOOST_CHECK(lines[i] == ((i < 900) ? i : -1));
+        }
+    }
+}
+
+
+/* Loader tests */
+BOOST_AUTO_TEST_CASE( off_parser_test )
+{
+    write("OFF\n5 2 0\n0.0 0.0 0.0\n1.0 0.0 0.0\n1.0 1.0 0.0\n0.0 1.0 0.0\n0.0 0.0 1.0\n3 0 1 4\n4 0 1 2 3\n");
+
+    light_list              lights;
+    primitive_store         everything;
+    std::list<material *>   materials;
+    off_parser(file, lights, everything, materials, nullptr);
+    BOOST_REQUIRE(everything.size() == 3);
+    BOOST_CHECK(everything.primitive(0)->get_vertex_a() == point_t<>(0.0f, 0.0f, 0.0f));
+    BOOST_CHECK(everything.primitive(0)->get_vertex_b() == point_t<>(1.0f, 0.0f, 0.0f));
+    BOOST_CHECK(everything.primitive(0)->get_vertex_c() == point_t<>(0.0f, 0.0f, 1.0f));
+
+    for (auto *m : materials)
+    {
+        delete m;
+    }
+}
+
+BOOST_AUTO_TEST_CASE( obj_parser_test )
+{
+    /* Negative indices, comments and normals */
+    write("# test\nv 0.0 0.0 0.0\nv 1.0 0.0 0.0\nv 1.0 1.0 0.0\n\nvn 0.0 0.0 2.0\nvt 0.5 0.5\ng group\nf 1/1/1 2/1/1 3/1/1\nv 0.0 1.0 0.0\nf -4//-1 -2//-1 -1//-1\ns off\nf 1 2 3 4");
+
+    light_list              lights;
+    primitive_store         everything;
+    std::list<material *>   materials;
+    camera                  *cam = nullptr;
+    obj_parser(file, "", lights, everything, materials, &cam);
+    BOOST_REQUIRE(everything.size() == 4);
+    BOOST_CHECK(everything.number_of_normals() == 1);
+    BOOST_CHECK(everything.number_of_texture_coords() == 1);
+    BOOST_CHECK(everything.primitive(1)->get_vertex_a() == point_t<>(0.0f, 0.0f, 0.0f));
+    BOOST_CHECK(everything.primitive(1)->get_vertex_b() == point_t<>(1.0f, 1.0f, 0.0f));
+    BOOST_CHECK(everything.primitive(1)->get_vertex_c() == point_t<>(0.0f, 1.0f, 0.0f));
+
+    for (auto *m : materials)
+    {
+        delete m;
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+}; /* namespace test */
+}; /* namespace raptor_raytracer */
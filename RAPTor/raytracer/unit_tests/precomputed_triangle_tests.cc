@@ -0,0 +1,138 @@
+#ifdef STAND_ALONE
+#define BOOST_TEST_MODULE precomputed_triangle test
+
+/* Common headers */
+#include "logging.h"
+
+/* Initialise logger */
+const raptor_physics::init_logger init_logger;
+#endif /* #ifdef STAND_ALONE */
+
+/* Standard headers */
+#include <vector>
+
+/* Boost headerrs */
+#include "boost/test/unit_test.hpp"
+
+/* Ray tracer headers */
+#include "precomputed_triangle.h"
+#include "phong_shader.h"
+
+
+namespace raptor_raytracer
+{
+namespace test
+{
+const float result_tolerance = 0.00001f;
+
+struct precomputed_triangle_fixture
+{
+    precomputed_triangle_fixture() :
+    mat(new phong_shader(ext_colour_t(255.0f, 255.0f, 255.0f)))
+    {
+        /* A triangle light */
+        tris.emplace_back(mat.get(), point_t(0.0f, 0.0f, 0.0f), point_t(0.0f, 1.0f, 0.0f), point_t(0.0f, 1.0f, 1.0f), true);
+
+        /* A square */
+        tris.emplace_back(mat.get(), point_t(1.0f, 0.0f, 0.0f), point_t(1.0f, 1.0f, 0.0f), point_t(1.0f, 1.0f, 1.0f), false);
+        tris.emplace_back(mat.get(), point_t(1.0f, 0.0f, 0.0f), point_t(1.0f, 1.0f, 1.0f), point_t(1.0f, 0.0f, 1.0f), false);
+    }
+
+    std::unique_ptr<material>           mat;
+    primitive_store                     tris;
+    std::vector<precomputed_triangle>   uut;
+};
+
+BOOST_FIXTURE_TEST_SUITE( precomputed_triangle_tests, precomputed_triangle_fixture );
+
+BOOST_AUTO_TEST_CASE( ctor_test )
+{
+    const precomputed_triangle light(*tris.primitive(0), 7);
+    BOOST_CHECK(light.index() == 7);
+    BOOST_CHECK(!light.is_occluder());
+
+    const precomputed_triangle opaque(*tris.primitive(1), 3);
+    BOOST_CHECK(opaque.index() == 3);
+    BOOST_CHECK(opaque.is_occluder());
+}
+
+BOOST_AUTO_TEST_CASE( hit_test )
+{
+    const precomputed_triangle pre(*tris.primitive(2), 2);
+    const ray r(point_t(-1.0f, 0.25f, 0.5f), 1.0f, 0.0f, 0.0f);
+
+    hit_description exp_h;
+    tris.primitive(2)->is_intersecting(&r, &exp_h);
+
+    hit_description h;
+    pre.is_intersecting(&r, &h);
+    BOOST_CHECK_CLOSE(h.d, 2.0f, result_tolerance);
+    BOOST_CHECK(h.d == exp_h.d);
+    BOOST_CHECK(h.u == exp_h.u);
+    BOOST_CHECK(h.v == exp_h.v);
+}
+
+BOOST_AUTO_TEST_CASE( miss_test )
+{
+    const precomputed_triangle pre(*tris.primitive(1), 1);
+
+    /* Miss to the side */
+    const ray r0(point_t(-1.0f, 0.25f, 0.5f), 1.0f, 0.0f, 0.0f);
+    hit_description h0(5.0f);
+    pre.is_intersecting(&r0, &h0);
+    BOOST_CHECK(h0.d == MAX_DIST);
+
+    /* Parallel to the triangle */
+    const ray r1(point_t(-1.0f, 0.75f, 0.25f), 0.0f, 1.0f, 0.0f);
+    hit_description h1(5.0f);
+    pre.is_intersecting(&r1, &h1);
+    BOOST_CHECK(h1.d == MAX_DIST);
+
+    /* Behind the ray */
+    const ray r2(point_t(2.0f, 0.75f, 0.25f), 1.0f, 0.0f, 0.0f);
+    hit_description h2(5.0f);
+    pre.is_intersecting(&r2, &h2);
+    BOOST_CHECK(h2.d == 5.0f);
+}
+
+BOOST_AUTO_TEST_CASE( precompute_triangles_test )
+{
+    std::vector<int> indirect({ 2, 0, 1 });
+    tris.swap(indirect);
+
+    precompute_triangles(&uut, tris);
+    BOOST_REQUIRE(uut.size() == 3);
+    BOOST_CHECK(uut[0].index() == 0);
+    BOOST_CHECK(uut[1].index() == 1);
+    BOOST_CHECK(uut[2].index() == 2);
+    BOOST_CHECK(!uut[0].is_occluder());
+    BOOST_CHECK(uut[1].is_occluder());
+    BOOST_CHECK(uut[2].is_occluder());
+}
+
+BOOST_AUTO_TEST_CASE( precompute_indirect_triangles_test )
+{
+    std::vector<int> indirect({ 2, 0, 1 });
+    tris.swap(indirect);
+
+    precompute_indirect_triangles(&uut, tris);
+    BOOST_REQUIRE(uut.size() == 3);
+    BOOST_CHECK(uut[0].index() == 2);
+    BOOST_CHECK(uut[1].index() == 0);
+    BOOST_CHECK(uut[2].index() == 1);
+    BOOST_CHECK(uut[0].is_occluder());
+    BOOST_CHECK(!uut[1].is_occluder());
+    BOOST_CHECK(uut[2].is_occluder());
+
+    /* Recompute after changing the indirection */
+    tris.reset_indirection();
+    precompute_indirect_triangles(&uut, tris);
+    BOOST_REQUIRE(uut.size() == 3);
+    BOOST_CHECK(uut[0].index() == 0);
+    BOOST_CHECK(uut[1].index() == 1);
+    BOOST_CHECK(uut[2].index() == 2);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+}; /* namespace test */
+}; /* namespace raptor_raytracer */
@@ -423,6 +423,61 @@ BOOST_AUTO_TEST_CASE( iterate_test )
     BOOST_CHECK(const_iter == uut_ptr->end());
 }
 
+BOOST_AUTO_TEST_CASE( shared_vertex_attributes_test )
+{
+    /* Attributes are added once and indexed by many triangles */
+    BOOST_CHECK(uut.add_normal(point_t(0.0f, 0.0f, 1.0f)) == 0);
+    BOOST_CHECK(uut.add_normal(point_t(0.0f, 1.0f, 0.0f)) == 1);
+    BOOST_CHECK(uut.add_texture_coord(point_t(0.0f, 0.0f, 0.0f)) == 0);
+    BOOST_CHECK(uut.add_texture_coord(point_t(1.0f, 0.0f, 0.0f)) == 1);
+    BOOST_CHECK(uut.add_texture_coord(point_t(0.0f, 1.0f, 0.0f)) == 2);
+    BOOST_CHECK(uut.normal(1)           == point_t(0.0f, 1.0f, 0.0f));
+    BOOST_CHECK(uut.texture_coord(2)    == point_t(0.0f, 1.0f, 0.0f));
+
+    const int vn_a[3] = { 0, 0, 0 };
+    const int vn_b[3] = { 1, 1, 1 };
+    const int vt[3]   = { 0, 1, 2 };
+    BOOST_CHECK(uut.emplace_back(nullptr, point_t(0.0f, 0.0f, 0.0f), point_t(1.0f, 0.0f, 0.0f), point_t(0.0f, 1.0f, 0.0f), false, &vn_a[0], &vt[0])    == 0);
+    BOOST_CHECK(uut.emplace_back(nullptr, point_t(0.0f, 0.0f, 0.0f), point_t(1.0f, 0.0f, 0.0f), point_t(0.0f, 1.0f, 0.0f), false, &vn_b[0], nullptr)   == 1);
+    BOOST_CHECK(uut.emplace_back(nullptr, point_t(0.0f, 0.0f, 0.0f), point_t(1.0f, 0.0f, 0.0f), point_t(0.0f, 1.0f, 0.0f))                             == 2);
+    BOOST_CHECK(uut.number_of_normals()             == 2);
+    BOOST_CHECK(uut.number_of_texture_coords()      == 3);
+    BOOST_CHECK(uut.number_of_vertex_attributes()   == 2);
+
+    /* Triangles with their own normals add them to the shared arrays, lots so they must grow */
+    const point_t<> vn_c[3] = { point_t(1.0f, 0.0f, 0.0f), point_t(1.0f, 0.0f, 0.0f), point_t(1.0f, 0.0f, 0.0f) };
+    for (int i = 0; i < 1000; ++i)
+    {
+        uut.emplace_back(nullptr, point_t(0.0f, 0.0f, 0.0f), point_t(1.0f, 0.0f, 0.0f), point_t(0.0f, 1.0f, 0.0f), false, &vn_c[0]);
+    }
+    BOOST_CHECK(uut.size()                          == 1003);
+    BOOST_CHECK(uut.number_of_normals()             == 3002);
+    BOOST_CHECK(uut.number_of_texture_coords()      == 3);
+    BOOST_CHECK(uut.number_of_vertex_attributes()   == 1002);
+
+    /* Reverse the primitives to check their attributes follow them */
+    std::vector<int> reversed(uut.size());
+    for (int i = 0; i < uut.size(); ++i)
+    {
+        reversed[i] = uut.size() - i - 1;
+    }
+    uut.swap(reversed).move_to_indirect();
+
+    /* Hit the triangles from below, so against their normals */
+    const point_t<> exp[4] = { point_t(-1.0f, 0.0f, 0.0f), point_t(0.0f, 0.0f, -1.0f), point_t(0.0f, -1.0f, 0.0f), point_t(0.0f, 0.0f, -1.0f) };
+    for (int i = 0; i < 4; ++i)
+    {
+        ray r(point_t(0.25f, 0.25f, -1.0f), 0.0f, 0.0f, 1.0f);
+        r.calculate_destination(1.0f);
+        hit_description h(1.0f, hit_t::miss, 0.2f, 0.3f);
+        const point_t<> n(uut.primitive(uut.size() - 4 + i)->normal_at_point(&r, &h));
+        BOOST_CHECK_CLOSE(n.x, exp[i].x, result_tolerance);
+        BOOST_CHECK_CLOSE(n.y, exp[i].y, result_tolerance);
+        BOOST_CHECK_CLOSE(n.z, exp[i].z, result_tolerance);
+        BOOST_CHECK(h.h == hit_t::in_out);
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 }; /* namespace test */
 }; /* namespace raptor_raytracer */
@@ -0,0 +1,180 @@
+#ifdef STAND_ALONE
+#define BOOST_TEST_MODULE random_stream test
+
+/* Common headers */
+#include "logging.h"
+
+/* Initialise logger */
+const raptor_physics::init_logger init_logger;
+#endif /* #ifdef STAND_ALONE */
+
+/* Standard headers */
+#include <cassert>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+/* Boost headers */
+#include "boost/test/unit_test.hpp"
+
+/* Ray tracer headers */
+#include "random_stream.h"
+#include "sobol_numbers_2d.h"
+
+
+namespace raptor_raytracer
+{
+namespace test
+{
+BOOST_AUTO_TEST_SUITE( random_stream_tests );
+
+
+BOOST_AUTO_TEST_CASE( repeat_test )
+{
+    random_stream a;
+    random_stream b;
+    a.seed(10, 20);
+    b.seed(10, 20);
+    for (int i = 0; i < 100; ++i)
+    {
+        BOOST_CHECK(a() == b());
+    }
+
+    /* Reseeding restarts the stream */
+    a.seed(10, 20);
+    b.seed(10, 20);
+    for (int i = 0; i < 100; ++i)
+    {
+        BOOST_CHECK(a.next() == b.next());
+    }
+}
+
+BOOST_AUTO_TEST_CASE( pixel_seed_test )
+{
+    /* Neighbouring pixels and swapped co-ordinates shouldnt share streams */
+    random_stream a;
+    random_stream b;
+    const std::uint32_t seeds[][2] = { { 1, 0 }, { 0, 1 }, { 1, 1 }, { 2, 0 } };
+    for (const auto &s : seeds)
+    {
+        a.seed(0, 0);
+        b.seed(s[0], s[1]);
+        int same = 0;
+        for (int i = 0; i < 100; ++i)
+        {
+            same += (a() == b());
+        }
+        BOOST_CHECK(same == 0);
+    }
+}
+
+BOOST_AUTO_TEST_CASE( range_test )
+{
+    random_stream uut;
+    double sum = 0.0;
+    double sum_sq = 0.0;
+    const int size = 100000;
+    for (int i = 0; i < size; ++i)
+    {
+        const float r = uut.next();
+        BOOST_REQUIRE(r >= 0.0f);
+        BOOST_REQUIRE(r < 1.0f);
+        sum += r;
+        sum_sq += r * r;
+    }
+
+    /* Uniform has mean 1/2 and variance 1/12 */
+    const double mean = sum / size;
+    BOOST_CHECK_CLOSE(mean, 0.5, 1.0);
+    BOOST_CHECK_CLOSE((sum_sq / size) - (mean * mean), 1.0 / 12.0, 1.0);
+}
+
+BOOST_AUTO_TEST_CASE( across_pixels_test )
+{
+    /* The first number of each pixel is what the sampler sees, so it must be uniform across the image */
+    random_stream uut;
+    std::vector<int> bins(16, 0);
+    for (std::uint32_t y = 0; y < 256; ++y)
+    {
+        for (std::uint32_t x = 0; x < 256; ++x)
+        {
+            uut.seed(x, y);
+            ++bins[static_cast<int>(uut.next() * 16.0f)];
+        }
+    }
+
+    for (const int b : bins)
+    {
+        BOOST_CHECK_MESSAGE(std::abs(b - 4096) < 300, b);
+    }
+}
+
+BOOST_AUTO_TEST_CASE( distribution_test )
+{
+    random_stream uut(3);
+    std::uniform_real_distribution<float> dist(-2.0f, 2.0f);
+    for (int i = 0; i < 1000; ++i)
+    {
+        const float r = dist(uut);
+        BOOST_REQUIRE(r >= -2.0f);
+        BOOST_REQUIRE(r < 2.0f);
+    }
+}
+
+BOOST_AUTO_TEST_CASE( thread_stream_test )
+{
+    random_stream &main_stream = random_stream::thread_stream();
+    main_stream.seed(5, 6);
+    const std::uint32_t expected = random_stream(main_stream)();
+
+    /* Another thread gets its own stream and cant disturb this one */
+    random_stream *other_stream = nullptr;
+    std::uint32_t other = 0;
+    std::thread t([&other_stream, &other]()
+    {
+        other_stream = &random_stream::thread_stream();
+        other_stream->seed(5, 6);
+        other = (*other_stream)();
+        (*other_stream)();
+    });
+    t.join();
+
+    BOOST_CHECK(other_stream != &main_stream);
+    BOOST_CHECK(other == expected);
+    BOOST_CHECK(main_stream() == expected);
+}
+
+BOOST_AUTO_TEST_CASE( sobol_scramble_test )
+{
+    /* Scrambling must keep the first 2^n points stratified in each dimension and at the start of their strata */
+    random_stream rng;
+    sobol_numbers_2d<float> uut(64);
+    for (int s = 0; s < 10; ++s)
+    {
+        uut.reset(rng(), rng());
+        std::vector<int> x_bins(64, 0);
+        std::vector<int> y_bins(64, 0);
+        for (int i = 0; i < 64; ++i)
+        {
+            float x;
+            float y;
+            uut.next(x, y);
+            BOOST_REQUIRE((x * 64.0f) == std::floor(x * 64.0f));
+            BOOST_REQUIRE((y * 64.0f) == std::floor(y * 64.0f));
+            ++x_bins[static_cast<int>(x * 64.0f)];
+            ++y_bins[static_cast<int>(y * 64.0f)];
+        }
+
+        for (int i = 0; i < 64; ++i)
+        {
+            BOOST_CHECK(x_bins[i] == 1);
+            BOOST_CHECK(y_bins[i] == 1);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+}; /* namespace test */
+}; /* namespace raptor_raytracer */
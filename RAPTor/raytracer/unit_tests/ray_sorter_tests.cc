@@ -0,0 +1,152 @@
+#ifdef STAND_ALONE
+#define BOOST_TEST_MODULE ray_sorter test
+
+/* Common headers */
+#include "logging.h"
+
+/* Initialise logger */
+const raptor_physics::init_logger init_logger;
+#endif /* #ifdef STAND_ALONE */
+
+/* Standard headers */
+#include <algorithm>
+#include <vector>
+
+/* Boost headers */
+#include "boost/test/unit_test.hpp"
+
+/* Ray tracer headers */
+#include "ray_sorter.h"
+
+
+namespace raptor_raytracer
+{
+namespace test
+{
+/* Check order is a permutation of 0 to n */
+bool is_permutation(const std::vector<int> &order)
+{
+    std::vector<int> sorted(order);
+    std::sort(sorted.begin(), sorted.end());
+    for (int i = 0; i < static_cast<int>(sorted.size()); ++i)
+    {
+        if (sorted[i] != i)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+BOOST_AUTO_TEST_SUITE( ray_sorter_tests );
+
+BOOST_AUTO_TEST_CASE( octant_test )
+{
+    BOOST_CHECK(ray_sorter::octant(ray(point_t<>(0.0f, 0.0f, 0.0f),  1.0f,  1.0f,  1.0f)) == 0);
+    BOOST_CHECK(ray_sorter::octant(ray(point_t<>(0.0f, 0.0f, 0.0f), -1.0f,  1.0f,  1.0f)) == 1);
+    BOOST_CHECK(ray_sorter::octant(ray(point_t<>(0.0f, 0.0f, 0.0f),  1.0f, -1.0f,  1.0f)) == 2);
+    BOOST_CHECK(ray_sorter::octant(ray(point_t<>(0.0f, 0.0f, 0.0f),  1.0f,  1.0f, -1.0f)) == 4);
+    BOOST_CHECK(ray_sorter::octant(ray(point_t<>(0.0f, 0.0f, 0.0f), -1.0f, -1.0f, -1.0f)) == 7);
+}
+
+BOOST_AUTO_TEST_CASE( empty_test )
+{
+    ray_sorter uut;
+    uut.sort(nullptr, nullptr, 0);
+}
+
+BOOST_AUTO_TEST_CASE( single_test )
+{
+    ray_sorter uut;
+    const ray r(point_t<>(1.0f, 2.0f, 3.0f), 0.0f, 0.0f, 1.0f);
+    int order = -1;
+    uut.sort(&r, &order, 1);
+    BOOST_CHECK(order == 0);
+}
+
+BOOST_AUTO_TEST_CASE( octant_grouping_test )
+{
+    /* Alternate directions so no octant starts grouped */
+    std::vector<ray> rays;
+    for (int i = 0; i < 64; ++i)
+    {
+        const float x = (i & 0x1) ? -1.0f :  1.0f;
+        const float y = (i & 0x2) ? -1.0f :  1.0f;
+        const float z = (i & 0x4) ? -1.0f :  1.0f;
+        rays.emplace_back(point_t<>(static_cast<float>(i), 0.0f, 0.0f), x, y, z);
+    }
+
+    ray_sorter uut;
+    std::vector<int> order(rays.size());
+    uut.sort(rays.data(), order.data(), rays.size());
+    BOOST_REQUIRE(is_permutation(order));
+    for (int i = 1; i < static_cast<int>(order.size()); ++i)
+    {
+        BOOST_CHECK(ray_sorter::octant(rays[order[i - 1]]) <= ray_sorter::octant(rays[order[i]]));
+    }
+}
+
+BOOST_AUTO_TEST_CASE( morton_order_test )
+{
+    /* Same direction, origins on a grid in reverse Morton order */
+    const point_t<> o[8] =
+    {
+        point_t<>(1.0f, 1.0f, 1.0f), point_t<>(0.0f, 1.0f, 1.0f), point_t<>(1.0f, 0.0f, 1.0f), point_t<>(0.0f, 0.0f, 1.0f),
+        point_t<>(1.0f, 1.0f, 0.0f), point_t<>(0.0f, 1.0f, 0.0f), point_t<>(1.0f, 0.0f, 0.0f), point_t<>(0.0f, 0.0f, 0.0f)
+    };
+
+    std::vector<ray> rays;
+    for (int i = 0; i < 8; ++i)
+    {
+        rays.emplace_back(o[i], 0.0f, 0.0f, 1.0f);
+    }
+
+    ray_sorter uut;
+    std::vector<int> order(rays.size());
+    uut.sort(rays.data(), order.data(), rays.size());
+    for (int i = 0; i < 8; ++i)
+    {
+        BOOST_CHECK(order[i] == (7 - i));
+    }
+}
+
+BOOST_AUTO_TEST_CASE( flat_bounds_test )
+{
+    /* All origins in the z = 0 plane */
+    std::vector<ray> rays;
+    for (int i = 0; i < 100; ++i)
+    {
+        rays.emplace_back(point_t<>(static_cast<float>(i % 10), static_cast<float>(i / 10), 0.0f), 0.0f, 0.0f, 1.0f);
+    }
+
+    ray_sorter uut;
+    std::vector<int> order(rays.size());
+    uut.sort(rays.data(), order.data(), rays.size());
+    BOOST_CHECK(is_permutation(order));
+    BOOST_CHECK(order[0] == 0);
+    BOOST_CHECK(order[99] == 99);
+}
+
+BOOST_AUTO_TEST_CASE( reuse_test )
+{
+    /* Sort a large set then a small one with the same sorter */
+    std::vector<ray> rays;
+    for (int i = 0; i < 1000; ++i)
+    {
+        rays.emplace_back(point_t<>(static_cast<float>(i * 7 % 13), static_cast<float>(i * 3 % 11), static_cast<float>(i % 5)), ((i % 3) - 1.0f), 1.0f, -1.0f);
+    }
+
+    ray_sorter uut;
+    std::vector<int> order(rays.size());
+    uut.sort(rays.data(), order.data(), rays.size());
+    BOOST_CHECK(is_permutation(order));
+
+    order.resize(10);
+    uut.sort(rays.data(), order.data(), 10);
+    BOOST_CHECK(is_permutation(order));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+}; /* namespace test */
+}; /* namespace raptor_raytracer */
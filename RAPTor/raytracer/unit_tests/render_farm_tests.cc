@@ -0,0 +1,252 @@
+#ifdef STAND_ALONE
+#define BOOST_TEST_MODULE render_farm test
+
+/* Common headers */
+#include "logging.h"
+
+/* Initialise logger */
+const raptor_physics::init_logger init_logger;
+#endif /* #ifdef STAND_ALONE */
+
+/* Standard headers */
+#include <atomic>
+#include <future>
+#include <thread>
+#include <vector>
+
+/* Boost headers */
+#include "boost/test/unit_test.hpp"
+
+/* Ray tracer headers */
+#include "render_farm.h"
+
+
+namespace raptor_raytracer
+{
+namespace test
+{
+const std::string local_host("127.0.0.1");
+
+/* Render a colour that identifies each pixel */
+bool render_pattern(const render_job &job, ext_colour_t *pixels)
+{
+    for (int y = job.t.y0; y < job.t.y1; ++y)
+    {
+        for (int x = job.t.x0; x < job.t.x1; ++x)
+        {
+            *pixels++ = ext_colour_t(x, y, job.frame);
+        }
+    }
+
+    return true;
+}
+
+struct render_farm_fixture
+{
+    render_farm_fixture(const int x_res, const int y_res, const int frames, const int tile_size)
+      : uut(new render_coordinator(0, x_res, y_res, frames, tile_size)),
+        image(x_res * y_res * frames),
+        returned(uut->number_of_jobs()),
+        x_res(x_res),
+        y_res(y_res),
+        frames(frames)
+    {  }
+
+    ~render_farm_fixture()
+    {
+        uut.reset();
+        for (auto &w : workers)
+        {
+            w.join();
+        }
+    }
+
+    /* Start a worker rendering with f */
+    void add_worker(const render_worker::render_function &f, std::atomic<int> *const worked = nullptr)
+    {
+        const std::uint16_t port = uut->port();
+        workers.emplace_back([f, port, worked]()
+        {
+            render_worker worker(local_host, port);
+            const bool ok = worker.run(f);
+            if ((worked != nullptr) && ok)
+            {
+                ++(*worked);
+            }
+        });
+    }
+
+    /* Run the farm, collecting the results */
+    bool run(const int timeout_ms = 60000)
+    {
+        return uut->run([this](const render_job &job, const ext_colour_t *pixels)
+        {
+            ++returned[job.id];
+            for (int y = job.t.y0; y < job.t.y1; ++y)
+            {
+                for (int x = job.t.x0; x < job.t.x1; ++x)
+                {
+                    image[(job.frame * x_res * y_res) + (y * x_res) + x] = *pixels++;
+                }
+            }
+        }, timeout_ms);
+    }
+
+    /* Check every pixel was rendered and every job was returned once */
+    void check_image() const
+    {
+        int wrong = 0;
+        for (int f = 0; f < frames; ++f)
+        {
+            for (int y = 0; y < y_res; ++y)
+            {
+                for (int x = 0; x < x_res; ++x)
+                {
+                    const ext_colour_t &p = image[(f * x_res * y_res) + (y * x_res) + x];
+                    wrong += (p.r != x) || (p.g != y) || (p.b != f);
+                }
+            }
+        }
+        BOOST_CHECK(wrong == 0);
+
+        for (const int r : returned)
+        {
+            BOOST_CHECK(r == 1);
+        }
+    }
+
+    std::unique_ptr<render_coordinator> uut;
+    std::vector<std::thread>            workers;
+    std::vector<ext_colour_t>           image;
+    std::vector<std::atomic<int>>       returned;
+    const int                           x_res;
+    const int                           y_res;
+    const int                           frames;
+};
+
+
+BOOST_AUTO_TEST_SUITE( render_farm_tests );
+
+BOOST_AUTO_TEST_CASE( tile_jobs_test )
+{
+    const render_coordinator uut(0, 100, 70, 1, 32);
+    BOOST_CHECK(uut.number_of_jobs() == 12);
+    BOOST_CHECK(uut.port() != 0);
+}
+
+BOOST_AUTO_TEST_CASE( frame_jobs_test )
+{
+    const render_coordinator uut(0, 100, 70, 5, 32);
+    BOOST_CHECK(uut.number_of_jobs() == 5);
+}
+
+BOOST_AUTO_TEST_CASE( one_worker_test )
+{
+    std::atomic<int> worked(0);
+    {
+        render_farm_fixture farm(100, 70, 1, 32);
+        farm.add_worker(render_pattern, &worked);
+        BOOST_CHECK(farm.run());
+        farm.check_image();
+    }
+    BOOST_CHECK(worked == 1);
+}
+
+BOOST_AUTO_TEST_CASE( many_workers_test )
+{
+    std::atomic<int> worked(0);
+    {
+        render_farm_fixture farm(256, 192, 1, 16);
+        for (int i = 0; i < 4; ++i)
+        {
+            farm.add_worker(render_pattern, &worked);
+        }
+        BOOST_CHECK(farm.run());
+        farm.check_image();
+    }
+    BOOST_CHECK(worked == 4);
+}
+
+BOOST_AUTO_TEST_CASE( frames_test )
+{
+    std::atomic<int> worked(0);
+    {
+        render_farm_fixture farm(40, 30, 7, 32);
+        farm.add_worker(render_pattern, &worked);
+        farm.add_worker(render_pattern, &worked);
+        BOOST_CHECK(farm.run());
+        farm.check_image();
+    }
+    BOOST_CHECK(worked == 2);
+}
+
+BOOST_AUTO_TEST_CASE( lost_worker_test )
+{
+    /* A worker that drops out with its first job */
+    std::atomic<int> worked(0);
+    std::atomic<int> dropped(0);
+    {
+        render_farm_fixture farm(128, 128, 1, 16);
+        farm.add_worker([&dropped](const render_job &, ext_colour_t *)
+        {
+            ++dropped;
+            return false;
+        }, &worked);
+        farm.add_worker(render_pattern, &worked);
+        BOOST_CHECK(farm.run());
+        farm.check_image();
+    }
+    BOOST_CHECK(worked == 1);
+    BOOST_CHECK(dropped <= 1);
+}
+
+BOOST_AUTO_TEST_CASE( stalled_worker_test )
+{
+    /* A worker that stalls on its first job until the farm is done */
+    std::promise<void> release;
+    std::shared_future<void> released(release.get_future());
+    std::atomic<int> worked(0);
+    std::atomic<int> stalled(0);
+    {
+        render_farm_fixture farm(128, 128, 1, 16);
+        farm.add_worker([released, &stalled](const render_job &job, ext_colour_t *pixels)
+        {
+            if (stalled++ == 0)
+            {
+                released.wait();
+            }
+            return render_pattern(job, pixels);
+        }, &worked);
+
+        /* The other worker finishes the new work and then the stalled jobs */
+        farm.add_worker(render_pattern, &worked);
+        BOOST_CHECK(farm.run());
+        release.set_value();
+        farm.check_image();
+    }
+    BOOST_CHECK(worked >= 1);
+}
+
+BOOST_AUTO_TEST_CASE( no_workers_test )
+{
+    render_farm_fixture farm(100, 70, 1, 32);
+    BOOST_CHECK(!farm.run(100));
+}
+
+BOOST_AUTO_TEST_CASE( no_coordinator_test )
+{
+    /* Find a port nothing is listening on */
+    std::uint16_t port;
+    {
+        const render_coordinator coordinator(0, 100, 70);
+        port = coordinator.port();
+    }
+
+    render_worker uut(local_host, port);
+    BOOST_CHECK(!uut.run(render_pattern));
+    BOOST_CHECK(uut.jobs_rendered() == 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+}; /* namespace test */
+}; /* namespace raptor_raytracer */
@@ -0,0 +1,280 @@
+#ifdef STAND_ALONE
+#define BOOST_TEST_MODULE scene_cache test
+
+/* Common headers */
+#include "logging.h"
+
+/* Initialise logger */
+const raptor_physics::init_logger init_logger;
+#endif /* #ifdef STAND_ALONE */
+
+/* Standard headers */
+#include <cstdio>
+#include <fstream>
+#include <list>
+#include <memory>
+
+/* Boost headerrs */
+#include "boost/test/unit_test.hpp"
+
+/* Ray tracer headers */
+#include "scene_cache.h"
+#include "phong_shader.h"
+#include "coloured_mapper_shader.h"
+#include "kd_tree.h"
+#include "bvh.h"
+#include "bih.h"
+
+
+namespace raptor_raytracer
+{
+namespace test
+{
+const float result_tolerance = 0.0001f;
+
+struct scene_cache_fixture
+{
+    scene_cache_fixture() :
+    cache_file("scene_cache_tests.cache"),
+    hash(0x123456789abcdefULL)
+    {
+        /* A grid of squares, half of them smooth shaded */
+        materials.push_back(new phong_shader(ext_colour_t(255.0f, 0.0f, 0.0f), 0.5f, 0.25f, 10.0f));
+        materials.push_back(new phong_shader(ext_colour_t(0.0f, 255.0f, 0.0f), 0.75f));
+        for (int i = 0; i < 10; ++i)
+        {
+            for (int j = 0; j < 10; ++j)
+            {
+                const point_t<> a(i * 10.0f, j * 10.0f, (i + j) * 2.0f);
+                const point_t<> b(a + point_t<>(9.0f, 0.0f, 0.0f));
+                const point_t<> c(a + point_t<>(9.0f, 9.0f, 0.0f));
+                const point_t<> d(a + point_t<>(0.0f, 9.0f, 0.0f));
+                material *const mat = materials.back();
+                if ((i + j) & 0x1)
+                {
+                    const point_t<> vn[3] = { point_t<>(0.0f, 0.0f, -1.0f), point_t<>(0.0f, 0.1f, -1.0f), point_t<>(0.1f, 0.0f, -1.0f) };
+                    const point_t<> vt[3] = { point_t<>(0.0f, 0.0f, 0.0f), point_t<>(1.0f, 0.0f, 0.0f), point_t<>(1.0f, 1.0f, 0.0f) };
+                    everything.emplace_back(mat, a, b, c, false, &vn[0], &vt[0]);
+                    everything.emplace_back(materials.front(), a, c, d, false, &vn[0]);
+                }
+                else
+                {
+                    everything.emplace_back(mat, a, b, c, false);
+                    everything.emplace_back(materials.front(), a, c, d, false);
+                }
+            }
+        }
+
+        /* A light made of primitives and a point light */
+        materials.push_back(new coloured_mapper_shader(ext_colour_t(255.0f, 255.0f, 255.0f), ext_colour_t(0.0f, 0.0f, 0.0f)));
+        const int first_light = everything.size();
+        everything.emplace_back(materials.back(), point_t<>(0.0f, 0.0f, -50.0f), point_t<>(10.0f, 0.0f, -50.0f), point_t<>(10.0f, 10.0f, -50.0f), true);
+        lights.push_back(light(&everything, ext_colour_t(255.0f, 255.0f, 255.0f), point_t<>(5.0f, 5.0f, -50.0f), 0.0f, new std::vector<int>({ first_light })));
+        lights.push_back(light(ext_colour_t(127.0f, 127.0f, 255.0f), point_t<>(50.0f, 50.0f, -20.0f), 0.1f, 1.0f));
+    }
+
+    ~scene_cache_fixture()
+    {
+        for (auto *m : materials)
+        {
+            delete m;
+        }
+
+        std::remove(cache_file.c_str());
+    }
+
+    /* Load into a new scene and check everything is the same */
+    void check_load(const ssd_type_t t, const ssd *const exp)
+    {
+        light_list                  loaded_lights;
+        primitive_store             loaded;
+        std::list<material *>       loaded_materials;
+        std::unique_ptr<ssd>        loaded_ssd;
+        BOOST_REQUIRE(scene_cache::load(cache_file, hash, t, &loaded_lights, &loaded, &loaded_materials, &loaded_ssd));
+
+        BOOST_REQUIRE(loaded.size() == everything.size());
+        BOOST_REQUIRE(loaded_materials.size() == materials.size());
+        auto exp_mat = materials.begin();
+        for (const auto *m : loaded_materials)
+        {
+            BOOST_CHECK((dynamic_cast<const phong_shader *>(m) != nullptr) == (dynamic_cast<const phong_shader *>(*exp_mat) != nullptr));
+            BOOST_CHECK((dynamic_cast<const coloured_mapper_shader *>(m) != nullptr) == (dynamic_cast<const coloured_mapper_shader *>(*exp_mat) != nullptr));
+            ++exp_mat;
+        }
+
+        BOOST_CHECK(loaded.number_of_normals()              == everything.number_of_normals());
+        BOOST_CHECK(loaded.number_of_texture_coords()       == everything.number_of_texture_coords());
+        BOOST_CHECK(loaded.number_of_vertex_attributes()    == everything.number_of_vertex_attributes());
+        for (int i = 0; i < everything.size(); ++i)
+        {
+            BOOST_CHECK(loaded.indirection(i)                   == everything.indirection(i));
+            BOOST_CHECK(loaded.primitive(i)->get_vertex_a()     == everything.primitive(i)->get_vertex_a());
+            BOOST_CHECK(loaded.primitive(i)->get_vertex_b()     == everything.primitive(i)->get_vertex_b());
+            BOOST_CHECK(loaded.primitive(i)->get_vertex_c()     == everything.primitive(i)->get_vertex_c());
+            BOOST_CHECK(loaded.primitive(i)->get_light()        == everything.primitive(i)->get_light());
+        }
+
+        BOOST_REQUIRE(loaded_lights.size() == lights.size());
+        for (unsigned i = 0; i < lights.size(); ++i)
+        {
+            BOOST_CHECK(loaded_lights[i].get_centre() == lights[i].get_centre());
+            const ext_colour_t loaded_i(loaded_lights[i].get_light_intensity(point_t<>(0.0f, 0.0f, 1.0f), 10.0f));
+            const ext_colour_t exp_i(lights[i].get_light_intensity(point_t<>(0.0f, 0.0f, 1.0f), 10.0f));
+            BOOST_CHECK_CLOSE(loaded_i.r, exp_i.r, result_tolerance);
+            BOOST_CHECK_CLOSE(loaded_i.g, exp_i.g, result_tolerance);
+            BOOST_CHECK_CLOSE(loaded_i.b, exp_i.b, result_tolerance);
+        }
+
+        /* Check the loaded ssd finds the same primitives */
+        if (exp != nullptr)
+        {
+            BOOST_REQUIRE(loaded_ssd != nullptr);
+            BOOST_CHECK(loaded_ssd->scene_lower_bound() == exp->scene_lower_bound());
+            BOOST_CHECK(loaded_ssd->scene_upper_bound() == exp->scene_upper_bound());
+            for (int i = -5; i <= 5; ++i)
+            {
+                for (int j = -5; j <= 5; ++j)
+                {
+                    const ray r(point_t<>(50.0f, 50.0f, -30.0f), i * 0.1f, j * 0.1f, 1.0f);
+                    hit_description loaded_h;
+                    hit_description exp_h;
+                    const int loaded_idx = loaded_ssd->find_nearest_object(&r, &loaded_h);
+                    const int exp_idx = exp->find_nearest_object(&r, &exp_h);
+                    BOOST_CHECK(loaded_idx == exp_idx);
+                    BOOST_CHECK_CLOSE(loaded_h.d, exp_h.d, result_tolerance);
+                }
+            }
+        }
+        else
+        {
+            BOOST_CHECK(loaded_ssd == nullptr);
+        }
+
+        for (auto *m : loaded_materials)
+        {
+            delete m;
+        }
+    }
+
+    std::string             cache_file;
+    std::uint64_t           hash;
+    light_list              lights;
+    primitive_store         everything;
+    std::list<material *>   materials;
+};
+
+BOOST_FIXTURE_TEST_SUITE( scene_cache_tests, scene_cache_fixture );
+
+BOOST_AUTO_TEST_CASE( hash_file_test )
+{
+    BOOST_CHECK(scene_cache::hash_file("scene_cache_tests.missing") == 0);
+
+    /* Write a file and hash it */
+    {
+        std::ofstream out(cache_file);
+        out << "v 0 0 0" << std::endl;
+    }
+    const std::uint64_t h0 = scene_cache::hash_file(cache_file);
+    BOOST_CHECK(h0 != 0);
+    BOOST_CHECK(scene_cache::hash_file(cache_file) == h0);
+
+    /* Change the file */
+    {
+        std::ofstream out(cache_file);
+        out << "v 0 0 1" << std::endl;
+    }
+    BOOST_CHECK(scene_cache::hash_file(cache_file) != h0);
+}
+
+BOOST_AUTO_TEST_CASE( missing_cache_test )
+{
+    light_list              loaded_lights;
+    primitive_store         loaded;
+    std::list<material *>   loaded_materials;
+    std::unique_ptr<ssd>    loaded_ssd;
+    BOOST_CHECK(!scene_cache::load(cache_file, hash, ssd_type_t::bvh, &loaded_lights, &loaded, &loaded_materials, &loaded_ssd));
+    BOOST_CHECK(loaded.empty());
+    BOOST_CHECK(loaded_lights.empty());
+    BOOST_CHECK(loaded_materials.empty());
+}
+
+BOOST_AUTO_TEST_CASE( stale_cache_test )
+{
+    BOOST_REQUIRE(scene_cache::save(cache_file, hash, lights, 0, everything, materials, ssd_type_t::wbvh, nullptr));
+
+    /* Different hash */
+    light_list              loaded_lights;
+    primitive_store         loaded;
+    std::list<material *>   loaded_materials;
+    std::unique_ptr<ssd>    loaded_ssd;
+    BOOST_CHECK(!scene_cache::load(cache_file, hash + 1, ssd_type_t::bvh, &loaded_lights, &loaded, &loaded_materials, &loaded_ssd));
+    BOOST_CHECK(loaded.empty());
+    BOOST_CHECK(loaded_lights.empty());
+    BOOST_CHECK(loaded_materials.empty());
+
+    /* Not a cache */
+    {
+        std::ofstream out(cache_file);
+        out << "v 0 0 0" << std::endl;
+    }
+    BOOST_CHECK(!scene_cache::load(cache_file, hash, ssd_type_t::bvh, &loaded_lights, &loaded, &loaded_materials, &loaded_ssd));
+    BOOST_CHECK(loaded.empty());
+}
+
+BOOST_AUTO_TEST_CASE( scene_only_test )
+{
+    BOOST_REQUIRE(scene_cache::save(cache_file, hash, lights, 0, everything, materials, ssd_type_t::wbvh, nullptr));
+    check_load(ssd_type_t::bvh, nullptr);
+}
+
+BOOST_AUTO_TEST_CASE( first_light_test )
+{
+    /* Lights before first_light arent from the scene so arent saved */
+    BOOST_REQUIRE(scene_cache::save(cache_file, hash, lights, 1, everything, materials, ssd_type_t::wbvh, nullptr));
+
+    light_list              loaded_lights;
+    primitive_store         loaded;
+    std::list<material *>   loaded_materials;
+    std::unique_ptr<ssd>    loaded_ssd;
+    BOOST_REQUIRE(scene_cache::load(cache_file, hash, ssd_type_t::bvh, &loaded_lights, &loaded, &loaded_materials, &loaded_ssd));
+    BOOST_REQUIRE(loaded_lights.size() == 1);
+    BOOST_CHECK(loaded_lights[0].get_centre() == lights[1].get_centre());
+
+    for (auto *m : loaded_materials)
+    {
+        delete m;
+    }
+}
+
+BOOST_AUTO_TEST_CASE( kd_tree_test )
+{
+    kd_tree exp(everything);
+    BOOST_REQUIRE(scene_cache::save(cache_file, hash, lights, 0, everything, materials, ssd_type_t::kdt, &exp));
+    check_load(ssd_type_t::kdt, &exp);
+}
+
+BOOST_AUTO_TEST_CASE( bvh_test )
+{
+    bvh exp(everything);
+    BOOST_REQUIRE(scene_cache::save(cache_file, hash, lights, 0, everything, materials, ssd_type_t::bvh, &exp));
+    check_load(ssd_type_t::bvh, &exp);
+}
+
+BOOST_AUTO_TEST_CASE( bih_test )
+{
+    bih exp(everything);
+    BOOST_REQUIRE(scene_cache::save(cache_file, hash, lights, 0, everything, materials, ssd_type_t::bih, &exp));
+    check_load(ssd_type_t::bih, &exp);
+}
+
+BOOST_AUTO_TEST_CASE( different_ssd_test )
+{
+    /* The scene is still loaded, but the ssd must be built */
+    bvh exp(everything);
+    BOOST_REQUIRE(scene_cache::save(cache_file, hash, lights, 0, everything, materials, ssd_type_t::bvh, &exp));
+    check_load(ssd_type_t::bih, nullptr);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+}; /* namespace test */
+}; /* namespace raptor_raytracer */
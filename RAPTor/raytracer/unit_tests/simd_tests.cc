@@ -30,6 +30,8 @@ const float result_tolerance = 0.00001;
 
 BOOST_AUTO_TEST_SUITE( simd_tests );
 
+/* The expected values are written for 4 lanes */
+#if SIMD_WIDTH == 4
 
 // CTOR tests
 BOOST_AUTO_TEST_CASE( simd_ctor_from_floats_test )
@@ -1351,6 +1353,32 @@ BOOST_AUTO_TEST_CASE( min_element_performance_test )
 }
 #endif /* #ifndef VALGRIND_TESTS */
 
+#else   /* #if SIMD_WIDTH == 4 */
+
+/* Mask and reduction tests for wider vectors */
+BOOST_AUTO_TEST_CASE( index_to_mask_lut_test )
+{
+    for (int i = 0; i < SIMD_WIDTH; ++i)
+    {
+        BOOST_CHECK(move_mask(index_to_mask_lut[i]) == ((1 << i) - 1));
+    }
+}
+
+BOOST_AUTO_TEST_CASE( min_element_test )
+{
+    float d[(SIMD_WIDTH * 3) + 1];
+    for (int i = 0; i < (SIMD_WIDTH * 3) + 1; ++i)
+    {
+        d[i] = static_cast<float>((i * 7) % 11);
+    }
+    d[SIMD_WIDTH + 3] = -1.0f;
+
+    float m;
+    BOOST_CHECK(min_element(&d[0], &m, (SIMD_WIDTH * 3) + 1) == SIMD_WIDTH + 3);
+    BOOST_CHECK(m == -1.0f);
+}
+#endif /* #if SIMD_WIDTH == 4 */
+
 BOOST_AUTO_TEST_SUITE_END()
 }; /* namespace test */
 }; /* namespace raptor_raytracer */
@@ -428,6 +428,8 @@ BOOST_AUTO_TEST_CASE( medium_random_vector_merge_sort_test )
     BOOST_CHECK_CLOSE(data[63],  98.2074738f,   result_tolerance);
 }
 
+/* Which buffer holds the result depends on the 4 lane merge network */
+#if SIMD_WIDTH == 4
 BOOST_AUTO_TEST_CASE( simd_width_m1_random_vector_merge_sort_test )
 {
     auto data(random(23));
@@ -521,6 +523,8 @@ BOOST_AUTO_TEST_CASE( not_in_register_block_random_vector_merge_sort_test )
     BOOST_CHECK_CLOSE(output[23],  86.9385834f,     result_tolerance);
 }
 
+#endif /* #if SIMD_WIDTH == 4 */
+
 BOOST_AUTO_TEST_CASE( odd_size_sweep_random_vector_merge_sort_test )
 {
     for (int i = 16; i < 48; ++i)
@@ -0,0 +1,240 @@
+#ifdef STAND_ALONE
+#define BOOST_TEST_MODULE texture_cache test
+
+/* Common headers */
+#include "logging.h"
+
+/* Initialise logger */
+const raptor_physics::init_logger init_logger;
+#endif /* #ifdef STAND_ALONE */
+
+/* Standard headers */
+#include <thread>
+#include <vector>
+
+/* Boost headers */
+#include "boost/test/unit_test.hpp"
+
+/* Ray tracer headers */
+#include "texture_cache.h"
+#include "planar_mapper.h"
+
+
+namespace raptor_raytracer
+{
+namespace test
+{
+const float result_tolerance = 0.0005f;
+const int tile_size = 1 << LOG2_TEXTURE_TILE_SIZE;
+
+struct texture_cache_fixture
+{
+    /* An rgb image with a different value in every componant */
+    texture_cache_fixture() : img(w * h * 3)
+    {
+        for (int i = 0; i < static_cast<int>(img.size()); ++i)
+        {
+            img[i] = static_cast<float>(i % 251);
+        }
+    }
+
+    const int           w = 100;
+    const int           h = 60;
+    std::vector<float>  img;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( texture_cache_tests, texture_cache_fixture );
+
+
+BOOST_AUTO_TEST_CASE( levels_test )
+{
+    texture_cache uut;
+    const cached_texture *const tex = uut.add("img", img.data(), w, h, 3);
+    BOOST_REQUIRE(tex != nullptr);
+    BOOST_CHECK(tex->components() == 3);
+
+    /* Halved rounding up to 1 by 1 */
+    const unsigned sizes[][2] = { { 100, 60 }, { 50, 30 }, { 25, 15 }, { 13, 8 }, { 7, 4 }, { 4, 2 }, { 2, 1 }, { 1, 1 } };
+    BOOST_REQUIRE(tex->levels() == 8);
+    for (int l = 0; l < tex->levels(); ++l)
+    {
+        BOOST_CHECK(tex->width(l)  == sizes[l][0]);
+        BOOST_CHECK(tex->height(l) == sizes[l][1]);
+    }
+}
+
+BOOST_AUTO_TEST_CASE( texel_test )
+{
+    /* Every texel should come back, including those over tile boundaries */
+    texture_cache uut;
+    const cached_texture *const tex = uut.add("img", img.data(), w, h, 3);
+    for (int y = 0; y < h; ++y)
+    {
+        for (int x = 0; x < w; ++x)
+        {
+            float t[3];
+            tex->texel(t, 0, x, y);
+            for (int i = 0; i < 3; ++i)
+            {
+                BOOST_REQUIRE(t[i] == img[(((y * w) + x) * 3) + i]);
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE( mip_test )
+{
+    /* Each texel of level 1 averages 4 of level 0 */
+    texture_cache uut;
+    const cached_texture *const tex = uut.add("img", img.data(), w, h, 3);
+    for (int y = 0; y < static_cast<int>(tex->height(1)); ++y)
+    {
+        for (int x = 0; x < static_cast<int>(tex->width(1)); ++x)
+        {
+            float t[3];
+            tex->texel(t, 1, x, y);
+            for (int i = 0; i < 3; ++i)
+            {
+                const float e = (img[((((y * 2) * w) + (x * 2)) * 3) + i] + img[((((y * 2) * w) + (x * 2) + 1) * 3) + i] +
+                    img[(((((y * 2) + 1) * w) + (x * 2)) * 3) + i] + img[(((((y * 2) + 1) * w) + (x * 2) + 1) * 3) + i]) * 0.25f;
+                BOOST_CHECK_CLOSE(t[i], e, result_tolerance);
+            }
+        }
+    }
+
+    /* The last level of a power of 2 image is its mean */
+    std::vector<float> grey(64 * 64);
+    double sum = 0.0;
+    for (int i = 0; i < static_cast<int>(grey.size()); ++i)
+    {
+        grey[i] = static_cast<float>(i % 64);
+        sum += grey[i];
+    }
+
+    const cached_texture *const grey_tex = uut.add("grey", grey.data(), 64, 64, 1);
+    BOOST_REQUIRE(grey_tex->levels() == 7);
+
+    float t;
+    grey_tex->texel(&t, 6, 0, 0);
+    BOOST_CHECK_CLOSE(t, sum / grey.size(), result_tolerance);
+}
+
+BOOST_AUTO_TEST_CASE( dedupe_test )
+{
+    texture_cache uut;
+    const cached_texture *const a = uut.add("img", img.data(), w, h, 3);
+    const cached_texture *const b = uut.add("img", img.data(), w, h, 3);
+    const cached_texture *const c = uut.add("other", img.data(), w, h, 3);
+    BOOST_CHECK(a == b);
+    BOOST_CHECK(a != c);
+}
+
+BOOST_AUTO_TEST_CASE( budget_test )
+{
+    /* 8 by 8 tiles with space for only 4 */
+    const int size = tile_size * 8;
+    const std::size_t tile_bytes = tile_size * tile_size * sizeof(float);
+    std::vector<float> big(size * size);
+    for (int i = 0; i < static_cast<int>(big.size()); ++i)
+    {
+        big[i] = static_cast<float>(i);
+    }
+
+    texture_cache uut(tile_bytes * 4);
+    const cached_texture *const tex = uut.add("big", big.data(), size, size, 1);
+    BOOST_CHECK(uut.tile_reads() == 0);
+    BOOST_CHECK(uut.resident() == 0);
+
+    /* Tiles are only read when used */
+    for (int y = 0; y < size; y += tile_size)
+    {
+        for (int x = 0; x < size; x += tile_size)
+        {
+            float t;
+            tex->texel(&t, 0, x + 1, y + 1);
+            BOOST_CHECK(t == big[((y + 1) * size) + x + 1]);
+            BOOST_CHECK(uut.resident() <= uut.budget());
+        }
+    }
+    BOOST_CHECK(uut.tile_reads() == 64);
+    BOOST_CHECK(uut.resident() == (tile_bytes * 4));
+
+    /* The first tile was evicted so is read again */
+    float t;
+    tex->texel(&t, 0, 0, 0);
+    BOOST_CHECK(t == big[0]);
+    BOOST_CHECK(uut.tile_reads() == 65);
+
+    /* Shrinking the budget evicts */
+    uut.budget(tile_bytes);
+    BOOST_CHECK(uut.resident() == tile_bytes);
+}
+
+BOOST_AUTO_TEST_CASE( threaded_test )
+{
+    /* Threads sharing a cache too small to hold the texture should all see the right texels */
+    texture_cache uut(tile_size * tile_size * 3 * sizeof(float) * 2);
+    const cached_texture *const tex = uut.add("img", img.data(), w, h, 3);
+
+    std::vector<int> errors(4, 0);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < static_cast<int>(errors.size()); ++i)
+    {
+        threads.emplace_back([this, tex, i, &errors]()
+        {
+            for (int j = 0; j < 4000; ++j)
+            {
+                const int x = ((j * 37) + (i * 11)) % w;
+                const int y = ((j * 13) + (i * 7)) % h;
+                float t[3];
+                tex->texel(t, 0, x, y);
+                errors[i] += (t[0] != img[((y * w) + x) * 3]);
+            }
+        });
+    }
+
+    for (auto &t : threads)
+    {
+        t.join();
+    }
+
+    for (const int e : errors)
+    {
+        BOOST_CHECK(e == 0);
+    }
+}
+
+BOOST_AUTO_TEST_CASE( level_of_detail_test )
+{
+    /* A flat grey image with a bright texel */
+    std::vector<float> spot(64 * 64, 100.0f);
+    spot[(8 * 64) + 8] = 4196.0f;
+
+    texture_cache uut;
+    const cached_texture *const tex = uut.add("spot", spot.data(), 64, 64, 1);
+    const planar_mapper mapper(tex, point_t<>(0.0f), point_t<>(1.0f, 0.0f, 0.0f), point_t<>(0.0f), texture_wrapping_mode_t::clamp, texture_wrapping_mode_t::clamp);
+
+    /* Texture co-ordinates at the bright texel with 1 unit of texture per 10 units of world */
+    const point_t<> vt(8.0f / 64.0f, 8.0f / 64.0f, 0.1f);
+    const ray r(point_t<>(0.0f, 0.0f, 0.0f), point_t<>(0.0f, 0.0f, 100.0f));
+
+    /* Without any spread the texel is sampled exactly */
+    ext_colour_t c;
+    mapper.texture_map(r, &c, point_t<>(0.0f, 0.0f, -1.0f), vt);
+    BOOST_CHECK_CLOSE(c.r, 4196.0f, result_tolerance);
+
+    /* Covering 4 by 4 texels it is averaged with its neighbours */
+    uut.pixel_spread(4.0f / (100.0f * 0.1f * 64.0f));
+    mapper.texture_map(r, &c, point_t<>(0.0f, 0.0f, -1.0f), vt);
+    BOOST_CHECK_CLOSE(c.r, 100.0f + (4096.0f / 16.0f), result_tolerance);
+
+    /* Covering the whole image it is the average of the image */
+    uut.pixel_spread(1.0f);
+    mapper.texture_map(r, &c, point_t<>(0.0f, 0.0f, -1.0f), vt);
+    BOOST_CHECK_CLOSE(c.r, 100.0f + (4096.0f / (64.0f * 64.0f)), result_tolerance);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+}; /* namespace test */
+}; /* namespace raptor_raytracer */
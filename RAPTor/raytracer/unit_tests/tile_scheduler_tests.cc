@@ -0,0 +1,143 @@
+#ifdef STAND_ALONE
+#define BOOST_TEST_MODULE tile_scheduler test
+
+/* Common headers */
+#include "logging.h"
+
+/* Initialise logger */
+const raptor_physics::init_logger init_logger;
+#endif /* #ifdef STAND_ALONE */
+
+/* Standard headers */
+#include <cstdlib>
+#include <vector>
+
+/* Boost headers */
+#include "boost/test/unit_test.hpp"
+
+/* Ray tracer headers */
+#include "tile_scheduler.h"
+
+
+namespace raptor_raytracer
+{
+namespace test
+{
+/* Count how many times each pixel is covered by a tile */
+std::vector<int> coverage(const tile_scheduler &uut, const int x_res, const int y_res)
+{
+    std::vector<int> covered(x_res * y_res, 0);
+    for (int i = 0; i < uut.number_of_tiles(); ++i)
+    {
+        const tile &t = uut.get_tile(i);
+        for (int y = t.y0; y < t.y1; ++y)
+        {
+            for (int x = t.x0; x < t.x1; ++x)
+            {
+                ++covered[x + (y * x_res)];
+            }
+        }
+    }
+
+    return covered;
+}
+
+BOOST_AUTO_TEST_SUITE( tile_scheduler_tests );
+
+BOOST_AUTO_TEST_CASE( ctor_test )
+{
+    const tile_scheduler uut(640, 480, 32, 8);
+    BOOST_CHECK(uut.number_of_tiles()   == 300);
+    BOOST_CHECK(uut.number_of_passes()  == 4);
+    BOOST_CHECK(uut.tile_size()         == 32);
+    BOOST_CHECK(uut.pass_step(0)        == 8);
+    BOOST_CHECK(uut.pass_step(1)        == 4);
+    BOOST_CHECK(uut.pass_step(2)        == 2);
+    BOOST_CHECK(uut.pass_step(3)        == 1);
+    BOOST_CHECK(!uut.cancelled());
+}
+
+BOOST_AUTO_TEST_CASE( default_ctor_test )
+{
+    const tile_scheduler uut(64, 64);
+    BOOST_CHECK(uut.number_of_tiles()   == 4);
+    BOOST_CHECK(uut.number_of_passes()  == 1);
+    BOOST_CHECK(uut.pass_step(0)        == 1);
+}
+
+BOOST_AUTO_TEST_CASE( hilbert_coverage_test )
+{
+    const tile_scheduler uut(200, 72, 16);
+    BOOST_CHECK(uut.number_of_tiles() == (13 * 5));
+    for (const int c : coverage(uut, 200, 72))
+    {
+        BOOST_REQUIRE(c == 1);
+    }
+}
+
+BOOST_AUTO_TEST_CASE( spiral_coverage_test )
+{
+    const tile_scheduler uut(200, 72, 16, 1, tile_order_t::spiral);
+    BOOST_CHECK(uut.number_of_tiles() == (13 * 5));
+    for (const int c : coverage(uut, 200, 72))
+    {
+        BOOST_REQUIRE(c == 1);
+    }
+}
+
+BOOST_AUTO_TEST_CASE( hilbert_order_test )
+{
+    /* Over a power of 2 square each tile is next to the last */
+    const tile_scheduler uut(256, 256, 32);
+    BOOST_CHECK(uut.get_tile(0).x0 == 0);
+    BOOST_CHECK(uut.get_tile(0).y0 == 0);
+    for (int i = 1; i < uut.number_of_tiles(); ++i)
+    {
+        const tile &l = uut.get_tile(i - 1);
+        const tile &t = uut.get_tile(i);
+        BOOST_CHECK((std::abs(t.x0 - l.x0) + std::abs(t.y0 - l.y0)) == 32);
+    }
+}
+
+BOOST_AUTO_TEST_CASE( spiral_order_test )
+{
+    /* Start in the middle and move out one ring at a time */
+    const tile_scheduler uut(160, 160, 32, 1, tile_order_t::spiral);
+    BOOST_CHECK(uut.get_tile(0).x0 == 64);
+    BOOST_CHECK(uut.get_tile(0).y0 == 64);
+
+    int last_ring = 0;
+    for (int i = 1; i < uut.number_of_tiles(); ++i)
+    {
+        const tile &t = uut.get_tile(i);
+        const int ring = std::max(std::abs(t.x0 - 64), std::abs(t.y0 - 64)) / 32;
+        BOOST_CHECK(ring >= last_ring);
+        last_ring = ring;
+    }
+    BOOST_CHECK(last_ring == 2);
+}
+
+BOOST_AUTO_TEST_CASE( clipped_tile_test )
+{
+    const tile_scheduler uut(40, 24, 16);
+    for (int i = 0; i < uut.number_of_tiles(); ++i)
+    {
+        const tile &t = uut.get_tile(i);
+        BOOST_CHECK(t.x1 <= 40);
+        BOOST_CHECK(t.y1 <= 24);
+        BOOST_CHECK(t.x1 > t.x0);
+        BOOST_CHECK(t.y1 > t.y0);
+    }
+}
+
+BOOST_AUTO_TEST_CASE( cancel_test )
+{
+    tile_scheduler uut(64, 64);
+    BOOST_CHECK(!uut.cancelled());
+    BOOST_CHECK(uut.cancel().cancelled());
+    BOOST_CHECK(!uut.reset().cancelled());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+}; /* namespace test */
+}; /* namespace raptor_raytracer */
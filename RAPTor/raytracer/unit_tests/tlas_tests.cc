@@ -0,0 +1,206 @@
+#ifdef STAND_ALONE
+#define BOOST_TEST_MODULE tlas test
+
+/* Common headers */
+#include "logging.h"
+
+/* Initialise logger */
+const raptor_physics::init_logger init_logger;
+#endif /* #ifdef STAND_ALONE */
+
+/* Standard headers */
+#include <memory>
+#include <vector>
+
+/* Boost headerrs */
+#include "boost/test/unit_test.hpp"
+
+/* Ray tracer headers */
+#include "phong_shader.h"
+#include "bvh.h"
+#include "tlas.h"
+
+
+namespace raptor_raytracer
+{
+namespace test
+{
+const float result_tolerance = 0.0001f;
+
+struct tlas_fixture
+{
+    tlas_fixture() :
+    mat(new phong_shader(ext_colour_t(255.0f, 255.0f, 255.0f))),
+    square(new primitive_store())
+    {
+        /* A single square to be instanced */
+        square->emplace_back(mat.get(), point_t<>(0.0f, 0.0f, 0.0f), point_t<>(0.0f, 9.0f, 0.0f), point_t<>(0.0f, 9.0f, 9.0f), false);
+        square->emplace_back(mat.get(), point_t<>(0.0f, 0.0f, 0.0f), point_t<>(0.0f, 9.0f, 9.0f), point_t<>(0.0f, 0.0f, 9.0f), false);
+        square_bvh.reset(new bvh(*square));
+
+        /* A grid of placements, some rotated and scaled */
+        for (int i = 0; i < 5; ++i)
+        {
+            for (int j = 0; j < 5; ++j)
+            {
+                for (int k = 0; k < 4; ++k)
+                {
+                    const quaternion_t o(point_t<>(0.0f, 1.0f, 0.0f), (i + j + k) * 0.3f);
+                    const point_t<> t(i * 20.0f, j * 15.0f, k * 25.0f);
+                    placements.emplace_back(o, t, 1.0f + (k * 0.25f));
+                }
+            }
+        }
+    }
+
+    /* Fire rays in all directions from a few origins and check uut finds the same hits as exp */
+    void check_rays(const ssd &uut, const ssd &exp) const
+    {
+        const point_t<> origins[3] = { point_t<>(-20.0f, 30.0f, 40.0f), point_t<>(110.0f, -10.0f, 120.0f), point_t<>(45.0f, 35.0f, 50.0f) };
+        for (const auto &o : origins)
+        {
+            for (int i = -4; i <= 4; ++i)
+            {
+                for (int j = -4; j <= 4; ++j)
+                {
+                    for (int k = -1; k <= 1; k += 2)
+                    {
+                        const ray r(o, static_cast<float>(k), i * 0.23f, j * 0.19f);
+                        hit_description uut_h;
+                        hit_description exp_h;
+                        const int uut_i = uut.find_nearest_object(&r, &uut_h);
+                        const int exp_i = exp.find_nearest_object(&r, &exp_h);
+                        BOOST_CHECK(uut_i == exp_i);
+                        BOOST_CHECK_CLOSE(uut_h.d, exp_h.d, result_tolerance);
+                        BOOST_CHECK(uut.found_nearer_object(&r, 100.0f) == exp.found_nearer_object(&r, 100.0f));
+                    }
+                }
+            }
+        }
+    }
+
+    std::unique_ptr<material>           mat;
+    std::shared_ptr<primitive_store>    square;
+    std::shared_ptr<bvh>                square_bvh;
+    std::vector<instance_transform>     placements;
+};
+
+BOOST_FIXTURE_TEST_SUITE( tlas_tests, tlas_fixture );
+
+BOOST_AUTO_TEST_CASE( empty_test )
+{
+    tlas uut(std::vector<instance>{});
+    BOOST_CHECK(uut.number_of_instances()   == 0);
+    BOOST_CHECK(uut.number_of_nodes()       == 1);
+    BOOST_CHECK(uut.number_of_leaves()      == 1);
+
+    hit_description h;
+    ray r(point_t<>(-1.0f, 8.0f, 1.0f), 1.0f, 0.0f, 0.0f);
+    BOOST_CHECK(uut.find_nearest_object(&r, &h) == -1);
+    BOOST_CHECK(!uut.found_nearer_object(&r, 10.0f));
+}
+
+BOOST_AUTO_TEST_CASE( identity_test )
+{
+    tlas uut({ instance(square_bvh, square) });
+    BOOST_CHECK(uut.number_of_nodes()   == 1);
+    BOOST_CHECK(uut.number_of_leaves()  == 1);
+    BOOST_CHECK(uut.scene_lower_bound() == point_t<>(0.0f, 0.0f, 0.0f));
+    BOOST_CHECK(uut.scene_upper_bound() == point_t<>(0.0f, 9.0f, 9.0f));
+
+    /* Miss */
+    hit_description h0;
+    ray r0(point_t<>(-1.0f, 10.0f, 1.0f), 1.0f, 0.0f, 0.0f);
+    BOOST_CHECK(uut.find_nearest_object(&r0, &h0) == -1);
+    BOOST_CHECK(!uut.found_nearer_object(&r0, 10.0f));
+
+    /* Hit */
+    hit_description h1;
+    ray r1(point_t<>(-1.0f, 8.0f, 1.0f), 1.0f, 0.0f, 0.0f);
+    BOOST_CHECK(uut.find_nearest_object(&r1, &h1) == 0);
+    BOOST_CHECK_CLOSE(h1.d, 1.0f, result_tolerance);
+    BOOST_CHECK( uut.found_nearer_object(&r1, 2.0f));
+    BOOST_CHECK(!uut.found_nearer_object(&r1, 0.5f));
+
+    /* Shading look up */
+    const instance_transform *xfm = nullptr;
+    BOOST_CHECK(uut.instanced_primitive(1, &xfm) == square->primitive(1));
+    BOOST_CHECK(xfm == &uut.get_instance(0).transform());
+}
+
+BOOST_AUTO_TEST_CASE( transformed_test )
+{
+    /* Rotate so the square faces z, then scale and move it */
+    const instance_transform xfm(quaternion_t(point_t<>(0.0f, 1.0f, 0.0f), PI * 0.5f), point_t<>(0.0f, 0.0f, 10.0f), 2.0f);
+    tlas uut({ instance(square_bvh, square, xfm) });
+    BOOST_CHECK(uut.scene_lower_bound().z > 9.99f);
+    BOOST_CHECK(uut.scene_upper_bound().z < 10.01f);
+    BOOST_CHECK_CLOSE(uut.scene_upper_bound().x, 18.0f, result_tolerance);
+    BOOST_CHECK_CLOSE(uut.scene_upper_bound().y, 18.0f, result_tolerance);
+
+    /* Hit in world space */
+    hit_description h;
+    ray r(point_t<>(4.0f, 4.0f, 5.0f), 0.0f, 0.0f, 1.0f);
+    const int i = uut.find_nearest_object(&r, &h);
+    BOOST_CHECK(i != -1);
+    BOOST_CHECK_CLOSE(h.d, 5.0f, result_tolerance);
+    BOOST_CHECK( uut.found_nearer_object(&r, 6.0f));
+    BOOST_CHECK(!uut.found_nearer_object(&r, 4.0f));
+
+    /* The normal must be in world space too */
+    const instance_transform *hit_xfm = nullptr;
+    const triangle *tri = uut.instanced_primitive(i, &hit_xfm);
+    BOOST_REQUIRE(tri != nullptr);
+    BOOST_REQUIRE(hit_xfm != nullptr);
+    r.calculate_destination(h.d);
+    const point_t<> n(tri->normal_at_point(&r, &h, hit_xfm));
+    BOOST_CHECK(fabs(n.x) < result_tolerance);
+    BOOST_CHECK(fabs(n.y) < result_tolerance);
+    BOOST_CHECK_CLOSE(n.z, -1.0f, result_tolerance);
+    BOOST_CHECK_CLOSE(r.get_length(), 5.0f, result_tolerance);
+}
+
+BOOST_AUTO_TEST_CASE( matches_flattened_test )
+{
+    /* Instance the square and flatten the same placements into one store */
+    std::vector<instance> instances;
+    primitive_store flat;
+    for (const auto &p : placements)
+    {
+        instances.emplace_back(square_bvh, square, p);
+        for (const auto &t : *square)
+        {
+            flat.emplace_back(mat.get(), p.point_to_world(t.get_vertex_a()), p.point_to_world(t.get_vertex_b()), p.point_to_world(t.get_vertex_c()), false);
+        }
+    }
+
+    tlas uut(instances);
+    bvh exp(flat);
+    BOOST_CHECK(uut.number_of_instances() == static_cast<int>(placements.size()));
+    BOOST_CHECK(uut.number_of_leaves() > 1);
+    BOOST_CHECK(uut.sah_cost() > 0.0f);
+    check_rays(uut, exp);
+}
+
+BOOST_AUTO_TEST_CASE( move_test )
+{
+    tlas uut({ instance(square_bvh, square), instance(square_bvh, square, instance_transform(quaternion_t(), point_t<>(10.0f, 0.0f, 0.0f))) });
+
+    hit_description h0;
+    ray r(point_t<>(-1.0f, 8.0f, 1.0f), 1.0f, 0.0f, 0.0f);
+    BOOST_CHECK(uut.find_nearest_object(&r, &h0) == 0);
+    BOOST_CHECK_CLOSE(h0.d, 1.0f, result_tolerance);
+
+    /* Move the first square behind the second */
+    uut.move_instance(0, instance_transform(quaternion_t(), point_t<>(20.0f, 0.0f, 0.0f)));
+    uut.rebuild();
+
+    hit_description h1;
+    BOOST_CHECK(uut.find_nearest_object(&r, &h1) == 2);
+    BOOST_CHECK_CLOSE(h1.d, 11.0f, result_tolerance);
+    BOOST_CHECK_CLOSE(uut.scene_upper_bound().x, 20.0f, result_tolerance);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+}; /* namespace test */
+}; /* namespace raptor_raytracer */
@@ -0,0 +1,113 @@
+#ifdef STAND_ALONE
+#define BOOST_TEST_MODULE traversal_statistics test
+
+/* Common headers */
+#include "logging.h"
+
+/* Initialise logger */
+const raptor_physics::init_logger init_logger;
+#endif /* #ifdef STAND_ALONE */
+
+/* Count in this file even when the ray tracer is built without counting */
+#ifndef TRAVERSAL_STATISTICS
+#define TRAVERSAL_STATISTICS
+#endif /* #ifndef TRAVERSAL_STATISTICS */
+
+/* Standard headers */
+#include <thread>
+
+/* Boost headers */
+#include "boost/test/unit_test.hpp"
+
+/* Ray tracer headers */
+#include "traversal_statistics.h"
+
+
+namespace raptor_raytracer
+{
+namespace test
+{
+BOOST_AUTO_TEST_SUITE( traversal_statistics_tests );
+
+BOOST_AUTO_TEST_CASE( ctor_test )
+{
+    const traversal_statistics uut;
+    for (int i = 0; i < traversal_statistics::number_of_counters; ++i)
+    {
+        BOOST_CHECK(uut.counts[i] == 0);
+    }
+}
+
+BOOST_AUTO_TEST_CASE( add_test )
+{
+    traversal_statistics uut;
+    traversal_statistics s;
+    for (int i = 0; i < traversal_statistics::number_of_counters; ++i)
+    {
+        uut.counts[i]   = i;
+        s.counts[i]     = 10 * i;
+    }
+
+    uut += s;
+    for (int i = 0; i < traversal_statistics::number_of_counters; ++i)
+    {
+        BOOST_CHECK(uut.counts[i] == static_cast<std::uint64_t>(11 * i));
+        BOOST_CHECK(s.counts[i]   == static_cast<std::uint64_t>(10 * i));
+    }
+}
+
+BOOST_AUTO_TEST_CASE( subtract_test )
+{
+    traversal_statistics a;
+    traversal_statistics b;
+    for (int i = 0; i < traversal_statistics::number_of_counters; ++i)
+    {
+        a.counts[i] = 7 * i;
+        b.counts[i] = 3 * i;
+    }
+
+    const traversal_statistics uut(a - b);
+    for (int i = 0; i < traversal_statistics::number_of_counters; ++i)
+    {
+        BOOST_CHECK(uut.counts[i] == static_cast<std::uint64_t>(4 * i));
+    }
+}
+
+BOOST_AUTO_TEST_CASE( count_test )
+{
+    const traversal_statistics before(thread_traversal_statistics);
+    COUNT_TRAVERSAL(nodes_visited, 3);
+    COUNT_TRAVERSAL(leaves_visited, 1);
+    COUNT_TRAVERSAL(triangle_tests, SIMD_WIDTH);
+    COUNT_TRAVERSAL(frustrum_culls, true);
+    COUNT_PACKET_LANES(0x3);
+
+    const traversal_statistics uut(thread_traversal_statistics - before);
+    BOOST_CHECK(uut.counts[traversal_statistics::nodes_visited]     == 3);
+    BOOST_CHECK(uut.counts[traversal_statistics::leaves_visited]    == 1);
+    BOOST_CHECK(uut.counts[traversal_statistics::triangle_tests]    == SIMD_WIDTH);
+    BOOST_CHECK(uut.counts[traversal_statistics::active_lanes]      == 2);
+    BOOST_CHECK(uut.counts[traversal_statistics::packet_lanes]      == SIMD_WIDTH);
+    BOOST_CHECK(uut.counts[traversal_statistics::frustrum_culls]    == 1);
+}
+
+BOOST_AUTO_TEST_CASE( per_thread_test )
+{
+    /* Work counted by another thread isnt seen by this one */
+    const traversal_statistics before(thread_traversal_statistics);
+    std::uint64_t other_nodes = 0;
+    std::thread other([&other_nodes]()
+    {
+        COUNT_TRAVERSAL(nodes_visited, 5);
+        other_nodes = thread_traversal_statistics.counts[traversal_statistics::nodes_visited];
+    });
+    other.join();
+
+    const traversal_statistics uut(thread_traversal_statistics - before);
+    BOOST_CHECK(other_nodes == 5);
+    BOOST_CHECK(uut.counts[traversal_statistics::nodes_visited] == 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+}; /* namespace test */
+}; /* namespace raptor_raytracer */
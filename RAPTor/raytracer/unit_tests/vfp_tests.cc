@@ -24,6 +24,8 @@ const float result_tolerance = 0.00001;
 
 BOOST_AUTO_TEST_SUITE( vfp_tests );
 
+/* The expected values are written for 4 lanes */
+#if SIMD_WIDTH == 4
 
 /* CTOR tests */
 BOOST_AUTO_TEST_CASE( vfp_ctor_from_floats_test )
@@ -1380,6 +1382,41 @@ BOOST_AUTO_TEST_CASE( merge_16x16_2_test )
     BOOST_CHECK_CLOSE(uut7[3],  86.9385986f,    result_tolerance);
 }
 
+#else   /* #if SIMD_WIDTH == 4 */
+
+/* Lane order tests for wider vectors */
+BOOST_AUTO_TEST_CASE( vfp_wide_lanes_test )
+{
+    /* Load increasing values */
+    float a[SIMD_WIDTH] __attribute__ ((aligned(SIMD_WIDTH * 4)));
+    for (int i = 0; i < SIMD_WIDTH; ++i)
+    {
+        a[i] = static_cast<float>(i) - 2.0f;
+    }
+    const vfp_t uut(&a[0]);
+
+    /* Checks */
+    const vfp_t sum(uut + vfp_t(2.0f));
+    for (int i = 0; i < SIMD_WIDTH; ++i)
+    {
+        BOOST_CHECK_CLOSE(uut[i], a[i], result_tolerance);
+        BOOST_CHECK_CLOSE(sum[i], static_cast<float>(i), result_tolerance);
+    }
+    BOOST_CHECK_CLOSE(horizontal_min(uut), -2.0f, result_tolerance);
+    BOOST_CHECK_CLOSE(horizontal_max(uut), SIMD_WIDTH - 3.0f, result_tolerance);
+    BOOST_CHECK(move_mask(uut < vfp_zero) == 0x3);
+    BOOST_CHECK(move_mask(vfp_true) == ((1 << SIMD_WIDTH) - 1));
+
+    /* Store back */
+    float b[SIMD_WIDTH] __attribute__ ((aligned(SIMD_WIDTH * 4)));
+    sum.store(&b[0]);
+    for (int i = 0; i < SIMD_WIDTH; ++i)
+    {
+        BOOST_CHECK_CLOSE(b[i], static_cast<float>(i), result_tolerance);
+    }
+}
+#endif /* #if SIMD_WIDTH == 4 */
+
 BOOST_AUTO_TEST_SUITE_END()
 }; // namespace test
 }; // namespace raptor_raytracer
@@ -30,6 +30,8 @@ const int result_tolerance = 0.00001;
 
 BOOST_AUTO_TEST_SUITE( vint_tests );
 
+/* The expected values are written for 4 lanes */
+#if SIMD_WIDTH == 4
 
 /* CTOR tests */
 BOOST_AUTO_TEST_CASE( vint_ctor_from_ints_test )
@@ -924,6 +926,31 @@ BOOST_AUTO_TEST_CASE( morton_code_performance_test )
     BOOST_CHECK(passed);
 }
 
+#else   /* #if SIMD_WIDTH == 4 */
+
+/* Lane order tests for wider vectors */
+BOOST_AUTO_TEST_CASE( vint_wide_lanes_test )
+{
+    /* Load increasing values */
+    int a[SIMD_WIDTH] __attribute__ ((aligned(SIMD_WIDTH * 4)));
+    for (int i = 0; i < SIMD_WIDTH; ++i)
+    {
+        a[i] = i;
+    }
+    const vint_t uut(&a[0]);
+
+    /* Checks */
+    const vint_t shifted(uut << 2);
+    const vint_t cmp(uut > vint_t(1));
+    for (int i = 0; i < SIMD_WIDTH; ++i)
+    {
+        BOOST_CHECK(uut[i] == i);
+        BOOST_CHECK(shifted[i] == (i << 2));
+        BOOST_CHECK(cmp[i] == ((i > 1) ? -1 : 0));
+    }
+}
+#endif /* #if SIMD_WIDTH == 4 */
+
 BOOST_AUTO_TEST_SUITE_END()
 }; // namespace test
 }; // namespace raptor_raytracer
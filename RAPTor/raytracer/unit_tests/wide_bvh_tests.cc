@@ -0,0 +1,146 @@
+#ifdef STAND_ALONE
+#define BOOST_TEST_MODULE wide_bvh test
+
+/* Common headers */
+#include "logging.h"
+
+/* Initialise logger */
+const raptor_physics::init_logger init_logger;
+#endif /* #ifdef STAND_ALONE */
+
+/* Standard headers */
+
+/* Boost headerrs */
+#include "boost/test/unit_test.hpp"
+
+/* Ray tracer headers */
+#include "phong_shader.h"
+#include "bvh.h"
+#include "wide_bvh.h"
+
+
+namespace raptor_raytracer
+{
+namespace test
+{
+const float result_tolerance = 0.00001f;
+
+struct wide_bvh_fixture
+{
+    wide_bvh_fixture() :
+    mat(new phong_shader(ext_colour_t(255.0f, 255.0f, 255.0f)))
+    {
+        /* A single square */
+        square.emplace_back(mat.get(), point_t(0.0f, 0.0f, 0.0f), point_t(0.0f, 9.0f, 0.0f), point_t(0.0f, 9.0f, 9.0f), false);
+        square.emplace_back(mat.get(), point_t(0.0f, 0.0f, 0.0f), point_t(0.0f, 9.0f, 9.0f), point_t(0.0f, 0.0f, 9.0f), false);
+
+        /* Layers of squares with a light in front */
+        for (int i = 0; i < 10; ++i)
+        {
+            for (int j = 0; j < 10; ++j)
+            {
+                for (int k = 0; k < 4; ++k)
+                {
+                    const float x = static_cast<float>(k * 3);
+                    const float y = static_cast<float>(i);
+                    const float z = static_cast<float>(j) + (k * 0.25f);
+                    layers.emplace_back(mat.get(), point_t(x, y, z), point_t(x, y + 0.9f, z), point_t(x, y + 0.9f, z + 0.9f), false);
+                    layers.emplace_back(mat.get(), point_t(x, y, z), point_t(x, y + 0.9f, z + 0.9f), point_t(x, y, z + 0.9f), false);
+                }
+            }
+        }
+        layers.emplace_back(mat.get(), point_t(-1.0f, 0.0f, 0.0f), point_t(-1.0f, 10.0f, 0.0f), point_t(-1.0f, 10.0f, 10.0f), true);
+    }
+
+    std::unique_ptr<material>   mat;
+    primitive_store             square;
+    primitive_store             layers;
+};
+
+BOOST_FIXTURE_TEST_SUITE( wide_bvh_tests, wide_bvh_fixture );
+
+BOOST_AUTO_TEST_CASE( single_node_test )
+{
+    wide_bvh uut(square);
+    BOOST_CHECK(uut.number_of_nodes()   == 1);
+    BOOST_CHECK(uut.number_of_leaves()  >= 1);
+    BOOST_CHECK(uut.number_of_leaves()  <= 2);
+
+    /* Miss */
+    hit_description h0;
+    ray r0(point_t(-1.0f, 10.0f, 1.0f), 1.0f, 0.0f, 0.0f);
+    BOOST_CHECK( uut.find_nearest_object(&r0, &h0) == -1);
+    BOOST_CHECK(!uut.found_nearer_object(&r0, 10.0f));
+
+    /* Hit from both sides */
+    hit_description h1;
+    ray r1(point_t(-1.0f, 8.0f, 1.0f), 1.0f, 0.0f, 0.0f);
+    BOOST_CHECK(uut.find_nearest_object(&r1, &h1) == 0);
+    BOOST_CHECK_CLOSE(h1.d, 1.0f, result_tolerance);
+    BOOST_CHECK( uut.found_nearer_object(&r1, 2.0f));
+    BOOST_CHECK(!uut.found_nearer_object(&r1, 0.5f));
+
+    hit_description h2;
+    ray r2(point_t(3.0f, 1.0f, 8.0f), -1.0f, 0.0f, 0.0f);
+    BOOST_CHECK(uut.find_nearest_object(&r2, &h2) == 1);
+    BOOST_CHECK_CLOSE(h2.d, 3.0f, result_tolerance);
+}
+
+BOOST_AUTO_TEST_CASE( structure_test )
+{
+    wide_bvh uut(layers);
+    BOOST_CHECK(uut.number_of_nodes() > 1);
+    BOOST_CHECK(uut.number_of_nodes() < static_cast<int>(layers.size()));
+    BOOST_CHECK(uut.number_of_leaves() > 0);
+    BOOST_CHECK(uut.number_of_leaves() <= static_cast<int>(layers.size()));
+}
+
+BOOST_AUTO_TEST_CASE( matches_bvh_test )
+{
+    wide_bvh uut(layers);
+    layers.reset_indirection();
+    bvh exp(layers);
+
+    /* Fire rays in all octants from a few origins */
+    const point_t<> origins[3] = { point_t<>(-5.0f, 4.5f, 5.0f), point_t<>(15.0f, -2.0f, 12.0f), point_t<>(4.5f, 4.5f, 4.5f) };
+    for (const auto &o : origins)
+    {
+        for (int i = -4; i <= 4; ++i)
+        {
+            for (int j = -4; j <= 4; ++j)
+            {
+                for (int k = -1; k <= 1; k += 2)
+                {
+                    const ray r(o, static_cast<float>(k), i * 0.23f, j * 0.19f);
+                    hit_description uut_h;
+                    hit_description exp_h;
+                    const int uut_i = uut.find_nearest_object(&r, &uut_h);
+                    const int exp_i = exp.find_nearest_object(&r, &exp_h);
+                    BOOST_CHECK(uut_i == exp_i);
+                    BOOST_CHECK(uut_h.d == exp_h.d);
+
+                    BOOST_CHECK(uut.found_nearer_object(&r, 5.0f) == exp.found_nearer_object(&r, 5.0f));
+                }
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE( light_doesnt_occlude_test )
+{
+    wide_bvh uut(layers);
+
+    /* Hit the light */
+    hit_description h;
+    ray r(point_t(-2.0f, 5.0f, 5.0f), 1.0f, 0.0f, 0.0f);
+    BOOST_CHECK(uut.find_nearest_object(&r, &h) == static_cast<int>(layers.size() - 1));
+    BOOST_CHECK_CLOSE(h.d, 1.0f, result_tolerance);
+
+    /* But it doesnt cast shadows */
+    BOOST_CHECK(!uut.found_nearer_object(&r, 1.5f));
+    BOOST_CHECK( uut.found_nearer_object(&r, 4.0f));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+}; /* namespace test */
+}; /* namespace raptor_raytracer */